@@ -26,8 +26,8 @@ int main()
         #define FRAMEBUFFER_WIDTH 128
         #define FRAMEBUFFER_HEIGHT 128
 
-        Framebuffer_t fb;
-        ShaderProgram_t shader;
+        Framebuffer_t fb = { 0 };
+        ShaderProgram_t shader = { 0 };
 
         // Setup all resources
         if(createResources(&fb, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, &shader) != 0)
@@ -59,25 +59,24 @@ int createResources(Framebuffer_t* fb, const size_t fbWidth, const size_t fbHeig
         if(fb != NULL)
         {
                 // Allocate color buffer
-                fb->colorBuffer = malloc( fbWidth * fbHeight * sizeof(unsigned char) * 3 );
-                if(fb->colorBuffer == NULL)
+                unsigned char* colorBuffer = malloc( fbWidth * fbHeight * sizeof(unsigned char) * 3 );
+                if(colorBuffer == NULL)
                 {
                         fprintf(stderr, "[ ERROR ] createResources() failed, failed to allocate memory for the frame buffer's color buffer!\n");
                         return 1;
                 }
 
                 // Allocate depth buffer
-                fb->depthBuffer = malloc( sizeof(float) * fbWidth * fbHeight );
-                if(fb->depthBuffer == NULL)
+                float* depthBuffer = malloc( sizeof(float) * fbWidth * fbHeight );
+                if(depthBuffer == NULL)
                 {
-                        destroyResources(fb, NULL);
+                        free(colorBuffer);
 
                         fprintf(stderr, "[ ERROR ] createResources() failed, failed to allocate memory for the frame buffer's depth buffer!\n");
                         return 1;
                 }
 
-                fb->width = fbWidth;
-                fb->height = fbWidth;
+                mnkt_framebuffer_init(fb, fbWidth, fbHeight, colorBuffer, depthBuffer);
         }
 
         // Setup shader program struct, if one is given
@@ -116,6 +115,9 @@ void destroyResources(Framebuffer_t* fb, ShaderProgram_t* shader)
                         fb->depthBuffer = NULL;
                 }
 
+                // Release the memory owned by the framebuffer itself (e.g. its frame arena)
+                mnkt_framebuffer_destroy(fb);
+
                 fb->width = 0;
                 fb->height = 0;
         }
@@ -145,7 +147,8 @@ void renderImage(Framebuffer_t* fb, ShaderProgram_t* shader)
                 return;
         }
 
-        // Clear framebuffer content
+        // Start a new frame and clear framebuffer content
+        mnkt_beginFrame(fb);
         mnkt_framebuffer_clearColor(255, 116, 0, fb);
         mnkt_framebuffer_clearDepth(1.0f, fb);
         
@@ -0,0 +1,408 @@
+/**
+ * @file blend.c
+ *
+ * Contains implementation of the output merger's blending functions
+*/
+
+#include "blend.h"
+
+#include "math/mathUtils.h"
+#include "utility/colorUtils.h"
+#include "utility/simd.h"
+
+#include <string.h>
+
+
+#ifdef MNKT_SIMD_SSE2
+/**
+ * @struct BlendFactorMasks_t
+ * Blend factor of the color components resolved, once per span, into lane masks: the factor is the sum of the
+ * selected operands, optionally subtracted from one, so no branch is taken inside the pixel loop
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        __m128          srcColor;               ///< All bits set if the factor uses the source color component
+        __m128          dstColor;               ///< All bits set if the factor uses the destination color component
+        __m128          srcAlpha;               ///< All bits set if the factor uses the source alpha
+        __m128          constant;               ///< Constant part of the factor (one or zero)
+        __m128          invert;                 ///< All bits set if the factor is subtracted from one
+} BlendFactorMasks_t;
+
+
+static BlendFactorMasks_t mnkt_blend_getFactorMasks(BlendFactor_t factor);
+static __m128   mnkt_blend_applyFactorMasks(const BlendFactorMasks_t* masks, __m128 srcColor, __m128 dstColor, __m128 srcAlpha);
+static void     mnkt_blend_quad(const BlendState_t* state, const BlendFactorMasks_t* srcFactor, const BlendFactorMasks_t* dstFactor, int bypassOpaque,
+                                const Vec4_t srcColors[4], unsigned char dstColors[12]);
+static __m128   mnkt_blend_combine(BlendOp_t op, __m128 src, __m128 dst);
+#else
+static float    mnkt_blend_getFactor(BlendFactor_t factor, const float src[4], const float dst[3], int channel);
+static float    mnkt_blend_combine(BlendOp_t op, float src, float dst);
+#endif
+
+
+/**
+ * @function mnkt_blend_alphaState
+ * Creates the state for the classic "over" blending of non premultiplied colors (src * srcAlpha + dst * (1 - srcAlpha))
+ * @return The blend state
+*/
+BlendState_t mnkt_blend_alphaState(void)
+{
+        return (BlendState_t) {
+                .enabled = 1,
+                .srcColorFactor = MNKT_BLEND_SRC_ALPHA,
+                .dstColorFactor = MNKT_BLEND_ONE_MINUS_SRC_ALPHA,
+                .colorOp = MNKT_BLEND_OP_ADD
+        };
+}
+
+
+/**
+ * @function mnkt_blend_premultipliedAlphaState
+ * Creates the state for the "over" blending of premultiplied colors (src + dst * (1 - srcAlpha))
+ * @return The blend state
+*/
+BlendState_t mnkt_blend_premultipliedAlphaState(void)
+{
+        return (BlendState_t) {
+                .enabled = 1,
+                .srcColorFactor = MNKT_BLEND_ONE,
+                .dstColorFactor = MNKT_BLEND_ONE_MINUS_SRC_ALPHA,
+                .colorOp = MNKT_BLEND_OP_ADD
+        };
+}
+
+
+/**
+ * @function mnkt_blend_additiveState
+ * Creates the state for additive blending (src * srcAlpha + dst), commonly used for particles
+ * @return The blend state
+*/
+BlendState_t mnkt_blend_additiveState(void)
+{
+        return (BlendState_t) {
+                .enabled = 1,
+                .srcColorFactor = MNKT_BLEND_SRC_ALPHA,
+                .dstColorFactor = MNKT_BLEND_ONE,
+                .colorOp = MNKT_BLEND_OP_ADD
+        };
+}
+
+
+/**
+ * @function mnkt_blend_isOpaqueBypass
+ * Checks if, with the given state, an opaque source color (alpha equal to one) always replaces the destination color,
+ * in such case the framebuffer does not need to be read for opaque fragments
+ * @param state The blend state to be checked
+ * @return One if opaque fragments can be written directly, zero otherwise
+*/
+int mnkt_blend_isOpaqueBypass(const BlendState_t* state)
+{
+        if(state == NULL || !state->enabled)
+                return 1;
+
+        if(state->colorOp != MNKT_BLEND_OP_ADD)
+                return 0;
+
+        // With alpha equal to one the source must be kept as it is...
+        if(state->srcColorFactor != MNKT_BLEND_ONE && state->srcColorFactor != MNKT_BLEND_SRC_ALPHA)
+                return 0;
+
+        // ...and the destination must be cancelled out
+        return state->dstColorFactor == MNKT_BLEND_ZERO || state->dstColorFactor == MNKT_BLEND_ONE_MINUS_SRC_ALPHA;
+}
+
+
+/**
+ * @function mnkt_blend_span
+ * Blends a span of contiguous fragments with the content of an RGB color buffer
+ * @param state The blend state to be used (if blending is disabled source colors are simply written)
+ * @param srcColors Colors produced by the fragment shader for each fragment of the span
+ * @param dstColors Pointer to the RGB color of the first pixel of the span inside the color buffer
+ * @param count Number of fragments in the span
+*/
+void mnkt_blend_span(const BlendState_t* state, const Vec4_t* srcColors, unsigned char* dstColors, size_t count)
+{
+        if(srcColors == NULL || dstColors == NULL)
+                return;
+
+        const int bypassOpaque = mnkt_blend_isOpaqueBypass(state);
+        const int blendEnabled = state != NULL && state->enabled;
+
+#ifdef MNKT_SIMD_SSE2
+        // Factors are resolved once for the whole span
+        BlendFactorMasks_t srcFactor = mnkt_blend_getFactorMasks(blendEnabled ? state->srcColorFactor : MNKT_BLEND_ONE);
+        BlendFactorMasks_t dstFactor = mnkt_blend_getFactorMasks(blendEnabled ? state->dstColorFactor : MNKT_BLEND_ZERO);
+
+        const BlendState_t replace = { .enabled = 0 };
+
+        if( !blendEnabled )
+                state = &replace;
+
+        // Four fragments are blended at a time, the last ones are padded to a full group
+        size_t i = 0;
+
+        for(; i + 4 <= count; i += 4, dstColors += 12)
+                mnkt_blend_quad(state, &srcFactor, &dstFactor, bypassOpaque, &srcColors[i], dstColors);
+
+        if(i < count)
+        {
+                Vec4_t tailSrc[4] = { 0 };
+                unsigned char tailDst[12] = { 0 };
+
+                memcpy(tailSrc, &srcColors[i], (count - i) * sizeof(Vec4_t));
+                memcpy(tailDst, dstColors, (count - i) * 3);
+
+                mnkt_blend_quad(state, &srcFactor, &dstFactor, bypassOpaque, tailSrc, tailDst);
+
+                memcpy(dstColors, tailDst, (count - i) * 3);
+        }
+#else
+        for(size_t i = 0; i < count; ++i, dstColors += 3)
+        {
+                const float src[4] = {
+                        mnkt_math_clamp(srcColors[i].r, 0.0f, 1.0f),
+                        mnkt_math_clamp(srcColors[i].g, 0.0f, 1.0f),
+                        mnkt_math_clamp(srcColors[i].b, 0.0f, 1.0f),
+                        mnkt_math_clamp(srcColors[i].a, 0.0f, 1.0f)
+                };
+
+                // Fast path, the framebuffer content is not read at all
+                if( !blendEnabled || (bypassOpaque && srcColors[i].a >= 1.0f) )
+                {
+                        for(int c = 0; c < 3; ++c)
+                                dstColors[c] = mnkt_colorAsUChar(src[c]);
+
+                        continue;
+                }
+
+                const float dst[3] = {
+                        mnkt_colorAsFloat(dstColors[0]),
+                        mnkt_colorAsFloat(dstColors[1]),
+                        mnkt_colorAsFloat(dstColors[2])
+                };
+
+                for(int c = 0; c < 3; ++c)
+                {
+                        float weightedSrc = src[c];
+                        float weightedDst = dst[c];
+
+                        if(state->colorOp < MNKT_BLEND_OP_MIN)
+                        {
+                                weightedSrc *= mnkt_blend_getFactor(state->srcColorFactor, src, dst, c);
+                                weightedDst *= mnkt_blend_getFactor(state->dstColorFactor, src, dst, c);
+                        }
+
+                        dstColors[c] = mnkt_colorAsUChar( mnkt_blend_combine(state->colorOp, weightedSrc, weightedDst) );
+                }
+        }
+#endif
+}
+
+
+#ifdef MNKT_SIMD_SSE2
+
+/**
+ * @function mnkt_blend_getFactorMasks
+ * Resolves a blend factor of the color components into the masks used by mnkt_blend_applyFactorMasks
+ * @param factor The blend factor
+ * @return The masks of the factor
+ * @note: For internal usage only!!!
+*/
+static BlendFactorMasks_t mnkt_blend_getFactorMasks(BlendFactor_t factor)
+{
+        const __m128 all = _mm_castsi128_ps( _mm_set1_epi32(-1) );
+        const __m128 none = _mm_setzero_ps();
+
+        BlendFactorMasks_t masks = {
+                .srcColor = none,
+                .dstColor = none,
+                .srcAlpha = none,
+                .constant = none,
+                .invert = none
+        };
+
+        switch(factor)
+        {
+                case MNKT_BLEND_ZERO:                   break;
+                case MNKT_BLEND_ONE:                    masks.constant = _mm_set1_ps(1.0f); break;
+                case MNKT_BLEND_SRC_COLOR:              masks.srcColor = all; break;
+                case MNKT_BLEND_ONE_MINUS_SRC_COLOR:    masks.srcColor = all; masks.invert = all; break;
+                case MNKT_BLEND_DST_COLOR:              masks.dstColor = all; break;
+                case MNKT_BLEND_ONE_MINUS_DST_COLOR:    masks.dstColor = all; masks.invert = all; break;
+                case MNKT_BLEND_SRC_ALPHA:              masks.srcAlpha = all; break;
+                case MNKT_BLEND_ONE_MINUS_SRC_ALPHA:    masks.srcAlpha = all; masks.invert = all; break;
+        }
+
+        return masks;
+}
+
+
+/**
+ * @function mnkt_blend_applyFactorMasks
+ * Computes the factor of a color component for four fragments
+ * @param masks The resolved blend factor
+ * @param srcColor The component of the source colors
+ * @param dstColor The component of the destination colors
+ * @param srcAlpha The alpha of the source colors
+ * @return The factors of the four fragments
+ * @note: For internal usage only!!!
+*/
+static __m128 mnkt_blend_applyFactorMasks(const BlendFactorMasks_t* masks, __m128 srcColor, __m128 dstColor, __m128 srcAlpha)
+{
+        __m128 factor = _mm_or_ps( _mm_or_ps( _mm_and_ps(masks->srcColor, srcColor), _mm_and_ps(masks->dstColor, dstColor) ),
+                                   _mm_or_ps( _mm_and_ps(masks->srcAlpha, srcAlpha), masks->constant ) );
+
+        return _mm_or_ps( _mm_and_ps(masks->invert, _mm_sub_ps(_mm_set1_ps(1.0f), factor)), _mm_andnot_ps(masks->invert, factor) );
+}
+
+
+/**
+ * @function mnkt_blend_quad
+ * Blends four contiguous fragments, their colors are transposed so that each register holds a component of the four fragments
+ * @param state The blend state (enabled)
+ * @param srcFactor The resolved source factor of the color components
+ * @param dstFactor The resolved destination factor of the color components
+ * @param bypassOpaque Non zero if opaque fragments replace the destination color
+ * @param srcColors Colors produced by the fragment shader for the four fragments
+ * @param dstColors RGB colors of the four pixels inside the color buffer
+ * @note: For internal usage only!!!
+*/
+static void mnkt_blend_quad(const BlendState_t* state, const BlendFactorMasks_t* srcFactor, const BlendFactorMasks_t* dstFactor, int bypassOpaque,
+                            const Vec4_t srcColors[4], unsigned char dstColors[12])
+{
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 toUChar = _mm_set1_ps(255.0f);
+        const __m128 toFloat = _mm_set1_ps(1.0f / 255.0f);
+
+        __m128 r = _mm_loadu_ps( (const float*) &srcColors[0] );
+        __m128 g = _mm_loadu_ps( (const float*) &srcColors[1] );
+        __m128 b = _mm_loadu_ps( (const float*) &srcColors[2] );
+        __m128 a = _mm_loadu_ps( (const float*) &srcColors[3] );
+
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+
+        // Opaque fragments are checked before clamping, as in the scalar path
+        const int opaque = bypassOpaque && _mm_movemask_ps( _mm_cmpge_ps(a, one) ) == 0xF;
+
+        __m128 result[3] = {
+                _mm_min_ps( _mm_max_ps(r, zero), one ),
+                _mm_min_ps( _mm_max_ps(g, zero), one ),
+                _mm_min_ps( _mm_max_ps(b, zero), one )
+        };
+
+        // Fast path, the framebuffer content is not read at all
+        if(state->enabled && !opaque)
+        {
+                const __m128 srcAlpha = _mm_min_ps( _mm_max_ps(a, zero), one );
+
+                for(int c = 0; c < 3; ++c)
+                {
+                        const __m128 src = result[c];
+                        const __m128 dst = _mm_mul_ps( _mm_cvtepi32_ps( _mm_setr_epi32(dstColors[c], dstColors[3 + c], dstColors[6 + c], dstColors[9 + c]) ), toFloat );
+
+                        // Min and max ignore factors
+                        __m128 blended;
+
+                        if(state->colorOp >= MNKT_BLEND_OP_MIN)
+                                blended = mnkt_blend_combine(state->colorOp, src, dst);
+                        else
+                                blended = mnkt_blend_combine(state->colorOp, _mm_mul_ps(src, mnkt_blend_applyFactorMasks(srcFactor, src, dst, srcAlpha)),
+                                                                             _mm_mul_ps(dst, mnkt_blend_applyFactorMasks(dstFactor, src, dst, srcAlpha)));
+
+                        result[c] = _mm_min_ps( _mm_max_ps(blended, zero), one );
+                }
+        }
+
+        int32_t channels[3][4];
+
+        for(int c = 0; c < 3; ++c)
+                _mm_storeu_si128( (__m128i*) channels[c], _mm_cvttps_epi32( _mm_mul_ps(result[c], toUChar) ) );
+
+        for(int i = 0; i < 4; ++i)
+        {
+                dstColors[(i * 3) + 0] = (unsigned char) channels[0][i];
+                dstColors[(i * 3) + 1] = (unsigned char) channels[1][i];
+                dstColors[(i * 3) + 2] = (unsigned char) channels[2][i];
+        }
+}
+
+
+/**
+ * @function mnkt_blend_combine
+ * Combines the weighted source and destination colors
+ * @param op The operation to be performed
+ * @param src The weighted source color
+ * @param dst The weighted destination color
+ * @return The blended color
+ * @note: For internal usage only!!!
+*/
+static __m128 mnkt_blend_combine(BlendOp_t op, __m128 src, __m128 dst)
+{
+        switch(op)
+        {
+                case MNKT_BLEND_OP_ADD:                 return _mm_add_ps(src, dst);
+                case MNKT_BLEND_OP_SUBTRACT:            return _mm_sub_ps(src, dst);
+                case MNKT_BLEND_OP_REVERSE_SUBTRACT:    return _mm_sub_ps(dst, src);
+                case MNKT_BLEND_OP_MIN:                 return _mm_min_ps(src, dst);
+                case MNKT_BLEND_OP_MAX:                 return _mm_max_ps(src, dst);
+        }
+
+        return src;
+}
+
+#else
+
+/**
+ * @function mnkt_blend_getFactor
+ * Computes the factor to be applied to a component of a color
+ * @param factor The blend factor to be computed
+ * @param src The source color
+ * @param dst The destination color
+ * @param channel Index of the color component (0 = red, 1 = green, 2 = blue)
+ * @return The factor to be applied to the given color component
+ * @note: For internal usage only!!!
+*/
+static float mnkt_blend_getFactor(BlendFactor_t factor, const float src[4], const float dst[3], int channel)
+{
+        switch(factor)
+        {
+                case MNKT_BLEND_ZERO:                   return 0.0f;
+                case MNKT_BLEND_ONE:                    return 1.0f;
+                case MNKT_BLEND_SRC_COLOR:              return src[channel];
+                case MNKT_BLEND_ONE_MINUS_SRC_COLOR:    return 1.0f - src[channel];
+                case MNKT_BLEND_DST_COLOR:              return dst[channel];
+                case MNKT_BLEND_ONE_MINUS_DST_COLOR:    return 1.0f - dst[channel];
+                case MNKT_BLEND_SRC_ALPHA:              return src[3];
+                case MNKT_BLEND_ONE_MINUS_SRC_ALPHA:    return 1.0f - src[3];
+        }
+
+        return 1.0f;
+}
+
+
+/**
+ * @function mnkt_blend_combine
+ * Combines the weighted source and destination color components
+ * @param op The operation to be performed
+ * @param src The weighted source color component
+ * @param dst The weighted destination color component
+ * @return The blended color component
+ * @note: For internal usage only!!!
+*/
+static float mnkt_blend_combine(BlendOp_t op, float src, float dst)
+{
+        switch(op)
+        {
+                case MNKT_BLEND_OP_ADD:                 return src + dst;
+                case MNKT_BLEND_OP_SUBTRACT:            return src - dst;
+                case MNKT_BLEND_OP_REVERSE_SUBTRACT:    return dst - src;
+                case MNKT_BLEND_OP_MIN:                 return fminf(src, dst);
+                case MNKT_BLEND_OP_MAX:                 return fmaxf(src, dst);
+        }
+
+        return src;
+}
+
+#endif
+
@@ -0,0 +1,109 @@
+/**
+ * @file blend.h
+ *
+ * Defines the BlendState_t struct and the functions of the output merger stage
+ * that blend the fragments colors with the content of the framebuffer.
+*/
+
+#ifndef MNKT_BLEND_H
+#define MNKT_BLEND_H
+
+#include <stddef.h>
+
+#include "math/vec.h"
+
+
+/**
+ * @enum BlendFactor_t
+ * Factors by which the source (fragment) and destination (framebuffer) colors are multiplied before being combined.
+ * There are no destination alpha factors, since the color buffer stores no alpha channel.
+*/
+typedef enum {
+        MNKT_BLEND_ZERO = 0,
+        MNKT_BLEND_ONE,
+        MNKT_BLEND_SRC_COLOR,
+        MNKT_BLEND_ONE_MINUS_SRC_COLOR,
+        MNKT_BLEND_DST_COLOR,
+        MNKT_BLEND_ONE_MINUS_DST_COLOR,
+        MNKT_BLEND_SRC_ALPHA,
+        MNKT_BLEND_ONE_MINUS_SRC_ALPHA,
+} BlendFactor_t;
+
+
+/**
+ * @enum BlendOp_t
+ * Operations used to combine the source and destination colors (after they are multiplied by their factors)
+*/
+typedef enum {
+        MNKT_BLEND_OP_ADD = 0,                  ///< src + dst
+        MNKT_BLEND_OP_SUBTRACT,                 ///< src - dst
+        MNKT_BLEND_OP_REVERSE_SUBTRACT,         ///< dst - src
+        MNKT_BLEND_OP_MIN,                      ///< min(src, dst), factors are ignored
+        MNKT_BLEND_OP_MAX,                      ///< max(src, dst), factors are ignored
+} BlendOp_t;
+
+
+/**
+ * @struct BlendState_t
+ * Defines how the color produced by the fragment shader is combined with the one stored in the framebuffer.
+ * Blending is performed on the RGB8 color buffer only: it stores no alpha channel, so the same factors and operation
+ * apply to the three color components and the source alpha is only used as a factor (the color attachments are never blended).
+ *
+ * A zero initialized struct disables blending (the fragment color overwrites the framebuffer content).
+*/
+typedef struct {
+        int             enabled;                ///< Non zero if blending must be performed
+
+        BlendFactor_t   srcColorFactor;         ///< Factor applied to the rgb components of the source color
+        BlendFactor_t   dstColorFactor;         ///< Factor applied to the rgb components of the destination color
+        BlendOp_t       colorOp;                ///< Operation used to combine the rgb components
+} BlendState_t;
+
+
+/**
+ * @function mnkt_blend_alphaState
+ * Creates the state for the classic "over" blending of non premultiplied colors (src * srcAlpha + dst * (1 - srcAlpha))
+ * @return The blend state
+*/
+BlendState_t    mnkt_blend_alphaState(void);
+
+
+/**
+ * @function mnkt_blend_premultipliedAlphaState
+ * Creates the state for the "over" blending of premultiplied colors (src + dst * (1 - srcAlpha))
+ * @return The blend state
+*/
+BlendState_t    mnkt_blend_premultipliedAlphaState(void);
+
+
+/**
+ * @function mnkt_blend_additiveState
+ * Creates the state for additive blending (src * srcAlpha + dst), commonly used for particles
+ * @return The blend state
+*/
+BlendState_t    mnkt_blend_additiveState(void);
+
+
+/**
+ * @function mnkt_blend_isOpaqueBypass
+ * Checks if, with the given state, an opaque source color (alpha equal to one) always replaces the destination color,
+ * in such case the framebuffer does not need to be read for opaque fragments
+ * @param state The blend state to be checked
+ * @return One if opaque fragments can be written directly, zero otherwise
+*/
+int             mnkt_blend_isOpaqueBypass(const BlendState_t* state);
+
+
+/**
+ * @function mnkt_blend_span
+ * Blends a span of contiguous fragments with the content of an RGB color buffer
+ * @param state The blend state to be used (if blending is disabled source colors are simply written)
+ * @param srcColors Colors produced by the fragment shader for each fragment of the span
+ * @param dstColors Pointer to the RGB color of the first pixel of the span inside the color buffer
+ * @param count Number of fragments in the span
+*/
+void            mnkt_blend_span(const BlendState_t* state, const Vec4_t* srcColors, unsigned char* dstColors, size_t count);
+
+
+#endif // MNKT_BLEND_H
+
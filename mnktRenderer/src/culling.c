@@ -0,0 +1,607 @@
+
+/**
+ * @file culling.c
+ *
+ * Contains implementation of the bounding volumes and frustum culling API
+*/
+
+#include "culling.h"
+
+#include "utility/simd.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @function mnkt_frustum_fromMatrix
+ * Extracts the planes of the frustum from a projection matrix (the space of the planes is the one
+ * transformed by the matrix: e.g. world space for a view projection matrix)
+ * @param viewProjection The matrix that transforms points into clip coordinates
+ * @return The frustum
+*/
+Frustum_t mnkt_frustum_fromMatrix(const Mat4_t* viewProjection)
+{
+        const float* m = viewProjection->m;
+        Frustum_t frustum;
+
+        // A point is inside the clipping volume if -w <= x, y, z <= w, each plane is the sum or the difference between the last row and another one
+        for(int i = 0; i < 6; ++i)
+        {
+                const int row = i / 2;
+                const float sign = (i & 1) ? -1.0f : 1.0f;
+
+                Vec4_t plane = {
+                        .x = m[3] + sign * m[row],
+                        .y = m[7] + sign * m[4 + row],
+                        .z = m[11] + sign * m[8 + row],
+                        .w = m[15] + sign * m[12 + row]
+                };
+
+                float length = sqrtf( (plane.x * plane.x) + (plane.y * plane.y) + (plane.z * plane.z) );
+
+                if(length > 0.0f)
+                        plane = mnkt_vec4_div(&plane, length);
+
+                frustum.planes[i] = plane;
+        }
+
+        return frustum;
+}
+
+
+/**
+ * @function mnkt_frustum_testBox
+ * Checks if a bounding box intersects the frustum (boxes close to the corners of the frustum can be reported as visible)
+ * @param frustum The frustum
+ * @param box The bounding box
+ * @return One if the box can be visible, zero if it is completely outside the frustum
+*/
+int mnkt_frustum_testBox(const Frustum_t* frustum, const BoundingBox_t* box)
+{
+        const Vec3_t center = {
+                .x = (box->min.x + box->max.x) * 0.5f,
+                .y = (box->min.y + box->max.y) * 0.5f,
+                .z = (box->min.z + box->max.z) * 0.5f
+        };
+
+        const Vec3_t extents = {
+                .x = (box->max.x - box->min.x) * 0.5f,
+                .y = (box->max.y - box->min.y) * 0.5f,
+                .z = (box->max.z - box->min.z) * 0.5f
+        };
+
+        for(int i = 0; i < 6; ++i)
+        {
+                const Vec4_t* plane = &frustum->planes[i];
+
+                // Distance of the corner that lies farthest along the plane's normal
+                float distance = (plane->x * center.x) + (plane->y * center.y) + (plane->z * center.z) + plane->w +
+                                 (fabsf(plane->x) * extents.x) + (fabsf(plane->y) * extents.y) + (fabsf(plane->z) * extents.z);
+
+                if(distance < 0.0f)
+                        return 0;
+        }
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_frustum_testSphere
+ * Checks if a bounding sphere intersects the frustum (spheres close to the corners of the frustum can be reported as visible)
+ * @param frustum The frustum
+ * @param sphere The bounding sphere
+ * @return One if the sphere can be visible, zero if it is completely outside the frustum
+*/
+int mnkt_frustum_testSphere(const Frustum_t* frustum, const BoundingSphere_t* sphere)
+{
+        for(int i = 0; i < 6; ++i)
+        {
+                const Vec4_t* plane = &frustum->planes[i];
+
+                float distance = (plane->x * sphere->center.x) + (plane->y * sphere->center.y) + (plane->z * sphere->center.z) + plane->w;
+
+                if(distance < -sphere->radius)
+                        return 0;
+        }
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_frustum_testBoxes
+ * Checks a batch of bounding boxes against the frustum, four boxes at a time when SSE instructions are available
+ * @param frustum The frustum
+ * @param boxes The bounding boxes
+ * @param count Number of bounding boxes
+ * @param visible Where the result of each test is stored (one if the box can be visible, zero otherwise)
+ * @return The number of boxes that can be visible
+*/
+size_t mnkt_frustum_testBoxes(const Frustum_t* frustum, const BoundingBox_t* boxes, size_t count, uint8_t* visible)
+{
+        size_t visibleCount = 0;
+        size_t i = 0;
+
+#ifdef MNKT_SIMD_SSE2
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 absMask = _mm_castsi128_ps( _mm_set1_epi32(0x7FFFFFFF) );
+
+        for(; i + 4 <= count; i += 4)
+        {
+                const BoundingBox_t* b = &boxes[i];
+
+                // Transpose the four boxes into center and extents along each axis
+                const __m128 minX = _mm_setr_ps(b[0].min.x, b[1].min.x, b[2].min.x, b[3].min.x);
+                const __m128 minY = _mm_setr_ps(b[0].min.y, b[1].min.y, b[2].min.y, b[3].min.y);
+                const __m128 minZ = _mm_setr_ps(b[0].min.z, b[1].min.z, b[2].min.z, b[3].min.z);
+                const __m128 maxX = _mm_setr_ps(b[0].max.x, b[1].max.x, b[2].max.x, b[3].max.x);
+                const __m128 maxY = _mm_setr_ps(b[0].max.y, b[1].max.y, b[2].max.y, b[3].max.y);
+                const __m128 maxZ = _mm_setr_ps(b[0].max.z, b[1].max.z, b[2].max.z, b[3].max.z);
+
+                const __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+                const __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+                const __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+                const __m128 extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+                const __m128 extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+                const __m128 extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+                __m128 outside = _mm_setzero_ps();
+
+                for(int p = 0; p < 6; ++p)
+                {
+                        const Vec4_t* plane = &frustum->planes[p];
+                        const __m128 planeX = _mm_set1_ps(plane->x);
+                        const __m128 planeY = _mm_set1_ps(plane->y);
+                        const __m128 planeZ = _mm_set1_ps(plane->z);
+
+                        __m128 distance = _mm_add_ps( _mm_set1_ps(plane->w), _mm_mul_ps(planeX, centerX) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(planeY, centerY) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(planeZ, centerZ) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(_mm_and_ps(planeX, absMask), extentX) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(_mm_and_ps(planeY, absMask), extentY) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(_mm_and_ps(planeZ, absMask), extentZ) );
+
+                        outside = _mm_or_ps( outside, _mm_cmplt_ps(distance, _mm_setzero_ps()) );
+                }
+
+                const int outsideMask = _mm_movemask_ps(outside);
+
+                for(int j = 0; j < 4; ++j)
+                {
+                        visible[i + j] = !((outsideMask >> j) & 1);
+                        visibleCount += visible[i + j];
+                }
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                visible[i] = (uint8_t) mnkt_frustum_testBox(frustum, &boxes[i]);
+                visibleCount += visible[i];
+        }
+
+        return visibleCount;
+}
+
+
+/**
+ * @function mnkt_frustum_testSpheres
+ * Checks a batch of bounding spheres against the frustum, four spheres at a time when SSE instructions are available
+ * @param frustum The frustum
+ * @param spheres The bounding spheres
+ * @param count Number of bounding spheres
+ * @param visible Where the result of each test is stored (one if the sphere can be visible, zero otherwise)
+ * @return The number of spheres that can be visible
+*/
+size_t mnkt_frustum_testSpheres(const Frustum_t* frustum, const BoundingSphere_t* spheres, size_t count, uint8_t* visible)
+{
+        size_t visibleCount = 0;
+        size_t i = 0;
+
+#ifdef MNKT_SIMD_SSE2
+        for(; i + 4 <= count; i += 4)
+        {
+                const BoundingSphere_t* s = &spheres[i];
+
+                const __m128 centerX = _mm_setr_ps(s[0].center.x, s[1].center.x, s[2].center.x, s[3].center.x);
+                const __m128 centerY = _mm_setr_ps(s[0].center.y, s[1].center.y, s[2].center.y, s[3].center.y);
+                const __m128 centerZ = _mm_setr_ps(s[0].center.z, s[1].center.z, s[2].center.z, s[3].center.z);
+                const __m128 negRadius = _mm_setr_ps(-s[0].radius, -s[1].radius, -s[2].radius, -s[3].radius);
+
+                __m128 outside = _mm_setzero_ps();
+
+                for(int p = 0; p < 6; ++p)
+                {
+                        const Vec4_t* plane = &frustum->planes[p];
+
+                        __m128 distance = _mm_add_ps( _mm_set1_ps(plane->w), _mm_mul_ps(_mm_set1_ps(plane->x), centerX) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(_mm_set1_ps(plane->y), centerY) );
+                        distance = _mm_add_ps( distance, _mm_mul_ps(_mm_set1_ps(plane->z), centerZ) );
+
+                        outside = _mm_or_ps( outside, _mm_cmplt_ps(distance, negRadius) );
+                }
+
+                const int outsideMask = _mm_movemask_ps(outside);
+
+                for(int j = 0; j < 4; ++j)
+                {
+                        visible[i + j] = !((outsideMask >> j) & 1);
+                        visibleCount += visible[i + j];
+                }
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                visible[i] = (uint8_t) mnkt_frustum_testSphere(frustum, &spheres[i]);
+                visibleCount += visible[i];
+        }
+
+        return visibleCount;
+}
+
+
+/**
+ * @function mnkt_bounds_fromPoints
+ * Computes the bounding box of a set of points
+ * @param points Array of data that starts with the coordinates of the first point (3 floats)
+ * @param count Number of points
+ * @param stride Distance in bytes between two consecutive points (e.g. the vertex size)
+ * @return The bounding box (empty, with min greater than max, if there are no points)
+*/
+BoundingBox_t mnkt_bounds_fromPoints(const void* points, size_t count, size_t stride)
+{
+        BoundingBox_t box = {
+                .min = { .x = FLT_MAX, .y = FLT_MAX, .z = FLT_MAX },
+                .max = { .x = -FLT_MAX, .y = -FLT_MAX, .z = -FLT_MAX }
+        };
+
+        const unsigned char* curr = points;
+
+        for(size_t i = 0; i < count; ++i, curr += stride)
+        {
+                Vec3_t point;
+                memcpy(&point, curr, sizeof(Vec3_t));
+
+                box.min.x = fminf(box.min.x, point.x);
+                box.min.y = fminf(box.min.y, point.y);
+                box.min.z = fminf(box.min.z, point.z);
+                box.max.x = fmaxf(box.max.x, point.x);
+                box.max.y = fmaxf(box.max.y, point.y);
+                box.max.z = fmaxf(box.max.z, point.z);
+        }
+
+        return box;
+}
+
+
+/**
+ * @function mnkt_bounds_transform
+ * Computes the bounding box of a transformed box (e.g. to move the bounds of a model into world space)
+ * @param box The bounding box
+ * @param transform The affine transformation
+ * @return The axis aligned bounding box that contains the transformed box
+*/
+BoundingBox_t mnkt_bounds_transform(const BoundingBox_t* box, const Mat4_t* transform)
+{
+        const float* m = transform->m;
+        const float boxMin[3] = { box->min.x, box->min.y, box->min.z };
+        const float boxMax[3] = { box->max.x, box->max.y, box->max.z };
+
+        // Start from the translation and add, for each element of the matrix, the extreme that minimizes (maximizes) the result (Arvo's method)
+        float resultMin[3] = { m[12], m[13], m[14] };
+        float resultMax[3] = { m[12], m[13], m[14] };
+
+        for(int row = 0; row < 3; ++row)
+        {
+                for(int col = 0; col < 3; ++col)
+                {
+                        const float a = m[(col * 4) + row] * boxMin[col];
+                        const float b = m[(col * 4) + row] * boxMax[col];
+
+                        resultMin[row] += fminf(a, b);
+                        resultMax[row] += fmaxf(a, b);
+                }
+        }
+
+        return (BoundingBox_t) {
+                .min = { .x = resultMin[0], .y = resultMin[1], .z = resultMin[2] },
+                .max = { .x = resultMax[0], .y = resultMax[1], .z = resultMax[2] }
+        };
+}
+
+
+/**
+ * @function mnkt_bounds_sphereFromBox
+ * Computes the bounding sphere of a bounding box
+ * @param box The bounding box
+ * @return The sphere centered in the center of the box that contains it
+*/
+BoundingSphere_t mnkt_bounds_sphereFromBox(const BoundingBox_t* box)
+{
+        const Vec3_t halfDiagonal = {
+                .x = (box->max.x - box->min.x) * 0.5f,
+                .y = (box->max.y - box->min.y) * 0.5f,
+                .z = (box->max.z - box->min.z) * 0.5f
+        };
+
+        return (BoundingSphere_t) {
+                .center = {
+                        .x = (box->min.x + box->max.x) * 0.5f,
+                        .y = (box->min.y + box->max.y) * 0.5f,
+                        .z = (box->min.z + box->max.z) * 0.5f
+                },
+                .radius = sqrtf( mnkt_vec3_dot(&halfDiagonal, &halfDiagonal) )
+        };
+}
+
+
+/**
+ * @function mnkt_bounds_project
+ * Computes the screen space rectangle covered by the part of a bounding box that lies in front of the near plane
+ * (the part that can be covered by the clipped triangles inside the box) and its minimum depth
+ * @param box The bounding box
+ * @param viewProjection The matrix that transforms the box into clip coordinates
+ * @param viewport The viewport on which the box is mapped
+ * @param screenMin Where the minimum screen coordinates (x, y) and the minimum depth (z) of the box are stored
+ * @param screenMax Where the maximum screen coordinates (x, y) and the maximum depth (z) of the box are stored
+ * @return Zero on success, non zero if no part of the box lies in front of the near plane or if it can not be projected
+*/
+int mnkt_bounds_project(const BoundingBox_t* box, const Mat4_t* viewProjection, const Viewport_t* viewport, Vec3_t* screenMin, Vec3_t* screenMax)
+{
+        Vec3_t corners[8];
+        Vec4_t clipCorners[8];
+
+        for(int i = 0; i < 8; ++i)
+        {
+                corners[i].x = (i & 1) ? box->max.x : box->min.x;
+                corners[i].y = (i & 2) ? box->max.y : box->min.y;
+                corners[i].z = (i & 4) ? box->max.z : box->min.z;
+        }
+
+        mnkt_mat4_transformPoints(viewProjection, corners, clipCorners, 8);
+
+        // Corners in front of the near plane (z >= -w) and intersections of the edges of the box with it
+        Vec4_t points[8 + 12];
+        int pointsCount = 0;
+
+        for(int i = 0; i < 8; ++i)
+        {
+                if(clipCorners[i].w + clipCorners[i].z >= 0.0f)
+                        points[pointsCount++] = clipCorners[i];
+        }
+
+        if(pointsCount < 8)
+        {
+                for(int i = 0; i < 8; ++i)
+                {
+                        for(int axis = 1; axis < 8; axis <<= 1)
+                        {
+                                if(i & axis)
+                                        continue;
+
+                                const Vec4_t* a = &clipCorners[i];
+                                const Vec4_t* b = &clipCorners[i | axis];
+                                const float distA = a->w + a->z;
+                                const float distB = b->w + b->z;
+
+                                if( (distA >= 0.0f) == (distB >= 0.0f) )
+                                        continue;
+
+                                const float t = distA / (distA - distB);
+
+                                points[pointsCount++] = (Vec4_t) {
+                                        .x = mnkt_math_lerp(a->x, b->x, t),
+                                        .y = mnkt_math_lerp(a->y, b->y, t),
+                                        .z = mnkt_math_lerp(a->z, b->z, t),
+                                        .w = mnkt_math_lerp(a->w, b->w, t)
+                                };
+                        }
+                }
+        }
+
+        if(pointsCount == 0)
+                return 1;
+
+        *screenMin = (Vec3_t) { .x = FLT_MAX, .y = FLT_MAX, .z = FLT_MAX };
+        *screenMax = (Vec3_t) { .x = -FLT_MAX, .y = -FLT_MAX, .z = -FLT_MAX };
+
+        for(int i = 0; i < pointsCount; ++i)
+        {
+                const Vec4_t* point = &points[i];
+
+                // Points on the plane of the camera (or NaN ones) can not be projected
+                if( !(point->w > FLT_EPSILON) )
+                        return 1;
+
+                // Same mapping applied by the pipeline to the vertices (the y axis points downwards)
+                const float x = viewport->x + ( ((point->x / point->w) + 1.0f) * 0.5f ) * viewport->width;
+                const float y = viewport->y + ( (1.0f - (point->y / point->w)) * 0.5f ) * viewport->height;
+                const float z = viewport->minDepth + ( ((point->z / point->w) + 1.0f) * 0.5f ) * (viewport->maxDepth - viewport->minDepth);
+
+                screenMin->x = fminf(screenMin->x, x);
+                screenMin->y = fminf(screenMin->y, y);
+                screenMin->z = fminf(screenMin->z, z);
+                screenMax->x = fmaxf(screenMax->x, x);
+                screenMax->y = fmaxf(screenMax->y, y);
+                screenMax->z = fmaxf(screenMax->z, z);
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_hiz_create
+ * Allocates the levels of a hierarchical depth buffer
+ * @param hiz The hierarchical depth buffer to be created (must be released with mnkt_hiz_destroy)
+ * @param width Width of the depth buffer from which it is built
+ * @param height Height of the depth buffer from which it is built
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_hiz_create(HiZBuffer_t* hiz, uint32_t width, uint32_t height)
+{
+        if(hiz == NULL)
+                return 1;
+
+        memset(hiz, 0, sizeof(HiZBuffer_t));
+
+        if(width == 0 || height == 0)
+                return 1;
+
+        // Each level halves the size of the previous one (rounding up, so that each texel covers the whole area of its children)
+        size_t totalSize = 0;
+
+        for(uint32_t w = width, h = height; hiz->levelsCount < MNKT_HIZ_MAX_LEVELS; w = (w + 1) / 2, h = (h + 1) / 2)
+        {
+                hiz->widths[hiz->levelsCount] = w;
+                hiz->heights[hiz->levelsCount] = h;
+                ++hiz->levelsCount;
+
+                totalSize += (size_t) w * h;
+
+                if(w == 1 && h == 1)
+                        break;
+        }
+
+        float* data = malloc(totalSize * sizeof(float));
+
+        if(data == NULL)
+        {
+                hiz->levelsCount = 0;
+                return 1;
+        }
+
+        for(uint32_t i = 0; i < hiz->levelsCount; ++i)
+        {
+                hiz->levels[i] = data;
+                data += (size_t) hiz->widths[i] * hiz->heights[i];
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_hiz_destroy
+ * Releases the levels of a hierarchical depth buffer
+ * @param hiz The hierarchical depth buffer to be released
+*/
+void mnkt_hiz_destroy(HiZBuffer_t* hiz)
+{
+        if(hiz == NULL)
+                return;
+
+        // All the levels are stored in the block of the first one
+        free(hiz->levels[0]);
+        memset(hiz, 0, sizeof(HiZBuffer_t));
+}
+
+
+/**
+ * @function mnkt_hiz_build
+ * Fills the levels of a hierarchical depth buffer with the content of the depth buffer of a framebuffer
+ * @param hiz The hierarchical depth buffer (created with the size of the framebuffer)
+ * @param fb The framebuffer whose depth buffer is read
+*/
+void mnkt_hiz_build(HiZBuffer_t* hiz, const Framebuffer_t* fb)
+{
+        if(hiz == NULL || fb == NULL || fb->depthBuffer == NULL || hiz->levelsCount == 0)
+                return;
+
+        if(hiz->widths[0] != fb->width || hiz->heights[0] != fb->height)
+                return;
+
+        memcpy(hiz->levels[0], fb->depthBuffer, (size_t) fb->width * fb->height * sizeof(float));
+
+        for(uint32_t level = 1; level < hiz->levelsCount; ++level)
+        {
+                const float* src = hiz->levels[level - 1];
+                const uint32_t srcWidth = hiz->widths[level - 1];
+                const uint32_t srcHeight = hiz->heights[level - 1];
+                float* dst = hiz->levels[level];
+
+                for(uint32_t y = 0; y < hiz->heights[level]; ++y)
+                {
+                        // Texels on the last row (column) of odd sized levels have a single child row (column)
+                        const float* row0 = &src[(size_t) (2 * y) * srcWidth];
+                        const float* row1 = &src[(size_t) (2 * y + 1 < srcHeight ? 2 * y + 1 : 2 * y) * srcWidth];
+
+                        for(uint32_t x = 0; x < hiz->widths[level]; ++x)
+                        {
+                                const uint32_t x0 = 2 * x;
+                                const uint32_t x1 = (x0 + 1 < srcWidth) ? x0 + 1 : x0;
+
+                                dst[(size_t) y * hiz->widths[level] + x] = fmaxf( fmaxf(row0[x0], row0[x1]), fmaxf(row1[x0], row1[x1]) );
+                        }
+                }
+        }
+}
+
+
+/**
+ * @function mnkt_hiz_testRect
+ * Checks if a screen space rectangle can be visible, that is if its minimum depth is not behind all the depth values it covers.
+ * The level in which the rectangle covers at most 2x2 texels is used, so the test reads only four values.
+ * @param hiz The hierarchical depth buffer
+ * @param screenMin Minimum screen coordinates (x, y) and minimum depth (z) of the rectangle
+ * @param screenMax Maximum screen coordinates (x, y) of the rectangle
+ * @return One if the rectangle can be visible, zero if it is occluded
+*/
+int mnkt_hiz_testRect(const HiZBuffer_t* hiz, const Vec3_t* screenMin, const Vec3_t* screenMax)
+{
+        if(hiz == NULL || hiz->levelsCount == 0)
+                return 1;
+
+        const float width = (float) hiz->widths[0];
+        const float height = (float) hiz->heights[0];
+
+        // Rectangles outside of the depth buffer are left to the frustum test
+        if(screenMax->x < 0.0f || screenMax->y < 0.0f || screenMin->x >= width || screenMin->y >= height)
+                return 1;
+
+        const uint32_t minX = (uint32_t) fmaxf(floorf(screenMin->x), 0.0f);
+        const uint32_t minY = (uint32_t) fmaxf(floorf(screenMin->y), 0.0f);
+        const uint32_t maxX = (uint32_t) fminf(floorf(screenMax->x), width - 1.0f);
+        const uint32_t maxY = (uint32_t) fminf(floorf(screenMax->y), height - 1.0f);
+
+        uint32_t level = 0;
+
+        while(level + 1 < hiz->levelsCount && ( (maxX >> level) - (minX >> level) > 1 || (maxY >> level) - (minY >> level) > 1 ))
+                ++level;
+
+        const float* depth = hiz->levels[level];
+        const uint32_t levelWidth = hiz->widths[level];
+        const uint32_t x0 = minX >> level, x1 = maxX >> level;
+        const uint32_t y0 = minY >> level, y1 = maxY >> level;
+
+        const float farthest = fmaxf( fmaxf(depth[(size_t) y0 * levelWidth + x0], depth[(size_t) y0 * levelWidth + x1]),
+                                      fmaxf(depth[(size_t) y1 * levelWidth + x0], depth[(size_t) y1 * levelWidth + x1]) );
+
+        return screenMin->z <= farthest;
+}
+
+
+/**
+ * @function mnkt_hiz_testBox
+ * Checks if a bounding box can be visible according to a hierarchical depth buffer
+ * @param hiz The hierarchical depth buffer
+ * @param box The bounding box
+ * @param viewProjection The matrix that transforms the box into clip coordinates
+ * @param viewport The viewport on which the box is mapped
+ * @return One if the box can be visible, zero if it is occluded
+*/
+int mnkt_hiz_testBox(const HiZBuffer_t* hiz, const BoundingBox_t* box, const Mat4_t* viewProjection, const Viewport_t* viewport)
+{
+        Vec3_t screenMin, screenMax;
+
+        // Boxes that can not be projected are always considered visible
+        if( mnkt_bounds_project(box, viewProjection, viewport, &screenMin, &screenMax) != 0 )
+                return 1;
+
+        return mnkt_hiz_testRect(hiz, &screenMin, &screenMax);
+}
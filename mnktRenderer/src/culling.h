@@ -0,0 +1,221 @@
+
+/**
+ * @file culling.h
+ *
+ * Defines the bounding volumes of the objects to be drawn and the functions that test them
+ * against the view frustum, so that objects that are not visible can be skipped before running the vertex shader.
+*/
+
+#ifndef MNKT_CULLING_H
+#define MNKT_CULLING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "math/vec.h"
+#include "math/mat.h"
+#include "framebuffer.h"
+
+
+/**
+ * @macro MNKT_HIZ_MAX_LEVELS
+ * Maximum number of levels of a hierarchical depth buffer (enough for framebuffers up to 65536 pixels wide)
+*/
+#define MNKT_HIZ_MAX_LEVELS             17
+
+
+/**
+ * @struct Frustum_t
+ * Planes that bound the visible volume, a point p is inside the plane (a, b, c, d) if a * p.x + b * p.y + c * p.z + d >= 0.
+ * Planes are stored in the order left, right, bottom, top, near, far and are normalized.
+*/
+typedef struct {
+        Vec4_t          planes[6];              ///< Planes of the frustum, pointing inwards
+} Frustum_t;
+
+
+/**
+ * @struct BoundingBox_t
+ * Axis aligned bounding box
+*/
+typedef struct {
+        Vec3_t          min;                    ///< Corner with the minimum coordinates
+        Vec3_t          max;                    ///< Corner with the maximum coordinates
+} BoundingBox_t;
+
+
+/**
+ * @struct BoundingSphere_t
+ * Bounding sphere
+*/
+typedef struct {
+        Vec3_t          center;                 ///< Center of the sphere
+        float           radius;                 ///< Radius of the sphere
+} BoundingSphere_t;
+
+
+/**
+ * @struct HiZBuffer_t
+ * Hierarchical depth buffer: each level stores, for each texel, the farthest depth of the
+ * 2x2 texels of the previous level that it covers (the first level is a copy of the depth buffer).
+ * It is built from the depth of the occluders (e.g. drawn first or in the previous frame) and assumes the MNKT_DEPTH_LESS depth test.
+*/
+typedef struct {
+        float*          levels[MNKT_HIZ_MAX_LEVELS];    ///< Depth values of each level, stored row by row
+        uint32_t        widths[MNKT_HIZ_MAX_LEVELS];    ///< Width of each level, expressed in texels
+        uint32_t        heights[MNKT_HIZ_MAX_LEVELS];   ///< Height of each level, expressed in texels
+        uint32_t        levelsCount;                    ///< Number of levels (the last one is a single texel)
+} HiZBuffer_t;
+
+
+/**
+ * @function mnkt_frustum_fromMatrix
+ * Extracts the planes of the frustum from a projection matrix (the space of the planes is the one
+ * transformed by the matrix: e.g. world space for a view projection matrix)
+ * @param viewProjection The matrix that transforms points into clip coordinates
+ * @return The frustum
+*/
+Frustum_t mnkt_frustum_fromMatrix(const Mat4_t* viewProjection);
+
+
+/**
+ * @function mnkt_frustum_testBox
+ * Checks if a bounding box intersects the frustum (boxes close to the corners of the frustum can be reported as visible)
+ * @param frustum The frustum
+ * @param box The bounding box
+ * @return One if the box can be visible, zero if it is completely outside the frustum
+*/
+int mnkt_frustum_testBox(const Frustum_t* frustum, const BoundingBox_t* box);
+
+
+/**
+ * @function mnkt_frustum_testSphere
+ * Checks if a bounding sphere intersects the frustum (spheres close to the corners of the frustum can be reported as visible)
+ * @param frustum The frustum
+ * @param sphere The bounding sphere
+ * @return One if the sphere can be visible, zero if it is completely outside the frustum
+*/
+int mnkt_frustum_testSphere(const Frustum_t* frustum, const BoundingSphere_t* sphere);
+
+
+/**
+ * @function mnkt_frustum_testBoxes
+ * Checks a batch of bounding boxes against the frustum, four boxes at a time when SSE instructions are available
+ * @param frustum The frustum
+ * @param boxes The bounding boxes
+ * @param count Number of bounding boxes
+ * @param visible Where the result of each test is stored (one if the box can be visible, zero otherwise)
+ * @return The number of boxes that can be visible
+*/
+size_t mnkt_frustum_testBoxes(const Frustum_t* frustum, const BoundingBox_t* boxes, size_t count, uint8_t* visible);
+
+
+/**
+ * @function mnkt_frustum_testSpheres
+ * Checks a batch of bounding spheres against the frustum, four spheres at a time when SSE instructions are available
+ * @param frustum The frustum
+ * @param spheres The bounding spheres
+ * @param count Number of bounding spheres
+ * @param visible Where the result of each test is stored (one if the sphere can be visible, zero otherwise)
+ * @return The number of spheres that can be visible
+*/
+size_t mnkt_frustum_testSpheres(const Frustum_t* frustum, const BoundingSphere_t* spheres, size_t count, uint8_t* visible);
+
+
+/**
+ * @function mnkt_bounds_fromPoints
+ * Computes the bounding box of a set of points
+ * @param points Array of data that starts with the coordinates of the first point (3 floats)
+ * @param count Number of points
+ * @param stride Distance in bytes between two consecutive points (e.g. the vertex size)
+ * @return The bounding box (empty, with min greater than max, if there are no points)
+*/
+BoundingBox_t mnkt_bounds_fromPoints(const void* points, size_t count, size_t stride);
+
+
+/**
+ * @function mnkt_bounds_transform
+ * Computes the bounding box of a transformed box (e.g. to move the bounds of a model into world space)
+ * @param box The bounding box
+ * @param transform The affine transformation
+ * @return The axis aligned bounding box that contains the transformed box
+*/
+BoundingBox_t mnkt_bounds_transform(const BoundingBox_t* box, const Mat4_t* transform);
+
+
+/**
+ * @function mnkt_bounds_sphereFromBox
+ * Computes the bounding sphere of a bounding box
+ * @param box The bounding box
+ * @return The sphere centered in the center of the box that contains it
+*/
+BoundingSphere_t mnkt_bounds_sphereFromBox(const BoundingBox_t* box);
+
+
+/**
+ * @function mnkt_bounds_project
+ * Computes the screen space rectangle covered by the part of a bounding box that lies in front of the near plane
+ * (the part that can be covered by the clipped triangles inside the box) and its minimum depth
+ * @param box The bounding box
+ * @param viewProjection The matrix that transforms the box into clip coordinates
+ * @param viewport The viewport on which the box is mapped
+ * @param screenMin Where the minimum screen coordinates (x, y) and the minimum depth (z) of the box are stored
+ * @param screenMax Where the maximum screen coordinates (x, y) and the maximum depth (z) of the box are stored
+ * @return Zero on success, non zero if no part of the box lies in front of the near plane or if it can not be projected
+*/
+int mnkt_bounds_project(const BoundingBox_t* box, const Mat4_t* viewProjection, const Viewport_t* viewport, Vec3_t* screenMin, Vec3_t* screenMax);
+
+
+/**
+ * @function mnkt_hiz_create
+ * Allocates the levels of a hierarchical depth buffer
+ * @param hiz The hierarchical depth buffer to be created (must be released with mnkt_hiz_destroy)
+ * @param width Width of the depth buffer from which it is built
+ * @param height Height of the depth buffer from which it is built
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_hiz_create(HiZBuffer_t* hiz, uint32_t width, uint32_t height);
+
+
+/**
+ * @function mnkt_hiz_destroy
+ * Releases the levels of a hierarchical depth buffer
+ * @param hiz The hierarchical depth buffer to be released
+*/
+void mnkt_hiz_destroy(HiZBuffer_t* hiz);
+
+
+/**
+ * @function mnkt_hiz_build
+ * Fills the levels of a hierarchical depth buffer with the content of the depth buffer of a framebuffer
+ * @param hiz The hierarchical depth buffer (created with the size of the framebuffer)
+ * @param fb The framebuffer whose depth buffer is read
+*/
+void mnkt_hiz_build(HiZBuffer_t* hiz, const Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_hiz_testRect
+ * Checks if a screen space rectangle can be visible, that is if its minimum depth is not behind all the depth values it covers.
+ * The level in which the rectangle covers at most 2x2 texels is used, so the test reads only four values.
+ * @param hiz The hierarchical depth buffer
+ * @param screenMin Minimum screen coordinates (x, y) and minimum depth (z) of the rectangle
+ * @param screenMax Maximum screen coordinates (x, y) of the rectangle
+ * @return One if the rectangle can be visible, zero if it is occluded
+*/
+int mnkt_hiz_testRect(const HiZBuffer_t* hiz, const Vec3_t* screenMin, const Vec3_t* screenMax);
+
+
+/**
+ * @function mnkt_hiz_testBox
+ * Checks if a bounding box can be visible according to a hierarchical depth buffer
+ * @param hiz The hierarchical depth buffer
+ * @param box The bounding box
+ * @param viewProjection The matrix that transforms the box into clip coordinates
+ * @param viewport The viewport on which the box is mapped
+ * @return One if the box can be visible, zero if it is occluded
+*/
+int mnkt_hiz_testBox(const HiZBuffer_t* hiz, const BoundingBox_t* box, const Mat4_t* viewProjection, const Viewport_t* viewport);
+
+
+#endif // MNKT_CULLING_H
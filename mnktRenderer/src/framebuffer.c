@@ -8,10 +8,491 @@
 
 #include "framebuffer.h"
 
+#include "utility/colorUtils.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/**
+ * @macro MNKT_ALIGNED_ALLOC
+ * Allocates memory aligned to the given boundary (the size must be a multiple of it), released by MNKT_ALIGNED_FREE.
+ * Used for the frame arena, whose sub arenas are aligned to the cache lines
+*/
+#if defined(_MSC_VER)
+        #include <malloc.h>
+        #define MNKT_ALIGNED_ALLOC(alignment, size)     _aligned_malloc((size), (alignment))
+        #define MNKT_ALIGNED_FREE(ptr)                  _aligned_free(ptr)
+#else
+        #define MNKT_ALIGNED_ALLOC(alignment, size)     aligned_alloc((alignment), (size))
+        #define MNKT_ALIGNED_FREE(ptr)                  free(ptr)
+#endif
+
+
+// Samples positions (offsets from the pixel center) for each supported samples count, they follow the standard D3D patterns
+static const Vec2_t MNKT_SAMPLE_POSITIONS_2X[2] = {
+        {  0.25f,  0.25f }, { -0.25f, -0.25f }
+};
+
+static const Vec2_t MNKT_SAMPLE_POSITIONS_4X[4] = {
+        { -0.125f, -0.375f }, {  0.375f, -0.125f }, { -0.375f,  0.125f }, {  0.125f,  0.375f }
+};
+
+static const Vec2_t MNKT_SAMPLE_POSITIONS_8X[8] = {
+        {  0.0625f, -0.1875f }, { -0.0625f,  0.1875f }, {  0.3125f,  0.0625f }, { -0.1875f, -0.3125f },
+        { -0.3125f,  0.3125f }, { -0.4375f, -0.0625f }, {  0.1875f,  0.4375f }, {  0.4375f, -0.4375f }
+};
+
+
+static Rect_t   mnkt_framebuffer_getClearRect(const Framebuffer_t* fb);
+static void     mnkt_framebuffer_resolvePixel(Framebuffer_t* fb, uint32_t x, uint32_t y, ResolveFilter_t filter);
+
+
+/**
+ * @function mnkt_framebuffer_init
+ * Initializes the given framebuffer with the given buffers and sets up the default state
+ * (viewport that covers the whole framebuffer with depth range [0, 1] and no scissor)
+ * @param fb Framebuffer to be initialized
+ * @param width Width of the framebuffer expressed in pixels
+ * @param height Height of the framebuffer expressed in pixels
+ * @param colorBuffer Color buffer of the framebuffer, must point to an array of 3 * width * height elements
+ *      (can be NULL for depth only framebuffers, e.g. shadow maps, on which nothing but depth is written)
+ * @param depthBuffer Depth buffer of the framebuffer, must point to an array of width * height elements
+ * @note: The framebuffer creates and owns the frame arena that stores the transient data of each frame,
+ *      it must be released with mnkt_framebuffer_destroy
+*/
+void mnkt_framebuffer_init(Framebuffer_t* fb, uint32_t width, uint32_t height, unsigned char* colorBuffer, float* depthBuffer)
+{
+        if(fb == NULL)
+                return;
+
+        memset(fb, 0, sizeof(Framebuffer_t));
+
+        fb->width = width;
+        fb->height = height;
+        fb->colorBuffer = colorBuffer;
+        fb->depthBuffer = depthBuffer;
+
+        mnkt_framebuffer_setViewport(fb, 0.0f, 0.0f, width, height);
+        mnkt_framebuffer_setDepthRange(fb, 0.0f, 1.0f);
+
+        // Transient data is taken from the arena, so that no malloc/free happens once the size of the frames stabilizes
+        // (drawing works, with a few more allocations, even if the arena cannot be created)
+        fb->ownedFrameArena = MNKT_ALIGNED_ALLOC(_Alignof(FrameArena_t), sizeof(FrameArena_t));
+
+        if(fb->ownedFrameArena != NULL && mnkt_frameArena_create(fb->ownedFrameArena, 1, MNKT_FRAME_ARENA_SIZE) != 0)
+        {
+                MNKT_ALIGNED_FREE(fb->ownedFrameArena);
+                fb->ownedFrameArena = NULL;
+        }
+
+        fb->frameArena = fb->ownedFrameArena;
+}
+
+
+/**
+ * @function mnkt_framebuffer_destroy
+ * Releases the memory owned by the given framebuffer (its frame arena and its per sample buffers),
+ * the color and depth buffers given to mnkt_framebuffer_init are owned by the caller and are not released
+ * @param fb Framebuffer to be destroyed
+*/
+void mnkt_framebuffer_destroy(Framebuffer_t* fb)
+{
+        if(fb == NULL)
+                return;
+
+        mnkt_framebuffer_destroyMultisample(fb);
+
+        if(fb->frameArena == fb->ownedFrameArena)
+                fb->frameArena = NULL;
+
+        mnkt_frameArena_destroy(fb->ownedFrameArena);
+        MNKT_ALIGNED_FREE(fb->ownedFrameArena);
+        fb->ownedFrameArena = NULL;
+}
+
+
+/**
+ * @function mnkt_framebuffer_setViewport
+ * Sets the area of the framebuffer on which normalized device coordinates are mapped
+ * @param fb Framebuffer of which the viewport must be set
+ * @param x X coordinate of the top left corner of the viewport
+ * @param y Y coordinate of the top left corner of the viewport
+ * @param width Width of the viewport expressed in pixels
+ * @param height Height of the viewport expressed in pixels
+*/
+void mnkt_framebuffer_setViewport(Framebuffer_t* fb, float x, float y, float width, float height)
+{
+        if(fb == NULL)
+                return;
+
+        fb->viewport.x = x;
+        fb->viewport.y = y;
+        fb->viewport.width = width;
+        fb->viewport.height = height;
+}
+
+
+/**
+ * @function mnkt_framebuffer_setDepthRange
+ * Sets the range on which the depth values, in normalized device coordinates, are mapped
+ * @param fb Framebuffer of which the depth range must be set
+ * @param minDepth Depth value on which the near plane is mapped
+ * @param maxDepth Depth value on which the far plane is mapped
+*/
+void mnkt_framebuffer_setDepthRange(Framebuffer_t* fb, float minDepth, float maxDepth)
+{
+        if(fb == NULL)
+                return;
+
+        fb->viewport.minDepth = minDepth;
+        fb->viewport.maxDepth = maxDepth;
+}
+
+
+/**
+ * @function mnkt_framebuffer_setScissor
+ * Enables the scissor test, fragments outside of the given rectangle will not be produced
+ * @param fb Framebuffer of which the scissor rectangle must be set
+ * @param x X coordinate of the top left corner of the scissor rectangle
+ * @param y Y coordinate of the top left corner of the scissor rectangle
+ * @param width Width of the scissor rectangle expressed in pixels
+ * @param height Height of the scissor rectangle expressed in pixels
+*/
+void mnkt_framebuffer_setScissor(Framebuffer_t* fb, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+        if(fb == NULL)
+                return;
+
+        fb->scissor.x = x;
+        fb->scissor.y = y;
+        fb->scissor.width = width;
+        fb->scissor.height = height;
+        fb->scissorEnabled = 1;
+}
+
+
+/**
+ * @function mnkt_framebuffer_disableScissor
+ * Disables the scissor test
+ * @param fb Framebuffer of which the scissor test must be disabled
+*/
+void mnkt_framebuffer_disableScissor(Framebuffer_t* fb)
+{
+        if(fb == NULL)
+                return;
+
+        fb->scissorEnabled = 0;
+}
+
+
+/**
+ * @function mnkt_framebuffer_getClipRect
+ * Computes the area of the framebuffer in which fragments can be produced, that is the
+ * intersection between the framebuffer, the viewport and the scissor rectangle (if enabled)
+ * @param fb Framebuffer of which the clip rectangle must be computed
+ * @return The clip rectangle, its width and height are zero if no fragment can be produced
+*/
+Rect_t mnkt_framebuffer_getClipRect(const Framebuffer_t* fb)
+{
+        Rect_t clipRect = { 0, 0, 0, 0 };
+
+        if(fb == NULL)
+                return clipRect;
+
+        // Start from the framebuffer area and restrict it to the viewport
+        int32_t minX = (int32_t) fmaxf(floorf(fb->viewport.x), 0.0f);
+        int32_t minY = (int32_t) fmaxf(floorf(fb->viewport.y), 0.0f);
+        int32_t maxX = (int32_t) fminf(ceilf(fb->viewport.x + fb->viewport.width), (float) fb->width);
+        int32_t maxY = (int32_t) fminf(ceilf(fb->viewport.y + fb->viewport.height), (float) fb->height);
+
+        // Restrict the area to the scissor rectangle
+        if(fb->scissorEnabled)
+        {
+                if(fb->scissor.x > minX)
+                        minX = fb->scissor.x;
+
+                if(fb->scissor.y > minY)
+                        minY = fb->scissor.y;
+
+                if(fb->scissor.x + fb->scissor.width < maxX)
+                        maxX = fb->scissor.x + fb->scissor.width;
+
+                if(fb->scissor.y + fb->scissor.height < maxY)
+                        maxY = fb->scissor.y + fb->scissor.height;
+        }
+
+        if(maxX <= minX || maxY <= minY)
+                return clipRect;
+
+        clipRect.x = minX;
+        clipRect.y = minY;
+        clipRect.width = maxX - minX;
+        clipRect.height = maxY - minY;
+
+        return clipRect;
+}
+
+
+/**
+ * @function mnkt_framebuffer_createMultisample
+ * Enables multisample anti-aliasing on the given framebuffer and allocates the per sample buffers
+ * @param fb Framebuffer on which multisampling must be enabled
+ * @param samplesCount Number of samples per pixel, can be 2, 4 or 8
+ * @param colorPoolCapacity Max number of pixels whose samples can have different colors
+ *      (use 0 to reserve space for a quarter of the framebuffer's pixels).
+ *      When the pool is exhausted partially covered pixels are drawn as if coverage was total (if at least half of the samples are covered) or not drawn at all.
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_framebuffer_createMultisample(Framebuffer_t* fb, uint32_t samplesCount, uint32_t colorPoolCapacity)
+{
+        if(fb == NULL || mnkt_framebuffer_getSamplePositions(samplesCount) == NULL)
+                return 1;
+
+        mnkt_framebuffer_destroyMultisample(fb);
+
+        const size_t pixelsCount = (size_t) fb->width * fb->height;
+
+        if(colorPoolCapacity == 0)
+                colorPoolCapacity = (pixelsCount / 4) + 1;
+
+        MultisampleBuffer_t* ms = &fb->multisample;
+
+        ms->depthBuffer = malloc(sizeof(float) * pixelsCount * samplesCount);
+        ms->colorIndices = malloc(sizeof(uint32_t) * pixelsCount);
+        ms->colorPool = malloc((size_t) colorPoolCapacity * samplesCount * 3);
+
+        if(ms->depthBuffer == NULL || ms->colorIndices == NULL || ms->colorPool == NULL)
+        {
+                mnkt_framebuffer_destroyMultisample(fb);
+                return 1;
+        }
+
+        ms->samplesCount = samplesCount;
+        ms->colorPoolCapacity = colorPoolCapacity;
+        ms->colorPoolUsed = 0;
+        ms->colorPoolFree = MNKT_PIXEL_COMPRESSED;
+
+        // All pixels start compressed
+        memset(ms->colorIndices, 0xFF, sizeof(uint32_t) * pixelsCount);
+
+        for(size_t i = 0; i < pixelsCount * samplesCount; ++i)
+                ms->depthBuffer[i] = 1.0f;
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_framebuffer_destroyMultisample
+ * Disables multisample anti-aliasing on the given framebuffer and deallocates the per sample buffers
+ * @param fb Framebuffer on which multisampling must be disabled
+*/
+void mnkt_framebuffer_destroyMultisample(Framebuffer_t* fb)
+{
+        if(fb == NULL)
+                return;
+
+        free(fb->multisample.depthBuffer);
+        free(fb->multisample.colorIndices);
+        free(fb->multisample.colorPool);
+
+        memset(&fb->multisample, 0, sizeof(MultisampleBuffer_t));
+}
+
+
+/**
+ * @function mnkt_framebuffer_getSamplePositions
+ * Gets the positions of the samples inside a pixel
+ * @param samplesCount Number of samples per pixel
+ * @return Array of samplesCount positions, expressed as offsets from the pixel center, NULL if the samples count is not supported
+*/
+const Vec2_t* mnkt_framebuffer_getSamplePositions(uint32_t samplesCount)
+{
+        switch(samplesCount)
+        {
+                case 2:         return MNKT_SAMPLE_POSITIONS_2X;
+                case 4:         return MNKT_SAMPLE_POSITIONS_4X;
+                case 8:         return MNKT_SAMPLE_POSITIONS_8X;
+                default:        return NULL;
+        }
+}
+
+
+/**
+ * @function mnkt_framebuffer_resolve
+ * Combines the samples of each pixel of a multisampled framebuffer and stores the result into its color buffer.
+ * Only the pixels whose samples differ are processed, the others are already stored in the color buffer:
+ * with the tent filter the neighbours of an edge pixel contribute to it, but fully covered neighbours are not filtered themselves.
+ * @param fb Framebuffer to be resolved
+ * @param filter Filter to be used to combine the samples
+*/
+void mnkt_framebuffer_resolve(Framebuffer_t* fb, ResolveFilter_t filter)
+{
+        if(fb == NULL || fb->colorBuffer == NULL || fb->multisample.samplesCount < 2)
+                return;
+
+        // Nothing to do if all pixels are compressed
+        if(fb->multisample.colorPoolUsed == 0)
+                return;
+
+        for(uint32_t y = 0; y < fb->height; ++y)
+        {
+                const uint32_t* rowIndices = &fb->multisample.colorIndices[(size_t) y * fb->width];
+
+                for(uint32_t x = 0; x < fb->width; ++x)
+                {
+                        if(rowIndices[x] != MNKT_PIXEL_COMPRESSED)
+                                mnkt_framebuffer_resolvePixel(fb, x, y, filter);
+                }
+        }
+}
+
+
+/**
+ * @function mnkt_framebuffer_setAttachment
+ * Sets a color attachment of the framebuffer, the framebuffer does not take ownership of its memory
+ * @param fb Framebuffer of which the attachment must be set
+ * @param index Index of the attachment (less than MNKT_MAX_COLOR_ATTACHMENTS)
+ * @param format Format of the attachment's pixels
+ * @param data Pixels of the attachment, must point to width * height elements of the given format (NULL to remove the attachment)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_framebuffer_setAttachment(Framebuffer_t* fb, uint32_t index, ColorFormat_t format, void* data)
+{
+        if(fb == NULL || index >= MNKT_MAX_COLOR_ATTACHMENTS || format > MNKT_FORMAT_RGBA32F)
+                return 1;
+
+        fb->attachments[index].format = format;
+        fb->attachments[index].data = data;
+
+        // Attachments in use are the ones up to the last one with data
+        fb->attachmentsCount = 0;
+
+        for(uint32_t i = 0; i < MNKT_MAX_COLOR_ATTACHMENTS; ++i)
+        {
+                if(fb->attachments[i].data != NULL)
+                        fb->attachmentsCount = i + 1;
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_framebuffer_writeAttachment
+ * Stores a color into a pixel of a color attachment, converting it to the attachment's format
+ * @param attachment The color attachment
+ * @param pixelIndex Index of the pixel inside the attachment
+ * @param color Color to be stored
+*/
+void mnkt_framebuffer_writeAttachment(const ColorAttachment_t* attachment, size_t pixelIndex, const Vec4_t* color)
+{
+        if(attachment->data == NULL)
+                return;
+
+        unsigned char* bytes = attachment->data;
+        float* floats = attachment->data;
+
+        switch(attachment->format)
+        {
+                case MNKT_FORMAT_RGB8:
+                        bytes[ pixelIndex * 3 ] =       mnkt_colorAsUChar(color->r);
+                        bytes[ (pixelIndex * 3) + 1 ] = mnkt_colorAsUChar(color->g);
+                        bytes[ (pixelIndex * 3) + 2 ] = mnkt_colorAsUChar(color->b);
+                        break;
+
+                case MNKT_FORMAT_RGBA8:
+                        bytes[ pixelIndex * 4 ] =       mnkt_colorAsUChar(color->r);
+                        bytes[ (pixelIndex * 4) + 1 ] = mnkt_colorAsUChar(color->g);
+                        bytes[ (pixelIndex * 4) + 2 ] = mnkt_colorAsUChar(color->b);
+                        bytes[ (pixelIndex * 4) + 3 ] = mnkt_colorAsUChar(color->a);
+                        break;
+
+                case MNKT_FORMAT_R32F:
+                        floats[pixelIndex] = color->x;
+                        break;
+
+                case MNKT_FORMAT_RGBA32F:
+                        memcpy(&floats[pixelIndex * 4], color, sizeof(float) * 4);
+                        break;
+        }
+}
+
+
+/**
+ * @function mnkt_framebuffer_readAttachment
+ * Reads a pixel of a color attachment
+ * @param attachment The color attachment
+ * @param pixelIndex Index of the pixel inside the attachment
+ * @return The color of the pixel (components not stored by the format are zero, alpha is one)
+*/
+Vec4_t mnkt_framebuffer_readAttachment(const ColorAttachment_t* attachment, size_t pixelIndex)
+{
+        Vec4_t color = { .x = 0.0f, .y = 0.0f, .z = 0.0f, .w = 1.0f };
+
+        if(attachment->data == NULL)
+                return color;
+
+        const unsigned char* bytes = attachment->data;
+        const float* floats = attachment->data;
+
+        switch(attachment->format)
+        {
+                case MNKT_FORMAT_RGB8:
+                        color.r = mnkt_colorAsFloat(bytes[ pixelIndex * 3 ]);
+                        color.g = mnkt_colorAsFloat(bytes[ (pixelIndex * 3) + 1 ]);
+                        color.b = mnkt_colorAsFloat(bytes[ (pixelIndex * 3) + 2 ]);
+                        break;
+
+                case MNKT_FORMAT_RGBA8:
+                        color.r = mnkt_colorAsFloat(bytes[ pixelIndex * 4 ]);
+                        color.g = mnkt_colorAsFloat(bytes[ (pixelIndex * 4) + 1 ]);
+                        color.b = mnkt_colorAsFloat(bytes[ (pixelIndex * 4) + 2 ]);
+                        color.a = mnkt_colorAsFloat(bytes[ (pixelIndex * 4) + 3 ]);
+                        break;
+
+                case MNKT_FORMAT_R32F:
+                        color.x = floats[pixelIndex];
+                        break;
+
+                case MNKT_FORMAT_RGBA32F:
+                        memcpy(&color, &floats[pixelIndex * 4], sizeof(float) * 4);
+                        break;
+        }
+
+        return color;
+}
+
+
+/**
+ * @function mnkt_framebuffer_clearAttachment
+ * Sets the color of all pixels of a color attachment (only the pixels inside the scissor rectangle, if enabled)
+ * @param index Index of the attachment to be cleared
+ * @param color Color to be used for all pixels
+ * @param fb Framebuffer of which the attachment must be cleared
+*/
+void mnkt_framebuffer_clearAttachment(uint32_t index, const Vec4_t* color, Framebuffer_t* fb)
+{
+        if(fb == NULL || color == NULL || index >= fb->attachmentsCount)
+                return;
+
+        const ColorAttachment_t* attachment = &fb->attachments[index];
+        Rect_t area = mnkt_framebuffer_getClearRect(fb);
+
+        for(int32_t y = area.y; y < area.y + area.height; ++y)
+        {
+                size_t pixelIndex = ((size_t) y * fb->width) + area.x;
+
+                for(int32_t x = 0; x < area.width; ++x, ++pixelIndex)
+                        mnkt_framebuffer_writeAttachment(attachment, pixelIndex, color);
+        }
+}
+
 
 /**
  * @function mnkt_framebuffer_clearColor
- * Sets the color of all pixels inside the framebuffer
+ * Sets the color of all pixels inside the framebuffer (only the pixels inside the scissor rectangle, if enabled)
  * @param r Red value to be used for the clear color
  * @param g Green value to be used for the clear color
  * @param b Blue value to be used for the clear color
@@ -22,31 +503,184 @@ void mnkt_framebuffer_clearColor(const unsigned char r, const unsigned char g, c
         if(fb == NULL || fb->colorBuffer == NULL)
                 return;
 
-        size_t currIndex = 0;
-        for(uint32_t i = 0; i < fb->width * fb->height; ++i)
+        Rect_t area = mnkt_framebuffer_getClearRect(fb);
+
+        for(int32_t y = area.y; y < area.y + area.height; ++y)
+        {
+                size_t currIndex = ( ((size_t) y * fb->width) + area.x ) * 3;
+
+                for(int32_t x = 0; x < area.width; ++x)
+                {
+                        fb->colorBuffer[currIndex] = r;
+                        fb->colorBuffer[currIndex + 1] = g;
+                        fb->colorBuffer[currIndex + 2] = b;
+
+                        currIndex += 3;
+                }
+        }
+
+        // All cleared pixels have the same color for all their samples
+        if(fb->multisample.samplesCount > 1)
         {
-                fb->colorBuffer[currIndex] = r;
-                fb->colorBuffer[currIndex + 1] = g;
-                fb->colorBuffer[currIndex + 2] = b;
+                MultisampleBuffer_t* ms = &fb->multisample;
+
+                // The whole pool is emptied if no pixel references it anymore, otherwise the slots of the cleared pixels are released one by one
+                if(area.width == (int32_t) fb->width && area.height == (int32_t) fb->height)
+                {
+                        ms->colorPoolUsed = 0;
+                        ms->colorPoolFree = MNKT_PIXEL_COMPRESSED;
+
+                } else
+                {
+                        for(int32_t y = area.y; y < area.y + area.height; ++y)
+                        {
+                                const uint32_t* rowIndices = &ms->colorIndices[ ((size_t) y * fb->width) + area.x ];
+
+                                for(int32_t x = 0; x < area.width; ++x)
+                                {
+                                        if(rowIndices[x] == MNKT_PIXEL_COMPRESSED)
+                                                continue;
 
-                currIndex += 3;
+                                        memcpy(&ms->colorPool[ (size_t) rowIndices[x] * ms->samplesCount * 3 ], &ms->colorPoolFree, sizeof(uint32_t));
+                                        ms->colorPoolFree = rowIndices[x];
+                                }
+                        }
+                }
+
+                for(int32_t y = area.y; y < area.y + area.height; ++y)
+                        memset(&ms->colorIndices[ ((size_t) y * fb->width) + area.x ], 0xFF, sizeof(uint32_t) * area.width);
         }
 }
 
 
 /**
  * @function mnkt_framebuffer_clearDepth
- * Sets the depth values of all pixels inside the framebuffer
+ * Sets the depth values of all pixels inside the framebuffer (only the pixels inside the scissor rectangle, if enabled)
  * @param depth Depth value to be used for all pixels
  * @param framebuffer Framebuffer of which the depth buffer must be cleared
 */
 void mnkt_framebuffer_clearDepth(float depth, Framebuffer_t* fb)
 {
-        if(fb == NULL || fb->depthBuffer == NULL)
+        if(fb == NULL)
                 return;
 
-        for(uint32_t i = 0; i < fb->width * fb->height; ++i)
-                fb->depthBuffer[i] = depth;
+        Rect_t area = mnkt_framebuffer_getClearRect(fb);
+
+        if(fb->depthBuffer != NULL)
+        {
+                for(int32_t y = area.y; y < area.y + area.height; ++y)
+                {
+                        float* row = &fb->depthBuffer[ ((size_t) y * fb->width) + area.x ];
+
+                        for(int32_t x = 0; x < area.width; ++x)
+                                row[x] = depth;
+                }
+        }
+
+        // Also clear the depth of each sample, if multisampling is enabled
+        if(fb->multisample.samplesCount > 1)
+        {
+                const uint32_t samplesCount = fb->multisample.samplesCount;
+
+                for(int32_t y = area.y; y < area.y + area.height; ++y)
+                {
+                        float* row = &fb->multisample.depthBuffer[ ( ((size_t) y * fb->width) + area.x ) * samplesCount ];
+
+                        for(int32_t i = 0; i < area.width * (int32_t) samplesCount; ++i)
+                                row[i] = depth;
+                }
+        }
 }
 
 
+/**
+ * @function mnkt_framebuffer_getClearRect
+ * Computes the area of the framebuffer affected by clear operations (the whole framebuffer
+ * or, if the scissor test is enabled, its intersection with the scissor rectangle)
+ * @param fb Framebuffer of which the clear area must be computed
+ * @return The area affected by clear operations
+ * @note: For internal usage only!!!
+*/
+static Rect_t mnkt_framebuffer_getClearRect(const Framebuffer_t* fb)
+{
+        Rect_t area = { 0, 0, (int32_t) fb->width, (int32_t) fb->height };
+
+        if(!fb->scissorEnabled)
+                return area;
+
+        int32_t maxX = fb->scissor.x + fb->scissor.width;
+        int32_t maxY = fb->scissor.y + fb->scissor.height;
+
+        area.x = fb->scissor.x > 0 ? fb->scissor.x : 0;
+        area.y = fb->scissor.y > 0 ? fb->scissor.y : 0;
+        area.width = (maxX < (int32_t) fb->width ? maxX : (int32_t) fb->width) - area.x;
+        area.height = (maxY < (int32_t) fb->height ? maxY : (int32_t) fb->height) - area.y;
+
+        if(area.width < 0 || area.height < 0)
+                area.width = area.height = 0;
+
+        return area;
+}
+
+
+/**
+ * @function mnkt_framebuffer_resolvePixel
+ * Combines the samples of an uncompressed pixel and stores the result into the color buffer
+ * @param fb Multisampled framebuffer that contains the pixel
+ * @param x X coordinate of the pixel
+ * @param y Y coordinate of the pixel
+ * @param filter Filter to be used to combine the samples
+ * @note: For internal usage only!!!
+*/
+static void mnkt_framebuffer_resolvePixel(Framebuffer_t* fb, uint32_t x, uint32_t y, ResolveFilter_t filter)
+{
+        const MultisampleBuffer_t* ms = &fb->multisample;
+        const Vec2_t* positions = mnkt_framebuffer_getSamplePositions(ms->samplesCount);
+
+        // With the box filter only the samples of the pixel itself are considered
+        const int32_t radius = (filter == MNKT_RESOLVE_TENT) ? 1 : 0;
+
+        float color[3] = { 0.0f, 0.0f, 0.0f };
+        float totalWeight = 0.0f;
+
+        for(int32_t dy = -radius; dy <= radius; ++dy)
+        {
+                for(int32_t dx = -radius; dx <= radius; ++dx)
+                {
+                        int32_t nx = (int32_t) x + dx;
+                        int32_t ny = (int32_t) y + dy;
+
+                        if(nx < 0 || ny < 0 || nx >= (int32_t) fb->width || ny >= (int32_t) fb->height)
+                                continue;
+
+                        size_t pixelIndex = ((size_t) ny * fb->width) + nx;
+                        uint32_t slot = ms->colorIndices[pixelIndex];
+
+                        for(uint32_t s = 0; s < ms->samplesCount; ++s)
+                        {
+                                float weight = 1.0f;
+
+                                if(filter == MNKT_RESOLVE_TENT)
+                                        weight = fmaxf(0.0f, 1.0f - fabsf(dx + positions[s].x)) * fmaxf(0.0f, 1.0f - fabsf(dy + positions[s].y));
+
+                                if(weight <= 0.0f)
+                                        continue;
+
+                                // Compressed pixels store the color of all their samples in the color buffer
+                                const unsigned char* sampleColor = (slot == MNKT_PIXEL_COMPRESSED) ?
+                                        &fb->colorBuffer[pixelIndex * 3] : &ms->colorPool[ ((size_t) slot * ms->samplesCount + s) * 3 ];
+
+                                color[0] += sampleColor[0] * weight;
+                                color[1] += sampleColor[1] * weight;
+                                color[2] += sampleColor[2] * weight;
+                                totalWeight += weight;
+                        }
+                }
+        }
+
+        size_t colorIndex = ( ((size_t) y * fb->width) + x ) * 3;
+
+        for(int c = 0; c < 3; ++c)
+                fb->colorBuffer[colorIndex + c] = (unsigned char) ( (color[c] / totalWeight) + 0.5f );
+}
+
@@ -11,6 +11,132 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "math/vec.h"
+#include "utility/arena.h"
+
+
+/**
+ * @macro MNKT_MAX_SAMPLES
+ * Maximum number of samples per pixel supported by multisampling
+*/
+#define MNKT_MAX_SAMPLES                8
+
+
+/**
+ * @macro MNKT_MAX_COLOR_ATTACHMENTS
+ * Maximum number of additional color attachments (render targets) of a framebuffer
+*/
+#define MNKT_MAX_COLOR_ATTACHMENTS      4
+
+
+/**
+ * @macro MNKT_FRAME_ARENA_SIZE
+ * Initial size in bytes of the frame arena created for each framebuffer (grown to the largest frame drawn)
+*/
+#define MNKT_FRAME_ARENA_SIZE           (1 << 18)
+
+
+/**
+ * @macro MNKT_PIXEL_COMPRESSED
+ * Value of a pixel's slot in the multisample color pool when all the pixel's samples
+ * have the same color (which is stored directly in the framebuffer's color buffer)
+*/
+#define MNKT_PIXEL_COMPRESSED           UINT32_MAX
+
+
+/**
+ * @struct Rect_t
+ * Models a rectangular area of the framebuffer, expressed in pixels
+*/
+typedef struct {
+        int32_t         x;                      ///< X coordinate of the top left corner of the rectangle
+        int32_t         y;                      ///< Y coordinate of the top left corner of the rectangle
+        int32_t         width;                  ///< Width of the rectangle
+        int32_t         height;                 ///< Height of the rectangle
+} Rect_t;
+
+
+/**
+ * @struct Viewport_t
+ * Defines the area of the framebuffer on which normalized device coordinates are mapped
+*/
+typedef struct {
+        float           x;                      ///< X coordinate of the top left corner of the viewport
+        float           y;                      ///< Y coordinate of the top left corner of the viewport
+        float           width;                  ///< Width of the viewport expressed in pixels
+        float           height;                 ///< Height of the viewport expressed in pixels
+        float           minDepth;               ///< Depth value on which the near plane is mapped
+        float           maxDepth;               ///< Depth value on which the far plane is mapped
+} Viewport_t;
+
+
+/**
+ * @enum ResolveFilter_t
+ * Filters that can be used to resolve the samples of a multisampled framebuffer into its color buffer
+*/
+typedef enum {
+        MNKT_RESOLVE_BOX = 0,                   ///< Average of the pixel's samples
+        MNKT_RESOLVE_TENT,                      ///< Samples of the pixel and of its neighbours weighted by their distance from the pixel center
+                                                ///< (only edge pixels are filtered, fully covered pixels next to them are left as they are)
+} ResolveFilter_t;
+
+
+/**
+ * @enum ColorFormat_t
+ * Formats in which the pixels of a color attachment can be stored
+*/
+typedef enum {
+        MNKT_FORMAT_RGB8 = 0,                   ///< 3 unsigned bytes per pixel, components in the range [0, 1]
+        MNKT_FORMAT_RGBA8,                      ///< 4 unsigned bytes per pixel, components in the range [0, 1]
+        MNKT_FORMAT_R32F,                       ///< 1 float per pixel (only the first component is stored)
+        MNKT_FORMAT_RGBA32F,                    ///< 4 floats per pixel
+} ColorFormat_t;
+
+
+/**
+ * @struct ColorAttachment_t
+ * Additional color buffer (render target) of a framebuffer, written by multiple targets fragment shaders
+*/
+typedef struct {
+        ColorFormat_t   format;                 ///< Format of the pixels
+        void*           data;                   ///< Pixels of the attachment, width * height elements of the given format (NULL if unused)
+} ColorAttachment_t;
+
+
+/**
+ * @struct MultisampleBuffer_t
+ * Stores the per sample data of a multisampled framebuffer.
+ *
+ * Colors are stored compressed: pixels fully covered by a primitive keep a single color in the
+ * framebuffer's color buffer, only pixels whose samples differ (primitives edges) get a slot
+ * in the color pool where the color of each sample is stored.
+*/
+typedef struct {
+        uint32_t        samplesCount;           ///< Number of samples per pixel (0 or 1 if multisampling is disabled)
+        float*          depthBuffer;            ///< Depth value of each sample, width * height * samplesCount elements
+        uint32_t*       colorIndices;           ///< For each pixel, the index of its slot in the color pool (MNKT_PIXEL_COMPRESSED if it has none)
+        unsigned char*  colorPool;              ///< RGB colors of the samples of the uncompressed pixels, 3 * samplesCount elements per slot
+        uint32_t        colorPoolCapacity;      ///< Number of slots in the color pool
+        uint32_t        colorPoolUsed;          ///< Number of slots taken from the pool so far (released ones included)
+        uint32_t        colorPoolFree;          ///< First released slot, to be reused before taking new ones (MNKT_PIXEL_COMPRESSED if none),
+                                                ///< released slots are chained through the index stored in their first bytes
+} MultisampleBuffer_t;
+
+
+/**
+ * @struct OcclusionQuery_t
+ * Counts the samples that pass the depth test while the query is active on a framebuffer
+*/
+typedef struct {
+        uint64_t        samplesPassed;          ///< Number of samples that passed the depth test (and were not discarded) while the query was active
+        int             testOnly;               ///< Non zero if, while the query is active, fragments are only depth tested and counted
+                                                ///< (no fragment shader invocation, no color or depth write), useful to test bounding box proxies
+} OcclusionQuery_t;
+
+
+// Binning buffers of the frame pipeline (defined in pipeline.h)
+struct FrameBins_t;
+
 
 /**
  * @struct Framebuffer
@@ -20,14 +146,192 @@
 typedef struct {
         uint32_t        width;                  ///< Width of the framebuffer image expressed in pixels
         uint32_t        height;                 ///< Height of the framebuffer image expressed in pixels
-        unsigned char*  colorBuffer;            ///< Stores pixels colors in RGB format, must point to an array of 3 * width * height elements
+        unsigned char*  colorBuffer;            ///< Stores pixels colors in RGB format, must point to an array of 3 * width * height elements (NULL for depth only framebuffers)
         float*          depthBuffer;            ///< Stores a depth value for each pixel of the color buffer, must point to an array of width * height elements
+
+        Viewport_t      viewport;               ///< Area of the framebuffer on which primitives are mapped
+        Rect_t          scissor;                ///< Area of the framebuffer outside of which no fragment is produced
+        int             scissorEnabled;         ///< Non zero if the scissor rectangle must be used
+
+        MultisampleBuffer_t multisample;        ///< Per sample data, used only if multisampling has been enabled with mnkt_framebuffer_createMultisample
+
+        FrameArena_t*   frameArena;             ///< Allocator for the transient data produced while rendering a frame (the one created by
+                                                ///< mnkt_framebuffer_init by default, NULL only if its allocation failed)
+        FrameArena_t*   ownedFrameArena;        ///< Frame arena created by mnkt_framebuffer_init, released by mnkt_framebuffer_destroy
+
+        OcclusionQuery_t* query;                ///< Occlusion query currently active on the framebuffer (NULL if none)
+
+        ColorAttachment_t attachments[MNKT_MAX_COLOR_ATTACHMENTS];      ///< Render targets written by multiple targets fragment shaders (e.g. a G-buffer)
+        uint32_t        attachmentsCount;       ///< Number of attachments in use (starting from the first one)
+
+        struct FrameBins_t* bins;               ///< Binning buffers that record the primitives drawn on the framebuffer instead of rasterizing them
+                                                ///< (set on the framebuffers returned by mnkt_pipeline_beginFrame, NULL for immediate drawing)
 } Framebuffer_t;
 
 
+/**
+ * @function mnkt_framebuffer_init
+ * Initializes the given framebuffer with the given buffers and sets up the default state
+ * (viewport that covers the whole framebuffer with depth range [0, 1] and no scissor)
+ * @param fb Framebuffer to be initialized
+ * @param width Width of the framebuffer expressed in pixels
+ * @param height Height of the framebuffer expressed in pixels
+ * @param colorBuffer Color buffer of the framebuffer, must point to an array of 3 * width * height elements
+ *      (can be NULL for depth only framebuffers, e.g. shadow maps, on which nothing but depth is written)
+ * @param depthBuffer Depth buffer of the framebuffer, must point to an array of width * height elements
+ * @note: The framebuffer creates and owns the frame arena that stores the transient data of each frame,
+ *      it must be released with mnkt_framebuffer_destroy
+*/
+void mnkt_framebuffer_init(Framebuffer_t* fb, uint32_t width, uint32_t height, unsigned char* colorBuffer, float* depthBuffer);
+
+
+/**
+ * @function mnkt_framebuffer_destroy
+ * Releases the memory owned by the given framebuffer (its frame arena and its per sample buffers),
+ * the color and depth buffers given to mnkt_framebuffer_init are owned by the caller and are not released
+ * @param fb Framebuffer to be destroyed
+*/
+void mnkt_framebuffer_destroy(Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_framebuffer_setViewport
+ * Sets the area of the framebuffer on which normalized device coordinates are mapped
+ * @param fb Framebuffer of which the viewport must be set
+ * @param x X coordinate of the top left corner of the viewport
+ * @param y Y coordinate of the top left corner of the viewport
+ * @param width Width of the viewport expressed in pixels
+ * @param height Height of the viewport expressed in pixels
+*/
+void mnkt_framebuffer_setViewport(Framebuffer_t* fb, float x, float y, float width, float height);
+
+
+/**
+ * @function mnkt_framebuffer_setDepthRange
+ * Sets the range on which the depth values, in normalized device coordinates, are mapped
+ * @param fb Framebuffer of which the depth range must be set
+ * @param minDepth Depth value on which the near plane is mapped
+ * @param maxDepth Depth value on which the far plane is mapped
+*/
+void mnkt_framebuffer_setDepthRange(Framebuffer_t* fb, float minDepth, float maxDepth);
+
+
+/**
+ * @function mnkt_framebuffer_setScissor
+ * Enables the scissor test, fragments outside of the given rectangle will not be produced
+ * @param fb Framebuffer of which the scissor rectangle must be set
+ * @param x X coordinate of the top left corner of the scissor rectangle
+ * @param y Y coordinate of the top left corner of the scissor rectangle
+ * @param width Width of the scissor rectangle expressed in pixels
+ * @param height Height of the scissor rectangle expressed in pixels
+*/
+void mnkt_framebuffer_setScissor(Framebuffer_t* fb, int32_t x, int32_t y, int32_t width, int32_t height);
+
+
+/**
+ * @function mnkt_framebuffer_disableScissor
+ * Disables the scissor test
+ * @param fb Framebuffer of which the scissor test must be disabled
+*/
+void mnkt_framebuffer_disableScissor(Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_framebuffer_getClipRect
+ * Computes the area of the framebuffer in which fragments can be produced, that is the
+ * intersection between the framebuffer, the viewport and the scissor rectangle (if enabled)
+ * @param fb Framebuffer of which the clip rectangle must be computed
+ * @return The clip rectangle, its width and height are zero if no fragment can be produced
+*/
+Rect_t mnkt_framebuffer_getClipRect(const Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_framebuffer_createMultisample
+ * Enables multisample anti-aliasing on the given framebuffer and allocates the per sample buffers
+ * @param fb Framebuffer on which multisampling must be enabled
+ * @param samplesCount Number of samples per pixel, can be 2, 4 or 8
+ * @param colorPoolCapacity Max number of pixels whose samples can have different colors
+ *      (use 0 to reserve space for a quarter of the framebuffer's pixels).
+ *      When the pool is exhausted partially covered pixels are drawn as if coverage was total (if at least half of the samples are covered) or not drawn at all.
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_framebuffer_createMultisample(Framebuffer_t* fb, uint32_t samplesCount, uint32_t colorPoolCapacity);
+
+
+/**
+ * @function mnkt_framebuffer_destroyMultisample
+ * Disables multisample anti-aliasing on the given framebuffer and deallocates the per sample buffers
+ * @param fb Framebuffer on which multisampling must be disabled
+*/
+void mnkt_framebuffer_destroyMultisample(Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_framebuffer_getSamplePositions
+ * Gets the positions of the samples inside a pixel
+ * @param samplesCount Number of samples per pixel
+ * @return Array of samplesCount positions, expressed as offsets from the pixel center, NULL if the samples count is not supported
+*/
+const Vec2_t* mnkt_framebuffer_getSamplePositions(uint32_t samplesCount);
+
+
+/**
+ * @function mnkt_framebuffer_resolve
+ * Combines the samples of each pixel of a multisampled framebuffer and stores the result into its color buffer.
+ * Only the pixels whose samples differ are processed, the others are already stored in the color buffer:
+ * with the tent filter the neighbours of an edge pixel contribute to it, but fully covered neighbours are not filtered themselves.
+ * @param fb Framebuffer to be resolved
+ * @param filter Filter to be used to combine the samples
+*/
+void mnkt_framebuffer_resolve(Framebuffer_t* fb, ResolveFilter_t filter);
+
+
+/**
+ * @function mnkt_framebuffer_setAttachment
+ * Sets a color attachment of the framebuffer, the framebuffer does not take ownership of its memory
+ * @param fb Framebuffer of which the attachment must be set
+ * @param index Index of the attachment (less than MNKT_MAX_COLOR_ATTACHMENTS)
+ * @param format Format of the attachment's pixels
+ * @param data Pixels of the attachment, must point to width * height elements of the given format (NULL to remove the attachment)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_framebuffer_setAttachment(Framebuffer_t* fb, uint32_t index, ColorFormat_t format, void* data);
+
+
+/**
+ * @function mnkt_framebuffer_writeAttachment
+ * Stores a color into a pixel of a color attachment, converting it to the attachment's format
+ * @param attachment The color attachment
+ * @param pixelIndex Index of the pixel inside the attachment
+ * @param color Color to be stored
+*/
+void mnkt_framebuffer_writeAttachment(const ColorAttachment_t* attachment, size_t pixelIndex, const Vec4_t* color);
+
+
+/**
+ * @function mnkt_framebuffer_readAttachment
+ * Reads a pixel of a color attachment
+ * @param attachment The color attachment
+ * @param pixelIndex Index of the pixel inside the attachment
+ * @return The color of the pixel (components not stored by the format are zero, alpha is one)
+*/
+Vec4_t mnkt_framebuffer_readAttachment(const ColorAttachment_t* attachment, size_t pixelIndex);
+
+
+/**
+ * @function mnkt_framebuffer_clearAttachment
+ * Sets the color of all pixels of a color attachment (only the pixels inside the scissor rectangle, if enabled)
+ * @param index Index of the attachment to be cleared
+ * @param color Color to be used for all pixels
+ * @param fb Framebuffer of which the attachment must be cleared
+*/
+void mnkt_framebuffer_clearAttachment(uint32_t index, const Vec4_t* color, Framebuffer_t* fb);
+
+
 /**
  * @function mnkt_framebuffer_clearColor
- * Sets the color of all pixels inside the framebuffer
+ * Sets the color of all pixels inside the framebuffer (only the pixels inside the scissor rectangle, if enabled)
  * @param r Red value to be used for the clear color
  * @param g Green value to be used for the clear color
  * @param b Blue value to be used for the clear color
@@ -38,7 +342,7 @@ void mnkt_framebuffer_clearColor(const unsigned char r, const unsigned char g, c
 
 /**
  * @function mnkt_framebuffer_clearDepth
- * Sets the depth values of all pixels inside the framebuffer
+ * Sets the depth values of all pixels inside the framebuffer (only the pixels inside the scissor rectangle, if enabled)
  * @param depth Depth value to be used for all pixels
  * @param framebuffer Framebuffer of which the depth buffer must be cleared
 */
@@ -0,0 +1,502 @@
+
+/*
+ * @file mat.c
+ *
+ * Contains implementation of the matrices API
+*/
+
+
+#include "mat.h"
+#include "mathUtils.h"
+#include "../utility/simd.h"
+
+#include <string.h>
+
+
+Mat3_t mnkt_mat3_identity(void)
+{
+        return (Mat3_t) {
+                .m = {
+                        1.0f, 0.0f, 0.0f,
+                        0.0f, 1.0f, 0.0f,
+                        0.0f, 0.0f, 1.0f
+                }
+        };
+}
+
+
+Mat3_t mnkt_mat3_fromMat4(const Mat4_t* a)
+{
+        return (Mat3_t) {
+                .m = {
+                        a->m[0], a->m[1], a->m[2],
+                        a->m[4], a->m[5], a->m[6],
+                        a->m[8], a->m[9], a->m[10]
+                }
+        };
+}
+
+
+Mat3_t mnkt_mat3_mul(const Mat3_t* a, const Mat3_t* b)
+{
+        Mat3_t result;
+
+        for(int col = 0; col < 3; ++col)
+        {
+                for(int row = 0; row < 3; ++row)
+                {
+                        result.m[(col * 3) + row] = (a->m[row] * b->m[col * 3]) +
+                                                    (a->m[3 + row] * b->m[(col * 3) + 1]) +
+                                                    (a->m[6 + row] * b->m[(col * 3) + 2]);
+                }
+        }
+
+        return result;
+}
+
+
+Vec3_t mnkt_mat3_mulVec3(const Mat3_t* a, const Vec3_t* v)
+{
+        return (Vec3_t) {
+                .x = (a->m[0] * v->x) + (a->m[3] * v->y) + (a->m[6] * v->z),
+                .y = (a->m[1] * v->x) + (a->m[4] * v->y) + (a->m[7] * v->z),
+                .z = (a->m[2] * v->x) + (a->m[5] * v->y) + (a->m[8] * v->z)
+        };
+}
+
+
+Mat3_t mnkt_mat3_transpose(const Mat3_t* a)
+{
+        return (Mat3_t) {
+                .m = {
+                        a->m[0], a->m[3], a->m[6],
+                        a->m[1], a->m[4], a->m[7],
+                        a->m[2], a->m[5], a->m[8]
+                }
+        };
+}
+
+
+/**
+ * @function mnkt_mat3_inverse
+ * Computes the inverse of a 3x3 matrix
+ * @param a Matrix to be inverted
+ * @param result Where the inverse is stored (can be the same as a)
+ * @return One on success, zero if the matrix is singular (result is left untouched)
+*/
+int mnkt_mat3_inverse(const Mat3_t* a, Mat3_t* result)
+{
+        const float* m = a->m;
+
+        // Cofactors of the first column
+        float c0 = (m[4] * m[8]) - (m[7] * m[5]);
+        float c1 = (m[7] * m[2]) - (m[1] * m[8]);
+        float c2 = (m[1] * m[5]) - (m[4] * m[2]);
+
+        float det = (m[0] * c0) + (m[3] * c1) + (m[6] * c2);
+
+        if(det == 0.0f || !isfinite(det))
+                return 0;
+
+        float invDet = 1.0f / det;
+
+        Mat3_t inverse = {
+                .m = {
+                        c0 * invDet,
+                        c1 * invDet,
+                        c2 * invDet,
+                        ((m[6] * m[5]) - (m[3] * m[8])) * invDet,
+                        ((m[0] * m[8]) - (m[6] * m[2])) * invDet,
+                        ((m[3] * m[2]) - (m[0] * m[5])) * invDet,
+                        ((m[3] * m[7]) - (m[6] * m[4])) * invDet,
+                        ((m[6] * m[1]) - (m[0] * m[7])) * invDet,
+                        ((m[0] * m[4]) - (m[3] * m[1])) * invDet
+                }
+        };
+
+        *result = inverse;
+        return 1;
+}
+
+
+/**
+ * @function mnkt_mat3_normalMatrix
+ * Computes the matrix that transforms normals, the inverse transpose of the upper left 3x3 part of the given matrix
+ * @param modelView Matrix that transforms the positions
+ * @param result Where the normal matrix is stored
+ * @return One on success, zero if the matrix is singular (result is left untouched)
+*/
+int mnkt_mat3_normalMatrix(const Mat4_t* modelView, Mat3_t* result)
+{
+        Mat3_t upperLeft = mnkt_mat3_fromMat4(modelView);
+        Mat3_t inverse;
+
+        if( !mnkt_mat3_inverse(&upperLeft, &inverse) )
+                return 0;
+
+        *result = mnkt_mat3_transpose(&inverse);
+        return 1;
+}
+
+
+Mat4_t mnkt_mat4_identity(void)
+{
+        return (Mat4_t) {
+                .m = {
+                        1.0f, 0.0f, 0.0f, 0.0f,
+                        0.0f, 1.0f, 0.0f, 0.0f,
+                        0.0f, 0.0f, 1.0f, 0.0f,
+                        0.0f, 0.0f, 0.0f, 1.0f
+                }
+        };
+}
+
+
+Mat4_t mnkt_mat4_mul(const Mat4_t* a, const Mat4_t* b)
+{
+        Mat4_t result;
+
+#ifdef MNKT_SIMD_SSE2
+        // Each column of the result is a linear combination of the columns of a
+        const __m128 col0 = _mm_loadu_ps(&a->m[0]);
+        const __m128 col1 = _mm_loadu_ps(&a->m[4]);
+        const __m128 col2 = _mm_loadu_ps(&a->m[8]);
+        const __m128 col3 = _mm_loadu_ps(&a->m[12]);
+
+        for(int col = 0; col < 4; ++col)
+        {
+                const float* factors = &b->m[col * 4];
+
+                __m128 sum = _mm_mul_ps(col0, _mm_set1_ps(factors[0]));
+                sum = _mm_add_ps( sum, _mm_mul_ps(col1, _mm_set1_ps(factors[1])) );
+                sum = _mm_add_ps( sum, _mm_mul_ps(col2, _mm_set1_ps(factors[2])) );
+                sum = _mm_add_ps( sum, _mm_mul_ps(col3, _mm_set1_ps(factors[3])) );
+
+                _mm_storeu_ps(&result.m[col * 4], sum);
+        }
+#else
+        for(int col = 0; col < 4; ++col)
+        {
+                for(int row = 0; row < 4; ++row)
+                {
+                        result.m[(col * 4) + row] = (a->m[row] * b->m[col * 4]) +
+                                                    (a->m[4 + row] * b->m[(col * 4) + 1]) +
+                                                    (a->m[8 + row] * b->m[(col * 4) + 2]) +
+                                                    (a->m[12 + row] * b->m[(col * 4) + 3]);
+                }
+        }
+#endif
+
+        return result;
+}
+
+
+Vec4_t mnkt_mat4_mulVec4(const Mat4_t* a, const Vec4_t* v)
+{
+#ifdef MNKT_SIMD_SSE2
+        __m128 sum = _mm_mul_ps( _mm_loadu_ps(&a->m[0]), _mm_set1_ps(v->x) );
+        sum = _mm_add_ps( sum, _mm_mul_ps(_mm_loadu_ps(&a->m[4]), _mm_set1_ps(v->y)) );
+        sum = _mm_add_ps( sum, _mm_mul_ps(_mm_loadu_ps(&a->m[8]), _mm_set1_ps(v->z)) );
+        sum = _mm_add_ps( sum, _mm_mul_ps(_mm_loadu_ps(&a->m[12]), _mm_set1_ps(v->w)) );
+
+        Vec4_t result;
+        _mm_storeu_ps(&result.x, sum);
+        return result;
+#else
+        return (Vec4_t) {
+                .x = (a->m[0] * v->x) + (a->m[4] * v->y) + (a->m[8] * v->z) + (a->m[12] * v->w),
+                .y = (a->m[1] * v->x) + (a->m[5] * v->y) + (a->m[9] * v->z) + (a->m[13] * v->w),
+                .z = (a->m[2] * v->x) + (a->m[6] * v->y) + (a->m[10] * v->z) + (a->m[14] * v->w),
+                .w = (a->m[3] * v->x) + (a->m[7] * v->y) + (a->m[11] * v->z) + (a->m[15] * v->w)
+        };
+#endif
+}
+
+
+Mat4_t mnkt_mat4_transpose(const Mat4_t* a)
+{
+        Mat4_t result;
+
+        for(int col = 0; col < 4; ++col)
+        {
+                for(int row = 0; row < 4; ++row)
+                        result.m[(col * 4) + row] = a->m[(row * 4) + col];
+        }
+
+        return result;
+}
+
+
+/**
+ * @function mnkt_mat4_inverse
+ * Computes the inverse of a 4x4 matrix (cofactors expansion)
+ * @param a Matrix to be inverted
+ * @param result Where the inverse is stored (can be the same as a)
+ * @return One on success, zero if the matrix is singular (result is left untouched)
+*/
+int mnkt_mat4_inverse(const Mat4_t* a, Mat4_t* result)
+{
+        const float* m = a->m;
+        float inv[16];
+
+        inv[0] =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+        inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+        inv[8] =  m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+        inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+        inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+        inv[5] =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+        inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+        inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+        inv[2] =  m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+        inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+        inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+        inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+        inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+        inv[7] =  m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+        inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+        inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+        float det = (m[0] * inv[0]) + (m[1] * inv[4]) + (m[2] * inv[8]) + (m[3] * inv[12]);
+
+        if(det == 0.0f || !isfinite(det))
+                return 0;
+
+        float invDet = 1.0f / det;
+
+        for(int i = 0; i < 16; ++i)
+                result->m[i] = inv[i] * invDet;
+
+        return 1;
+}
+
+
+Mat4_t mnkt_mat4_translation(const Vec3_t* offset)
+{
+        Mat4_t result = mnkt_mat4_identity();
+
+        result.m[12] = offset->x;
+        result.m[13] = offset->y;
+        result.m[14] = offset->z;
+        return result;
+}
+
+
+Mat4_t mnkt_mat4_scale(const Vec3_t* factors)
+{
+        Mat4_t result = mnkt_mat4_identity();
+
+        result.m[0] = factors->x;
+        result.m[5] = factors->y;
+        result.m[10] = factors->z;
+        return result;
+}
+
+
+/**
+ * @function mnkt_mat4_lookAt
+ * Computes the view matrix of a camera placed in eye and looking at target
+ * @param eye Position of the camera
+ * @param target Point the camera looks at
+ * @param up Up direction of the camera (must not be parallel to the view direction)
+ * @return The view matrix (identity if eye and target coincide)
+*/
+Mat4_t mnkt_mat4_lookAt(const Vec3_t* eye, const Vec3_t* target, const Vec3_t* up)
+{
+        Vec3_t forward = { .x = target->x - eye->x, .y = target->y - eye->y, .z = target->z - eye->z };
+        float forwardLength = sqrtf( mnkt_vec3_dot(&forward, &forward) );
+
+        if(forwardLength == 0.0f)
+                return mnkt_mat4_identity();
+
+        forward = mnkt_vec3_div(&forward, forwardLength);
+
+        Vec3_t side = mnkt_vec3_cross(&forward, up);
+        float sideLength = sqrtf( mnkt_vec3_dot(&side, &side) );
+
+        if(sideLength == 0.0f)
+                return mnkt_mat4_identity();
+
+        side = mnkt_vec3_div(&side, sideLength);
+
+        Vec3_t cameraUp = mnkt_vec3_cross(&side, &forward);
+
+        return (Mat4_t) {
+                .m = {
+                        side.x, cameraUp.x, -forward.x, 0.0f,
+                        side.y, cameraUp.y, -forward.y, 0.0f,
+                        side.z, cameraUp.z, -forward.z, 0.0f,
+                        -mnkt_vec3_dot(&side, eye), -mnkt_vec3_dot(&cameraUp, eye), mnkt_vec3_dot(&forward, eye), 1.0f
+                }
+        };
+}
+
+
+/**
+ * @function mnkt_mat4_perspective
+ * Computes a perspective projection matrix
+ * @param fovY Vertical field of view expressed in radians
+ * @param aspect Ratio between the width and the height of the viewport
+ * @param nearPlane Distance of the near plane from the camera (must be greater than zero)
+ * @param farPlane Distance of the far plane from the camera
+ * @return The projection matrix
+*/
+Mat4_t mnkt_mat4_perspective(float fovY, float aspect, float nearPlane, float farPlane)
+{
+        const float f = 1.0f / tanf(fovY / 2.0f);
+        const float invDepth = 1.0f / (nearPlane - farPlane);
+
+        return (Mat4_t) {
+                .m = {
+                        f / aspect, 0.0f, 0.0f, 0.0f,
+                        0.0f, f, 0.0f, 0.0f,
+                        0.0f, 0.0f, (farPlane + nearPlane) * invDepth, -1.0f,
+                        0.0f, 0.0f, 2.0f * farPlane * nearPlane * invDepth, 0.0f
+                }
+        };
+}
+
+
+/**
+ * @function mnkt_mat4_ortho
+ * Computes an orthographic projection matrix
+ * @param left X coordinate, in view space, mapped on the left side of the viewport
+ * @param right X coordinate, in view space, mapped on the right side of the viewport
+ * @param bottom Y coordinate, in view space, mapped on the bottom side of the viewport
+ * @param top Y coordinate, in view space, mapped on the top side of the viewport
+ * @param nearPlane Distance of the near plane from the camera
+ * @param farPlane Distance of the far plane from the camera
+ * @return The projection matrix
+*/
+Mat4_t mnkt_mat4_ortho(float left, float right, float bottom, float top, float nearPlane, float farPlane)
+{
+        return (Mat4_t) {
+                .m = {
+                        2.0f / (right - left), 0.0f, 0.0f, 0.0f,
+                        0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
+                        0.0f, 0.0f, -2.0f / (farPlane - nearPlane), 0.0f,
+                        -(right + left) / (right - left), -(top + bottom) / (top - bottom), -(farPlane + nearPlane) / (farPlane - nearPlane), 1.0f
+                }
+        };
+}
+
+
+/**
+ * @function mnkt_mat4_transformPoints
+ * Transforms a stream of points stored as an array of structures (the w coordinate of each point is assumed to be one).
+ * Points are processed with SSE/AVX instructions when available.
+ * @param a The transformation matrix
+ * @param points Points to be transformed
+ * @param result Array in which the transformed points are stored (must not overlap with points)
+ * @param count Number of points
+*/
+void mnkt_mat4_transformPoints(const Mat4_t* a, const Vec3_t* points, Vec4_t* result, size_t count)
+{
+        size_t i = 0;
+
+#if defined(MNKT_SIMD_AVX)
+        // Two points for each 256 bits register, the columns of the matrix are repeated on both halves
+        const __m256 col0 = _mm256_broadcast_ps( (const __m128*) &a->m[0] );
+        const __m256 col1 = _mm256_broadcast_ps( (const __m128*) &a->m[4] );
+        const __m256 col2 = _mm256_broadcast_ps( (const __m128*) &a->m[8] );
+        const __m256 col3 = _mm256_broadcast_ps( (const __m128*) &a->m[12] );
+
+        for(; i + 2 <= count; i += 2)
+        {
+                const Vec3_t* p0 = &points[i];
+                const Vec3_t* p1 = &points[i + 1];
+
+                __m256 sum = _mm256_add_ps( col3, _mm256_mul_ps(col0, _mm256_setr_ps(p0->x, p0->x, p0->x, p0->x, p1->x, p1->x, p1->x, p1->x)) );
+                sum = _mm256_add_ps( sum, _mm256_mul_ps(col1, _mm256_setr_ps(p0->y, p0->y, p0->y, p0->y, p1->y, p1->y, p1->y, p1->y)) );
+                sum = _mm256_add_ps( sum, _mm256_mul_ps(col2, _mm256_setr_ps(p0->z, p0->z, p0->z, p0->z, p1->z, p1->z, p1->z, p1->z)) );
+
+                _mm256_storeu_ps(&result[i].x, sum);
+        }
+#endif
+
+#if defined(MNKT_SIMD_SSE2)
+        const __m128 col0SSE = _mm_loadu_ps(&a->m[0]);
+        const __m128 col1SSE = _mm_loadu_ps(&a->m[4]);
+        const __m128 col2SSE = _mm_loadu_ps(&a->m[8]);
+        const __m128 col3SSE = _mm_loadu_ps(&a->m[12]);
+
+        for(; i < count; ++i)
+        {
+                __m128 sum = _mm_add_ps( col3SSE, _mm_mul_ps(col0SSE, _mm_set1_ps(points[i].x)) );
+                sum = _mm_add_ps( sum, _mm_mul_ps(col1SSE, _mm_set1_ps(points[i].y)) );
+                sum = _mm_add_ps( sum, _mm_mul_ps(col2SSE, _mm_set1_ps(points[i].z)) );
+
+                _mm_storeu_ps(&result[i].x, sum);
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                Vec4_t point = { .x = points[i].x, .y = points[i].y, .z = points[i].z, .w = 1.0f };
+                result[i] = mnkt_mat4_mulVec4(a, &point);
+        }
+}
+
+
+/**
+ * @function mnkt_mat4_transformPointsSoA
+ * Transforms a stream of points stored as a structure of arrays (the w coordinate of each point is assumed to be one).
+ * Points are processed four (SSE) or eight (AVX) at a time when available.
+ * @param a The transformation matrix
+ * @param x X coordinates of the points
+ * @param y Y coordinates of the points
+ * @param z Z coordinates of the points
+ * @param count Number of points
+ * @param resultX Array in which the x coordinates of the transformed points are stored
+ * @param resultY Array in which the y coordinates of the transformed points are stored
+ * @param resultZ Array in which the z coordinates of the transformed points are stored
+ * @param resultW Array in which the w coordinates of the transformed points are stored
+*/
+void mnkt_mat4_transformPointsSoA(const Mat4_t* a, const float* x, const float* y, const float* z, size_t count,
+                                  float* resultX, float* resultY, float* resultZ, float* resultW)
+{
+        float* results[4] = { resultX, resultY, resultZ, resultW };
+        size_t i = 0;
+
+#if defined(MNKT_SIMD_AVX)
+        for(; i + 8 <= count; i += 8)
+        {
+                const __m256 px = _mm256_loadu_ps(&x[i]);
+                const __m256 py = _mm256_loadu_ps(&y[i]);
+                const __m256 pz = _mm256_loadu_ps(&z[i]);
+
+                // Each output coordinate is the dot product between a row of the matrix and the points
+                for(int row = 0; row < 4; ++row)
+                {
+                        __m256 sum = _mm256_add_ps( _mm256_set1_ps(a->m[12 + row]), _mm256_mul_ps(px, _mm256_set1_ps(a->m[row])) );
+                        sum = _mm256_add_ps( sum, _mm256_mul_ps(py, _mm256_set1_ps(a->m[4 + row])) );
+                        sum = _mm256_add_ps( sum, _mm256_mul_ps(pz, _mm256_set1_ps(a->m[8 + row])) );
+
+                        _mm256_storeu_ps(&results[row][i], sum);
+                }
+        }
+#endif
+
+#if defined(MNKT_SIMD_SSE2)
+        for(; i + 4 <= count; i += 4)
+        {
+                const __m128 px = _mm_loadu_ps(&x[i]);
+                const __m128 py = _mm_loadu_ps(&y[i]);
+                const __m128 pz = _mm_loadu_ps(&z[i]);
+
+                for(int row = 0; row < 4; ++row)
+                {
+                        __m128 sum = _mm_add_ps( _mm_set1_ps(a->m[12 + row]), _mm_mul_ps(px, _mm_set1_ps(a->m[row])) );
+                        sum = _mm_add_ps( sum, _mm_mul_ps(py, _mm_set1_ps(a->m[4 + row])) );
+                        sum = _mm_add_ps( sum, _mm_mul_ps(pz, _mm_set1_ps(a->m[8 + row])) );
+
+                        _mm_storeu_ps(&results[row][i], sum);
+                }
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                for(int row = 0; row < 4; ++row)
+                        results[row][i] = a->m[12 + row] + (a->m[row] * x[i]) + (a->m[4 + row] * y[i]) + (a->m[8 + row] * z[i]);
+        }
+}
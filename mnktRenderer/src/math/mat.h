@@ -0,0 +1,94 @@
+
+/**
+ * @file mat.h
+ *
+ * Defines basic structures which models 3x3 and 4x4 matrices
+ * and functions to operate on them.
+ *
+ * Matrices are stored in column major order (element at row r and column c is m[c * size + r])
+ * and follow the conventions of the pipeline: right handed view space looking down the negative z axis,
+ * normalized device coordinates in the range [-1, 1] on all the axes.
+ *
+ * @warning Functions that operates on matrices takes them as pointers to avoid copies,
+ * no check is made on the validity of such pointers!!!
+*/
+
+
+#ifndef MNKT_MAT_H
+#define MNKT_MAT_H
+
+#include <stddef.h>
+
+#include "vec.h"
+
+
+/**
+ * @struct Mat3_t
+ * Models a 3x3 matrix of floating point values (column major)
+*/
+typedef struct {
+        float   m[9];
+} Mat3_t;
+
+
+/**
+ * @struct Mat4_t
+ * Models a 4x4 matrix of floating point values (column major)
+*/
+typedef struct {
+        float   m[16];
+} Mat4_t;
+
+
+Mat3_t  mnkt_mat3_identity(void);
+Mat3_t  mnkt_mat3_fromMat4(const Mat4_t* a);
+Mat3_t  mnkt_mat3_mul(const Mat3_t* a, const Mat3_t* b);
+Vec3_t  mnkt_mat3_mulVec3(const Mat3_t* a, const Vec3_t* v);
+Mat3_t  mnkt_mat3_transpose(const Mat3_t* a);
+int     mnkt_mat3_inverse(const Mat3_t* a, Mat3_t* result);
+int     mnkt_mat3_normalMatrix(const Mat4_t* modelView, Mat3_t* result);
+
+Mat4_t  mnkt_mat4_identity(void);
+Mat4_t  mnkt_mat4_mul(const Mat4_t* a, const Mat4_t* b);
+Vec4_t  mnkt_mat4_mulVec4(const Mat4_t* a, const Vec4_t* v);
+Mat4_t  mnkt_mat4_transpose(const Mat4_t* a);
+int     mnkt_mat4_inverse(const Mat4_t* a, Mat4_t* result);
+
+Mat4_t  mnkt_mat4_translation(const Vec3_t* offset);
+Mat4_t  mnkt_mat4_scale(const Vec3_t* factors);
+Mat4_t  mnkt_mat4_lookAt(const Vec3_t* eye, const Vec3_t* target, const Vec3_t* up);
+Mat4_t  mnkt_mat4_perspective(float fovY, float aspect, float nearPlane, float farPlane);
+Mat4_t  mnkt_mat4_ortho(float left, float right, float bottom, float top, float nearPlane, float farPlane);
+
+
+/**
+ * @function mnkt_mat4_transformPoints
+ * Transforms a stream of points stored as an array of structures (the w coordinate of each point is assumed to be one).
+ * Points are processed with SSE/AVX instructions when available.
+ * @param a The transformation matrix
+ * @param points Points to be transformed
+ * @param result Array in which the transformed points are stored (must not overlap with points)
+ * @param count Number of points
+*/
+void    mnkt_mat4_transformPoints(const Mat4_t* a, const Vec3_t* points, Vec4_t* result, size_t count);
+
+
+/**
+ * @function mnkt_mat4_transformPointsSoA
+ * Transforms a stream of points stored as a structure of arrays (the w coordinate of each point is assumed to be one).
+ * Points are processed four (SSE) or eight (AVX) at a time when available.
+ * @param a The transformation matrix
+ * @param x X coordinates of the points
+ * @param y Y coordinates of the points
+ * @param z Z coordinates of the points
+ * @param count Number of points
+ * @param resultX Array in which the x coordinates of the transformed points are stored
+ * @param resultY Array in which the y coordinates of the transformed points are stored
+ * @param resultZ Array in which the z coordinates of the transformed points are stored
+ * @param resultW Array in which the w coordinates of the transformed points are stored
+*/
+void    mnkt_mat4_transformPointsSoA(const Mat4_t* a, const float* x, const float* y, const float* z, size_t count,
+                                     float* resultX, float* resultY, float* resultZ, float* resultW);
+
+
+#endif // MNKT_MAT_H
@@ -3,6 +3,7 @@
  * @file mathUtils.h
  *
  * Contains definition of common math and geometrical utility functions
+ * (defined in this header to be inlined in every translation unit)
 */
 
 #ifndef MNKT_MATH_UTILS_H
@@ -11,6 +12,8 @@
 #include <stddef.h>
 #include <math.h>
 
+#include "../utility/inline.h"
+
 
 /**
  * @function mnkt_math_clamp
@@ -22,7 +25,13 @@
  * min, if value is smaller than min.
  * max, if value is greater than max.
 */
-float   mnkt_math_clamp(float value, float min, float max);
+static MNKT_FORCEINLINE float mnkt_math_clamp(float value, float min, float max)
+{
+        if(value < min)
+                return min;
+
+        return value > max ? max : value;
+}
 
 
 /**
@@ -33,7 +42,14 @@ float   mnkt_math_clamp(float value, float min, float max);
  * @param t Interpolation parameter
  * @return The linear interpolation between a and b at the t value, if t is in range [0, 1], a otherwise
 */
-float   mnkt_math_lerp(float a, float b, float t);
+static MNKT_FORCEINLINE float mnkt_math_lerp(float a, float b, float t)
+{
+        // Check validity of t
+        if( !isfinite(t) )
+                return a;
+
+        return a + t * (b - a);
+}
 
 
 /**
@@ -47,7 +63,16 @@ float   mnkt_math_lerp(float a, float b, float t);
  * @param maxRectY Y coordinate of the rectangle's bottom right corner
  * @return One if the point is inside the specified rectangle or on its border, zero if it is outside
 */
-int     mnkt_math_pointIntersectRect(float x, float y, float minRectX, float minRectY, float maxRectX, float maxRectY);
+static MNKT_FORCEINLINE int mnkt_math_pointIntersectRect(float x, float y, float minRectX, float minRectY, float maxRectX, float maxRectY)
+{
+        if(x < minRectX || x > maxRectX)
+                return 0;
+
+        if(y < minRectY || y > maxRectY)
+                return 0;
+
+        return 1;
+}
 
 
 #endif // MNKT_MATH_UTILS_H
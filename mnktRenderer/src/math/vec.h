@@ -5,6 +5,9 @@
  * Defines basic structures which models mathemathical vectors
  * and functions to operate on them.
  *
+ * Functions are defined in this header (forcibly inlined) so that they can be inlined in the per pixel loops
+ * of every translation unit, Vec4_t operations use SSE instructions when available.
+ *
  * @warning Functions that operates on vectors takes them as pointers to avoid copies,
  * no check is made on the validity of such pointers!!!
 */
@@ -13,6 +16,10 @@
 #ifndef MNKT_VEC_H
 #define MNKT_VEC_H
 
+#include "mathUtils.h"
+#include "../utility/inline.h"
+#include "../utility/simd.h"
+
 
 /**
  * @struct Vec2_t
@@ -77,30 +84,269 @@ typedef struct {
 } Vec4_t;
 
 
-Vec2_t  mnkt_vec2_add(const Vec2_t* a, const Vec2_t* b);
-Vec2_t  mnkt_vec2_sub(const Vec2_t* a, const Vec2_t* b);
-Vec2_t  mnkt_vec2_mul(const Vec2_t* a, const float scalar);
-Vec2_t  mnkt_vec2_div(const Vec2_t* a, const float scalar);
-float   mnkt_vec2_dot(const Vec2_t* a, const Vec2_t* b);
-Vec2_t  mnkt_vec2_clamp(const Vec2_t* a, const Vec2_t min, const Vec2_t max);
-Vec2_t  mnkt_vec2_lerp(const Vec2_t* a, const Vec2_t* b, float t);
-
-Vec3_t  mnkt_vec3_add(const Vec3_t* a, const Vec3_t* b);
-Vec3_t  mnkt_vec3_sub(const Vec3_t* a, const Vec3_t* b);
-Vec3_t  mnkt_vec3_mul(const Vec3_t* a, const float scalar);
-Vec3_t  mnkt_vec3_div(const Vec3_t* a, const float scalar);
-float   mnkt_vec3_dot(const Vec3_t* a, const Vec3_t* b);
-Vec3_t  mnkt_vec3_cross(const Vec3_t* a, const Vec3_t* b);
-Vec3_t  mnkt_vec3_clamp(const Vec3_t* a, const Vec3_t min, const Vec3_t max);
-Vec3_t  mnkt_vec3_lerp(const Vec3_t* a, const Vec3_t* b, float t);
-
-Vec4_t  mnkt_vec4_add(const Vec4_t* a, const Vec4_t* b);
-Vec4_t  mnkt_vec4_sub(const Vec4_t* a, const Vec4_t* b);
-Vec4_t  mnkt_vec4_mul(const Vec4_t* a, const float scalar);
-Vec4_t  mnkt_vec4_div(const Vec4_t* a, const float scalar);
-float   mnkt_vec4_dot(const Vec4_t* a, const Vec4_t* b);
-Vec4_t  mnkt_vec4_clamp(const Vec4_t* a, const Vec4_t min, const Vec4_t max);
-Vec4_t  mnkt_vec4_lerp(const Vec4_t* a, const Vec4_t* b, float t);
+static MNKT_FORCEINLINE Vec2_t mnkt_vec2_add(const Vec2_t* a, const Vec2_t* b)
+{
+        return (Vec2_t)
+        {
+                .x = a->x + b->x,
+                .y = a->y + b->y
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec2_t mnkt_vec2_sub(const Vec2_t* a, const Vec2_t* b)
+{
+        return (Vec2_t)
+        {
+                .x = a->x - b->x,
+                .y = a->y - b->y
+        };
+}
+
+static MNKT_FORCEINLINE Vec2_t mnkt_vec2_mul(const Vec2_t* a, const float scalar)
+{
+        return (Vec2_t)
+        {
+                .x = a->x * scalar,
+                .y = a->y * scalar
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec2_t mnkt_vec2_div(const Vec2_t* a, const float scalar)
+{
+        return (Vec2_t)
+        {
+                .x = a->x / scalar,
+                .y = a->y / scalar
+        };
+}
+
+
+static MNKT_FORCEINLINE float mnkt_vec2_dot(const Vec2_t* a, const Vec2_t* b)
+{
+        return (a->x * b->x) + (a->y * b->y);
+}
+
+
+static MNKT_FORCEINLINE Vec2_t mnkt_vec2_clamp(const Vec2_t* a, const Vec2_t min, const Vec2_t max)
+{
+        return (Vec2_t) {
+                .x = mnkt_math_clamp(a->x, min.x, max.x),
+                .y = mnkt_math_clamp(a->y, min.y, max.y)
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec2_t mnkt_vec2_lerp(const Vec2_t* a, const Vec2_t* b, float t)
+{
+        return (Vec2_t) {
+                .x = mnkt_math_lerp(a->x, b->x, t),
+                .y = mnkt_math_lerp(a->y, b->y, t)
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_add(const Vec3_t* a, const Vec3_t* b)
+{
+        return (Vec3_t)
+        {
+                .x = a->x + b->x,
+                .y = a->y + b->y,
+                .z = a->z + b->z
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_sub(const Vec3_t* a, const Vec3_t* b)
+{
+        return (Vec3_t)
+        {
+                .x = a->x + b->x,
+                .y = a->y + b->y,
+                .z = a->z + b->z
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_mul(const Vec3_t* a, const float scalar)
+{
+        return (Vec3_t)
+        {
+                .x = a->x * scalar,
+                .y = a->y * scalar,
+                .z = a->z * scalar
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_div(const Vec3_t* a, const float scalar)
+{
+        return (Vec3_t)
+        {
+                .x = a->x / scalar,
+                .y = a->y / scalar,
+                .z = a->z / scalar
+        };
+}
+
+
+static MNKT_FORCEINLINE float mnkt_vec3_dot(const Vec3_t* a, const Vec3_t* b)
+{
+        return (a->x * b->x) + (a->y * b->y) + (a->z * b->z);
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_cross(const Vec3_t* a, const Vec3_t* b)
+{
+        return (Vec3_t)
+        {
+                .x = (a->y * b->z) - (a->z * b->y),
+                .y = (a->z * b->x) - (a->x * b->z),
+                .z = (a->x * b->y) - (a->y * b->x),
+        };
+
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_clamp(const Vec3_t* a, const Vec3_t min, const Vec3_t max)
+{
+        return (Vec3_t) {
+                .x = mnkt_math_clamp(a->x, min.x, max.x),
+                .y = mnkt_math_clamp(a->y, min.y, max.y),
+                .z = mnkt_math_clamp(a->z, min.z, max.z)
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec3_t mnkt_vec3_lerp(const Vec3_t* a, const Vec3_t* b, float t)
+{
+        return (Vec3_t) {
+                .x = mnkt_math_lerp(a->x, b->x, t),
+                .y = mnkt_math_lerp(a->y, b->y, t),
+                .z = mnkt_math_lerp(a->z, b->z, t)
+        };
+}
+
+
+static MNKT_FORCEINLINE Vec4_t mnkt_vec4_add(const Vec4_t* a, const Vec4_t* b)
+{
+#ifdef MNKT_SIMD_SSE2
+        Vec4_t result;
+        _mm_storeu_ps( &result.x, _mm_add_ps(_mm_loadu_ps(&a->x), _mm_loadu_ps(&b->x)) );
+        return result;
+#else
+        return (Vec4_t)
+        {
+                .x = a->x + b->x,
+                .y = a->y + b->y,
+                .z = a->z + b->z,
+                .w = a->w + b->w
+        };
+#endif
+}
+
+
+static MNKT_FORCEINLINE Vec4_t mnkt_vec4_sub(const Vec4_t* a, const Vec4_t* b)
+{
+#ifdef MNKT_SIMD_SSE2
+        Vec4_t result;
+        _mm_storeu_ps( &result.x, _mm_sub_ps(_mm_loadu_ps(&a->x), _mm_loadu_ps(&b->x)) );
+        return result;
+#else
+        return (Vec4_t)
+        {
+                .x = a->x - b->x,
+                .y = a->y - b->y,
+                .z = a->z - b->z,
+                .w = a->w - b->w
+        };
+#endif
+}
+
+
+static MNKT_FORCEINLINE Vec4_t mnkt_vec4_mul(const Vec4_t* a, const float scalar)
+{
+#ifdef MNKT_SIMD_SSE2
+        Vec4_t result;
+        _mm_storeu_ps( &result.x, _mm_mul_ps(_mm_loadu_ps(&a->x), _mm_set1_ps(scalar)) );
+        return result;
+#else
+        return (Vec4_t)
+        {
+                .x = a->x * scalar,
+                .y = a->y * scalar,
+                .z = a->z * scalar,
+                .w = a->w * scalar
+        };
+#endif
+}
+
+
+static MNKT_FORCEINLINE Vec4_t mnkt_vec4_div(const Vec4_t* a, const float scalar)
+{
+#ifdef MNKT_SIMD_SSE2
+        Vec4_t result;
+        _mm_storeu_ps( &result.x, _mm_div_ps(_mm_loadu_ps(&a->x), _mm_set1_ps(scalar)) );
+        return result;
+#else
+        return (Vec4_t)
+        {
+                .x = a->x / scalar,
+                .y = a->y / scalar,
+                .z = a->z / scalar,
+                .w = a->w / scalar
+        };
+#endif
+}
+
+
+static MNKT_FORCEINLINE float mnkt_vec4_dot(const Vec4_t* a, const Vec4_t* b)
+{
+        return (a->x * b->x) + (a->y * b->y) + (a->z * b->z) + (a->w * b->w);
+}
+
+
+static MNKT_FORCEINLINE Vec4_t mnkt_vec4_clamp(const Vec4_t* a, const Vec4_t min, const Vec4_t max)
+{
+#ifdef MNKT_SIMD_SSE2
+        // Operands order keeps the NaN behaviour of mnkt_math_clamp (NaN components are returned unchanged)
+        Vec4_t result;
+        __m128 value = _mm_max_ps( _mm_loadu_ps(&min.x), _mm_loadu_ps(&a->x) );
+        _mm_storeu_ps( &result.x, _mm_min_ps(_mm_loadu_ps(&max.x), value) );
+        return result;
+#else
+        return (Vec4_t) {
+                .x = mnkt_math_clamp(a->x, min.x, max.x),
+                .y = mnkt_math_clamp(a->y, min.y, max.y),
+                .z = mnkt_math_clamp(a->z, min.z, max.z),
+                .w = mnkt_math_clamp(a->w, min.w, max.w)
+        };
+#endif
+}
+
+
+static MNKT_FORCEINLINE Vec4_t mnkt_vec4_lerp(const Vec4_t* a, const Vec4_t* b, float t)
+{
+#ifdef MNKT_SIMD_SSE2
+        // Check validity of t (same as mnkt_math_lerp)
+        if( !isfinite(t) )
+                return *a;
+
+        Vec4_t result;
+        __m128 va = _mm_loadu_ps(&a->x);
+        __m128 diff = _mm_sub_ps( _mm_loadu_ps(&b->x), va );
+        _mm_storeu_ps( &result.x, _mm_add_ps(va, _mm_mul_ps(_mm_set1_ps(t), diff)) );
+        return result;
+#else
+        return (Vec4_t) {
+                .x = mnkt_math_lerp(a->x, b->x, t),
+                .y = mnkt_math_lerp(a->y, b->y, t),
+                .z = mnkt_math_lerp(a->z, b->z, t),
+                .w = mnkt_math_lerp(a->w, b->w, t)
+        };
+#endif
+}
 
 
 #endif // MNKT_VEC_H
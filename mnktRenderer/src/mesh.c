@@ -0,0 +1,1490 @@
+
+/**
+ * @file mesh.c
+ *
+ * Contains implementation of the meshes API
+*/
+
+#include "mesh.h"
+
+#include "math/vec.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+        #define MNKT_MESH_MMAP_WIN32
+        #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+        #define MNKT_MESH_MMAP_POSIX
+        #include <sys/mman.h>
+        #include <fcntl.h>
+        #include <unistd.h>
+#endif
+
+
+/**
+ * @macro MNKT_MESH_CACHE_VERSION
+ * Version of the layout of the cache files, caches with a different version are rejected
+*/
+#define MNKT_MESH_CACHE_VERSION         1
+
+/**
+ * @macro MNKT_MESH_CACHE_BYTE_ORDER
+ * Value stored in the cache files to detect if they were written on a machine with a different endianness
+*/
+#define MNKT_MESH_CACHE_BYTE_ORDER      0x01020304u
+
+/**
+ * @macro MNKT_MESH_CACHE_ALIGNMENT
+ * Alignment, in bytes, of the vertices and indices inside the cache files
+*/
+#define MNKT_MESH_CACHE_ALIGNMENT       64
+
+/**
+ * @macro MNKT_PLY_MAX_ELEMENTS
+ * Maximum number of elements that can be declared in the header of a PLY file
+*/
+#define MNKT_PLY_MAX_ELEMENTS           16
+
+/**
+ * @macro MNKT_PLY_MAX_PROPERTIES
+ * Maximum number of properties that can be declared for an element of a PLY file
+*/
+#define MNKT_PLY_MAX_PROPERTIES         32
+
+
+// Magic string at the start of the cache files
+static const char MNKT_MESH_CACHE_MAGIC[8] = { 'M', 'N', 'K', 'T', 'M', 'E', 'S', 'H' };
+
+
+/**
+ * @struct MeshCacheHeader_t
+ * Header at the start of the cache files, vertices and indices follow at the given offsets
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        char            magic[8];               ///< Always MNKT_MESH_CACHE_MAGIC
+        uint32_t        version;                ///< Always MNKT_MESH_CACHE_VERSION
+        uint32_t        byteOrder;              ///< MNKT_MESH_CACHE_BYTE_ORDER as written by the machine that created the cache
+        uint32_t        attributes;             ///< Attributes stored in each vertex
+        uint32_t        vertexSize;             ///< Size in bytes of a vertex
+        uint32_t        verticesCount;          ///< Number of vertices
+        uint32_t        indicesCount;           ///< Number of indices
+        uint64_t        verticesOffset;         ///< Offset in bytes of the vertices from the start of the file
+        uint64_t        indicesOffset;          ///< Offset in bytes of the indices from the start of the file
+} MeshCacheHeader_t;
+
+
+/**
+ * @struct MeshBuffer_t
+ * Growable array of bytes used while importing meshes
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        unsigned char*  data;                   ///< Content of the buffer
+        size_t          size;                   ///< Number of bytes in use
+        size_t          capacity;               ///< Number of bytes allocated
+} MeshBuffer_t;
+
+
+/**
+ * @struct ObjVertex_t
+ * Entry of the hash table that maps the combinations of position, texture coordinates and normal of an OBJ file to the vertices of the mesh
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        int64_t         position;               ///< Index of the position
+        int64_t         texcoord;               ///< Index of the texture coordinates (-1 if missing)
+        int64_t         normal;                 ///< Index of the normal (-1 if missing)
+        uint32_t        vertex;                 ///< Index of the vertex of the mesh (UINT32_MAX if the entry is empty)
+} ObjVertex_t;
+
+
+/**
+ * @enum PlyType_t
+ * Types of the properties of a PLY file
+ * @note: For internal usage only!!!
+*/
+typedef enum {
+        MNKT_PLY_INT8, MNKT_PLY_UINT8, MNKT_PLY_INT16, MNKT_PLY_UINT16,
+        MNKT_PLY_INT32, MNKT_PLY_UINT32, MNKT_PLY_FLOAT32, MNKT_PLY_FLOAT64,
+        MNKT_PLY_INVALID
+} PlyType_t;
+
+
+/**
+ * @enum PlyFormat_t
+ * Formats in which the data of a PLY file can be stored
+ * @note: For internal usage only!!!
+*/
+typedef enum {
+        MNKT_PLY_ASCII,
+        MNKT_PLY_BINARY_LE,
+        MNKT_PLY_BINARY_BE
+} PlyFormat_t;
+
+
+/**
+ * @struct PlyProperty_t
+ * Property of an element of a PLY file
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        char            name[32];               ///< Name of the property
+        PlyType_t       type;                   ///< Type of the value (of the items if the property is a list)
+        PlyType_t       countType;              ///< Type of the items count if the property is a list, MNKT_PLY_INVALID otherwise
+} PlyProperty_t;
+
+
+/**
+ * @struct PlyElement_t
+ * Element declared in the header of a PLY file
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        char            name[32];                               ///< Name of the element
+        size_t          count;                                  ///< Number of instances of the element stored in the file
+        PlyProperty_t   properties[MNKT_PLY_MAX_PROPERTIES];    ///< Properties of each instance
+        uint32_t        propertiesCount;                        ///< Number of properties
+} PlyElement_t;
+
+
+/**
+ * @struct PlyReader_t
+ * State of the reader of the data of a PLY file
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        const char*     cursor;                 ///< Next byte to be read
+        const char*     end;                    ///< End of the file
+        PlyFormat_t     format;                 ///< Format of the data
+} PlyReader_t;
+
+
+// Prototypes for internal functions
+
+static char*    mnkt_mesh_readFile(const char* path, size_t* size);
+static int      mnkt_mesh_push(MeshBuffer_t* buffer, const void* data, size_t size);
+static void     mnkt_mesh_writeVertex(unsigned char* vertex, uint32_t attributes, const float* position, const float* normal, const float* texcoord, const float* color);
+static int      mnkt_mesh_build(Mesh_t* mesh, uint32_t attributes, MeshBuffer_t* vertices, MeshBuffer_t* indices, int hasNormals);
+static void     mnkt_mesh_computeNormals(Mesh_t* mesh);
+static int      mnkt_mesh_pushPolygon(MeshBuffer_t* indices, const uint32_t* polygon, size_t cornersCount);
+
+static const char*      mnkt_obj_skipSpaces(const char* cursor);
+static size_t           mnkt_obj_parseFloats(const char** cursor, float* values, size_t maxCount);
+static int              mnkt_obj_resolveIndex(long index, size_t count, int64_t* result);
+static int              mnkt_obj_findVertex(ObjVertex_t** table, size_t* capacity, size_t* count, const ObjVertex_t* key, uint32_t* vertex);
+
+static int              mnkt_ply_parseHeader(const char* data, size_t size, PlyElement_t* elements, uint32_t* elementsCount, PlyReader_t* reader);
+static PlyType_t        mnkt_ply_typeFromName(const char* name);
+static int              mnkt_ply_readValue(PlyReader_t* reader, PlyType_t type, double* value);
+static float            mnkt_ply_normalizeColor(double value, PlyType_t type);
+
+static void*    mnkt_mesh_mapFile(const char* path, size_t* size);
+static void     mnkt_mesh_unmapFile(void* data, size_t size);
+static char*    mnkt_mesh_appendToPath(const char* path, const char* suffix);
+static int      mnkt_mesh_replaceFile(const char* source, const char* destination);
+
+
+/**
+ * @function mnkt_mesh_vertexSize
+ * Computes the size of a vertex that stores the given attributes
+ * @param attributes Attributes stored in the vertex (combination of MeshAttribute_t)
+ * @return Size in bytes of the vertex
+*/
+uint32_t mnkt_mesh_vertexSize(uint32_t attributes)
+{
+        uint32_t size = 3 * sizeof(float);
+
+        if(attributes & MNKT_MESH_NORMAL)
+                size += 3 * sizeof(float);
+
+        if(attributes & MNKT_MESH_TEXCOORD)
+                size += 2 * sizeof(float);
+
+        if(attributes & MNKT_MESH_COLOR)
+                size += 4 * sizeof(float);
+
+        return size;
+}
+
+
+/**
+ * @function mnkt_mesh_attributeOffset
+ * Computes the offset of an attribute inside a vertex
+ * @param attributes Attributes stored in the vertex (combination of MeshAttribute_t)
+ * @param attribute The attribute whose offset is computed (zero to get the offset of the position)
+ * @return Offset in bytes of the attribute from the start of the vertex
+*/
+uint32_t mnkt_mesh_attributeOffset(uint32_t attributes, MeshAttribute_t attribute)
+{
+        if(attribute == 0)
+                return 0;
+
+        // Attributes are stored in the order of their flags, so the position and the attributes with a lower flag precede the requested one
+        return mnkt_mesh_vertexSize( attributes & ((uint32_t) attribute - 1) );
+}
+
+
+/**
+ * @function mnkt_mesh_loadOBJ
+ * Imports a mesh from a Wavefront OBJ file, polygons are split into triangles and
+ * identical combinations of position, texture coordinates and normal share the same vertex
+ * @param path Path of the file
+ * @param attributes Attributes to be stored in each vertex (combination of MeshAttribute_t)
+ * @param mesh Where the imported mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_loadOBJ(const char* path, uint32_t attributes, Mesh_t* mesh)
+{
+        if(path == NULL || mesh == NULL)
+                return 1;
+
+        memset(mesh, 0, sizeof(Mesh_t));
+
+        size_t fileSize;
+        char* text = mnkt_mesh_readFile(path, &fileSize);
+
+        if(text == NULL)
+                return 1;
+
+        // Positions are stored along with their color (white if not specified)
+        MeshBuffer_t positions = { 0 };
+        MeshBuffer_t texcoords = { 0 };
+        MeshBuffer_t normals = { 0 };
+        MeshBuffer_t vertices = { 0 };
+        MeshBuffer_t indices = { 0 };
+        MeshBuffer_t polygon = { 0 };
+
+        ObjVertex_t* table = NULL;
+        size_t tableCapacity = 0;
+        size_t tableCount = 0;
+
+        const uint32_t vertexSize = mnkt_mesh_vertexSize(attributes);
+        unsigned char* vertex = malloc(vertexSize);
+        int hasNormals = 1;
+        int error = (vertex == NULL);
+
+        const char* cursor = text;
+
+        while(!error && *cursor != '\0')
+        {
+                cursor = mnkt_obj_skipSpaces(cursor);
+
+                if(cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
+                {
+                        float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+
+                        cursor += 1;
+                        error = mnkt_obj_parseFloats(&cursor, values, 6) < 3 || mnkt_mesh_push(&positions, values, sizeof(values));
+                }
+                else if(cursor[0] == 'v' && cursor[1] == 't' && (cursor[2] == ' ' || cursor[2] == '\t'))
+                {
+                        float values[2] = { 0.0f, 0.0f };
+
+                        cursor += 2;
+                        error = mnkt_obj_parseFloats(&cursor, values, 2) < 1 || mnkt_mesh_push(&texcoords, values, sizeof(values));
+                }
+                else if(cursor[0] == 'v' && cursor[1] == 'n' && (cursor[2] == ' ' || cursor[2] == '\t'))
+                {
+                        float values[3] = { 0.0f, 0.0f, 0.0f };
+
+                        cursor += 2;
+                        error = mnkt_obj_parseFloats(&cursor, values, 3) < 3 || mnkt_mesh_push(&normals, values, sizeof(values));
+                }
+                else if(cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+                {
+                        const size_t positionsCount = positions.size / (6 * sizeof(float));
+                        const size_t texcoordsCount = texcoords.size / (2 * sizeof(float));
+                        const size_t normalsCount = normals.size / (3 * sizeof(float));
+
+                        polygon.size = 0;
+                        cursor = mnkt_obj_skipSpaces(cursor + 1);
+
+                        // Each corner is in the form position[/[texcoord][/normal]]
+                        while(!error && *cursor != '\n' && *cursor != '\r' && *cursor != '\0' && *cursor != '#')
+                        {
+                                ObjVertex_t key = { .position = -1, .texcoord = -1, .normal = -1 };
+                                char* end;
+
+                                error = mnkt_obj_resolveIndex(strtol(cursor, &end, 10), positionsCount, &key.position) || end == cursor;
+                                cursor = end;
+
+                                if(!error && *cursor == '/')
+                                {
+                                        ++cursor;
+
+                                        if(*cursor != '/')
+                                        {
+                                                error = mnkt_obj_resolveIndex(strtol(cursor, &end, 10), texcoordsCount, &key.texcoord) || end == cursor;
+                                                cursor = end;
+                                        }
+
+                                        if(!error && *cursor == '/')
+                                        {
+                                                ++cursor;
+                                                error = mnkt_obj_resolveIndex(strtol(cursor, &end, 10), normalsCount, &key.normal) || end == cursor;
+                                                cursor = end;
+                                        }
+                                }
+
+                                uint32_t vertexIndex = 0;
+
+                                if(!error)
+                                        error = mnkt_obj_findVertex(&table, &tableCapacity, &tableCount, &key, &vertexIndex);
+
+                                // A new vertex must be created for this combination of attributes
+                                if(!error && vertexIndex == vertices.size / vertexSize)
+                                {
+                                        const float* position = (const float*) positions.data + (key.position * 6);
+                                        const float* texcoord = key.texcoord >= 0 ? (const float*) texcoords.data + (key.texcoord * 2) : NULL;
+                                        const float* normal = key.normal >= 0 ? (const float*) normals.data + (key.normal * 3) : NULL;
+                                        const float color[4] = { position[3], position[4], position[5], 1.0f };
+
+                                        hasNormals &= (normal != NULL);
+
+                                        mnkt_mesh_writeVertex(vertex, attributes, position, normal, texcoord, color);
+                                        error = mnkt_mesh_push(&vertices, vertex, vertexSize);
+                                }
+
+                                if(!error)
+                                        error = mnkt_mesh_push(&polygon, &vertexIndex, sizeof(uint32_t));
+
+                                cursor = mnkt_obj_skipSpaces(cursor);
+                        }
+
+                        if(!error)
+                                error = mnkt_mesh_pushPolygon(&indices, (const uint32_t*) polygon.data, polygon.size / sizeof(uint32_t));
+                }
+
+                // Go to the next line
+                while(*cursor != '\n' && *cursor != '\0')
+                        ++cursor;
+
+                if(*cursor == '\n')
+                        ++cursor;
+        }
+
+        if(!error)
+                error = mnkt_mesh_build(mesh, attributes, &vertices, &indices, hasNormals);
+
+        if(error)
+        {
+                free(vertices.data);
+                free(indices.data);
+        }
+
+        free(vertex);
+        free(table);
+        free(polygon.data);
+        free(normals.data);
+        free(texcoords.data);
+        free(positions.data);
+        free(text);
+
+        return error;
+}
+
+
+/**
+ * @function mnkt_mesh_loadPLY
+ * Imports a mesh from a PLY file (ascii, binary little endian or binary big endian), polygons are split into triangles
+ * @param path Path of the file
+ * @param attributes Attributes to be stored in each vertex (combination of MeshAttribute_t)
+ * @param mesh Where the imported mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_loadPLY(const char* path, uint32_t attributes, Mesh_t* mesh)
+{
+        if(path == NULL || mesh == NULL)
+                return 1;
+
+        memset(mesh, 0, sizeof(Mesh_t));
+
+        size_t fileSize;
+        char* data = mnkt_mesh_readFile(path, &fileSize);
+
+        if(data == NULL)
+                return 1;
+
+        PlyElement_t* elements = malloc(sizeof(PlyElement_t) * MNKT_PLY_MAX_ELEMENTS);
+        uint32_t elementsCount = 0;
+        PlyReader_t reader;
+
+        MeshBuffer_t vertices = { 0 };
+        MeshBuffer_t indices = { 0 };
+        MeshBuffer_t polygon = { 0 };
+
+        const uint32_t vertexSize = mnkt_mesh_vertexSize(attributes);
+        unsigned char* vertex = malloc(vertexSize);
+        size_t verticesCount = 0;
+        int hasNormals = 0;
+
+        int error = (elements == NULL || vertex == NULL);
+
+        if(!error)
+                error = mnkt_ply_parseHeader(data, fileSize, elements, &elementsCount, &reader);
+
+        // Elements are stored one after the other in the order of declaration
+        for(uint32_t e = 0; !error && e < elementsCount; ++e)
+        {
+                const PlyElement_t* element = &elements[e];
+                const int isVertex = (strcmp(element->name, "vertex") == 0);
+                const int isFace = (strcmp(element->name, "face") == 0);
+
+                if(isVertex)
+                {
+                        // Vertices are referenced by the faces, so they must be declared first and only once
+                        error = (verticesCount != 0 || indices.size != 0 || element->count >= UINT32_MAX);
+                        verticesCount = element->count;
+                }
+
+                for(size_t i = 0; !error && i < element->count; ++i)
+                {
+                        float position[3] = { 0.0f, 0.0f, 0.0f };
+                        float normal[3] = { 0.0f, 0.0f, 0.0f };
+                        float texcoord[2] = { 0.0f, 0.0f };
+                        float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+                        polygon.size = 0;
+
+                        for(uint32_t p = 0; !error && p < element->propertiesCount; ++p)
+                        {
+                                const PlyProperty_t* property = &element->properties[p];
+                                const char* name = property->name;
+                                double value;
+
+                                if(property->countType != MNKT_PLY_INVALID)
+                                {
+                                        error = mnkt_ply_readValue(&reader, property->countType, &value) || value < 0.0;
+
+                                        const int isPolygon = isFace && (strcmp(name, "vertex_indices") == 0 || strcmp(name, "vertex_index") == 0);
+                                        const size_t itemsCount = error ? 0 : (size_t) value;
+
+                                        for(size_t j = 0; !error && j < itemsCount; ++j)
+                                        {
+                                                error = mnkt_ply_readValue(&reader, property->type, &value);
+
+                                                if(!error && isPolygon)
+                                                {
+                                                        uint32_t index = (uint32_t) value;
+
+                                                        error = (value < 0.0 || value >= (double) verticesCount) ||
+                                                                mnkt_mesh_push(&polygon, &index, sizeof(uint32_t));
+                                                }
+                                        }
+
+                                        continue;
+                                }
+
+                                error = mnkt_ply_readValue(&reader, property->type, &value);
+
+                                if(error || !isVertex)
+                                        continue;
+
+                                if(strcmp(name, "x") == 0)
+                                        position[0] = (float) value;
+                                else if(strcmp(name, "y") == 0)
+                                        position[1] = (float) value;
+                                else if(strcmp(name, "z") == 0)
+                                        position[2] = (float) value;
+                                else if(strcmp(name, "nx") == 0)
+                                        normal[0] = (float) value;
+                                else if(strcmp(name, "ny") == 0)
+                                        normal[1] = (float) value;
+                                else if(strcmp(name, "nz") == 0)
+                                        normal[2] = (float) value;
+                                else if(strcmp(name, "u") == 0 || strcmp(name, "s") == 0 || strcmp(name, "texture_u") == 0 || strcmp(name, "texture_s") == 0)
+                                        texcoord[0] = (float) value;
+                                else if(strcmp(name, "v") == 0 || strcmp(name, "t") == 0 || strcmp(name, "texture_v") == 0 || strcmp(name, "texture_t") == 0)
+                                        texcoord[1] = (float) value;
+                                else if(strcmp(name, "red") == 0)
+                                        color[0] = mnkt_ply_normalizeColor(value, property->type);
+                                else if(strcmp(name, "green") == 0)
+                                        color[1] = mnkt_ply_normalizeColor(value, property->type);
+                                else if(strcmp(name, "blue") == 0)
+                                        color[2] = mnkt_ply_normalizeColor(value, property->type);
+                                else if(strcmp(name, "alpha") == 0)
+                                        color[3] = mnkt_ply_normalizeColor(value, property->type);
+                        }
+
+                        if(!error && isVertex)
+                        {
+                                mnkt_mesh_writeVertex(vertex, attributes, position, normal, texcoord, color);
+                                error = mnkt_mesh_push(&vertices, vertex, vertexSize);
+                        }
+
+                        if(!error && isFace)
+                                error = mnkt_mesh_pushPolygon(&indices, (const uint32_t*) polygon.data, polygon.size / sizeof(uint32_t));
+                }
+
+                if(isVertex)
+                {
+                        for(uint32_t p = 0; p < element->propertiesCount; ++p)
+                                hasNormals |= (strcmp(element->properties[p].name, "nx") == 0);
+                }
+        }
+
+        if(!error)
+                error = mnkt_mesh_build(mesh, attributes, &vertices, &indices, hasNormals);
+
+        if(error)
+        {
+                free(vertices.data);
+                free(indices.data);
+        }
+
+        free(polygon.data);
+        free(vertex);
+        free(elements);
+        free(data);
+
+        return error;
+}
+
+
+/**
+ * @function mnkt_mesh_writeCache
+ * Saves the given mesh into a binary cache file. The file is written next to the cache (path followed by ".tmp") and then
+ * moved over it, so an existing cache is replaced only by a complete one and its mappings stay valid.
+ * @param path Path of the cache file
+ * @param mesh The mesh to be saved
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_writeCache(const char* path, const Mesh_t* mesh)
+{
+        if(path == NULL || mesh == NULL || mesh->vertexSize != mnkt_mesh_vertexSize(mesh->attributes))
+                return 1;
+
+        const size_t verticesSize = (size_t) mesh->verticesCount * mesh->vertexSize;
+        const size_t indicesSize = (size_t) mesh->indicesCount * sizeof(uint32_t);
+
+        MeshCacheHeader_t header = {
+                .version = MNKT_MESH_CACHE_VERSION,
+                .byteOrder = MNKT_MESH_CACHE_BYTE_ORDER,
+                .attributes = mesh->attributes,
+                .vertexSize = mesh->vertexSize,
+                .verticesCount = mesh->verticesCount,
+                .indicesCount = mesh->indicesCount,
+                .verticesOffset = MNKT_MESH_CACHE_ALIGNMENT,
+        };
+
+        header.indicesOffset = (header.verticesOffset + verticesSize + MNKT_MESH_CACHE_ALIGNMENT - 1) & ~((uint64_t) MNKT_MESH_CACHE_ALIGNMENT - 1);
+        memcpy(header.magic, MNKT_MESH_CACHE_MAGIC, sizeof(header.magic));
+
+        // The cache is written aside and then moved over the old one, so that mappings of the old cache (and readers that
+        // open the file meanwhile) never see a truncated or partially written file
+        char* tempPath = mnkt_mesh_appendToPath(path, ".tmp");
+
+        if(tempPath == NULL)
+                return 1;
+
+        FILE* file = fopen(tempPath, "wb");
+
+        if(file == NULL)
+        {
+                free(tempPath);
+                return 1;
+        }
+
+        static const unsigned char padding[MNKT_MESH_CACHE_ALIGNMENT] = { 0 };
+
+        int error = fwrite(&header, sizeof(header), 1, file) != 1;
+        error |= fwrite(padding, 1, header.verticesOffset - sizeof(header), file) != header.verticesOffset - sizeof(header);
+
+        if(verticesSize > 0)
+        {
+                error |= fwrite(mesh->vertices, 1, verticesSize, file) != verticesSize;
+                error |= fwrite(padding, 1, header.indicesOffset - header.verticesOffset - verticesSize, file) != header.indicesOffset - header.verticesOffset - verticesSize;
+        }
+
+        if(indicesSize > 0)
+                error |= fwrite(mesh->indices, 1, indicesSize, file) != indicesSize;
+
+        error |= fclose(file) != 0;
+
+        if(!error)
+                error = mnkt_mesh_replaceFile(tempPath, path);
+
+        // Never leave a truncated cache behind
+        if(error)
+                remove(tempPath);
+
+        free(tempPath);
+        return error;
+}
+
+
+/**
+ * @function mnkt_mesh_mapCache
+ * Loads a mesh from a binary cache file by mapping it in memory, vertices and indices point directly into the mapping.
+ * The mapping is private: changes made to the mesh data are not written back to the file.
+ * @param path Path of the cache file
+ * @param mesh Where the loaded mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure (e.g. the file is not a valid cache)
+*/
+int mnkt_mesh_mapCache(const char* path, Mesh_t* mesh)
+{
+        if(path == NULL || mesh == NULL)
+                return 1;
+
+        memset(mesh, 0, sizeof(Mesh_t));
+
+        size_t size;
+        unsigned char* data = mnkt_mesh_mapFile(path, &size);
+
+        if(data == NULL)
+                return 1;
+
+        MeshCacheHeader_t header;
+
+        if(size < sizeof(header))
+        {
+                mnkt_mesh_unmapFile(data, size);
+                return 1;
+        }
+
+        memcpy(&header, data, sizeof(header));
+
+        // Only the header is validated, the content is used as is
+        const uint64_t verticesSize = (uint64_t) header.verticesCount * header.vertexSize;
+        const uint64_t indicesSize = (uint64_t) header.indicesCount * sizeof(uint32_t);
+
+        if(memcmp(header.magic, MNKT_MESH_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+           header.version != MNKT_MESH_CACHE_VERSION || header.byteOrder != MNKT_MESH_CACHE_BYTE_ORDER ||
+           header.vertexSize != mnkt_mesh_vertexSize(header.attributes) ||
+           header.verticesOffset % MNKT_MESH_CACHE_ALIGNMENT != 0 || header.indicesOffset % MNKT_MESH_CACHE_ALIGNMENT != 0 ||
+           header.verticesOffset > size || verticesSize > size - header.verticesOffset ||
+           header.indicesOffset > size || indicesSize > size - header.indicesOffset)
+        {
+                mnkt_mesh_unmapFile(data, size);
+                return 1;
+        }
+
+        mesh->vertices = data + header.verticesOffset;
+        mesh->indices = (uint32_t*) (data + header.indicesOffset);
+        mesh->verticesCount = header.verticesCount;
+        mesh->indicesCount = header.indicesCount;
+        mesh->vertexSize = header.vertexSize;
+        mesh->attributes = header.attributes;
+        mesh->mapping = data;
+        mesh->mappingSize = size;
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_load
+ * Loads a mesh from its cache file if it is valid, up to date and stores the requested attributes,
+ * otherwise the mesh is imported from the source file (OBJ or PLY, chosen by extension) and the cache is written.
+ * @param path Path of the source file
+ * @param cachePath Path of the cache file (NULL to always import the source file), each set of attributes is cached
+ *      in its own file, whose path is cachePath followed by ".a" and the attributes in decimal (e.g. "mesh.cache.a3")
+ * @param attributes Attributes to be stored in each vertex (combination of MeshAttribute_t)
+ * @param mesh Where the loaded mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_load(const char* path, const char* cachePath, uint32_t attributes, Mesh_t* mesh)
+{
+        if(path == NULL || mesh == NULL)
+                return 1;
+
+        // Each set of attributes has its own cache file, so meshes loaded with different attributes do not overwrite each other's cache
+        char* attributesCachePath = NULL;
+
+        if(cachePath != NULL)
+        {
+                char suffix[16];
+                snprintf(suffix, sizeof(suffix), ".a%u", (unsigned int) attributes);
+
+                attributesCachePath = mnkt_mesh_appendToPath(cachePath, suffix);
+        }
+
+        if(attributesCachePath != NULL)
+        {
+                struct stat sourceStat;
+                struct stat cacheStat;
+
+                // A missing source file does not invalidate the cache
+                int upToDate = stat(attributesCachePath, &cacheStat) == 0 &&
+                               (stat(path, &sourceStat) != 0 || sourceStat.st_mtime <= cacheStat.st_mtime);
+
+                if(upToDate && mnkt_mesh_mapCache(attributesCachePath, mesh) == 0)
+                {
+                        if(mesh->attributes == attributes)
+                        {
+                                free(attributesCachePath);
+                                return 0;
+                        }
+
+                        mnkt_mesh_destroy(mesh);
+                }
+        }
+
+        const char* extension = strrchr(path, '.');
+        int error = 1;
+
+        if(extension != NULL && (strcmp(extension, ".obj") == 0 || strcmp(extension, ".OBJ") == 0))
+                error = mnkt_mesh_loadOBJ(path, attributes, mesh);
+        else if(extension != NULL && (strcmp(extension, ".ply") == 0 || strcmp(extension, ".PLY") == 0))
+                error = mnkt_mesh_loadPLY(path, attributes, mesh);
+
+        // Failing to write the cache only costs a new import on the next run
+        if(!error && attributesCachePath != NULL)
+                mnkt_mesh_writeCache(attributesCachePath, mesh);
+
+        free(attributesCachePath);
+        return error;
+}
+
+
+/**
+ * @function mnkt_mesh_destroy
+ * Releases the data of the given mesh (unmapping its cache file, if any)
+ * @param mesh The mesh to be released
+*/
+void mnkt_mesh_destroy(Mesh_t* mesh)
+{
+        if(mesh == NULL)
+                return;
+
+        if(mesh->mapping != NULL)
+        {
+                mnkt_mesh_unmapFile(mesh->mapping, mesh->mappingSize);
+        } else {
+                free(mesh->vertices);
+                free(mesh->indices);
+        }
+
+        memset(mesh, 0, sizeof(Mesh_t));
+}
+
+
+/**
+ * @function mnkt_mesh_readFile
+ * Reads the whole content of a file, a terminating null character is appended to it
+ * @param path Path of the file
+ * @param size Where the size of the file is stored
+ * @return The content of the file (to be released with free), NULL on failure
+ * @note: For internal usage only!!!
+*/
+static char* mnkt_mesh_readFile(const char* path, size_t* size)
+{
+        FILE* file = fopen(path, "rb");
+
+        if(file == NULL)
+                return NULL;
+
+        char* data = NULL;
+        long length = -1;
+
+        if(fseek(file, 0, SEEK_END) == 0)
+                length = ftell(file);
+
+        if(length >= 0 && fseek(file, 0, SEEK_SET) == 0)
+                data = malloc((size_t) length + 1);
+
+        if(data != NULL && fread(data, 1, (size_t) length, file) != (size_t) length)
+        {
+                free(data);
+                data = NULL;
+        }
+
+        fclose(file);
+
+        if(data == NULL)
+                return NULL;
+
+        data[length] = '\0';
+        *size = (size_t) length;
+
+        return data;
+}
+
+
+/**
+ * @function mnkt_mesh_push
+ * Appends data to a growable buffer
+ * @param buffer The buffer
+ * @param data Data to be appended
+ * @param size Size in bytes of the data
+ * @return Zero on success, non zero if the buffer could not be grown
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_push(MeshBuffer_t* buffer, const void* data, size_t size)
+{
+        if(buffer->size + size > buffer->capacity)
+        {
+                size_t capacity = buffer->capacity < 256 ? 256 : buffer->capacity * 2;
+
+                while(capacity < buffer->size + size)
+                        capacity *= 2;
+
+                unsigned char* grown = realloc(buffer->data, capacity);
+
+                if(grown == NULL)
+                        return 1;
+
+                buffer->data = grown;
+                buffer->capacity = capacity;
+        }
+
+        memcpy(buffer->data + buffer->size, data, size);
+        buffer->size += size;
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_writeVertex
+ * Interleaves the attributes of a vertex
+ * @param vertex Where the vertex is written
+ * @param attributes Attributes to be stored in the vertex
+ * @param position Position of the vertex (3 floats)
+ * @param normal Normal of the vertex (3 floats, NULL if missing)
+ * @param texcoord Texture coordinates of the vertex, with the origin in the bottom left corner (2 floats, NULL if missing)
+ * @param color Color of the vertex (4 floats)
+ * @note: For internal usage only!!!
+*/
+static void mnkt_mesh_writeVertex(unsigned char* vertex, uint32_t attributes, const float* position, const float* normal, const float* texcoord, const float* color)
+{
+        float* dst = (float*) vertex;
+
+        *dst++ = position[0];
+        *dst++ = position[1];
+        *dst++ = position[2];
+
+        if(attributes & MNKT_MESH_NORMAL)
+        {
+                *dst++ = normal != NULL ? normal[0] : 0.0f;
+                *dst++ = normal != NULL ? normal[1] : 0.0f;
+                *dst++ = normal != NULL ? normal[2] : 0.0f;
+        }
+
+        // Files put the origin of the textures in the bottom left corner, textures are sampled with the origin in the top left one
+        if(attributes & MNKT_MESH_TEXCOORD)
+        {
+                *dst++ = texcoord != NULL ? texcoord[0] : 0.0f;
+                *dst++ = texcoord != NULL ? 1.0f - texcoord[1] : 0.0f;
+        }
+
+        if(attributes & MNKT_MESH_COLOR)
+        {
+                *dst++ = color[0];
+                *dst++ = color[1];
+                *dst++ = color[2];
+                *dst++ = color[3];
+        }
+}
+
+
+/**
+ * @function mnkt_mesh_build
+ * Fills a mesh with the imported vertices and indices, the mesh takes ownership of their data
+ * @param mesh The mesh to be filled
+ * @param attributes Attributes stored in each vertex
+ * @param vertices Interleaved vertices
+ * @param indices Indices of the triangles
+ * @param hasNormals Whether all the vertices had a normal in the source file (otherwise normals are computed)
+ * @return Zero on success, non zero if the mesh is too big
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_build(Mesh_t* mesh, uint32_t attributes, MeshBuffer_t* vertices, MeshBuffer_t* indices, int hasNormals)
+{
+        const uint32_t vertexSize = mnkt_mesh_vertexSize(attributes);
+
+        if(vertices->size / vertexSize >= UINT32_MAX || indices->size / sizeof(uint32_t) >= UINT32_MAX)
+                return 1;
+
+        mesh->vertices = vertices->data;
+        mesh->indices = (uint32_t*) indices->data;
+        mesh->verticesCount = (uint32_t) (vertices->size / vertexSize);
+        mesh->indicesCount = (uint32_t) (indices->size / sizeof(uint32_t));
+        mesh->vertexSize = vertexSize;
+        mesh->attributes = attributes;
+
+        if((attributes & MNKT_MESH_NORMAL) && !hasNormals)
+                mnkt_mesh_computeNormals(mesh);
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_computeNormals
+ * Computes the normal of each vertex as the average of the normals of the triangles that share it (weighted by their area)
+ * @param mesh The mesh whose normals are computed (must store normals)
+ * @note: For internal usage only!!!
+*/
+static void mnkt_mesh_computeNormals(Mesh_t* mesh)
+{
+        unsigned char* vertices = mesh->vertices;
+        const uint32_t normalOffset = mnkt_mesh_attributeOffset(mesh->attributes, MNKT_MESH_NORMAL);
+
+        for(uint32_t i = 0; i < mesh->verticesCount; ++i)
+                memset(vertices + ((size_t) i * mesh->vertexSize) + normalOffset, 0, sizeof(Vec3_t));
+
+        for(uint32_t i = 0; i + 3 <= mesh->indicesCount; i += 3)
+        {
+                Vec3_t* positions[3];
+
+                for(int j = 0; j < 3; ++j)
+                        positions[j] = (Vec3_t*) (vertices + ((size_t) mesh->indices[i + j] * mesh->vertexSize));
+
+                Vec3_t edgeA = { .x = positions[1]->x - positions[0]->x, .y = positions[1]->y - positions[0]->y, .z = positions[1]->z - positions[0]->z };
+                Vec3_t edgeB = { .x = positions[2]->x - positions[0]->x, .y = positions[2]->y - positions[0]->y, .z = positions[2]->z - positions[0]->z };
+
+                // The length of the cross product is twice the area of the triangle
+                Vec3_t faceNormal = mnkt_vec3_cross(&edgeA, &edgeB);
+
+                for(int j = 0; j < 3; ++j)
+                {
+                        Vec3_t* normal = (Vec3_t*) ((unsigned char*) positions[j] + normalOffset);
+                        *normal = mnkt_vec3_add(normal, &faceNormal);
+                }
+        }
+
+        for(uint32_t i = 0; i < mesh->verticesCount; ++i)
+        {
+                Vec3_t* normal = (Vec3_t*) (vertices + ((size_t) i * mesh->vertexSize) + normalOffset);
+                float length = sqrtf( mnkt_vec3_dot(normal, normal) );
+
+                if(length > 0.0f)
+                        *normal = mnkt_vec3_div(normal, length);
+        }
+}
+
+
+/**
+ * @function mnkt_mesh_pushPolygon
+ * Splits a convex polygon into a fan of triangles and appends their indices
+ * @param indices Where the indices are appended
+ * @param polygon Indices of the corners of the polygon
+ * @param cornersCount Number of corners (polygons with less than three corners are ignored)
+ * @return Zero on success, non zero if the indices could not be appended
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_pushPolygon(MeshBuffer_t* indices, const uint32_t* polygon, size_t cornersCount)
+{
+        for(size_t i = 2; i < cornersCount; ++i)
+        {
+                const uint32_t triangle[3] = { polygon[0], polygon[i - 1], polygon[i] };
+
+                if( mnkt_mesh_push(indices, triangle, sizeof(triangle)) )
+                        return 1;
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_obj_skipSpaces
+ * Skips the spaces and tabs (but not the line terminators) of an OBJ file
+ * @param cursor Current position inside the file
+ * @return The position of the first character that is not a space
+ * @note: For internal usage only!!!
+*/
+static const char* mnkt_obj_skipSpaces(const char* cursor)
+{
+        while(*cursor == ' ' || *cursor == '\t')
+                ++cursor;
+
+        return cursor;
+}
+
+
+/**
+ * @function mnkt_obj_parseFloats
+ * Parses the numbers that follow a statement of an OBJ file, up to the end of the line
+ * @param cursor Current position inside the file, updated to the position after the last parsed number
+ * @param values Where the parsed numbers are stored
+ * @param maxCount Maximum number of numbers to be parsed
+ * @return The number of parsed numbers
+ * @note: For internal usage only!!!
+*/
+static size_t mnkt_obj_parseFloats(const char** cursor, float* values, size_t maxCount)
+{
+        size_t count = 0;
+
+        while(count < maxCount)
+        {
+                const char* start = mnkt_obj_skipSpaces(*cursor);
+                char* end;
+
+                // strtof would skip line terminators
+                if(*start == '\n' || *start == '\r' || *start == '\0')
+                        break;
+
+                float value = strtof(start, &end);
+
+                if(end == start)
+                        break;
+
+                values[count++] = value;
+                *cursor = end;
+        }
+
+        return count;
+}
+
+
+/**
+ * @function mnkt_obj_resolveIndex
+ * Converts an index of an OBJ file (one based, negative if relative to the end) into a zero based index
+ * @param index The index to be converted
+ * @param count Number of elements defined so far
+ * @param result Where the converted index is stored
+ * @return Zero on success, non zero if the index is out of range
+ * @note: For internal usage only!!!
+*/
+static int mnkt_obj_resolveIndex(long index, size_t count, int64_t* result)
+{
+        int64_t resolved = index > 0 ? (int64_t) index - 1 : (int64_t) count + index;
+
+        if(index == 0 || resolved < 0 || resolved >= (int64_t) count)
+                return 1;
+
+        *result = resolved;
+        return 0;
+}
+
+
+/**
+ * @function mnkt_obj_findVertex
+ * Looks for the vertex that corresponds to a combination of position, texture coordinates and normal,
+ * if none exists the combination is added to the table and associated with the next vertex of the mesh
+ * @param table Hash table (open addressing), grown when it is half full
+ * @param capacity Number of entries of the table (a power of two)
+ * @param count Number of used entries of the table (equal to the number of vertices of the mesh)
+ * @param key The combination to be looked for
+ * @param vertex Where the index of the vertex is stored (equal to the old count if a new vertex must be created)
+ * @return Zero on success, non zero if the table could not be grown
+ * @note: For internal usage only!!!
+*/
+static int mnkt_obj_findVertex(ObjVertex_t** table, size_t* capacity, size_t* count, const ObjVertex_t* key, uint32_t* vertex)
+{
+        if((*count + 1) * 2 > *capacity)
+        {
+                size_t newCapacity = *capacity < 1024 ? 1024 : *capacity * 2;
+                ObjVertex_t* newTable = malloc(sizeof(ObjVertex_t) * newCapacity);
+
+                if(newTable == NULL)
+                        return 1;
+
+                for(size_t i = 0; i < newCapacity; ++i)
+                        newTable[i].vertex = UINT32_MAX;
+
+                // Rehash the old entries
+                for(size_t i = 0; i < *capacity; ++i)
+                {
+                        const ObjVertex_t* entry = &(*table)[i];
+
+                        if(entry->vertex == UINT32_MAX)
+                                continue;
+
+                        uint64_t slot = ((uint64_t) entry->position * 73856093u) ^ ((uint64_t) entry->texcoord * 19349663u) ^ ((uint64_t) entry->normal * 83492791u);
+
+                        while(newTable[slot & (newCapacity - 1)].vertex != UINT32_MAX)
+                                ++slot;
+
+                        newTable[slot & (newCapacity - 1)] = *entry;
+                }
+
+                free(*table);
+                *table = newTable;
+                *capacity = newCapacity;
+        }
+
+        uint64_t slot = ((uint64_t) key->position * 73856093u) ^ ((uint64_t) key->texcoord * 19349663u) ^ ((uint64_t) key->normal * 83492791u);
+
+        for(;; ++slot)
+        {
+                ObjVertex_t* entry = &(*table)[slot & (*capacity - 1)];
+
+                if(entry->vertex == UINT32_MAX)
+                {
+                        if(*count >= UINT32_MAX - 1)
+                                return 1;
+
+                        *entry = *key;
+                        entry->vertex = (uint32_t) (*count)++;
+                        *vertex = entry->vertex;
+                        return 0;
+                }
+
+                if(entry->position == key->position && entry->texcoord == key->texcoord && entry->normal == key->normal)
+                {
+                        *vertex = entry->vertex;
+                        return 0;
+                }
+        }
+}
+
+
+/**
+ * @function mnkt_ply_parseHeader
+ * Parses the header of a PLY file
+ * @param data Content of the file (null terminated)
+ * @param size Size of the file in bytes
+ * @param elements Where the declared elements are stored (MNKT_PLY_MAX_ELEMENTS at most)
+ * @param elementsCount Where the number of declared elements is stored
+ * @param reader Where the reader of the data that follows the header is initialized
+ * @return Zero on success, non zero if the header is not valid or not supported
+ * @note: For internal usage only!!!
+*/
+static int mnkt_ply_parseHeader(const char* data, size_t size, PlyElement_t* elements, uint32_t* elementsCount, PlyReader_t* reader)
+{
+        if(strncmp(data, "ply", 3) != 0 || (data[3] != '\n' && data[3] != '\r'))
+                return 1;
+
+        const char* line = data;
+        int hasFormat = 0;
+
+        *elementsCount = 0;
+
+        for(;;)
+        {
+                const char* lineEnd = strchr(line, '\n');
+
+                if(lineEnd == NULL)
+                        return 1;
+
+                char words[5][32] = { { 0 } };
+                int wordsCount = 0;
+                const char* cursor = line;
+
+                // Split the line into (at most five) words
+                while(cursor < lineEnd && wordsCount < 5)
+                {
+                        while(cursor < lineEnd && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+                                ++cursor;
+
+                        size_t length = 0;
+
+                        while(cursor < lineEnd && *cursor != ' ' && *cursor != '\t' && *cursor != '\r')
+                        {
+                                if(length < sizeof(words[0]) - 1)
+                                        words[wordsCount][length++] = *cursor;
+
+                                ++cursor;
+                        }
+
+                        if(length > 0)
+                                ++wordsCount;
+                }
+
+                line = lineEnd + 1;
+
+                if(wordsCount == 0)
+                        continue;
+
+                if(strcmp(words[0], "end_header") == 0)
+                        break;
+
+                if(strcmp(words[0], "format") == 0 && wordsCount >= 2)
+                {
+                        hasFormat = 1;
+
+                        if(strcmp(words[1], "ascii") == 0)
+                                reader->format = MNKT_PLY_ASCII;
+                        else if(strcmp(words[1], "binary_little_endian") == 0)
+                                reader->format = MNKT_PLY_BINARY_LE;
+                        else if(strcmp(words[1], "binary_big_endian") == 0)
+                                reader->format = MNKT_PLY_BINARY_BE;
+                        else
+                                return 1;
+                }
+                else if(strcmp(words[0], "element") == 0 && wordsCount >= 3)
+                {
+                        if(*elementsCount >= MNKT_PLY_MAX_ELEMENTS)
+                                return 1;
+
+                        PlyElement_t* element = &elements[(*elementsCount)++];
+
+                        strcpy(element->name, words[1]);
+                        element->count = strtoull(words[2], NULL, 10);
+                        element->propertiesCount = 0;
+                }
+                else if(strcmp(words[0], "property") == 0 && wordsCount >= 3)
+                {
+                        if(*elementsCount == 0 || elements[*elementsCount - 1].propertiesCount >= MNKT_PLY_MAX_PROPERTIES)
+                                return 1;
+
+                        PlyElement_t* element = &elements[*elementsCount - 1];
+                        PlyProperty_t* property = &element->properties[element->propertiesCount++];
+
+                        if(strcmp(words[1], "list") == 0)
+                        {
+                                if(wordsCount < 5)
+                                        return 1;
+
+                                property->countType = mnkt_ply_typeFromName(words[2]);
+                                property->type = mnkt_ply_typeFromName(words[3]);
+                                strcpy(property->name, words[4]);
+
+                                if(property->countType == MNKT_PLY_INVALID || property->countType == MNKT_PLY_FLOAT32 || property->countType == MNKT_PLY_FLOAT64)
+                                        return 1;
+                        } else {
+                                property->countType = MNKT_PLY_INVALID;
+                                property->type = mnkt_ply_typeFromName(words[1]);
+                                strcpy(property->name, words[2]);
+                        }
+
+                        if(property->type == MNKT_PLY_INVALID)
+                                return 1;
+                }
+        }
+
+        reader->cursor = line;
+        reader->end = data + size;
+
+        return !hasFormat;
+}
+
+
+/**
+ * @function mnkt_ply_typeFromName
+ * Converts the name of a type of a PLY file into the corresponding value
+ * @param name Name of the type
+ * @return The type, MNKT_PLY_INVALID if unknown
+ * @note: For internal usage only!!!
+*/
+static PlyType_t mnkt_ply_typeFromName(const char* name)
+{
+        static const char* names[][2] = {
+                { "char", "int8" }, { "uchar", "uint8" }, { "short", "int16" }, { "ushort", "uint16" },
+                { "int", "int32" }, { "uint", "uint32" }, { "float", "float32" }, { "double", "float64" }
+        };
+
+        for(int i = 0; i < MNKT_PLY_INVALID; ++i)
+        {
+                if(strcmp(name, names[i][0]) == 0 || strcmp(name, names[i][1]) == 0)
+                        return (PlyType_t) i;
+        }
+
+        return MNKT_PLY_INVALID;
+}
+
+
+/**
+ * @function mnkt_ply_readValue
+ * Reads the next value from the data of a PLY file
+ * @param reader The reader of the data
+ * @param type Type of the value
+ * @param value Where the value is stored
+ * @return Zero on success, non zero if the data is over or malformed
+ * @note: For internal usage only!!!
+*/
+static int mnkt_ply_readValue(PlyReader_t* reader, PlyType_t type, double* value)
+{
+        if(reader->format == MNKT_PLY_ASCII)
+        {
+                char* end;
+
+                *value = strtod(reader->cursor, &end);
+
+                if(end == reader->cursor)
+                        return 1;
+
+                reader->cursor = end;
+                return 0;
+        }
+
+        static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+        const size_t size = sizes[type];
+
+        if((size_t) (reader->end - reader->cursor) < size)
+                return 1;
+
+        unsigned char bytes[8];
+        memcpy(bytes, reader->cursor, size);
+        reader->cursor += size;
+
+        // Swap the bytes if the endianness of the file differs from the one of the machine
+        const uint16_t endiannessCheck = 1;
+        const int isLittleEndian = *(const unsigned char*) &endiannessCheck;
+
+        if(isLittleEndian != (reader->format == MNKT_PLY_BINARY_LE))
+        {
+                for(size_t i = 0; i < size / 2; ++i)
+                {
+                        unsigned char tmp = bytes[i];
+                        bytes[i] = bytes[size - 1 - i];
+                        bytes[size - 1 - i] = tmp;
+                }
+        }
+
+        switch(type)
+        {
+                case MNKT_PLY_INT8:     { int8_t v;   memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_UINT8:    { uint8_t v;  memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_INT16:    { int16_t v;  memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_UINT16:   { uint16_t v; memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_INT32:    { int32_t v;  memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_UINT32:   { uint32_t v; memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_FLOAT32:  { float v;    memcpy(&v, bytes, size); *value = v; break; }
+                case MNKT_PLY_FLOAT64:  { double v;   memcpy(&v, bytes, size); *value = v; break; }
+                default:
+                        return 1;
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_ply_normalizeColor
+ * Converts a color component of a PLY file into the range [0.0f, 1.0f]
+ * @param value The color component
+ * @param type Type of the component (integer components are divided by the maximum value of their type)
+ * @return The normalized component
+ * @note: For internal usage only!!!
+*/
+static float mnkt_ply_normalizeColor(double value, PlyType_t type)
+{
+        if(type == MNKT_PLY_UINT8)
+                return (float) (value / 255.0);
+
+        if(type == MNKT_PLY_UINT16)
+                return (float) (value / 65535.0);
+
+        return (float) value;
+}
+
+
+/**
+ * @function mnkt_mesh_mapFile
+ * Maps a whole file in memory (private, copy on write mapping).
+ * On platforms without memory mapping the file is read into an allocated buffer.
+ * @param path Path of the file
+ * @param size Where the size of the file is stored
+ * @return The start of the mapping, NULL on failure (or if the file is empty)
+ * @note: For internal usage only!!!
+*/
+static void* mnkt_mesh_mapFile(const char* path, size_t* size)
+{
+#if defined(MNKT_MESH_MMAP_POSIX)
+        int fd = open(path, O_RDONLY);
+
+        if(fd < 0)
+                return NULL;
+
+        struct stat fileStat;
+        void* data = NULL;
+
+        if(fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+        {
+                *size = (size_t) fileStat.st_size;
+                data = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+                if(data == MAP_FAILED)
+                        data = NULL;
+        }
+
+        // The mapping stays valid after the file is closed
+        close(fd);
+        return data;
+#elif defined(MNKT_MESH_MMAP_WIN32)
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+        if(file == INVALID_HANDLE_VALUE)
+                return NULL;
+
+        LARGE_INTEGER fileSize;
+        void* data = NULL;
+
+        if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+                HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+
+                if(mapping != NULL)
+                {
+                        *size = (size_t) fileSize.QuadPart;
+                        data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+                        CloseHandle(mapping);
+                }
+        }
+
+        CloseHandle(file);
+        return data;
+#else
+        char* data = mnkt_mesh_readFile(path, size);
+
+        if(data != NULL && *size == 0)
+        {
+                free(data);
+                data = NULL;
+        }
+
+        return data;
+#endif
+}
+
+
+/**
+ * @function mnkt_mesh_unmapFile
+ * Releases a file mapped by mnkt_mesh_mapFile
+ * @param data Start of the mapping
+ * @param size Size of the mapping
+ * @note: For internal usage only!!!
+*/
+static void mnkt_mesh_unmapFile(void* data, size_t size)
+{
+#if defined(MNKT_MESH_MMAP_POSIX)
+        munmap(data, size);
+#elif defined(MNKT_MESH_MMAP_WIN32)
+        (void) size;
+        UnmapViewOfFile(data);
+#else
+        (void) size;
+        free(data);
+#endif
+}
+
+
+/**
+ * @function mnkt_mesh_appendToPath
+ * Builds a path made of the given one followed by a suffix
+ * @param path The path
+ * @param suffix The suffix to be appended
+ * @return The new path (must be released with free), NULL on failure
+ * @note: For internal usage only!!!
+*/
+static char* mnkt_mesh_appendToPath(const char* path, const char* suffix)
+{
+        const size_t pathLength = strlen(path);
+        const size_t suffixLength = strlen(suffix);
+        char* result = malloc(pathLength + suffixLength + 1);
+
+        if(result == NULL)
+                return NULL;
+
+        memcpy(result, path, pathLength);
+        memcpy(result + pathLength, suffix, suffixLength + 1);
+
+        return result;
+}
+
+
+/**
+ * @function mnkt_mesh_replaceFile
+ * Moves a file over another one, replacing it if it exists (atomically where the platform allows it)
+ * @param source Path of the file to be moved
+ * @param destination Path of the file to be replaced
+ * @return Zero on success, non zero on failure
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_replaceFile(const char* source, const char* destination)
+{
+#if defined(MNKT_MESH_MMAP_WIN32)
+        return MoveFileExA(source, destination, MOVEFILE_REPLACE_EXISTING) == 0;
+#else
+        return rename(source, destination) != 0;
+#endif
+}
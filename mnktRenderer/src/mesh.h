@@ -0,0 +1,141 @@
+
+/**
+ * @file mesh.h
+ *
+ * Defines the indexed triangle meshes and the functions used to import them from OBJ and PLY files.
+ *
+ * Imported meshes can be saved into a binary cache that stores the vertices, already interleaved
+ * in the layout expected by the shader programs, and the indices. Caches are loaded by mapping
+ * the file in memory, so no parsing nor copy is made.
+*/
+
+#ifndef MNKT_MESH_H
+#define MNKT_MESH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/**
+ * @macro MNKT_VERTEX_CACHE_SIZE
+ * Number of processed vertices kept by the post transform cache of indexed draws (entries are replaced in FIFO order)
+*/
+#define MNKT_VERTEX_CACHE_SIZE          32
+
+
+/**
+ * @enum MeshAttribute_t
+ * Attributes that can be stored in the vertices of a mesh. The position (3 floats) is always present,
+ * the other attributes follow it in the order of this enumeration: normal (3 floats),
+ * texture coordinates (2 floats) and color (4 floats).
+*/
+typedef enum {
+        MNKT_MESH_NORMAL        = 1 << 0,       ///< Normal of the vertex (computed from the triangles if missing in the file)
+        MNKT_MESH_TEXCOORD      = 1 << 1,       ///< Texture coordinates, (0, 0) is the top left corner of the texture (zero if missing in the file)
+        MNKT_MESH_COLOR         = 1 << 2        ///< RGBA color with components in the range [0.0f, 1.0f] (opaque white if missing in the file)
+} MeshAttribute_t;
+
+
+/**
+ * @struct Mesh_t
+ * Indexed triangle mesh, its data can be drawn with mnkt_drawIndexed using vertexSize as the vertex size of the shader program
+*/
+typedef struct {
+        void*           vertices;               ///< Interleaved vertices, verticesCount * vertexSize bytes
+        uint32_t*       indices;                ///< Indices of the vertices, grouped three by three to form triangles
+        uint32_t        verticesCount;          ///< Number of vertices
+        uint32_t        indicesCount;           ///< Number of indices (three times the number of triangles)
+        uint32_t        vertexSize;             ///< Size in bytes of a vertex
+        uint32_t        attributes;             ///< Attributes stored in each vertex (combination of MeshAttribute_t)
+        void*           mapping;                ///< Cache file mapped in memory that holds vertices and indices (NULL if they are owned by the mesh)
+        size_t          mappingSize;            ///< Size in bytes of the mapping
+} Mesh_t;
+
+
+/**
+ * @function mnkt_mesh_vertexSize
+ * Computes the size of a vertex that stores the given attributes
+ * @param attributes Attributes stored in the vertex (combination of MeshAttribute_t)
+ * @return Size in bytes of the vertex
+*/
+uint32_t mnkt_mesh_vertexSize(uint32_t attributes);
+
+
+/**
+ * @function mnkt_mesh_attributeOffset
+ * Computes the offset of an attribute inside a vertex
+ * @param attributes Attributes stored in the vertex (combination of MeshAttribute_t)
+ * @param attribute The attribute whose offset is computed (zero to get the offset of the position)
+ * @return Offset in bytes of the attribute from the start of the vertex
+*/
+uint32_t mnkt_mesh_attributeOffset(uint32_t attributes, MeshAttribute_t attribute);
+
+
+/**
+ * @function mnkt_mesh_loadOBJ
+ * Imports a mesh from a Wavefront OBJ file, polygons are split into triangles and
+ * identical combinations of position, texture coordinates and normal share the same vertex
+ * @param path Path of the file
+ * @param attributes Attributes to be stored in each vertex (combination of MeshAttribute_t)
+ * @param mesh Where the imported mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_loadOBJ(const char* path, uint32_t attributes, Mesh_t* mesh);
+
+
+/**
+ * @function mnkt_mesh_loadPLY
+ * Imports a mesh from a PLY file (ascii, binary little endian or binary big endian), polygons are split into triangles
+ * @param path Path of the file
+ * @param attributes Attributes to be stored in each vertex (combination of MeshAttribute_t)
+ * @param mesh Where the imported mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_loadPLY(const char* path, uint32_t attributes, Mesh_t* mesh);
+
+
+/**
+ * @function mnkt_mesh_writeCache
+ * Saves the given mesh into a binary cache file. The file is written next to the cache (path followed by ".tmp") and then
+ * moved over it, so an existing cache is replaced only by a complete one and its mappings stay valid.
+ * @param path Path of the cache file
+ * @param mesh The mesh to be saved
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_writeCache(const char* path, const Mesh_t* mesh);
+
+
+/**
+ * @function mnkt_mesh_mapCache
+ * Loads a mesh from a binary cache file by mapping it in memory, vertices and indices point directly into the mapping.
+ * The mapping is private: changes made to the mesh data are not written back to the file.
+ * @param path Path of the cache file
+ * @param mesh Where the loaded mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure (e.g. the file is not a valid cache)
+*/
+int mnkt_mesh_mapCache(const char* path, Mesh_t* mesh);
+
+
+/**
+ * @function mnkt_mesh_load
+ * Loads a mesh from its cache file if it is valid, up to date and stores the requested attributes,
+ * otherwise the mesh is imported from the source file (OBJ or PLY, chosen by extension) and the cache is written.
+ * @param path Path of the source file
+ * @param cachePath Path of the cache file (NULL to always import the source file), each set of attributes is cached
+ *      in its own file, whose path is cachePath followed by ".a" and the attributes in decimal (e.g. "mesh.cache.a3")
+ * @param attributes Attributes to be stored in each vertex (combination of MeshAttribute_t)
+ * @param mesh Where the loaded mesh is stored (must be released with mnkt_mesh_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_load(const char* path, const char* cachePath, uint32_t attributes, Mesh_t* mesh);
+
+
+/**
+ * @function mnkt_mesh_destroy
+ * Releases the data of the given mesh (unmapping its cache file, if any)
+ * @param mesh The mesh to be released
+*/
+void mnkt_mesh_destroy(Mesh_t* mesh);
+
+
+#endif // MNKT_MESH_H
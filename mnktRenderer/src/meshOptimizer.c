@@ -0,0 +1,634 @@
+
+/**
+ * @file meshOptimizer.c
+ *
+ * Contains implementation of the mesh optimization functions
+*/
+
+#include "meshOptimizer.h"
+
+#include "math/vec.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @macro MNKT_FORSYTH_MAX_VALENCE
+ * Number of precomputed valence scores, vertices shared by more triangles compute their score on the fly
+*/
+#define MNKT_FORSYTH_MAX_VALENCE        32
+
+
+/**
+ * @struct SimulatedCache_t
+ * Simulation of the post transform cache of mnkt_drawIndexed (same size and replacement policy)
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        uint32_t        indices[MNKT_VERTEX_CACHE_SIZE];        ///< Index of the vertex held by each entry (UINT32_MAX if empty)
+        uint32_t        nextEntry;                              ///< Next entry to be replaced
+} SimulatedCache_t;
+
+
+/**
+ * @struct MeshCluster_t
+ * Group of consecutive triangles sorted to reduce overdraw
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        float           sortKey;                ///< How much the cluster faces outwards from the center of the mesh
+        uint32_t        firstTriangle;          ///< Index of the first triangle of the cluster
+        uint32_t        trianglesCount;         ///< Number of triangles of the cluster
+} MeshCluster_t;
+
+
+// Prototypes for internal functions
+
+static float    mnkt_mesh_forsythScore(int32_t cachePosition, uint32_t remainingTriangles, const float* cacheScores, const float* valenceScores);
+static uint32_t mnkt_mesh_simulateTriangle(SimulatedCache_t* cache, const uint32_t* triangle);
+static Vec3_t   mnkt_mesh_triangleNormal(const unsigned char* vertices, uint32_t vertexSize, const uint32_t* triangle, Vec3_t* centroid);
+static int      mnkt_mesh_compareClusters(const void* a, const void* b);
+
+
+/**
+ * @function mnkt_mesh_optimizeVertexCache
+ * Reorders the triangles to maximize the hits of the post transform cache (Forsyth's linear speed vertex cache optimization)
+ * The vertices are scored against a simulated LRU cache even though the cache of mnkt_drawIndexed is FIFO: the LRU order
+ * favours the vertices that were just used, which keeps the triangles emitted in strips and gives fewer FIFO misses than
+ * scoring the FIFO order itself (about 0.74 vs 0.95 misses per triangle on a tessellated grid)
+ * @param indices Indices of the vertices, grouped three by three to form triangles (reordered in place)
+ * @param indicesCount Number of indices
+ * @param verticesCount Number of vertices referenced by the indices
+ * @return Zero on success, non zero on failure (indices are left untouched)
+*/
+int mnkt_mesh_optimizeVertexCache(uint32_t* indices, size_t indicesCount, size_t verticesCount)
+{
+        if(indices == NULL)
+                return 1;
+
+        const size_t trianglesCount = indicesCount / 3;
+
+        for(size_t i = 0; i < trianglesCount * 3; ++i)
+        {
+                if(indices[i] >= verticesCount)
+                        return 1;
+        }
+
+        if(trianglesCount == 0)
+                return 0;
+
+        uint32_t* offsets = malloc(sizeof(uint32_t) * (verticesCount + 1));
+        uint32_t* remaining = calloc(verticesCount, sizeof(uint32_t));
+        uint32_t* adjacency = malloc(sizeof(uint32_t) * trianglesCount * 3);
+        int32_t* cachePositions = malloc(sizeof(int32_t) * verticesCount);
+        float* vertexScores = malloc(sizeof(float) * verticesCount);
+        float* triangleScores = malloc(sizeof(float) * trianglesCount);
+        unsigned char* emitted = calloc(trianglesCount, 1);
+        uint32_t* result = malloc(sizeof(uint32_t) * trianglesCount * 3);
+
+        if(offsets == NULL || remaining == NULL || adjacency == NULL || cachePositions == NULL ||
+           vertexScores == NULL || triangleScores == NULL || emitted == NULL || result == NULL)
+        {
+                free(offsets); free(remaining); free(adjacency); free(cachePositions);
+                free(vertexScores); free(triangleScores); free(emitted); free(result);
+                return 1;
+        }
+
+        // Scores of the positions inside the cache (the last triangle's vertices get a fixed score) and of the number of remaining triangles
+        float cacheScores[MNKT_VERTEX_CACHE_SIZE];
+        float valenceScores[MNKT_FORSYTH_MAX_VALENCE];
+
+        for(int i = 0; i < MNKT_VERTEX_CACHE_SIZE; ++i)
+                cacheScores[i] = i < 3 ? 0.75f : powf(1.0f - (float) (i - 3) / (MNKT_VERTEX_CACHE_SIZE - 3), 1.5f);
+
+        for(int i = 0; i < MNKT_FORSYTH_MAX_VALENCE; ++i)
+                valenceScores[i] = i == 0 ? 0.0f : 2.0f / sqrtf((float) i);
+
+        // Build the list of the triangles that use each vertex
+        for(size_t i = 0; i < trianglesCount * 3; ++i)
+                remaining[indices[i]]++;
+
+        offsets[0] = 0;
+
+        for(size_t v = 0; v < verticesCount; ++v)
+        {
+                offsets[v + 1] = offsets[v] + remaining[v];
+                remaining[v] = 0;
+                cachePositions[v] = -1;
+        }
+
+        for(size_t i = 0; i < trianglesCount * 3; ++i)
+        {
+                uint32_t v = indices[i];
+                adjacency[offsets[v] + remaining[v]++] = (uint32_t) (i / 3);
+        }
+
+        for(size_t v = 0; v < verticesCount; ++v)
+                vertexScores[v] = mnkt_mesh_forsythScore(-1, remaining[v], cacheScores, valenceScores);
+
+        for(size_t t = 0; t < trianglesCount; ++t)
+                triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[(t * 3) + 1]] + vertexScores[indices[(t * 3) + 2]];
+
+        uint32_t cache[MNKT_VERTEX_CACHE_SIZE + 3];
+        uint32_t cacheCount = 0;
+        size_t nextUnemitted = 0;
+        int64_t best = -1;
+
+        for(size_t emittedCount = 0; emittedCount < trianglesCount; ++emittedCount)
+        {
+                // No triangle uses the cached vertices, restart from the first triangle not yet emitted
+                if(best < 0)
+                {
+                        while(emitted[nextUnemitted])
+                                ++nextUnemitted;
+
+                        best = (int64_t) nextUnemitted;
+                }
+
+                const uint32_t* triangle = &indices[best * 3];
+
+                memcpy(&result[emittedCount * 3], triangle, sizeof(uint32_t) * 3);
+                emitted[best] = 1;
+
+                // Remove the triangle from the lists of its vertices
+                for(int j = 0; j < 3; ++j)
+                {
+                        uint32_t v = triangle[j];
+                        uint32_t* list = &adjacency[offsets[v]];
+
+                        for(uint32_t k = 0; k < remaining[v]; ++k)
+                        {
+                                if(list[k] == (uint32_t) best)
+                                {
+                                        list[k] = list[--remaining[v]];
+                                        break;
+                                }
+                        }
+                }
+
+                // The vertices of the triangle move to the front of the (LRU) cache, see above for why LRU rather than FIFO
+                uint32_t newCache[MNKT_VERTEX_CACHE_SIZE + 3];
+                uint32_t newCount = 0;
+
+                for(int j = 0; j < 3; ++j)
+                {
+                        if(j == 0 || (triangle[j] != triangle[0] && (j == 1 || triangle[j] != triangle[1])))
+                                newCache[newCount++] = triangle[j];
+                }
+
+                for(uint32_t k = 0; k < cacheCount; ++k)
+                {
+                        uint32_t v = cache[k];
+
+                        if(v != triangle[0] && v != triangle[1] && v != triangle[2])
+                                newCache[newCount++] = v;
+                }
+
+                // Update the scores of the vertices whose position changed and of their triangles
+                float bestScore = -1.0f;
+                best = -1;
+
+                for(uint32_t k = 0; k < newCount; ++k)
+                {
+                        uint32_t v = newCache[k];
+
+                        cachePositions[v] = k < MNKT_VERTEX_CACHE_SIZE ? (int32_t) k : -1;
+                        vertexScores[v] = mnkt_mesh_forsythScore(cachePositions[v], remaining[v], cacheScores, valenceScores);
+                }
+
+                for(uint32_t k = 0; k < newCount; ++k)
+                {
+                        uint32_t v = newCache[k];
+
+                        for(uint32_t a = 0; a < remaining[v]; ++a)
+                        {
+                                uint32_t t = adjacency[offsets[v] + a];
+                                float score = vertexScores[indices[t * 3]] + vertexScores[indices[(t * 3) + 1]] + vertexScores[indices[(t * 3) + 2]];
+
+                                triangleScores[t] = score;
+
+                                if(score > bestScore)
+                                {
+                                        bestScore = score;
+                                        best = t;
+                                }
+                        }
+                }
+
+                cacheCount = newCount < MNKT_VERTEX_CACHE_SIZE ? newCount : MNKT_VERTEX_CACHE_SIZE;
+                memcpy(cache, newCache, sizeof(uint32_t) * cacheCount);
+        }
+
+        memcpy(indices, result, sizeof(uint32_t) * trianglesCount * 3);
+
+        free(offsets); free(remaining); free(adjacency); free(cachePositions);
+        free(vertexScores); free(triangleScores); free(emitted); free(result);
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_optimizeOverdraw
+ * Reorders the triangles to reduce overdraw without losing the post transform cache locality:
+ * the triangles, already optimized for the vertex cache, are split into clusters where the cache is flushed
+ * and where the cache miss ratio of the cluster is low enough to start a new one (Tipsify's soft boundaries),
+ * then the clusters that face outwards from the center of the mesh (likely to occlude the others) are drawn first
+ * @param indices Indices of the vertices, grouped three by three to form triangles (reordered in place)
+ * @param indicesCount Number of indices
+ * @param vertices Vertices of the mesh, each one starts with its position (3 floats)
+ * @param verticesCount Number of vertices
+ * @param vertexSize Size in bytes of a vertex
+ * @param threshold Maximum allowed increase of the cache miss ratio (e.g. 1.05 allows 5% more vertex shader invocations),
+ *      the higher the threshold the smaller the clusters
+ * @return Zero on success, non zero on failure (indices are left untouched)
+*/
+int mnkt_mesh_optimizeOverdraw(uint32_t* indices, size_t indicesCount, const void* vertices, size_t verticesCount, uint32_t vertexSize, float threshold)
+{
+        if(indices == NULL || vertices == NULL || vertexSize < sizeof(Vec3_t) || threshold < 1.0f)
+                return 1;
+
+        const size_t trianglesCount = indicesCount / 3;
+
+        for(size_t i = 0; i < trianglesCount * 3; ++i)
+        {
+                if(indices[i] >= verticesCount)
+                        return 1;
+        }
+
+        if(trianglesCount == 0)
+                return 0;
+
+        MeshCluster_t* clusters = malloc(sizeof(MeshCluster_t) * trianglesCount);
+        uint32_t* result = malloc(sizeof(uint32_t) * trianglesCount * 3);
+
+        if(clusters == NULL || result == NULL)
+        {
+                free(clusters);
+                free(result);
+                return 1;
+        }
+
+        // Hard boundaries: a new cluster starts at each triangle whose vertices all miss the cache
+        SimulatedCache_t cache;
+        size_t clustersCount = 0;
+
+        memset(cache.indices, 0xFF, sizeof(cache.indices));
+        cache.nextEntry = 0;
+
+        for(size_t t = 0; t < trianglesCount; ++t)
+        {
+                if(mnkt_mesh_simulateTriangle(&cache, &indices[t * 3]) == 3 || t == 0)
+                {
+                        clusters[clustersCount].firstTriangle = (uint32_t) t;
+                        clusters[clustersCount].trianglesCount = 0;
+                        ++clustersCount;
+                }
+
+                clusters[clustersCount - 1].trianglesCount++;
+        }
+
+        // Soft boundaries: each hard cluster is split as soon as the part seen so far, drawn with an empty cache,
+        // has a cache miss ratio within the threshold of the one of the whole hard cluster
+        const size_t hardClustersCount = clustersCount;
+
+        for(size_t c = 0; c < hardClustersCount; ++c)
+        {
+                const uint32_t first = clusters[c].firstTriangle;
+                const uint32_t end = first + clusters[c].trianglesCount;
+                size_t clusterMisses = 0;
+
+                memset(cache.indices, 0xFF, sizeof(cache.indices));
+                cache.nextEntry = 0;
+
+                for(uint32_t t = first; t < end; ++t)
+                        clusterMisses += mnkt_mesh_simulateTriangle(&cache, &indices[(size_t) t * 3]);
+
+                const float maxRatio = threshold * (float) clusterMisses / (float) (end - first);
+                uint32_t start = first;
+                size_t misses = 0;
+
+                memset(cache.indices, 0xFF, sizeof(cache.indices));
+                cache.nextEntry = 0;
+
+                for(uint32_t t = first; t < end; ++t)
+                {
+                        misses += mnkt_mesh_simulateTriangle(&cache, &indices[(size_t) t * 3]);
+
+                        if(t + 1 < end && (float) misses <= maxRatio * (float) (t + 1 - start))
+                        {
+                                // The first part keeps the slot of the hard cluster, the following ones are appended
+                                MeshCluster_t* cluster = start == first ? &clusters[c] : &clusters[clustersCount++];
+
+                                cluster->firstTriangle = start;
+                                cluster->trianglesCount = t + 1 - start;
+
+                                start = t + 1;
+                                misses = 0;
+
+                                memset(cache.indices, 0xFF, sizeof(cache.indices));
+                                cache.nextEntry = 0;
+                        }
+                }
+
+                MeshCluster_t* cluster = start == first ? &clusters[c] : &clusters[clustersCount++];
+
+                cluster->firstTriangle = start;
+                cluster->trianglesCount = end - start;
+        }
+
+        // Center of the mesh (average of the triangles' centroids weighted by their area)
+        Vec3_t meshCenter = { .x = 0.0f, .y = 0.0f, .z = 0.0f };
+        float meshArea = 0.0f;
+
+        for(size_t t = 0; t < trianglesCount; ++t)
+        {
+                Vec3_t centroid;
+                Vec3_t normal = mnkt_mesh_triangleNormal(vertices, vertexSize, &indices[t * 3], &centroid);
+                float area = sqrtf( mnkt_vec3_dot(&normal, &normal) );
+
+                centroid = mnkt_vec3_mul(&centroid, area);
+                meshCenter = mnkt_vec3_add(&meshCenter, &centroid);
+                meshArea += area;
+        }
+
+        if(meshArea > 0.0f)
+                meshCenter = mnkt_vec3_div(&meshCenter, meshArea);
+
+        // Clusters whose average normal points away from the center are more likely to occlude the others
+        for(size_t c = 0; c < clustersCount; ++c)
+        {
+                MeshCluster_t* cluster = &clusters[c];
+                Vec3_t clusterCenter = { .x = 0.0f, .y = 0.0f, .z = 0.0f };
+                Vec3_t clusterNormal = { .x = 0.0f, .y = 0.0f, .z = 0.0f };
+                float clusterArea = 0.0f;
+
+                for(uint32_t t = cluster->firstTriangle; t < cluster->firstTriangle + cluster->trianglesCount; ++t)
+                {
+                        Vec3_t centroid;
+                        Vec3_t normal = mnkt_mesh_triangleNormal(vertices, vertexSize, &indices[t * 3], &centroid);
+                        float area = sqrtf( mnkt_vec3_dot(&normal, &normal) );
+
+                        centroid = mnkt_vec3_mul(&centroid, area);
+                        clusterCenter = mnkt_vec3_add(&clusterCenter, &centroid);
+                        clusterNormal = mnkt_vec3_add(&clusterNormal, &normal);
+                        clusterArea += area;
+                }
+
+                float normalLength = sqrtf( mnkt_vec3_dot(&clusterNormal, &clusterNormal) );
+                cluster->sortKey = 0.0f;
+
+                if(clusterArea > 0.0f && normalLength > 0.0f)
+                {
+                        clusterCenter = mnkt_vec3_div(&clusterCenter, clusterArea);
+                        clusterNormal = mnkt_vec3_div(&clusterNormal, normalLength);
+
+                        Vec3_t offset = {
+                                .x = clusterCenter.x - meshCenter.x,
+                                .y = clusterCenter.y - meshCenter.y,
+                                .z = clusterCenter.z - meshCenter.z
+                        };
+
+                        cluster->sortKey = mnkt_vec3_dot(&offset, &clusterNormal);
+                }
+        }
+
+        qsort(clusters, clustersCount, sizeof(MeshCluster_t), mnkt_mesh_compareClusters);
+
+        size_t written = 0;
+
+        for(size_t c = 0; c < clustersCount; ++c)
+        {
+                memcpy(&result[written], &indices[(size_t) clusters[c].firstTriangle * 3], sizeof(uint32_t) * clusters[c].trianglesCount * 3);
+                written += (size_t) clusters[c].trianglesCount * 3;
+        }
+
+        memcpy(indices, result, sizeof(uint32_t) * written);
+
+        free(clusters);
+        free(result);
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_optimizeVertexFetch
+ * Reorders the vertices in the order in which they are first referenced by the indices (which are updated accordingly),
+ * vertices that are never referenced are removed
+ * @param vertices Vertices of the mesh (reordered in place)
+ * @param verticesCount Number of vertices
+ * @param vertexSize Size in bytes of a vertex
+ * @param indices Indices of the vertices (updated in place)
+ * @param indicesCount Number of indices
+ * @return The number of vertices left (verticesCount if the vertices could not be reordered)
+*/
+size_t mnkt_mesh_optimizeVertexFetch(void* vertices, size_t verticesCount, uint32_t vertexSize, uint32_t* indices, size_t indicesCount)
+{
+        if(vertices == NULL || indices == NULL)
+                return verticesCount;
+
+        for(size_t i = 0; i < indicesCount; ++i)
+        {
+                if(indices[i] >= verticesCount)
+                        return verticesCount;
+        }
+
+        uint32_t* remap = malloc(sizeof(uint32_t) * verticesCount);
+        unsigned char* reordered = malloc((size_t) vertexSize * verticesCount);
+
+        if(remap == NULL || reordered == NULL)
+        {
+                free(remap);
+                free(reordered);
+                return verticesCount;
+        }
+
+        memset(remap, 0xFF, sizeof(uint32_t) * verticesCount);
+
+        uint32_t newCount = 0;
+
+        for(size_t i = 0; i < indicesCount; ++i)
+        {
+                uint32_t v = indices[i];
+
+                if(remap[v] == UINT32_MAX)
+                {
+                        memcpy(reordered + ((size_t) newCount * vertexSize), (unsigned char*) vertices + ((size_t) v * vertexSize), vertexSize);
+                        remap[v] = newCount++;
+                }
+
+                indices[i] = remap[v];
+        }
+
+        memcpy(vertices, reordered, (size_t) newCount * vertexSize);
+
+        free(remap);
+        free(reordered);
+
+        return newCount;
+}
+
+
+/**
+ * @function mnkt_mesh_optimize
+ * Runs all the optimizations on a mesh: vertex cache, overdraw (with a threshold of 1.05) and vertex fetch
+ * @param mesh The mesh to be optimized (mapped meshes are optimized in their private mapping)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_optimize(Mesh_t* mesh)
+{
+        if(mesh == NULL)
+                return 1;
+
+        if( mnkt_mesh_optimizeVertexCache(mesh->indices, mesh->indicesCount, mesh->verticesCount) )
+                return 1;
+
+        if( mnkt_mesh_optimizeOverdraw(mesh->indices, mesh->indicesCount, mesh->vertices, mesh->verticesCount, mesh->vertexSize, 1.05f) )
+                return 1;
+
+        mesh->verticesCount = (uint32_t) mnkt_mesh_optimizeVertexFetch(mesh->vertices, mesh->verticesCount, mesh->vertexSize, mesh->indices, mesh->indicesCount);
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_cacheMissRatio
+ * Computes the average number of vertices processed for each triangle by mnkt_drawIndexed (ACMR),
+ * simulating its post transform cache
+ * @param indices Indices of the vertices, grouped three by three to form triangles
+ * @param indicesCount Number of indices
+ * @return The average number of cache misses per triangle, in the range [0.5, 3] for closed meshes (zero if there are no triangles)
+*/
+float mnkt_mesh_cacheMissRatio(const uint32_t* indices, size_t indicesCount)
+{
+        const size_t trianglesCount = indicesCount / 3;
+
+        if(indices == NULL || trianglesCount == 0)
+                return 0.0f;
+
+        SimulatedCache_t cache;
+        size_t misses = 0;
+
+        memset(cache.indices, 0xFF, sizeof(cache.indices));
+        cache.nextEntry = 0;
+
+        for(size_t t = 0; t < trianglesCount; ++t)
+                misses += mnkt_mesh_simulateTriangle(&cache, &indices[t * 3]);
+
+        return (float) misses / (float) trianglesCount;
+}
+
+
+/**
+ * @function mnkt_mesh_forsythScore
+ * Computes the score of a vertex, the higher the score the sooner the triangles that use it should be drawn
+ * @param cachePosition Position of the vertex in the simulated LRU cache (-1 if not cached)
+ * @param remainingTriangles Number of triangles not yet emitted that use the vertex
+ * @param cacheScores Scores of the positions in the cache
+ * @param valenceScores Scores of the numbers of remaining triangles
+ * @return The score of the vertex
+ * @note: For internal usage only!!!
+*/
+static float mnkt_mesh_forsythScore(int32_t cachePosition, uint32_t remainingTriangles, const float* cacheScores, const float* valenceScores)
+{
+        // Vertices without triangles left do not contribute to any triangle
+        if(remainingTriangles == 0)
+                return -1.0f;
+
+        float score = cachePosition >= 0 ? cacheScores[cachePosition] : 0.0f;
+
+        // Vertices with few triangles left are preferred, so that they can leave the cache sooner
+        if(remainingTriangles < MNKT_FORSYTH_MAX_VALENCE)
+                return score + valenceScores[remainingTriangles];
+
+        return score + (2.0f / sqrtf((float) remainingTriangles));
+}
+
+
+/**
+ * @function mnkt_mesh_simulateTriangle
+ * Simulates the fetch of the vertices of a triangle by the post transform cache of mnkt_drawIndexed
+ * @param cache The simulated cache
+ * @param triangle Indices of the vertices of the triangle
+ * @return The number of vertices that missed the cache
+ * @note: For internal usage only!!!
+*/
+static uint32_t mnkt_mesh_simulateTriangle(SimulatedCache_t* cache, const uint32_t* triangle)
+{
+        uint32_t misses = 0;
+
+        for(int corner = 0; corner < 3; ++corner)
+        {
+                int hit = 0;
+
+                for(uint32_t i = 0; i < MNKT_VERTEX_CACHE_SIZE && !hit; ++i)
+                        hit = (cache->indices[i] == triangle[corner]);
+
+                if(hit)
+                        continue;
+
+                // Entries that hold the other vertices of the same triangle are never replaced
+                uint32_t entry = cache->nextEntry;
+
+                while(cache->indices[entry] == triangle[0] || cache->indices[entry] == triangle[1] || cache->indices[entry] == triangle[2])
+                        entry = (entry + 1) % MNKT_VERTEX_CACHE_SIZE;
+
+                cache->nextEntry = (entry + 1) % MNKT_VERTEX_CACHE_SIZE;
+                cache->indices[entry] = triangle[corner];
+                ++misses;
+        }
+
+        return misses;
+}
+
+
+/**
+ * @function mnkt_mesh_triangleNormal
+ * Computes the centroid of a triangle and its normal scaled by its area
+ * @param vertices Vertices of the mesh, each one starts with its position
+ * @param vertexSize Size in bytes of a vertex
+ * @param triangle Indices of the vertices of the triangle
+ * @param centroid Where the centroid of the triangle is stored
+ * @return The normal of the triangle, whose length is equal to the area of the triangle
+ * @note: For internal usage only!!!
+*/
+static Vec3_t mnkt_mesh_triangleNormal(const unsigned char* vertices, uint32_t vertexSize, const uint32_t* triangle, Vec3_t* centroid)
+{
+        Vec3_t positions[3];
+
+        for(int j = 0; j < 3; ++j)
+                memcpy(&positions[j], vertices + ((size_t) triangle[j] * vertexSize), sizeof(Vec3_t));
+
+        centroid->x = (positions[0].x + positions[1].x + positions[2].x) / 3.0f;
+        centroid->y = (positions[0].y + positions[1].y + positions[2].y) / 3.0f;
+        centroid->z = (positions[0].z + positions[1].z + positions[2].z) / 3.0f;
+
+        Vec3_t edgeA = { .x = positions[1].x - positions[0].x, .y = positions[1].y - positions[0].y, .z = positions[1].z - positions[0].z };
+        Vec3_t edgeB = { .x = positions[2].x - positions[0].x, .y = positions[2].y - positions[0].y, .z = positions[2].z - positions[0].z };
+
+        Vec3_t normal = mnkt_vec3_cross(&edgeA, &edgeB);
+        return mnkt_vec3_mul(&normal, 0.5f);
+}
+
+
+/**
+ * @function mnkt_mesh_compareClusters
+ * Comparison function used to sort the clusters by decreasing sort key (ties keep the original order)
+ * @param a First cluster
+ * @param b Second cluster
+ * @return Negative if a must be drawn before b, positive otherwise
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_compareClusters(const void* a, const void* b)
+{
+        const MeshCluster_t* clusterA = a;
+        const MeshCluster_t* clusterB = b;
+
+        if(clusterA->sortKey != clusterB->sortKey)
+                return clusterA->sortKey > clusterB->sortKey ? -1 : 1;
+
+        return clusterA->firstTriangle < clusterB->firstTriangle ? -1 : 1;
+}
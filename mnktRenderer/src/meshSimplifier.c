@@ -0,0 +1,759 @@
+/**
+ * @file meshSimplifier.c
+ *
+ * Contains implementation of the mesh simplification and levels of detail functions
+*/
+
+#include "meshSimplifier.h"
+
+#include "meshOptimizer.h"
+#include "math/vec.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @macro MNKT_BORDER_WEIGHT
+ * Weight of the planes that keep the borders in place, relative to the planes of the triangles
+*/
+#define MNKT_BORDER_WEIGHT              10.0
+
+
+/**
+ * @struct Quadric_t
+ * Quadric error metric: sum of the squared distances from a set of weighted planes (symmetric matrix A, vector b and constant c)
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        double          a00, a01, a02, a11, a12, a22;   ///< Upper triangle of the matrix
+        double          b0, b1, b2;                     ///< Linear term
+        double          c;                              ///< Constant term
+        double          weight;                         ///< Sum of the weights of the planes
+} Quadric_t;
+
+
+/**
+ * @struct EdgeCollapse_t
+ * Candidate collapse of a vertex onto another one
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        float           cost;                   ///< Squared error introduced by the collapse
+        uint32_t        from;                   ///< Vertex removed by the collapse
+        uint32_t        to;                     ///< Vertex that takes the place of the removed one
+} EdgeCollapse_t;
+
+
+/**
+ * @struct SortedPosition_t
+ * Position of a vertex, used to find the vertices that share the same position
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        Vec3_t          position;               ///< Position of the vertex
+        uint32_t        index;                  ///< Index of the vertex
+} SortedPosition_t;
+
+
+/**
+ * @enum VertexKind_t
+ * Which collapses are allowed for a vertex
+ * @note: For internal usage only!!!
+*/
+typedef enum {
+        MNKT_VERTEX_INTERIOR = 0,               ///< The vertex can collapse along any edge
+        MNKT_VERTEX_BORDER,                     ///< The vertex can collapse only along border edges
+        MNKT_VERTEX_LOCKED                      ///< The vertex can not collapse (attribute seams and non manifold edges)
+} VertexKind_t;
+
+
+// Prototypes for internal functions
+
+static void     mnkt_quadric_addPlane(Quadric_t* quadric, const Vec3_t* normal, const Vec3_t* point, double weight);
+static void     mnkt_quadric_add(Quadric_t* quadric, const Quadric_t* other);
+static double   mnkt_quadric_error(const Quadric_t* quadric, const Vec3_t* point);
+static uint64_t mnkt_mesh_edgeKey(uint32_t a, uint32_t b);
+static void     mnkt_mesh_buildAdjacency(const uint32_t* indices, size_t indicesCount, size_t verticesCount, uint32_t* offsets, uint32_t* adjacency);
+static Vec3_t   mnkt_mesh_faceNormal(const Vec3_t* a, const Vec3_t* b, const Vec3_t* c);
+static int      mnkt_mesh_collapseFlips(const Vec3_t* positions, const uint32_t* indices, const uint32_t* triangles, uint32_t trianglesCount, uint32_t from, uint32_t to);
+static int      mnkt_mesh_compareEdges(const void* a, const void* b);
+static int      mnkt_mesh_compareCollapses(const void* a, const void* b);
+static int      mnkt_mesh_comparePositions(const void* a, const void* b);
+
+
+/**
+ * @function mnkt_mesh_simplify
+ * Reduces the number of triangles of a mesh by collapsing its edges in order of increasing quadric error.
+ * Vertices are never moved nor created: the mesh keeps its vertices and only the indices change.
+ * Borders are collapsed only along themselves and vertices on attribute seams (same position, different attributes) are kept.
+ * @param indices Indices of the vertices, grouped three by three to form triangles (replaced by the simplified triangles)
+ * @param indicesCount Number of indices
+ * @param vertices Vertices of the mesh, each one starts with its position (3 floats)
+ * @param verticesCount Number of vertices
+ * @param vertexSize Size in bytes of a vertex
+ * @param targetIndicesCount Number of indices below which the simplification stops
+ * @param maxError Maximum error allowed for a collapse, in the units of the vertices (FLT_MAX for no limit)
+ * @param error Where the error of the simplified mesh is stored (can be NULL)
+ * @return The number of indices of the simplified mesh (indicesCount if the mesh could not be simplified)
+*/
+size_t mnkt_mesh_simplify(uint32_t* indices, size_t indicesCount, const void* vertices, size_t verticesCount, uint32_t vertexSize,
+                          size_t targetIndicesCount, float maxError, float* error)
+{
+        if(error != NULL)
+                *error = 0.0f;
+
+        if(indices == NULL || vertices == NULL || vertexSize < sizeof(Vec3_t) || indicesCount < 3 || indicesCount / 3 > UINT32_MAX / 3)
+                return indicesCount;
+
+        for(size_t i = 0; i < indicesCount; ++i)
+        {
+                if(indices[i] >= verticesCount)
+                        return indicesCount;
+        }
+
+        const size_t trianglesCount = indicesCount / 3;
+
+        Vec3_t* positions = malloc(verticesCount * sizeof(Vec3_t));
+        Quadric_t* quadrics = calloc(verticesCount, sizeof(Quadric_t));
+        uint8_t* seams = calloc(verticesCount, sizeof(uint8_t));
+        uint8_t* kinds = malloc(verticesCount * sizeof(uint8_t));
+        uint8_t* locked = malloc(verticesCount * sizeof(uint8_t));
+        uint32_t* remap = malloc(verticesCount * sizeof(uint32_t));
+        uint32_t* adjacencyOffsets = malloc((verticesCount + 1) * sizeof(uint32_t));
+        uint32_t* adjacency = malloc(trianglesCount * 3 * sizeof(uint32_t));
+        uint64_t* edges = malloc(trianglesCount * 3 * sizeof(uint64_t));
+        EdgeCollapse_t* collapses = malloc(trianglesCount * 3 * sizeof(EdgeCollapse_t));
+        SortedPosition_t* sorted = malloc(verticesCount * sizeof(SortedPosition_t));
+
+        if(positions == NULL || quadrics == NULL || seams == NULL || kinds == NULL || locked == NULL || remap == NULL ||
+           adjacencyOffsets == NULL || adjacency == NULL || edges == NULL || collapses == NULL || sorted == NULL)
+        {
+                free(positions); free(quadrics); free(seams); free(kinds); free(locked); free(remap);
+                free(adjacencyOffsets); free(adjacency); free(edges); free(collapses); free(sorted);
+
+                return indicesCount;
+        }
+
+        for(size_t v = 0; v < verticesCount; ++v)
+                memcpy(&positions[v], (const unsigned char*) vertices + (v * vertexSize), sizeof(Vec3_t));
+
+        // Referenced vertices (marked in the locked flags, free until the first pass) that share their position with others lie on an attribute seam
+        memset(locked, 0, verticesCount);
+
+        for(size_t i = 0; i < trianglesCount * 3; ++i)
+                locked[indices[i]] = 1;
+
+        size_t sortedCount = 0;
+
+        for(size_t v = 0; v < verticesCount; ++v)
+        {
+                if(locked[v])
+                        sorted[sortedCount++] = (SortedPosition_t) { .position = positions[v], .index = (uint32_t) v };
+        }
+
+        qsort(sorted, sortedCount, sizeof(SortedPosition_t), mnkt_mesh_comparePositions);
+
+        for(size_t i = 1; i < sortedCount; ++i)
+        {
+                if( mnkt_mesh_comparePositions(&sorted[i - 1], &sorted[i]) == 0 )
+                {
+                        seams[sorted[i - 1].index] = 1;
+                        seams[sorted[i].index] = 1;
+                }
+        }
+
+        free(sorted);
+
+        // Each vertex starts with the planes of its triangles, weighted by their area
+        for(size_t t = 0; t < trianglesCount; ++t)
+        {
+                const uint32_t* triangle = &indices[t * 3];
+                Vec3_t normal = mnkt_mesh_faceNormal(&positions[triangle[0]], &positions[triangle[1]], &positions[triangle[2]]);
+                float length = sqrtf( mnkt_vec3_dot(&normal, &normal) );
+
+                if(length <= 0.0f)
+                        continue;
+
+                normal = (Vec3_t) { .x = normal.x / length, .y = normal.y / length, .z = normal.z / length };
+
+                for(int j = 0; j < 3; ++j)
+                        mnkt_quadric_addPlane(&quadrics[triangle[j]], &normal, &positions[triangle[0]], length * 0.5);
+        }
+
+        // Border edges (shared by a single triangle) add the plane orthogonal to their triangle, so that the outline of the mesh is preserved
+        mnkt_mesh_buildAdjacency(indices, trianglesCount * 3, verticesCount, adjacencyOffsets, adjacency);
+
+        for(size_t t = 0; t < trianglesCount; ++t)
+        {
+                const uint32_t* triangle = &indices[t * 3];
+                Vec3_t normal = mnkt_mesh_faceNormal(&positions[triangle[0]], &positions[triangle[1]], &positions[triangle[2]]);
+
+                for(int j = 0; j < 3; ++j)
+                {
+                        const uint32_t a = triangle[j];
+                        const uint32_t b = triangle[(j + 1) % 3];
+                        uint32_t sharedCount = 0;
+
+                        for(uint32_t k = adjacencyOffsets[a]; k < adjacencyOffsets[a + 1]; ++k)
+                        {
+                                const uint32_t* other = &indices[(size_t) adjacency[k] * 3];
+                                sharedCount += (other[0] == b || other[1] == b || other[2] == b);
+                        }
+
+                        if(sharedCount != 1)
+                                continue;
+
+                        Vec3_t edge = { .x = positions[b].x - positions[a].x, .y = positions[b].y - positions[a].y, .z = positions[b].z - positions[a].z };
+                        Vec3_t borderNormal = mnkt_vec3_cross(&edge, &normal);
+                        float length = sqrtf( mnkt_vec3_dot(&borderNormal, &borderNormal) );
+
+                        if(length <= 0.0f)
+                                continue;
+
+                        borderNormal = (Vec3_t) { .x = borderNormal.x / length, .y = borderNormal.y / length, .z = borderNormal.z / length };
+
+                        const double weight = MNKT_BORDER_WEIGHT * mnkt_vec3_dot(&edge, &edge);
+
+                        mnkt_quadric_addPlane(&quadrics[a], &borderNormal, &positions[a], weight);
+                        mnkt_quadric_addPlane(&quadrics[b], &borderNormal, &positions[a], weight);
+                }
+        }
+
+        const double maxCost = (double) maxError * (double) maxError;
+        double resultCost = 0.0;
+        size_t currentCount = trianglesCount * 3;
+
+        // Each pass collapses the cheapest edges whose neighbourhoods do not overlap, then the triangles are rebuilt
+        while(currentCount > targetIndicesCount)
+        {
+                const size_t currentTriangles = currentCount / 3;
+
+                for(size_t i = 0; i < currentCount; ++i)
+                        edges[i] = mnkt_mesh_edgeKey(indices[i], indices[(i % 3 == 2) ? i - 2 : i + 1]);
+
+                qsort(edges, currentCount, sizeof(uint64_t), mnkt_mesh_compareEdges);
+
+                for(size_t v = 0; v < verticesCount; ++v)
+                        kinds[v] = seams[v] ? MNKT_VERTEX_LOCKED : MNKT_VERTEX_INTERIOR;
+
+                // Classify the vertices from the number of triangles that share each of their edges
+                for(size_t i = 0; i < currentCount; )
+                {
+                        size_t count = 1;
+
+                        while(i + count < currentCount && edges[i + count] == edges[i])
+                                ++count;
+
+                        const uint32_t a = (uint32_t) (edges[i] >> 32);
+                        const uint32_t b = (uint32_t) edges[i];
+
+                        for(int j = 0; j < 2; ++j)
+                        {
+                                const uint32_t v = (j == 0) ? a : b;
+
+                                if(count > 2)
+                                        kinds[v] = MNKT_VERTEX_LOCKED;
+                                else if(count == 1 && kinds[v] == MNKT_VERTEX_INTERIOR)
+                                        kinds[v] = MNKT_VERTEX_BORDER;
+                        }
+
+                        i += count;
+                }
+
+                mnkt_mesh_buildAdjacency(indices, currentCount, verticesCount, adjacencyOffsets, adjacency);
+
+                // Cheapest direction of each edge, among the allowed ones
+                size_t collapsesCount = 0;
+
+                for(size_t i = 0; i < currentCount; )
+                {
+                        size_t count = 1;
+
+                        while(i + count < currentCount && edges[i + count] == edges[i])
+                                ++count;
+
+                        const uint32_t ends[2] = { (uint32_t) (edges[i] >> 32), (uint32_t) edges[i] };
+                        EdgeCollapse_t best = { .cost = FLT_MAX, .from = UINT32_MAX, .to = UINT32_MAX };
+
+                        for(int j = 0; j < 2 && count <= 2 && ends[0] != ends[1]; ++j)
+                        {
+                                const uint32_t from = ends[j];
+                                const uint32_t to = ends[1 - j];
+
+                                if( kinds[from] == MNKT_VERTEX_LOCKED || (kinds[from] == MNKT_VERTEX_BORDER && count != 1) )
+                                        continue;
+
+                                Quadric_t quadric = quadrics[from];
+                                mnkt_quadric_add(&quadric, &quadrics[to]);
+
+                                const float cost = (float) mnkt_quadric_error(&quadric, &positions[to]);
+
+                                if(cost < best.cost)
+                                        best = (EdgeCollapse_t) { .cost = cost, .from = from, .to = to };
+                        }
+
+                        if(best.from != UINT32_MAX)
+                                collapses[collapsesCount++] = best;
+
+                        i += count;
+                }
+
+                qsort(collapses, collapsesCount, sizeof(EdgeCollapse_t), mnkt_mesh_compareCollapses);
+
+                memset(locked, 0, verticesCount);
+
+                for(size_t v = 0; v < verticesCount; ++v)
+                        remap[v] = (uint32_t) v;
+
+                size_t remainingTriangles = currentTriangles;
+                size_t appliedCount = 0;
+
+                for(size_t c = 0; c < collapsesCount && remainingTriangles * 3 > targetIndicesCount; ++c)
+                {
+                        const EdgeCollapse_t* collapse = &collapses[c];
+
+                        if((double) collapse->cost > maxCost)
+                                break;
+
+                        if(locked[collapse->from] || locked[collapse->to])
+                                continue;
+
+                        const uint32_t* triangles = &adjacency[adjacencyOffsets[collapse->from]];
+                        const uint32_t trianglesAround = adjacencyOffsets[collapse->from + 1] - adjacencyOffsets[collapse->from];
+
+                        if( mnkt_mesh_collapseFlips(positions, indices, triangles, trianglesAround, collapse->from, collapse->to) )
+                                continue;
+
+                        remap[collapse->from] = collapse->to;
+                        mnkt_quadric_add(&quadrics[collapse->to], &quadrics[collapse->from]);
+
+                        // The neighbourhood of the removed vertex changes, so its vertices wait for the next pass
+                        for(uint32_t t = 0; t < trianglesAround; ++t)
+                        {
+                                const uint32_t* triangle = &indices[(size_t) triangles[t] * 3];
+
+                                if(triangle[0] == collapse->to || triangle[1] == collapse->to || triangle[2] == collapse->to)
+                                        --remainingTriangles;
+
+                                locked[triangle[0]] = locked[triangle[1]] = locked[triangle[2]] = 1;
+                        }
+
+                        locked[collapse->to] = 1;
+
+                        if((double) collapse->cost > resultCost)
+                                resultCost = collapse->cost;
+
+                        ++appliedCount;
+                }
+
+                if(appliedCount == 0)
+                        break;
+
+                // Rebuild the triangles, dropping the ones that became degenerate
+                size_t written = 0;
+
+                for(size_t t = 0; t < currentTriangles; ++t)
+                {
+                        const uint32_t a = remap[indices[t * 3]];
+                        const uint32_t b = remap[indices[t * 3 + 1]];
+                        const uint32_t c = remap[indices[t * 3 + 2]];
+
+                        if(a == b || b == c || a == c)
+                                continue;
+
+                        indices[written++] = a;
+                        indices[written++] = b;
+                        indices[written++] = c;
+                }
+
+                currentCount = written;
+        }
+
+        free(positions); free(quadrics); free(seams); free(kinds); free(locked); free(remap);
+        free(adjacencyOffsets); free(adjacency); free(edges); free(collapses);
+
+        if(error != NULL)
+                *error = (float) sqrt(resultCost);
+
+        return currentCount;
+}
+
+
+/**
+ * @function mnkt_mesh_buildLods
+ * Builds a chain of levels of detail of a mesh, each level is simplified from the previous one
+ * until the given number of levels is reached or the mesh can not be simplified any further
+ * @param mesh The mesh (its triangles form the full detail level)
+ * @param levelsCount Maximum number of levels (up to MNKT_MESH_MAX_LODS)
+ * @param reduction Ratio between the number of triangles of a level and the previous one (e.g. 0.5)
+ * @param lods Where the chain is stored (must be released with mnkt_mesh_destroyLods)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_buildLods(const Mesh_t* mesh, uint32_t levelsCount, float reduction, MeshLods_t* lods)
+{
+        if(lods == NULL)
+                return 1;
+
+        memset(lods, 0, sizeof(MeshLods_t));
+
+        if(mesh == NULL || mesh->indices == NULL || mesh->vertices == NULL || levelsCount == 0 || !(reduction > 0.0f && reduction < 1.0f))
+                return 1;
+
+        if(levelsCount > MNKT_MESH_MAX_LODS)
+                levelsCount = MNKT_MESH_MAX_LODS;
+
+        const size_t indicesCount = mesh->indicesCount - (mesh->indicesCount % 3);
+
+        lods->indices = malloc((indicesCount > 0 ? indicesCount : 1) * sizeof(uint32_t));
+        uint32_t* scratch = malloc((indicesCount > 0 ? indicesCount : 1) * sizeof(uint32_t));
+
+        if(lods->indices == NULL || scratch == NULL)
+        {
+                free(scratch);
+                mnkt_mesh_destroyLods(lods);
+
+                return 1;
+        }
+
+        memcpy(lods->indices, mesh->indices, indicesCount * sizeof(uint32_t));
+        memcpy(scratch, mesh->indices, indicesCount * sizeof(uint32_t));
+
+        lods->levels[0] = (MeshLod_t) { .indexOffset = 0, .indicesCount = (uint32_t) indicesCount, .error = 0.0f };
+        lods->levelsCount = 1;
+
+        size_t totalCount = indicesCount;
+        size_t previousCount = indicesCount;
+
+        while(lods->levelsCount < levelsCount)
+        {
+                const size_t targetCount = (size_t) ((float) (previousCount / 3) * reduction) * 3;
+                float levelError;
+
+                // Levels are simplified from the previous one, so their errors add up
+                const size_t levelCount = mnkt_mesh_simplify(scratch, previousCount, mesh->vertices, mesh->verticesCount, mesh->vertexSize, targetCount, FLT_MAX, &levelError);
+
+                if(levelCount == 0 || levelCount >= previousCount)
+                        break;
+
+                uint32_t* grown = realloc(lods->indices, (totalCount + levelCount) * sizeof(uint32_t));
+
+                if(grown == NULL)
+                        break;
+
+                lods->indices = grown;
+                memcpy(&lods->indices[totalCount], scratch, levelCount * sizeof(uint32_t));
+                mnkt_mesh_optimizeVertexCache(&lods->indices[totalCount], levelCount, mesh->verticesCount);
+
+                lods->levels[lods->levelsCount] = (MeshLod_t) {
+                        .indexOffset = (uint32_t) totalCount,
+                        .indicesCount = (uint32_t) levelCount,
+                        .error = lods->levels[lods->levelsCount - 1].error + levelError
+                };
+
+                ++lods->levelsCount;
+                totalCount += levelCount;
+                previousCount = levelCount;
+        }
+
+        free(scratch);
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_destroyLods
+ * Releases the data of a chain of levels of detail
+ * @param lods The chain to be released
+*/
+void mnkt_mesh_destroyLods(MeshLods_t* lods)
+{
+        if(lods == NULL)
+                return;
+
+        free(lods->indices);
+        memset(lods, 0, sizeof(MeshLods_t));
+}
+
+
+/**
+ * @function mnkt_mesh_selectLod
+ * Selects the coarsest level of detail whose error, projected on the viewport of the framebuffer, is not larger than the given one
+ * @param lods The chain of levels of detail
+ * @param projection Projection matrix used to draw the mesh (perspective or orthographic)
+ * @param distance Distance between the camera and the closest point of the mesh bounds, in the units of the vertices
+ * @param maxPixelError Maximum error allowed on screen, expressed in pixels (e.g. 1.0f)
+ * @param fb Framebuffer on which the mesh is drawn
+ * @return The index of the selected level (zero if the full detail level is needed)
+*/
+uint32_t mnkt_mesh_selectLod(const MeshLods_t* lods, const Mat4_t* projection, float distance, float maxPixelError, const Framebuffer_t* fb)
+{
+        if(lods == NULL || projection == NULL || fb == NULL)
+                return 0;
+
+        // Pixels covered by a unit length along the vertical axis of the viewport
+        float pixelsPerUnit = projection->m[5] * fb->viewport.height * 0.5f;
+
+        // Perspective projections (w depends on the depth) shrink the error with the distance
+        if(projection->m[11] != 0.0f)
+        {
+                if(distance <= 0.0f)
+                        return 0;
+
+                pixelsPerUnit /= distance;
+        }
+
+        uint32_t selected = 0;
+
+        while(selected + 1 < lods->levelsCount && lods->levels[selected + 1].error * fabsf(pixelsPerUnit) <= maxPixelError)
+                ++selected;
+
+        return selected;
+}
+
+
+/**
+ * @function mnkt_quadric_addPlane
+ * Adds a weighted plane to a quadric
+ * @param quadric The quadric
+ * @param normal Unit normal of the plane
+ * @param point A point of the plane
+ * @param weight Weight of the plane
+ * @note: For internal usage only!!!
+*/
+static void mnkt_quadric_addPlane(Quadric_t* quadric, const Vec3_t* normal, const Vec3_t* point, double weight)
+{
+        const double a = normal->x, b = normal->y, c = normal->z;
+        const double d = -((a * point->x) + (b * point->y) + (c * point->z));
+
+        quadric->a00 += weight * a * a;
+        quadric->a01 += weight * a * b;
+        quadric->a02 += weight * a * c;
+        quadric->a11 += weight * b * b;
+        quadric->a12 += weight * b * c;
+        quadric->a22 += weight * c * c;
+        quadric->b0 += weight * a * d;
+        quadric->b1 += weight * b * d;
+        quadric->b2 += weight * c * d;
+        quadric->c += weight * d * d;
+        quadric->weight += weight;
+}
+
+
+/**
+ * @function mnkt_quadric_add
+ * Adds a quadric to another one
+ * @param quadric The quadric that is updated
+ * @param other The quadric to be added
+ * @note: For internal usage only!!!
+*/
+static void mnkt_quadric_add(Quadric_t* quadric, const Quadric_t* other)
+{
+        quadric->a00 += other->a00;
+        quadric->a01 += other->a01;
+        quadric->a02 += other->a02;
+        quadric->a11 += other->a11;
+        quadric->a12 += other->a12;
+        quadric->a22 += other->a22;
+        quadric->b0 += other->b0;
+        quadric->b1 += other->b1;
+        quadric->b2 += other->b2;
+        quadric->c += other->c;
+        quadric->weight += other->weight;
+}
+
+
+/**
+ * @function mnkt_quadric_error
+ * Evaluates a quadric at a point
+ * @param quadric The quadric
+ * @param point The point
+ * @return The weighted average of the squared distances of the point from the planes of the quadric
+ * @note: For internal usage only!!!
+*/
+static double mnkt_quadric_error(const Quadric_t* quadric, const Vec3_t* point)
+{
+        const double x = point->x, y = point->y, z = point->z;
+
+        double error = (quadric->a00 * x * x) + (quadric->a11 * y * y) + (quadric->a22 * z * z) +
+                       2.0 * ( (quadric->a01 * x * y) + (quadric->a02 * x * z) + (quadric->a12 * y * z) ) +
+                       2.0 * ( (quadric->b0 * x) + (quadric->b1 * y) + (quadric->b2 * z) ) + quadric->c;
+
+        if(quadric->weight > 0.0)
+                error /= quadric->weight;
+
+        return fabs(error);
+}
+
+
+/**
+ * @function mnkt_mesh_edgeKey
+ * Computes the key of an edge, the same for both its directions
+ * @param a First vertex of the edge
+ * @param b Second vertex of the edge
+ * @return The key, with the smallest vertex in the upper half
+ * @note: For internal usage only!!!
+*/
+static uint64_t mnkt_mesh_edgeKey(uint32_t a, uint32_t b)
+{
+        return (a < b) ? (((uint64_t) a << 32) | b) : (((uint64_t) b << 32) | a);
+}
+
+
+/**
+ * @function mnkt_mesh_buildAdjacency
+ * Lists, for each vertex, the triangles that share it
+ * @param indices Indices of the vertices, grouped three by three to form triangles
+ * @param indicesCount Number of indices
+ * @param verticesCount Number of vertices
+ * @param offsets Where the index of the first triangle of each vertex inside the adjacency array is stored (verticesCount + 1 elements)
+ * @param adjacency Where the triangles of all the vertices are stored (indicesCount elements)
+ * @note: For internal usage only!!!
+*/
+static void mnkt_mesh_buildAdjacency(const uint32_t* indices, size_t indicesCount, size_t verticesCount, uint32_t* offsets, uint32_t* adjacency)
+{
+        memset(offsets, 0, (verticesCount + 1) * sizeof(uint32_t));
+
+        for(size_t i = 0; i < indicesCount; ++i)
+                ++offsets[indices[i] + 1];
+
+        for(size_t v = 0; v < verticesCount; ++v)
+                offsets[v + 1] += offsets[v];
+
+        // Fill the lists moving each offset forward, then move the offsets back to the start of their lists
+        for(size_t i = 0; i < indicesCount; ++i)
+                adjacency[offsets[indices[i]]++] = (uint32_t) (i / 3);
+
+        for(size_t v = verticesCount; v > 0; --v)
+                offsets[v] = offsets[v - 1];
+
+        offsets[0] = 0;
+}
+
+
+/**
+ * @function mnkt_mesh_faceNormal
+ * Computes the normal of a triangle
+ * @param a First vertex of the triangle
+ * @param b Second vertex of the triangle
+ * @param c Third vertex of the triangle
+ * @return The normal (not normalized, its length is twice the area of the triangle)
+ * @note: For internal usage only!!!
+*/
+static Vec3_t mnkt_mesh_faceNormal(const Vec3_t* a, const Vec3_t* b, const Vec3_t* c)
+{
+        Vec3_t edgeA = { .x = b->x - a->x, .y = b->y - a->y, .z = b->z - a->z };
+        Vec3_t edgeB = { .x = c->x - a->x, .y = c->y - a->y, .z = c->z - a->z };
+
+        return mnkt_vec3_cross(&edgeA, &edgeB);
+}
+
+
+/**
+ * @function mnkt_mesh_collapseFlips
+ * Checks if moving a vertex onto another one flips any of the triangles that survive the collapse
+ * @param positions Positions of the vertices
+ * @param indices Indices of the vertices of the mesh
+ * @param triangles Triangles that share the removed vertex
+ * @param trianglesCount Number of triangles that share the removed vertex
+ * @param from Vertex removed by the collapse
+ * @param to Vertex that takes the place of the removed one
+ * @return One if a triangle would be flipped, zero otherwise
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_collapseFlips(const Vec3_t* positions, const uint32_t* indices, const uint32_t* triangles, uint32_t trianglesCount, uint32_t from, uint32_t to)
+{
+        for(uint32_t t = 0; t < trianglesCount; ++t)
+        {
+                const uint32_t* triangle = &indices[(size_t) triangles[t] * 3];
+
+                // Triangles that share the collapsed edge disappear
+                if(triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                        continue;
+
+                Vec3_t corners[3] = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+                Vec3_t before = mnkt_mesh_faceNormal(&corners[0], &corners[1], &corners[2]);
+
+                for(int j = 0; j < 3; ++j)
+                {
+                        if(triangle[j] == from)
+                                corners[j] = positions[to];
+                }
+
+                Vec3_t after = mnkt_mesh_faceNormal(&corners[0], &corners[1], &corners[2]);
+
+                if( mnkt_vec3_dot(&before, &after) <= 0.0f )
+                        return 1;
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_mesh_compareEdges
+ * Comparison function used to sort the edges by their key (the two vertices, smallest first)
+ * @param a First edge
+ * @param b Second edge
+ * @return Negative if a comes before b, positive if it comes after, zero if they are the same edge
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_compareEdges(const void* a, const void* b)
+{
+        const uint64_t edgeA = *(const uint64_t*) a;
+        const uint64_t edgeB = *(const uint64_t*) b;
+
+        return (edgeA > edgeB) - (edgeA < edgeB);
+}
+
+
+/**
+ * @function mnkt_mesh_compareCollapses
+ * Comparison function used to sort the collapses by increasing cost (ties are sorted by vertex, so the order is deterministic)
+ * @param a First collapse
+ * @param b Second collapse
+ * @return Negative if a must be applied before b, positive otherwise
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_compareCollapses(const void* a, const void* b)
+{
+        const EdgeCollapse_t* collapseA = a;
+        const EdgeCollapse_t* collapseB = b;
+
+        if(collapseA->cost != collapseB->cost)
+                return collapseA->cost < collapseB->cost ? -1 : 1;
+
+        if(collapseA->from != collapseB->from)
+                return collapseA->from < collapseB->from ? -1 : 1;
+
+        return (collapseA->to > collapseB->to) - (collapseA->to < collapseB->to);
+}
+
+
+/**
+ * @function mnkt_mesh_comparePositions
+ * Comparison function used to sort the vertices by position
+ * @param a First vertex
+ * @param b Second vertex
+ * @return Negative if a comes before b, positive if it comes after, zero if they have the same position
+ * @note: For internal usage only!!!
+*/
+static int mnkt_mesh_comparePositions(const void* a, const void* b)
+{
+        const Vec3_t* positionA = &((const SortedPosition_t*) a)->position;
+        const Vec3_t* positionB = &((const SortedPosition_t*) b)->position;
+
+        if(positionA->x != positionB->x)
+                return positionA->x < positionB->x ? -1 : 1;
+
+        if(positionA->y != positionB->y)
+                return positionA->y < positionB->y ? -1 : 1;
+
+        if(positionA->z != positionB->z)
+                return positionA->z < positionB->z ? -1 : 1;
+
+        return 0;
+}
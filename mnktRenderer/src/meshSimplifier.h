@@ -0,0 +1,106 @@
+
+/**
+ * @file meshSimplifier.h
+ *
+ * Defines the functions that simplify indexed meshes (edge collapses driven by quadric error metrics)
+ * and build chains of levels of detail, together with the selection of the level to be drawn
+ * from the error that each level would produce on screen.
+ *
+ * Simplified levels reuse the vertices of the mesh: only the indices change, so all the levels
+ * can be drawn with mnkt_drawIndexed from the same vertex array.
+*/
+
+#ifndef MNKT_MESH_SIMPLIFIER_H
+#define MNKT_MESH_SIMPLIFIER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "mesh.h"
+#include "math/mat.h"
+#include "framebuffer.h"
+
+
+/**
+ * @macro MNKT_MESH_MAX_LODS
+ * Maximum number of levels of detail of a mesh (the full detail level included)
+*/
+#define MNKT_MESH_MAX_LODS              8
+
+
+/**
+ * @struct MeshLod_t
+ * Level of detail of a mesh, its triangles are stored in the indices array of the chain
+*/
+typedef struct {
+        uint32_t        indexOffset;            ///< Index of the first element of the level inside the indices of the chain
+        uint32_t        indicesCount;           ///< Number of indices of the level
+        float           error;                  ///< Maximum distance between the level and the full detail mesh, in the units of the vertices
+} MeshLod_t;
+
+
+/**
+ * @struct MeshLods_t
+ * Chain of levels of detail of a mesh, sorted from the full detail one to the coarsest one
+*/
+typedef struct {
+        uint32_t*       indices;                ///< Indices of all the levels, each level is optimized for the post transform cache
+        MeshLod_t       levels[MNKT_MESH_MAX_LODS];     ///< The levels of detail
+        uint32_t        levelsCount;            ///< Number of levels
+} MeshLods_t;
+
+
+/**
+ * @function mnkt_mesh_simplify
+ * Reduces the number of triangles of a mesh by collapsing its edges in order of increasing quadric error.
+ * Vertices are never moved nor created: the mesh keeps its vertices and only the indices change.
+ * Borders are collapsed only along themselves and vertices on attribute seams (same position, different attributes) are kept.
+ * @param indices Indices of the vertices, grouped three by three to form triangles (replaced by the simplified triangles)
+ * @param indicesCount Number of indices
+ * @param vertices Vertices of the mesh, each one starts with its position (3 floats)
+ * @param verticesCount Number of vertices
+ * @param vertexSize Size in bytes of a vertex
+ * @param targetIndicesCount Number of indices below which the simplification stops
+ * @param maxError Maximum error allowed for a collapse, in the units of the vertices (FLT_MAX for no limit)
+ * @param error Where the error of the simplified mesh is stored (can be NULL)
+ * @return The number of indices of the simplified mesh (indicesCount if the mesh could not be simplified)
+*/
+size_t mnkt_mesh_simplify(uint32_t* indices, size_t indicesCount, const void* vertices, size_t verticesCount, uint32_t vertexSize,
+                          size_t targetIndicesCount, float maxError, float* error);
+
+
+/**
+ * @function mnkt_mesh_buildLods
+ * Builds a chain of levels of detail of a mesh, each level is simplified from the previous one
+ * until the given number of levels is reached or the mesh can not be simplified any further
+ * @param mesh The mesh (its triangles form the full detail level)
+ * @param levelsCount Maximum number of levels (up to MNKT_MESH_MAX_LODS)
+ * @param reduction Ratio between the number of triangles of a level and the previous one (e.g. 0.5)
+ * @param lods Where the chain is stored (must be released with mnkt_mesh_destroyLods)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_mesh_buildLods(const Mesh_t* mesh, uint32_t levelsCount, float reduction, MeshLods_t* lods);
+
+
+/**
+ * @function mnkt_mesh_destroyLods
+ * Releases the data of a chain of levels of detail
+ * @param lods The chain to be released
+*/
+void mnkt_mesh_destroyLods(MeshLods_t* lods);
+
+
+/**
+ * @function mnkt_mesh_selectLod
+ * Selects the coarsest level of detail whose error, projected on the viewport of the framebuffer, is not larger than the given one
+ * @param lods The chain of levels of detail
+ * @param projection Projection matrix used to draw the mesh (perspective or orthographic)
+ * @param distance Distance between the camera and the closest point of the mesh bounds, in the units of the vertices
+ * @param maxPixelError Maximum error allowed on screen, expressed in pixels (e.g. 1.0f)
+ * @param fb Framebuffer on which the mesh is drawn
+ * @return The index of the selected level (zero if the full detail level is needed)
+*/
+uint32_t mnkt_mesh_selectLod(const MeshLods_t* lods, const Mat4_t* projection, float distance, float maxPixelError, const Framebuffer_t* fb);
+
+
+#endif // MNKT_MESH_SIMPLIFIER_H
@@ -0,0 +1,219 @@
+/**
+ * @file meshlet.c
+ *
+ * Contains implementation of the meshlets API
+*/
+
+#include "meshlet.h"
+
+#include "math/vec.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Prototypes for internal functions
+
+static void     mnkt_meshlets_computeBounds(Meshlet_t* meshlet, const Meshlets_t* meshlets, const unsigned char* vertices, uint32_t vertexSize);
+
+
+/**
+ * @function mnkt_meshlets_build
+ * Splits an indexed mesh into meshlets and computes their bounds and normal cones
+ * @param indices Indices of the vertices, grouped three by three to form triangles (triangles that refer to missing vertices are skipped)
+ * @param indicesCount Number of indices
+ * @param vertices Vertices of the mesh, each one starts with its position (3 floats)
+ * @param verticesCount Number of vertices
+ * @param vertexSize Size in bytes of a vertex
+ * @param meshlets Where the meshlets are stored (must be released with mnkt_meshlets_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_meshlets_build(const uint32_t* indices, size_t indicesCount, const void* vertices, size_t verticesCount, uint32_t vertexSize, Meshlets_t* meshlets)
+{
+        if(meshlets == NULL)
+                return 1;
+
+        memset(meshlets, 0, sizeof(Meshlets_t));
+
+        if(indices == NULL || vertices == NULL || vertexSize < sizeof(Vec3_t) || indicesCount / 3 > UINT32_MAX / 3)
+                return 1;
+
+        const size_t trianglesCount = indicesCount / 3;
+
+        // Worst case sizes, shrunk once the meshlets are built
+        meshlets->meshlets = malloc( (trianglesCount > 0 ? trianglesCount : 1) * sizeof(Meshlet_t) );
+        meshlets->vertexIndices = malloc( (trianglesCount > 0 ? trianglesCount * 3 : 1) * sizeof(uint32_t) );
+        meshlets->triangles = malloc( trianglesCount > 0 ? trianglesCount * 3 : 1 );
+
+        // Local index of each vertex inside the meshlet being built (UINT8_MAX if the vertex is not part of it)
+        uint8_t* localIndices = malloc(verticesCount > 0 ? verticesCount : 1);
+
+        if(meshlets->meshlets == NULL || meshlets->vertexIndices == NULL || meshlets->triangles == NULL || localIndices == NULL)
+        {
+                free(localIndices);
+                mnkt_meshlets_destroy(meshlets);
+
+                return 1;
+        }
+
+        memset(localIndices, UINT8_MAX, verticesCount);
+
+        Meshlet_t current = { 0 };
+
+        for(size_t t = 0; t < trianglesCount; ++t)
+        {
+                const uint32_t* triangle = &indices[t * 3];
+
+                if(triangle[0] >= verticesCount || triangle[1] >= verticesCount || triangle[2] >= verticesCount)
+                        continue;
+
+                uint32_t newVertices = (localIndices[triangle[0]] == UINT8_MAX) +
+                                       (localIndices[triangle[1]] == UINT8_MAX && triangle[1] != triangle[0]) +
+                                       (localIndices[triangle[2]] == UINT8_MAX && triangle[2] != triangle[0] && triangle[2] != triangle[1]);
+
+                // Close the current meshlet when the triangle does not fit into it
+                if(current.verticesCount + newVertices > MNKT_MESHLET_MAX_VERTICES || current.trianglesCount == MNKT_MESHLET_MAX_TRIANGLES)
+                {
+                        for(uint32_t v = 0; v < current.verticesCount; ++v)
+                                localIndices[meshlets->vertexIndices[current.vertexOffset + v]] = UINT8_MAX;
+
+                        meshlets->meshlets[meshlets->meshletsCount++] = current;
+
+                        current = (Meshlet_t) {
+                                .vertexOffset = current.vertexOffset + current.verticesCount,
+                                .triangleOffset = current.triangleOffset + current.trianglesCount
+                        };
+                }
+
+                uint8_t* localTriangle = &meshlets->triangles[(size_t) (current.triangleOffset + current.trianglesCount) * 3];
+
+                for(int j = 0; j < 3; ++j)
+                {
+                        if(localIndices[triangle[j]] == UINT8_MAX)
+                        {
+                                localIndices[triangle[j]] = (uint8_t) current.verticesCount;
+                                meshlets->vertexIndices[current.vertexOffset + current.verticesCount++] = triangle[j];
+                        }
+
+                        localTriangle[j] = localIndices[triangle[j]];
+                }
+
+                ++current.trianglesCount;
+        }
+
+        if(current.trianglesCount > 0)
+                meshlets->meshlets[meshlets->meshletsCount++] = current;
+
+        free(localIndices);
+
+        meshlets->vertexIndicesCount = current.vertexOffset + current.verticesCount;
+        meshlets->trianglesCount = current.triangleOffset + current.trianglesCount;
+
+        // Give back the memory that was not used (failures are harmless, the original blocks are kept)
+        if(meshlets->meshletsCount > 0)
+        {
+                void* shrunk = realloc(meshlets->meshlets, meshlets->meshletsCount * sizeof(Meshlet_t));
+                meshlets->meshlets = (shrunk != NULL) ? shrunk : meshlets->meshlets;
+
+                shrunk = realloc(meshlets->vertexIndices, meshlets->vertexIndicesCount * sizeof(uint32_t));
+                meshlets->vertexIndices = (shrunk != NULL) ? shrunk : meshlets->vertexIndices;
+
+                shrunk = realloc(meshlets->triangles, (size_t) meshlets->trianglesCount * 3);
+                meshlets->triangles = (shrunk != NULL) ? shrunk : meshlets->triangles;
+        }
+
+        for(uint32_t m = 0; m < meshlets->meshletsCount; ++m)
+                mnkt_meshlets_computeBounds(&meshlets->meshlets[m], meshlets, vertices, vertexSize);
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_meshlets_destroy
+ * Releases the data of the given meshlets
+ * @param meshlets The meshlets to be released
+*/
+void mnkt_meshlets_destroy(Meshlets_t* meshlets)
+{
+        if(meshlets == NULL)
+                return;
+
+        free(meshlets->meshlets);
+        free(meshlets->vertexIndices);
+        free(meshlets->triangles);
+
+        memset(meshlets, 0, sizeof(Meshlets_t));
+}
+
+
+/**
+ * @function mnkt_meshlets_computeBounds
+ * Computes the bounding volumes and the normal cone of a meshlet
+ * @param meshlet The meshlet whose vertices and triangles are already set
+ * @param meshlets The meshlets to which the meshlet belongs
+ * @param vertices Vertices of the mesh, each one starts with its position
+ * @param vertexSize Size in bytes of a vertex
+ * @note: For internal usage only!!!
+*/
+static void mnkt_meshlets_computeBounds(Meshlet_t* meshlet, const Meshlets_t* meshlets, const unsigned char* vertices, uint32_t vertexSize)
+{
+        Vec3_t positions[MNKT_MESHLET_MAX_VERTICES];
+
+        for(uint32_t v = 0; v < meshlet->verticesCount; ++v)
+                memcpy(&positions[v], vertices + ((size_t) meshlets->vertexIndices[meshlet->vertexOffset + v] * vertexSize), sizeof(Vec3_t));
+
+        meshlet->bounds = mnkt_bounds_fromPoints(positions, meshlet->verticesCount, sizeof(Vec3_t));
+        meshlet->sphere = mnkt_bounds_sphereFromBox(&meshlet->bounds);
+
+        // The axis of the cone is the average of the unit normals of the triangles (degenerate triangles are ignored)
+        Vec3_t normals[MNKT_MESHLET_MAX_TRIANGLES];
+        uint32_t normalsCount = 0;
+        Vec3_t axis = { .x = 0.0f, .y = 0.0f, .z = 0.0f };
+
+        for(uint32_t t = 0; t < meshlet->trianglesCount; ++t)
+        {
+                const uint8_t* triangle = &meshlets->triangles[(size_t) (meshlet->triangleOffset + t) * 3];
+                const Vec3_t* a = &positions[triangle[0]];
+                const Vec3_t* b = &positions[triangle[1]];
+                const Vec3_t* c = &positions[triangle[2]];
+
+                Vec3_t edgeA = { .x = b->x - a->x, .y = b->y - a->y, .z = b->z - a->z };
+                Vec3_t edgeB = { .x = c->x - a->x, .y = c->y - a->y, .z = c->z - a->z };
+                Vec3_t normal = mnkt_vec3_cross(&edgeA, &edgeB);
+
+                float length = sqrtf( mnkt_vec3_dot(&normal, &normal) );
+
+                if(length <= 0.0f)
+                        continue;
+
+                normal = (Vec3_t) { .x = normal.x / length, .y = normal.y / length, .z = normal.z / length };
+                normals[normalsCount++] = normal;
+
+                axis.x += normal.x;
+                axis.y += normal.y;
+                axis.z += normal.z;
+        }
+
+        float axisLength = sqrtf( mnkt_vec3_dot(&axis, &axis) );
+
+        meshlet->coneAxis = (Vec3_t) { .x = 0.0f, .y = 0.0f, .z = 0.0f };
+        meshlet->coneCutoff = 1.0f;
+
+        if(normalsCount == 0 || axisLength <= 0.0f)
+                return;
+
+        axis = (Vec3_t) { .x = axis.x / axisLength, .y = axis.y / axisLength, .z = axis.z / axisLength };
+
+        float minDot = 1.0f;
+
+        for(uint32_t n = 0; n < normalsCount; ++n)
+                minDot = fminf(minDot, mnkt_vec3_dot(&axis, &normals[n]));
+
+        meshlet->coneAxis = axis;
+
+        // Cones wider than a hemisphere can never face away from the camera
+        if(minDot > 0.0f)
+                meshlet->coneCutoff = sqrtf(1.0f - (minDot * minDot));
+}
@@ -0,0 +1,89 @@
+
+/**
+ * @file meshlet.h
+ *
+ * Defines the meshlets: small clusters of triangles of an indexed mesh, each one with its own bounds and normal cone,
+ * so that large meshes can be culled piece by piece (frustum, back faces and occlusion) before their vertices are shaded.
+ *
+ * Meshlets are built by scanning the triangles in order, so meshes should be optimized for the vertex cache first
+ * (e.g. with mnkt_mesh_optimize) to get compact clusters.
+*/
+
+#ifndef MNKT_MESHLET_H
+#define MNKT_MESHLET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "culling.h"
+
+
+/**
+ * @macro MNKT_MESHLET_MAX_VERTICES
+ * Maximum number of vertices referenced by a meshlet (local indices fit in a byte)
+*/
+#define MNKT_MESHLET_MAX_VERTICES       64
+
+/**
+ * @macro MNKT_MESHLET_MAX_TRIANGLES
+ * Maximum number of triangles of a meshlet
+*/
+#define MNKT_MESHLET_MAX_TRIANGLES      124
+
+
+/**
+ * @struct Meshlet_t
+ * Cluster of triangles that reference at most MNKT_MESHLET_MAX_VERTICES vertices.
+ * The normal cone contains the normals of all the triangles (counter clockwise triangles face their normal):
+ * the meshlet faces away from a camera at position p if dot(center - p, coneAxis) > coneCutoff * length(center - p) + radius,
+ * where center and radius are the ones of the bounding sphere.
+*/
+typedef struct {
+        uint32_t        vertexOffset;           ///< Index of the first vertex of the meshlet inside the vertexIndices array of the meshlets
+        uint32_t        triangleOffset;         ///< Index of the first triangle of the meshlet inside the triangles array of the meshlets
+        uint32_t        verticesCount;          ///< Number of vertices of the meshlet
+        uint32_t        trianglesCount;         ///< Number of triangles of the meshlet
+        BoundingBox_t   bounds;                 ///< Bounding box of the vertices
+        BoundingSphere_t sphere;                ///< Bounding sphere of the vertices
+        Vec3_t          coneAxis;               ///< Axis of the normal cone
+        float           coneCutoff;             ///< Sine of the half angle of the normal cone (one if the cone is wider than a hemisphere)
+} Meshlet_t;
+
+
+/**
+ * @struct Meshlets_t
+ * Meshlets of an indexed mesh, the triangles of each meshlet refer to its own vertices through local indices
+*/
+typedef struct {
+        Meshlet_t*      meshlets;               ///< The meshlets
+        uint32_t*       vertexIndices;          ///< For each vertex of each meshlet, its index inside the vertices of the mesh
+        uint8_t*        triangles;              ///< Local indices of the vertices, grouped three by three to form triangles
+        uint32_t        meshletsCount;          ///< Number of meshlets
+        uint32_t        vertexIndicesCount;     ///< Number of elements stored in the vertexIndices array
+        uint32_t        trianglesCount;         ///< Number of triangles (the triangles array stores three times this number of elements)
+} Meshlets_t;
+
+
+/**
+ * @function mnkt_meshlets_build
+ * Splits an indexed mesh into meshlets and computes their bounds and normal cones
+ * @param indices Indices of the vertices, grouped three by three to form triangles (triangles that refer to missing vertices are skipped)
+ * @param indicesCount Number of indices
+ * @param vertices Vertices of the mesh, each one starts with its position (3 floats)
+ * @param verticesCount Number of vertices
+ * @param vertexSize Size in bytes of a vertex
+ * @param meshlets Where the meshlets are stored (must be released with mnkt_meshlets_destroy)
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_meshlets_build(const uint32_t* indices, size_t indicesCount, const void* vertices, size_t verticesCount, uint32_t vertexSize, Meshlets_t* meshlets);
+
+
+/**
+ * @function mnkt_meshlets_destroy
+ * Releases the data of the given meshlets
+ * @param meshlets The meshlets to be released
+*/
+void mnkt_meshlets_destroy(Meshlets_t* meshlets);
+
+
+#endif // MNKT_MESHLET_H
@@ -7,11 +7,175 @@
 
 #include "mnktRenderer.h"
 
+#include "utility/thread.h"
+#include "utility/jobs.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @macro MNKT_PASS_TILE_SIZE
+ * Side, expressed in pixels, of the square tiles in which full screen passes split the framebuffer
+*/
+#define MNKT_PASS_TILE_SIZE             32
+
+/**
+ * @macro MNKT_CULL_BATCH_SIZE
+ * Number of draw commands whose bounds are tested against the frustum at once by mnkt_drawBatch
+*/
+#define MNKT_CULL_BATCH_SIZE            64
+
+/**
+ * @macro MNKT_CLIP_W_EPSILON
+ * Minimum w coordinate of clipped triangles' vertices, keeps the perspective division away from zero
+*/
+#define MNKT_CLIP_W_EPSILON             1e-5f
+
+/**
+ * @macro MNKT_CLIP_MAX_VERTICES
+ * Maximum number of vertices of a clipped triangle (each of the near, far and w planes may add one)
+*/
+#define MNKT_CLIP_MAX_VERTICES          6
+
+/**
+ * @struct ProcessedVertex_t
+ * Output of the vertex shader for a single vertex, kept so that it can be shared by adjacent primitives
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        Vec4_t                  clipCoords;                     ///< Position of the vertex expressed in clip coordinates
+        ShaderParameter_t       varyings[MAX_VARYING_PARAMS];   ///< Varyings outputted by the vertex shader
+} ProcessedVertex_t;
+
+
+/**
+ * @struct VertexCache_t
+ * Post transform cache of indexed draws, keeps the output of the vertex shader for the most recently processed vertices
+ * (entries are replaced in FIFO order, as in hardware caches)
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        uint32_t                indices[MNKT_VERTEX_CACHE_SIZE];        ///< Index of the vertex held by each entry (UINT32_MAX if empty)
+        ProcessedVertex_t       vertices[MNKT_VERTEX_CACHE_SIZE];       ///< Processed vertices
+        uint32_t                nextEntry;                              ///< Next entry to be replaced
+} VertexCache_t;
+
+
+/**
+ * @struct FullscreenPass_t
+ * State of a full screen pass shared by all the threads that run it, each thread repeatedly takes the next unprocessed tile
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        PixelShaderFunc_t               pixelShader;    ///< Function run for each pixel
+        const ShaderParameter_t*        uniforms;       ///< Uniforms passed to the pixel shader
+        Framebuffer_t*                  fb;             ///< Framebuffer on which the pass is run
+        Rect_t                          area;           ///< Area of the framebuffer covered by the pass
+        uint32_t                        tilesX;         ///< Number of tiles on each row
+        uint32_t                        tilesCount;     ///< Total number of tiles
+#ifdef MNKT_THREADS
+        atomic_uint                     nextTile;       ///< Index of the next tile to be processed
+#else
+        uint32_t                        nextTile;       ///< Index of the next tile to be processed
+#endif
+} FullscreenPass_t;
+
+
+/**
+ * @struct MeshletPass_t
+ * State of a meshlets draw shared by all the threads that run it, each thread repeatedly takes the next undrawn band of the framebuffer
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        const Meshlets_t*               meshlets;               ///< Meshlets of the mesh
+        const char*                     vertices;               ///< Vertices of the mesh
+        const uint32_t*                 visible;                ///< Indices of the meshlets that passed the culling tests
+        const int32_t*                  rows;                   ///< First and last row of the framebuffer covered by each visible meshlet
+        uint32_t                        visibleCount;           ///< Number of visible meshlets
+        const ShaderProgram_t*          shader;                 ///< Shader program used for drawing
+        Framebuffer_t*                  fb;                     ///< Framebuffer on which the meshlets are drawn
+        Rect_t                          area;                   ///< Area of the framebuffer covered by the bands
+        uint32_t                        bandHeight;             ///< Height of each band, expressed in pixels
+        uint32_t                        bandsCount;             ///< Number of bands
+        uint64_t                        samplesPassed[MNKT_MAX_THREADS];        ///< Samples counted by the occlusion query in each band
+#ifdef MNKT_THREADS
+        atomic_uint                     nextBand;               ///< Index of the next band to be drawn
+#else
+        uint32_t                        nextBand;               ///< Index of the next band to be drawn
+#endif
+} MeshletPass_t;
+
+
+static void     mnkt_drawTriangleList(const char* vertices, const size_t verticesCount, const ShaderProgram_t* shader, Framebuffer_t* fb);
+static void     mnkt_processVertex(const void* vertexData, const ShaderProgram_t* shader, ProcessedVertex_t* vertex);
+static const ProcessedVertex_t* mnkt_fetchVertex(VertexCache_t* cache, const char* vertices, const uint32_t triangle[3], int corner, const ShaderProgram_t* shader);
+static void     mnkt_drawLineSegment(const ProcessedVertex_t* vertexA, const ProcessedVertex_t* vertexB, const ShaderProgram_t* shader, Framebuffer_t* fb);
+static void     mnkt_drawTriangle(const ProcessedVertex_t* vertexA, const ProcessedVertex_t* vertexB, const ProcessedVertex_t* vertexC, const ShaderProgram_t* shader, Framebuffer_t* fb);
+
 static int      mnkt_isVertexVisible(const Vec4_t* vertex);
-static int      mnkt_clipLine(Vec4_t vertices[2]);
-static int      mnkt_clipTriangle(Vec4_t vertices[3], Vec4_t additionalTriangle[3]);
+static int      mnkt_clipLine(Vec4_t vertices[2], ShaderParameter_t varyings[2][MAX_VARYING_PARAMS], size_t varyingsCount);
+static int      mnkt_clipTriangle(Vec4_t vertices[MNKT_CLIP_MAX_VERTICES], ShaderParameter_t varyings[MNKT_CLIP_MAX_VERTICES][MAX_VARYING_PARAMS], size_t varyingsCount);
+static void     mnkt_emitTriangle(Vec3_t screenCoords[3], const ShaderProgram_t* shader, ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb);
+
+static Vec3_t   mnkt_ndcToScreenCoords(Vec4_t ndcCoords, const Viewport_t* viewport);
+
+static int      mnkt_cullMeshlet(const Meshlet_t* meshlet, const MeshletCulling_t* culling, const Viewport_t* viewport, const Rect_t* area, int32_t rows[2]);
+static void     mnkt_runMeshletPass(void* pass);
+static void     mnkt_runMeshletPassBand(MeshletPass_t* pass, uint32_t band);
+
+static void     mnkt_runFullscreenPass(void* pass);
+static void     mnkt_runFullscreenPassTile(const FullscreenPass_t* pass, uint32_t tile);
+
+
+/**
+ * @function mnkt_beginFrame
+ * Prepares the given framebuffer for a new frame, all the transient data allocated
+ * by the pipeline during the previous frame is released (nothing is done on the framebuffers
+ * returned by mnkt_pipeline_beginFrame, which already resets their frame arena)
+ * @param fb Framebuffer on which the new frame will be rendered
+*/
+void mnkt_beginFrame(Framebuffer_t* fb)
+{
+        // The arena of the framebuffers of a frame pipeline is reset by mnkt_pipeline_beginFrame
+        if(fb == NULL || fb->bins != NULL)
+                return;
+
+        // Release the transient data of the previous frame (the arena keeps its memory, so no malloc/free happens)
+        mnkt_frameArena_reset(fb->frameArena);
+}
+
+
+/**
+ * @function mnkt_beginQuery
+ * Activates an occlusion query on the given framebuffer, from now on the samples that pass the depth test are counted
+ * into the query (its counter is reset). Only one query can be active on a framebuffer at a time.
+ * @param query The query to be activated
+ * @param fb Framebuffer on which the query is activated
+*/
+void mnkt_beginQuery(OcclusionQuery_t* query, Framebuffer_t* fb)
+{
+        if(query == NULL || fb == NULL)
+                return;
 
-static Vec3_t   mnkt_ndcToScreenCoords(Vec4_t clipCoords, size_t screenWidth, size_t screenHeight);
+        query->samplesPassed = 0;
+        fb->query = query;
+}
+
+
+/**
+ * @function mnkt_endQuery
+ * Deactivates the occlusion query active on the given framebuffer, its samplesPassed field holds the result
+ * @param fb Framebuffer on which the query was activated
+*/
+void mnkt_endQuery(Framebuffer_t* fb)
+{
+        if(fb == NULL)
+                return;
+
+        fb->query = NULL;
+}
 
 
 /**
@@ -41,7 +205,7 @@ void mnkt_drawPoints(void* vertices, const size_t verticesCount, const size_t po
                 // Invoke the vertex shader on the current point
                 clipCoords = shader->vertexShader(currVertexData, varyings, shader->uniforms);
                 
-                // Perform clipping (for simplicity, as OpenGL standard specifies, we discard the point if its center is not inside the view volume)
+                // Perform clipping (the point is discarded if its center is outside the near and far planes, the sprite is clipped to the framebuffer by the rasterizer)
                 if( !mnkt_isVertexVisible(&clipCoords) )
                         continue;
 
@@ -49,10 +213,13 @@ void mnkt_drawPoints(void* vertices, const size_t verticesCount, const size_t po
                 clipCoords = mnkt_vec4_div(&clipCoords, clipCoords.w);
 
                 // Convert ndc coordinates to screen coordinates
-                screenCoords = mnkt_ndcToScreenCoords(clipCoords, fb->width, fb->height);
+                screenCoords = mnkt_ndcToScreenCoords(clipCoords, &fb->viewport);
 
-                // Rasterize the point
-                mnkt_rasterizePoint(screenCoords, pointSize, shader, varyings, fb);
+                // Rasterize the point (framebuffers of a frame pipeline record it, it is rasterized by the back end)
+                if(fb->bins != NULL)
+                        mnkt_frameBins_addPoint(fb, screenCoords, pointSize, shader, varyings);
+                else
+                        mnkt_rasterizePoint(screenCoords, pointSize, shader, varyings, fb);
         }
 }
 
@@ -71,39 +238,25 @@ void mnkt_drawLines(void* vertices, const size_t verticesCount, ShaderProgram_t*
         if(vertices == NULL || shader == NULL || fb == NULL)
                 return;
 
-        Vec4_t clipCoords[2];
-        Vec3_t screenCoords[2];
-        ShaderParameter_t varyings[2][MAX_VARYING_PARAMS];
+        ProcessedVertex_t processed[2];
 
         char* currVertexData = vertices;
 
-        // Until points can be extracted from the given vertices
+        // Until lines can be extracted from the given vertices
         for(size_t i = 0; i + 2 <= verticesCount; i += 2)
         {
                 // Invoke vertex shader on each vertex
                 for(size_t j = 0; j < 2; ++j, currVertexData += shader->vertexSize)
-                        clipCoords[j] = shader->vertexShader(currVertexData, varyings[j], shader->uniforms);
-
-                // Perform clipping (discard the line if clipping fails)
-                if(mnkt_clipLine(clipCoords) != 2)
-                        continue;
-
-                // Perform perspective division and convert from ndc space to screen space
-                for(size_t j = 0; j < 2; ++j)
-                {
-                        clipCoords[j] = mnkt_vec4_div(&clipCoords[j], clipCoords[j].w);
-                        screenCoords[j] = mnkt_ndcToScreenCoords(clipCoords[j], fb->width, fb->height);
-                }
+                        mnkt_processVertex(currVertexData, shader, &processed[j]);
 
-                // Rasterize the line
-                mnkt_rasterizeLine(screenCoords, shader, varyings, fb);
+                mnkt_drawLineSegment(&processed[0], &processed[1], shader, fb);
         }
 }
 
 
 /**
  * @function mnkt_drawPolyLine
- * Draws a continuous segmented line
+ * Draws a continuous segmented line (line strip), each vertex is processed by the vertex shader only once
  * @param vertices Array of data that defines the properties of each vertex that composes the line to be drawn.
  *      Vertices in this array define the points that are to be connected by the line.
  * @param verticesCount Number of elements stored in the given vertices array
@@ -112,13 +265,65 @@ void mnkt_drawLines(void* vertices, const size_t verticesCount, ShaderProgram_t*
 */
 void mnkt_drawPolyLine(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb)
 {
-        if(vertices == NULL || shader == NULL || fb == NULL)
+        if(vertices == NULL || shader == NULL || fb == NULL || verticesCount < 2)
                 return;
 
+        ProcessedVertex_t processed[2];
+
         char* currVertexData = vertices;
 
-        for(size_t i = 0; i + 2 <= verticesCount; ++i, currVertexData += shader->vertexSize)
-                mnkt_drawLines(currVertexData, 2, shader, fb);
+        mnkt_processVertex(currVertexData, shader, &processed[0]);
+        currVertexData += shader->vertexSize;
+
+        // Each new vertex forms a segment with the previous one (the two slots are used alternately)
+        for(size_t i = 1; i < verticesCount; ++i, currVertexData += shader->vertexSize)
+        {
+                ProcessedVertex_t* prev = &processed[(i - 1) & 1];
+                ProcessedVertex_t* curr = &processed[i & 1];
+
+                mnkt_processVertex(currVertexData, shader, curr);
+                mnkt_drawLineSegment(prev, curr, shader, fb);
+        }
+}
+
+
+/**
+ * @function mnkt_drawLineLoop
+ * Draws a closed segmented line (the last vertex is connected to the first one),
+ * each vertex is processed by the vertex shader only once
+ * @param vertices Array of data that defines the properties of each vertex that composes the line to be drawn.
+ *      Vertices in this array define the points that are to be connected by the line.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered line should be outputted
+*/
+void mnkt_drawLineLoop(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(vertices == NULL || shader == NULL || fb == NULL || verticesCount < 2)
+                return;
+
+        ProcessedVertex_t first;
+        ProcessedVertex_t processed[2];
+
+        char* currVertexData = vertices;
+
+        mnkt_processVertex(currVertexData, shader, &first);
+        currVertexData += shader->vertexSize;
+
+        processed[0] = first;
+
+        for(size_t i = 1; i < verticesCount; ++i, currVertexData += shader->vertexSize)
+        {
+                ProcessedVertex_t* prev = &processed[(i - 1) & 1];
+                ProcessedVertex_t* curr = &processed[i & 1];
+
+                mnkt_processVertex(currVertexData, shader, curr);
+                mnkt_drawLineSegment(prev, curr, shader, fb);
+        }
+
+        // Close the loop
+        if(verticesCount > 2)
+                mnkt_drawLineSegment(&processed[(verticesCount - 1) & 1], &first, shader, fb);
 }
 
 
@@ -136,69 +341,711 @@ void mnkt_draw(void* vertices, const size_t verticesCount, ShaderProgram_t* shad
         if(vertices == NULL || shader == NULL || fb == NULL)
                 return;
 
-        Vec4_t clipCoords[6];
-        Vec3_t screenCoords[6];
-        ShaderParameter_t varyings[6][MAX_VARYING_PARAMS];
+        mnkt_drawTriangleList(vertices, verticesCount, shader, fb);
+}
+
+
+/**
+ * @function mnkt_drawInstanced
+ * Draws multiple instances of the same sequence of triangles.
+ * For each instance the built-in parameters MNKT_BUILTIN_INSTANCE_ID and MNKT_BUILTIN_INSTANCE_DATA are set
+ * in the shader's uniforms, so that the shaders can customize each instance (e.g. by applying a different transform).
+ * The given shader program is not modified: the parameters are set on a copy of it, made once for all the instances.
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ *      Vertices in this array are grouped three by three to form triangles.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param instances Array of per-instance attributes (can be NULL if the shaders only use the instance ID)
+ * @param instanceSize Size in bytes of the attributes of a single instance
+ * @param instancesCount Number of instances to be drawn
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawInstanced(void* vertices, const size_t verticesCount, const void* instances, const size_t instanceSize, const size_t instancesCount,
+                        ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(vertices == NULL || shader == NULL || fb == NULL)
+                return;
+
+        // The built-in parameters are updated on a copy of the shader, only those change from an instance to the next one
+        ShaderProgram_t instanceShader = *shader;
+        ShaderParameter_t* instanceId = &instanceShader.uniforms[MNKT_BUILTIN_INSTANCE_ID];
+        ShaderParameter_t* instanceData = &instanceShader.uniforms[MNKT_BUILTIN_INSTANCE_DATA];
+
+        const char* currInstanceData = instances;
+
+        for(size_t i = 0; i < instancesCount; ++i)
+        {
+                instanceId->uintData = (uint32_t) i;
+                instanceData->userData = (void*) currInstanceData;
+
+                mnkt_drawTriangleList(vertices, verticesCount, &instanceShader, fb);
+
+                if(currInstanceData != NULL)
+                        currInstanceData += instanceSize;
+        }
+}
+
+
+/**
+ * @function mnkt_drawTriangleStrip
+ * Draws a strip of triangles, each vertex (after the first two) forms a triangle with the two vertices that precede it.
+ * Each vertex is processed by the vertex shader only once and the winding order of the triangles is preserved.
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawTriangleStrip(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(vertices == NULL || shader == NULL || fb == NULL || verticesCount < 3)
+                return;
+
+        ProcessedVertex_t processed[3];
+
+        char* currVertexData = (char*) vertices;
+
+        for(size_t i = 0; i < 2; ++i, currVertexData += shader->vertexSize)
+                mnkt_processVertex(currVertexData, shader, &processed[i]);
+
+        // The three slots are used as a ring buffer
+        for(size_t i = 2; i < verticesCount; ++i, currVertexData += shader->vertexSize)
+        {
+                ProcessedVertex_t* first = &processed[(i - 2) % 3];
+                ProcessedVertex_t* second = &processed[(i - 1) % 3];
+                ProcessedVertex_t* third = &processed[i % 3];
+
+                mnkt_processVertex(currVertexData, shader, third);
+
+                // Odd triangles have their first two vertices swapped to keep a consistent winding order
+                if(i & 1)
+                        mnkt_drawTriangle(second, first, third, shader, fb);
+                else
+                        mnkt_drawTriangle(first, second, third, shader, fb);
+        }
+}
+
+
+/**
+ * @function mnkt_drawTriangleFan
+ * Draws a fan of triangles, each vertex (after the first two) forms a triangle with the previous vertex and the first one.
+ * Each vertex is processed by the vertex shader only once.
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawTriangleFan(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(vertices == NULL || shader == NULL || fb == NULL || verticesCount < 3)
+                return;
+
+        ProcessedVertex_t center;
+        ProcessedVertex_t processed[2];
 
         char* currVertexData = (char*) vertices;
 
+        mnkt_processVertex(currVertexData, shader, &center);
+        currVertexData += shader->vertexSize;
+
+        mnkt_processVertex(currVertexData, shader, &processed[1]);
+        currVertexData += shader->vertexSize;
+
+        for(size_t i = 2; i < verticesCount; ++i, currVertexData += shader->vertexSize)
+        {
+                ProcessedVertex_t* prev = &processed[(i - 1) & 1];
+                ProcessedVertex_t* curr = &processed[i & 1];
+
+                mnkt_processVertex(currVertexData, shader, curr);
+                mnkt_drawTriangle(&center, prev, curr, shader, fb);
+        }
+}
+
+
+/**
+ * @function mnkt_drawIndexed
+ * Draws a sequence of indexed triangles, vertices shared by nearby triangles are processed by the vertex shader only once
+ * as long as they are still in the post transform cache (the last MNKT_VERTEX_CACHE_SIZE processed vertices)
+ * @param vertices Array of data that defines the properties of each vertex that can be drawn
+ * @param verticesCount Number of elements stored in the given vertices array (triangles that refer to other vertices are skipped)
+ * @param indices Indices of the vertices, grouped three by three to form triangles
+ * @param indicesCount Number of elements stored in the given indices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawIndexed(void* vertices, const size_t verticesCount, const uint32_t* indices, const size_t indicesCount, ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(vertices == NULL || indices == NULL || shader == NULL || fb == NULL)
+                return;
+
+        VertexCache_t cache;
+
+        memset(cache.indices, 0xFF, sizeof(cache.indices));
+        cache.nextEntry = 0;
+
+        for(size_t i = 0; i + 3 <= indicesCount; i += 3)
+        {
+                const uint32_t* triangle = &indices[i];
+
+                if(triangle[0] >= verticesCount || triangle[1] >= verticesCount || triangle[2] >= verticesCount)
+                        continue;
+
+                const ProcessedVertex_t* a = mnkt_fetchVertex(&cache, vertices, triangle, 0, shader);
+                const ProcessedVertex_t* b = mnkt_fetchVertex(&cache, vertices, triangle, 1, shader);
+                const ProcessedVertex_t* c = mnkt_fetchVertex(&cache, vertices, triangle, 2, shader);
+
+                mnkt_drawTriangle(a, b, c, shader, fb);
+        }
+}
+
+
+/**
+ * @function mnkt_drawBatch
+ * Draws a sequence of commands, the bounds of the commands are tested against the frustum
+ * in batches and the commands that are completely outside of it are skipped before running the vertex shader
+ * @param commands Commands to be drawn, in order
+ * @param commandsCount Number of elements stored in the given commands array
+ * @param frustum Frustum against which the bounds are tested, e.g. mnkt_frustum_fromMatrix(viewProjection) for world space bounds (NULL to draw all the commands)
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+ * @return The number of commands that have been drawn
+*/
+size_t mnkt_drawBatch(const DrawCommand_t* commands, const size_t commandsCount, const Frustum_t* frustum, Framebuffer_t* fb)
+{
+        if(commands == NULL || fb == NULL)
+                return 0;
+
+        BoundingBox_t bounds[MNKT_CULL_BATCH_SIZE];
+        uint8_t visible[MNKT_CULL_BATCH_SIZE];
+        size_t drawnCount = 0;
+
+        for(size_t first = 0; first < commandsCount; first += MNKT_CULL_BATCH_SIZE)
+        {
+                const size_t batchSize = (commandsCount - first < MNKT_CULL_BATCH_SIZE) ? commandsCount - first : MNKT_CULL_BATCH_SIZE;
+
+                // Gather the bounds so that they can be tested together, commands without bounds get an infinite box
+                if(frustum != NULL)
+                {
+                        for(size_t i = 0; i < batchSize; ++i)
+                        {
+                                const BoundingBox_t* box = commands[first + i].bounds;
+
+                                bounds[i] = (box != NULL) ? *box : (BoundingBox_t) {
+                                        .min = { .x = -INFINITY, .y = -INFINITY, .z = -INFINITY },
+                                        .max = { .x = INFINITY, .y = INFINITY, .z = INFINITY }
+                                };
+                        }
+
+                        mnkt_frustum_testBoxes(frustum, bounds, batchSize, visible);
+                } else {
+                        memset(visible, 1, batchSize);
+                }
+
+                for(size_t i = 0; i < batchSize; ++i)
+                {
+                        const DrawCommand_t* command = &commands[first + i];
+
+                        if(!visible[i] && command->bounds != NULL)
+                                continue;
+
+                        if(command->indices != NULL)
+                                mnkt_drawIndexed(command->vertices, command->verticesCount, command->indices, command->indicesCount, command->shader, fb);
+                        else
+                                mnkt_draw(command->vertices, command->verticesCount, command->shader, fb);
+
+                        ++drawnCount;
+                }
+        }
+
+        return drawnCount;
+}
+
+
+/**
+ * @function mnkt_drawMeshlets
+ * Draws the meshlets of an indexed mesh, the meshlets that are outside of the frustum, that face away from the camera
+ * or that are occluded are skipped before their vertices are shaded. The vertices of each meshlet are processed by the vertex shader once.
+ * The framebuffer is split into horizontal bands that are drawn in parallel by the given number of threads, each thread
+ * draws (in order) the meshlets whose projected bounds overlap its band, so the result does not depend on the number of threads.
+ * @param meshlets Meshlets of the mesh
+ * @param vertices Array of data that defines the properties of each vertex of the mesh
+ * @param verticesCount Number of elements stored in the given vertices array (meshlets that refer to other vertices are skipped)
+ * @param culling Parameters of the culling tests (NULL to draw all the meshlets on the calling thread only)
+ * @param threadsCount Maximum number of threads that draw the meshlets, the calling thread included, taken from the job system (0 or 1 to draw them on the calling thread only)
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted (multisampled framebuffers are drawn on the calling thread only)
+ * @return The number of meshlets that have been drawn
+*/
+size_t mnkt_drawMeshlets(const Meshlets_t* meshlets, void* vertices, const size_t verticesCount, const MeshletCulling_t* culling, uint32_t threadsCount,
+                         ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(meshlets == NULL || vertices == NULL || shader == NULL || fb == NULL || meshlets->meshletsCount == 0)
+                return 0;
+
+        Rect_t area = mnkt_framebuffer_getClipRect(fb);
+
+        if(area.width <= 0 || area.height <= 0)
+                return 0;
+
+        // The list of visible meshlets is transient data of the frame
+        const size_t listSize = (size_t) meshlets->meshletsCount * (sizeof(uint32_t) + (2 * sizeof(int32_t)));
+        Arena_t* arena = mnkt_frameArena_getThreadArena(fb->frameArena, 0);
+        uint32_t* visible = (arena != NULL) ? mnkt_arena_alloc(arena, listSize, sizeof(uint32_t)) : malloc(listSize);
+
+        if(visible == NULL)
+                return 0;
+
+        int32_t* rows = (int32_t*) (visible + meshlets->meshletsCount);
+        uint32_t visibleCount = 0;
+
+        Frustum_t frustum;
+        BoundingBox_t bounds[MNKT_CULL_BATCH_SIZE];
+        uint8_t insideFrustum[MNKT_CULL_BATCH_SIZE];
+
+        if(culling != NULL)
+                frustum = mnkt_frustum_fromMatrix(&culling->viewProjection);
+
+        for(uint32_t first = 0; first < meshlets->meshletsCount; first += MNKT_CULL_BATCH_SIZE)
+        {
+                const uint32_t batchSize = (meshlets->meshletsCount - first < MNKT_CULL_BATCH_SIZE) ? meshlets->meshletsCount - first : MNKT_CULL_BATCH_SIZE;
+
+                // Frustum test on a batch of meshlets, then the back face and the occlusion tests on the survivors
+                if(culling != NULL)
+                {
+                        for(uint32_t i = 0; i < batchSize; ++i)
+                                bounds[i] = meshlets->meshlets[first + i].bounds;
+
+                        mnkt_frustum_testBoxes(&frustum, bounds, batchSize, insideFrustum);
+                }
+
+                for(uint32_t i = 0; i < batchSize; ++i)
+                {
+                        const Meshlet_t* meshlet = &meshlets->meshlets[first + i];
+                        int32_t* meshletRows = &rows[visibleCount * 2];
+
+                        if(culling != NULL && (!insideFrustum[i] || !mnkt_cullMeshlet(meshlet, culling, &fb->viewport, &area, meshletRows)))
+                                continue;
+
+                        if(culling == NULL)
+                        {
+                                meshletRows[0] = area.y;
+                                meshletRows[1] = area.y + area.height - 1;
+                        }
+
+                        visible[visibleCount++] = first + i;
+                }
+        }
+
+        // Meshlets can be assigned to the bands only when their projected bounds are known
+        // (the triangles drawn on the framebuffers of a frame pipeline are recorded by the calling thread only)
+        if(culling == NULL || fb->multisample.samplesCount > 1 || fb->bins != NULL || threadsCount == 0)
+                threadsCount = 1;
+
+        if(threadsCount > MNKT_MAX_THREADS)
+                threadsCount = MNKT_MAX_THREADS;
+
+        if(threadsCount > (uint32_t) area.height)
+                threadsCount = (uint32_t) area.height;
+
+        MeshletPass_t pass = {
+                .meshlets = meshlets,
+                .vertices = vertices,
+                .visible = visible,
+                .rows = rows,
+                .visibleCount = visibleCount,
+                .shader = shader,
+                .fb = fb,
+                .area = area,
+                .bandHeight = ((uint32_t) area.height + threadsCount - 1) / threadsCount,
+                .bandsCount = 0
+        };
+
+        pass.bandsCount = ((uint32_t) area.height + pass.bandHeight - 1) / pass.bandHeight;
+
+        // Meshlets whose vertices are not all available are never drawn
+        for(uint32_t i = 0; i < pass.visibleCount; )
+        {
+                const Meshlet_t* meshlet = &meshlets->meshlets[visible[i]];
+                int valid = 1;
+
+                for(uint32_t v = 0; v < meshlet->verticesCount && valid; ++v)
+                        valid = meshlets->vertexIndices[meshlet->vertexOffset + v] < verticesCount;
+
+                if(valid)
+                {
+                        ++i;
+                        continue;
+                }
+
+                --pass.visibleCount;
+                memmove(&visible[i], &visible[i + 1], (pass.visibleCount - i) * sizeof(uint32_t));
+                memmove(&rows[i * 2], &rows[(i + 1) * 2], (pass.visibleCount - i) * 2 * sizeof(int32_t));
+        }
+
+#ifdef MNKT_THREADS
+        atomic_init(&pass.nextBand, 0);
+#else
+        pass.nextBand = 0;
+#endif
+
+        // The calling thread works together with the workers of the job system, the bands are taken by whoever is free
+        mnkt_jobs_runParallel(mnkt_runMeshletPass, &pass, pass.bandsCount);
+
+        if(fb->query != NULL)
+        {
+                for(uint32_t i = 0; i < pass.bandsCount; ++i)
+                        fb->query->samplesPassed += pass.samplesPassed[i];
+        }
+
+        if(arena == NULL)
+                free(visible);
+
+        return pass.visibleCount;
+}
+
+
+/**
+ * @function mnkt_drawFullscreenPass
+ * Runs a function over all the pixels of the framebuffer (those inside the clip rectangle), e.g. the lighting pass of deferred shading.
+ * For each pixel the function receives the content of the color attachments and of the depth buffer, its output is stored into the color buffer.
+ * The framebuffer is split into tiles that are processed in parallel by the given number of threads.
+ * @param pixelShader Function to be run for each pixel
+ * @param uniforms Uniforms to be passed to the function (can be NULL)
+ * @param threadsCount Maximum number of threads that process the tiles, the calling thread included, taken from the job system (0 or 1 to run the pass on the calling thread only)
+ * @param fb Framebuffer on which the pass is run (must have a color buffer)
+*/
+void mnkt_drawFullscreenPass(PixelShaderFunc_t pixelShader, const ShaderParameter_t* uniforms, uint32_t threadsCount, Framebuffer_t* fb)
+{
+        if(pixelShader == NULL || fb == NULL || fb->colorBuffer == NULL)
+                return;
+
+        // Framebuffers of a frame pipeline record the pass, it is run by the back end
+        if(fb->bins != NULL)
+        {
+                mnkt_frameBins_addFullscreenPass(fb, pixelShader, uniforms);
+                return;
+        }
+
+        Rect_t area = mnkt_framebuffer_getClipRect(fb);
+
+        if(area.width <= 0 || area.height <= 0)
+                return;
+
+        FullscreenPass_t pass = {
+                .pixelShader = pixelShader,
+                .uniforms = uniforms,
+                .fb = fb,
+                .area = area,
+                .tilesX = (uint32_t) (area.width + MNKT_PASS_TILE_SIZE - 1) / MNKT_PASS_TILE_SIZE,
+                .tilesCount = 0
+        };
+
+        pass.tilesCount = pass.tilesX * ( (uint32_t) (area.height + MNKT_PASS_TILE_SIZE - 1) / MNKT_PASS_TILE_SIZE );
+
+        if(threadsCount > pass.tilesCount)
+                threadsCount = pass.tilesCount;
+
+        if(threadsCount > MNKT_MAX_THREADS)
+                threadsCount = MNKT_MAX_THREADS;
+
+#ifdef MNKT_THREADS
+        atomic_init(&pass.nextTile, 0);
+#else
+        pass.nextTile = 0;
+#endif
+
+        // The calling thread works together with the workers of the job system, the tiles are taken by whoever is free
+        mnkt_jobs_runParallel(mnkt_runFullscreenPass, &pass, threadsCount);
+}
+
+
+/**
+ * @function mnkt_drawTriangleList
+ * Draws a sequence of triangles (the parameters are assumed to be valid)
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ *      Vertices in this array are grouped three by three to form triangles.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+ * @note: For internal usage only!!!
+*/
+static void mnkt_drawTriangleList(const char* vertices, const size_t verticesCount, const ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        ProcessedVertex_t processed[3];
+
+        const char* currVertexData = vertices;
+
         // Until triangles can be built from the given vertices
         for(size_t i = 0; i + 3 <= verticesCount; i += 3)
         {
                 // Invoke vertex shader on each vertex
                 for(int j = 0; j < 3; ++j, currVertexData += shader->vertexSize)
-                        clipCoords[j] = shader->vertexShader(currVertexData, varyings[j], shader->uniforms);
+                        mnkt_processVertex(currVertexData, shader, &processed[j]);
 
-                // Perform clipping (discard the triangle if clipping fails)
-                size_t clippedVerticesNum = mnkt_clipTriangle( clipCoords, &(clipCoords[3]) );
+                mnkt_drawTriangle(&processed[0], &processed[1], &processed[2], shader, fb);
+        }
+}
 
-                if(clippedVerticesNum < 3)
-                        continue;
 
-                // Perform perspective division and convert from ndc to screen space
-                for(size_t j = 0; j < clippedVerticesNum; ++j)
-                {
-                        clipCoords[j] = mnkt_vec4_div(&clipCoords[j], clipCoords[j].w);
-                        screenCoords[j] = mnkt_ndcToScreenCoords(clipCoords[j], fb->width, fb->height);
-                }
+/**
+ * @function mnkt_processVertex
+ * Invokes the vertex shader on the given vertex
+ * @param vertexData Data of the vertex to be processed
+ * @param shader Shader program to be used
+ * @param vertex Where the output of the vertex shader is stored
+ * @note: For internal usage only!!!
+*/
+static void mnkt_processVertex(const void* vertexData, const ShaderProgram_t* shader, ProcessedVertex_t* vertex)
+{
+        vertex->clipCoords = shader->vertexShader(vertexData, vertex->varyings, shader->uniforms);
+}
 
-                // Rasterize the triangle
-                mnkt_rasterizeTriangle(screenCoords, shader, varyings, fb);
 
-                // Rasterize the additional triangle produced by the clipping process, if necessary
-                if(clippedVerticesNum > 3)
-                        mnkt_rasterizeTriangle( &(screenCoords[3]), shader, varyings + 3, fb );
+/**
+ * @function mnkt_fetchVertex
+ * Looks for a vertex of a triangle in the post transform cache, on a miss the vertex is processed and stored in the cache
+ * (entries that hold the other vertices of the same triangle are never replaced)
+ * @param cache The post transform cache
+ * @param vertices Array of data of the vertices
+ * @param triangle Indices of the vertices of the triangle
+ * @param corner Which vertex of the triangle is fetched
+ * @param shader Shader program to be used
+ * @return The processed vertex (valid until the next triangle is fetched)
+ * @note: For internal usage only!!!
+*/
+static const ProcessedVertex_t* mnkt_fetchVertex(VertexCache_t* cache, const char* vertices, const uint32_t triangle[3], int corner, const ShaderProgram_t* shader)
+{
+        const uint32_t index = triangle[corner];
+
+        for(uint32_t i = 0; i < MNKT_VERTEX_CACHE_SIZE; ++i)
+        {
+                if(cache->indices[i] == index)
+                        return &cache->vertices[i];
         }
+
+        uint32_t entry = cache->nextEntry;
+
+        while(cache->indices[entry] == triangle[0] || cache->indices[entry] == triangle[1] || cache->indices[entry] == triangle[2])
+                entry = (entry + 1) % MNKT_VERTEX_CACHE_SIZE;
+
+        cache->nextEntry = (entry + 1) % MNKT_VERTEX_CACHE_SIZE;
+        cache->indices[entry] = index;
+
+        mnkt_processVertex(vertices + ((size_t) index * shader->vertexSize), shader, &cache->vertices[entry]);
+
+        return &cache->vertices[entry];
+}
+
+
+/**
+ * @function mnkt_drawLineSegment
+ * Clips and rasterizes the line defined by two processed vertices
+ * @param vertexA First extreme of the line
+ * @param vertexB Second extreme of the line
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered line should be outputted
+ * @note: For internal usage only!!!
+*/
+static void mnkt_drawLineSegment(const ProcessedVertex_t* vertexA, const ProcessedVertex_t* vertexB, const ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        Vec4_t clipCoords[2] = { vertexA->clipCoords, vertexB->clipCoords };
+        Vec3_t screenCoords[2];
+        ShaderParameter_t varyings[2][MAX_VARYING_PARAMS];
+
+        // Depth only programs never read the varyings
+        if( !shader->depthOnly )
+        {
+                memcpy(varyings[0], vertexA->varyings, sizeof(varyings[0]));
+                memcpy(varyings[1], vertexB->varyings, sizeof(varyings[1]));
+        }
+
+        // Perform clipping (discard the line if clipping fails)
+        if(mnkt_clipLine(clipCoords, varyings, mnkt_getInterpolatedVaryingsCount(shader)) != 2)
+                return;
+
+        // Perform perspective division and convert from ndc space to screen space
+        for(size_t j = 0; j < 2; ++j)
+        {
+                clipCoords[j] = mnkt_vec4_div(&clipCoords[j], clipCoords[j].w);
+                screenCoords[j] = mnkt_ndcToScreenCoords(clipCoords[j], &fb->viewport);
+        }
+
+        // Rasterize the line (framebuffers of a frame pipeline record it, it is rasterized by the back end)
+        if(fb->bins != NULL)
+                mnkt_frameBins_addLine(fb, screenCoords, shader, (const ShaderParameter_t (*)[MAX_VARYING_PARAMS]) varyings);
+        else
+                mnkt_rasterizeLine(screenCoords, shader, varyings, fb);
+}
+
+
+/**
+ * @function mnkt_drawTriangle
+ * Clips and rasterizes the triangle defined by three processed vertices
+ * @param vertexA First vertex of the triangle
+ * @param vertexB Second vertex of the triangle
+ * @param vertexC Third vertex of the triangle
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangle should be outputted
+ * @note: For internal usage only!!!
+*/
+static void mnkt_drawTriangle(const ProcessedVertex_t* vertexA, const ProcessedVertex_t* vertexB, const ProcessedVertex_t* vertexC, const ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        Vec4_t clipCoords[MNKT_CLIP_MAX_VERTICES] = { vertexA->clipCoords, vertexB->clipCoords, vertexC->clipCoords };
+        Vec3_t screenCoords[MNKT_CLIP_MAX_VERTICES];
+        ShaderParameter_t varyings[MNKT_CLIP_MAX_VERTICES][MAX_VARYING_PARAMS];
+
+        // Depth only programs never read the varyings
+        if( !shader->depthOnly )
+        {
+                memcpy(varyings[0], vertexA->varyings, sizeof(varyings[0]));
+                memcpy(varyings[1], vertexB->varyings, sizeof(varyings[1]));
+                memcpy(varyings[2], vertexC->varyings, sizeof(varyings[2]));
+        }
+
+        // Perform clipping (discard the triangle if it lies outside of the clipping volume)
+        const int clippedVerticesNum = mnkt_clipTriangle(clipCoords, varyings, mnkt_getInterpolatedVaryingsCount(shader));
+
+        if(clippedVerticesNum < 3)
+                return;
+
+        // Perform perspective division and convert from ndc to screen space
+        for(int j = 0; j < clippedVerticesNum; ++j)
+        {
+                clipCoords[j] = mnkt_vec4_div(&clipCoords[j], clipCoords[j].w);
+                screenCoords[j] = mnkt_ndcToScreenCoords(clipCoords[j], &fb->viewport);
+        }
+
+        if(clippedVerticesNum == 3)
+        {
+                mnkt_emitTriangle(screenCoords, shader, varyings, fb);
+                return;
+        }
+
+        // The clipped polygon is convex: split it in a fan of triangles sharing its first vertex
+        // (which holds the values of the varyings that are not interpolated)
+        Vec3_t fanCoords[3];
+        ShaderParameter_t fanVaryings[3][MAX_VARYING_PARAMS];
+
+        fanCoords[0] = screenCoords[0];
+
+        if( !shader->depthOnly )
+                memcpy(fanVaryings[0], varyings[0], sizeof(fanVaryings[0]));
+
+        for(int j = 1; j + 1 < clippedVerticesNum; ++j)
+        {
+                fanCoords[1] = screenCoords[j];
+                fanCoords[2] = screenCoords[j + 1];
+
+                if( !shader->depthOnly )
+                        memcpy(fanVaryings[1], varyings[j], 2 * sizeof(fanVaryings[0]));
+
+                mnkt_emitTriangle(fanCoords, shader, fanVaryings, fb);
+        }
+}
+
+
+/**
+ * @function mnkt_emitTriangle
+ * Rasterizes a triangle expressed in screen coordinates, or records it if the framebuffer belongs to a frame pipeline
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param shader Shader program to be used for drawing
+ * @param varyings Varyings of the vertices of the triangle
+ * @param fb Framebuffer on which the triangle should be outputted
+ * @note: For internal usage only!!!
+*/
+static void mnkt_emitTriangle(Vec3_t screenCoords[3], const ShaderProgram_t* shader, ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
+{
+        // Framebuffers of a frame pipeline record the triangles, those are rasterized by its back end
+        if(fb->bins != NULL)
+                mnkt_frameBins_addTriangle(fb, screenCoords, shader, (const ShaderParameter_t (*)[MAX_VARYING_PARAMS]) varyings);
+        else
+                mnkt_rasterizeTriangle(screenCoords, shader, (const ShaderParameter_t (*)[MAX_VARYING_PARAMS]) varyings, fb);
 }
 
 
 /**
  * @function mnkt_isVertexVisible
- * Checks if the given vertex is visible according to its w parameter
+ * Checks if the given vertex lies between the near and far planes of the clipping volume
+ * (the other planes are handled by the rasterizer, which clips primitives to the framebuffer)
  * @param vertex The vertex to be checked, expressed in clip coordinates
  * @return One if the vertex is visible, zero otherwise
 */
 static int mnkt_isVertexVisible(const Vec4_t* vertex)
 {
-        return ( fabs(vertex->x) <= vertex->w && fabs(vertex->y) <= vertex->w && fabs(vertex->z) <= vertex->w );
+        return ( vertex->w > 0 && fabs(vertex->z) <= vertex->w );
 }
 
 
 /**
  * @function mnkt_clipLine
- * Performs clipping on the line defined by the given vertices
+ * Performs clipping on the line defined by the given vertices against the near and far planes of the clipping volume.
+ * Clipping against the other planes is performed by the rasterizer (on the framebuffer's clip rectangle),
+ * so that wide lines keep their width up to the edges of the viewport.
  * @param vertices Vertices, expressed in clip coordinates, which define the extremes of the line to be clipped
+ * @param varyings Varyings of the two vertices, the interpolated ones are updated according to the clipped vertices
+ * @param varyingsCount Number of varyings (starting from the first one) to be interpolated
  * @return The number of vertices correctly clipped (that must be redered).
  *      Zero if the given line does not intersect the clipping volume (must be discared).
 */
-static int mnkt_clipLine(Vec4_t vertices[2])
+static int mnkt_clipLine(Vec4_t vertices[2], ShaderParameter_t varyings[2][MAX_VARYING_PARAMS], size_t varyingsCount)
 {
-        // TODO: FIX THIS!!! (need to implement clipping properly...)
-        vertices[0].x = mnkt_math_clamp(vertices[0].x, -1.0f, 1.0f);
-        vertices[0].y = mnkt_math_clamp(vertices[0].y, -1.0f, 1.0f);
+        // Signed distances of the vertices from the near (z = -w) and far (z = w) planes, positive inside
+        const float dist[2][2] = {
+                { vertices[0].w + vertices[0].z, vertices[1].w + vertices[1].z },
+                { vertices[0].w - vertices[0].z, vertices[1].w - vertices[1].z }
+        };
+
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+
+        for(int i = 0; i < 2; ++i)
+        {
+                if(dist[i][0] < 0.0f && dist[i][1] < 0.0f)
+                        return 0;
+
+                float t = dist[i][0] / (dist[i][0] - dist[i][1]);
+
+                if(dist[i][0] < 0.0f && t > t0)
+                        t0 = t;
+                else if(dist[i][1] < 0.0f && t < t1)
+                        t1 = t;
+        }
 
-        vertices[1].x = mnkt_math_clamp(vertices[1].x, -1.0f, 1.0f);
-        vertices[1].y = mnkt_math_clamp(vertices[1].y, -1.0f, 1.0f);
+        if(t0 > t1)
+                return 0;
+
+        if(t0 == 0.0f && t1 == 1.0f)
+                return 2;
+
+        // Move the extremes on the clipping planes
+        const Vec4_t original[2] = { vertices[0], vertices[1] };
+        const float tValues[2] = { t0, t1 };
+
+        if(varyingsCount > MAX_VARYING_PARAMS)
+                varyingsCount = MAX_VARYING_PARAMS;
+
+        ShaderParameter_t originalVaryings[2][MAX_VARYING_PARAMS];
+        memcpy(originalVaryings, varyings, sizeof(originalVaryings));
+
+        for(int j = 0; j < 2; ++j)
+        {
+                float t = tValues[j];
+
+                vertices[j].x = mnkt_math_lerp(original[0].x, original[1].x, t);
+                vertices[j].y = mnkt_math_lerp(original[0].y, original[1].y, t);
+                vertices[j].z = mnkt_math_lerp(original[0].z, original[1].z, t);
+                vertices[j].w = mnkt_math_lerp(original[0].w, original[1].w, t);
+
+                for(size_t k = 0; k < varyingsCount; ++k)
+                {
+                        Vec4_t* varying = &varyings[j][k].vec4;
+                        const Vec4_t* varyingA = &originalVaryings[0][k].vec4;
+                        const Vec4_t* varyingB = &originalVaryings[1][k].vec4;
+
+                        varying->x = mnkt_math_lerp(varyingA->x, varyingB->x, t);
+                        varying->y = mnkt_math_lerp(varyingA->y, varyingB->y, t);
+                        varying->z = mnkt_math_lerp(varyingA->z, varyingB->z, t);
+                        varying->w = mnkt_math_lerp(varyingA->w, varyingB->w, t);
+                }
+        }
 
         return 2;
 }
@@ -206,20 +1053,112 @@ static int mnkt_clipLine(Vec4_t vertices[2])
 
 /**
  * @function mnkt_clipTriangle
- * Performs clipping on the triangle defined by the given vertices
- * @param vertices Vertices, expressed in clip coordinates, which define the triangle to be clipped
- * @param additionalTriangle Array in which the vertices of an additional triangle, resulting from the clipping process, are stored if necessary
- * @return The number of vertices correctly clipped (that must be redered).
+ * Performs clipping on the triangle defined by the given vertices against the near and far planes of the clipping volume
+ * and against the w = MNKT_CLIP_W_EPSILON plane (Sutherland-Hodgman algorithm).
+ * Clipping against the other planes is performed by the rasterizer (on the framebuffer's clip rectangle).
+ * @param vertices Vertices, expressed in clip coordinates, of the triangle to be clipped (the first three elements),
+ *      replaced by the vertices of the clipped convex polygon
+ * @param varyings Varyings of the three vertices, replaced by the ones of the vertices of the clipped polygon.
+ *      The interpolated ones are computed according to the clipped vertices, the others take the values of the first vertex of the triangle
+ * @param varyingsCount Number of varyings (starting from the first one) to be interpolated
+ * @return The number of vertices of the clipped polygon (3 if the triangle lies inside the clipping volume).
  *      Zero if the given triangle does not intersect the clipping volume (must be discared).
 */
-static int mnkt_clipTriangle(Vec4_t vertices[3], Vec4_t additionalTriangle[3])
+static int mnkt_clipTriangle(Vec4_t vertices[MNKT_CLIP_MAX_VERTICES], ShaderParameter_t varyings[MNKT_CLIP_MAX_VERTICES][MAX_VARYING_PARAMS], size_t varyingsCount)
 {
-        // TODO: FIX THIS!!! (need to implement clipping properly...)
-        vertices[0].x = mnkt_math_clamp(vertices[0].x, -1.0f, 1.0f);
-        vertices[1].y = mnkt_math_clamp(vertices[1].y, -1.0f, 1.0f);
-        vertices[2].z = mnkt_math_clamp(vertices[2].z, -1.0f, 1.0f);
+        // Signed distance of a vertex from the clipping planes (near, far and w = epsilon), positive inside
+        #define MNKT_CLIP_DISTANCE(v, plane)    ( (plane) == 0 ? (v).w + (v).z : ( (plane) == 1 ? (v).w - (v).z : (v).w - MNKT_CLIP_W_EPSILON ) )
+
+        int inside = 1;
+
+        for(int plane = 0; plane < 3; ++plane)
+        {
+                const float dist[3] = {
+                        MNKT_CLIP_DISTANCE(vertices[0], plane),
+                        MNKT_CLIP_DISTANCE(vertices[1], plane),
+                        MNKT_CLIP_DISTANCE(vertices[2], plane)
+                };
+
+                // Discard the triangle if all of its vertices lie outside of the plane
+                if( !(dist[0] >= 0.0f || dist[1] >= 0.0f || dist[2] >= 0.0f) )
+                        return 0;
+
+                if( !(dist[0] >= 0.0f && dist[1] >= 0.0f && dist[2] >= 0.0f) )
+                        inside = 0;
+        }
+
+        if(inside)
+                return 3;
+
+        if(varyingsCount > MAX_VARYING_PARAMS)
+                varyingsCount = MAX_VARYING_PARAMS;
+
+        // The varyings that are not interpolated keep the values of the first vertex, whichever vertex the polygon starts from
+        const size_t flatSize = (MAX_VARYING_PARAMS - varyingsCount) * sizeof(ShaderParameter_t);
+
+        memcpy(varyings[1] + varyingsCount, varyings[0] + varyingsCount, flatSize);
+        memcpy(varyings[2] + varyingsCount, varyings[0] + varyingsCount, flatSize);
+
+        Vec4_t inVertices[MNKT_CLIP_MAX_VERTICES];
+        ShaderParameter_t inVaryings[MNKT_CLIP_MAX_VERTICES][MAX_VARYING_PARAMS];
+        int count = 3;
+
+        for(int plane = 0; plane < 3 && count > 0; ++plane)
+        {
+                memcpy(inVertices, vertices, count * sizeof(Vec4_t));
+                memcpy(inVaryings, varyings, count * sizeof(inVaryings[0]));
+
+                const int inCount = count;
+                count = 0;
+
+                // Each edge adds at most two vertices, rounding errors on degenerate triangles can not overflow the polygon
+                for(int i = 0; i < inCount && count + 2 <= MNKT_CLIP_MAX_VERTICES; ++i)
+                {
+                        const int next = (i + 1 < inCount) ? i + 1 : 0;
+                        const Vec4_t* a = &inVertices[i];
+                        const Vec4_t* b = &inVertices[next];
+                        const float distA = MNKT_CLIP_DISTANCE(*a, plane);
+                        const float distB = MNKT_CLIP_DISTANCE(*b, plane);
+
+                        if(distA >= 0.0f)
+                        {
+                                vertices[count] = *a;
+                                memcpy(varyings[count], inVaryings[i], sizeof(varyings[count]));
+                                ++count;
+                        }
 
-        return 3;
+                        // Add the intersection of the edge with the plane
+                        if( (distA >= 0.0f) != (distB >= 0.0f) )
+                        {
+                                const float t = distA / (distA - distB);
+
+                                vertices[count].x = mnkt_math_lerp(a->x, b->x, t);
+                                vertices[count].y = mnkt_math_lerp(a->y, b->y, t);
+                                vertices[count].z = mnkt_math_lerp(a->z, b->z, t);
+                                vertices[count].w = mnkt_math_lerp(a->w, b->w, t);
+
+                                memcpy(varyings[count] + varyingsCount, inVaryings[i] + varyingsCount, flatSize);
+
+                                for(size_t k = 0; k < varyingsCount; ++k)
+                                {
+                                        Vec4_t* varying = &varyings[count][k].vec4;
+                                        const Vec4_t* varyingA = &inVaryings[i][k].vec4;
+                                        const Vec4_t* varyingB = &inVaryings[next][k].vec4;
+
+                                        varying->x = mnkt_math_lerp(varyingA->x, varyingB->x, t);
+                                        varying->y = mnkt_math_lerp(varyingA->y, varyingB->y, t);
+                                        varying->z = mnkt_math_lerp(varyingA->z, varyingB->z, t);
+                                        varying->w = mnkt_math_lerp(varyingA->w, varyingB->w, t);
+                                }
+
+                                ++count;
+                        }
+                }
+        }
+
+        #undef MNKT_CLIP_DISTANCE
+
+        return count;
 }
 
 
@@ -227,18 +1166,213 @@ static int mnkt_clipTriangle(Vec4_t vertices[3], Vec4_t additionalTriangle[3])
  * @function mnkt_ndcToScreenCoords
  * Converts NDC coordinates to screen coordinates (applies the viewport transform)
  * @param ndcCoords The coordinates to be converted from NDC to screen space
- * @param screenWidth The width of the screen
- * @param screenHeight The height of the screen
+ * @param viewport The viewport on which NDC coordinates are mapped
  * @return A Vec3 which defines the coordinates, in screen space, of the given point
 */
-static Vec3_t mnkt_ndcToScreenCoords(Vec4_t ndcCoords, size_t screenWidth, size_t screenHeight)
+static Vec3_t mnkt_ndcToScreenCoords(Vec4_t ndcCoords, const Viewport_t* viewport)
 {
         return (Vec3_t)
         {
-                .x = ( (ndcCoords.x + 1) / 2 ) * screenWidth,
-                .y = ( ( (-1 * ndcCoords.y) + 1) / 2) * screenHeight,
-                .z = ( (ndcCoords.z + 1) / 2 )
+                .x = viewport->x + ( (ndcCoords.x + 1) / 2 ) * viewport->width,
+                .y = viewport->y + ( ( (-1 * ndcCoords.y) + 1) / 2) * viewport->height,
+                .z = viewport->minDepth + ( (ndcCoords.z + 1) / 2 ) * (viewport->maxDepth - viewport->minDepth)
         };
 }
 
 
+/**
+ * @function mnkt_cullMeshlet
+ * Runs the back face and the occlusion tests on a meshlet that is inside the frustum and computes the rows of the framebuffer it covers
+ * @param meshlet The meshlet to be tested
+ * @param culling Parameters of the culling tests
+ * @param viewport Viewport on which the meshlet is mapped
+ * @param area Area of the framebuffer in which fragments can be produced
+ * @param rows Where the first and the last row covered by the meshlet are stored
+ * @return One if the meshlet can be visible, zero if it must be skipped
+ * @note: For internal usage only!!!
+*/
+static int mnkt_cullMeshlet(const Meshlet_t* meshlet, const MeshletCulling_t* culling, const Viewport_t* viewport, const Rect_t* area, int32_t rows[2])
+{
+        if(culling->cullBackFaces)
+        {
+                const Vec3_t view = {
+                        .x = meshlet->sphere.center.x - culling->cameraPosition.x,
+                        .y = meshlet->sphere.center.y - culling->cameraPosition.y,
+                        .z = meshlet->sphere.center.z - culling->cameraPosition.z
+                };
+
+                // All the normals of the cone point away from any point of the bounding sphere
+                if( mnkt_vec3_dot(&view, &meshlet->coneAxis) > (meshlet->coneCutoff * sqrtf(mnkt_vec3_dot(&view, &view))) + meshlet->sphere.radius )
+                        return 0;
+        }
+
+        Vec3_t screenMin, screenMax;
+
+        // Meshlets that can not be projected may cover any row and are never occluded
+        // (the ones that cross the near plane are bounded by their part in front of it, the rest of their triangles is clipped away)
+        if( mnkt_bounds_project(&meshlet->bounds, &culling->viewProjection, viewport, &screenMin, &screenMax) != 0 )
+        {
+                rows[0] = area->y;
+                rows[1] = area->y + area->height - 1;
+
+                return 1;
+        }
+
+        if( culling->hiz != NULL && !mnkt_hiz_testRect(culling->hiz, &screenMin, &screenMax) )
+                return 0;
+
+        // One row of margin on each side covers the rounding of the rasterizer
+        rows[0] = (int32_t) fmaxf(floorf(screenMin.y) - 1.0f, (float) area->y);
+        rows[1] = (int32_t) fminf(ceilf(screenMax.y) + 1.0f, (float) (area->y + area->height - 1));
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_runMeshletPass
+ * Draws the bands of a meshlets pass until all of them have been taken (run by each thread of the pass)
+ * @param pass The meshlets pass
+ * @note: For internal usage only!!!
+*/
+static void mnkt_runMeshletPass(void* pass)
+{
+        MeshletPass_t* meshletPass = pass;
+
+        for(;;)
+        {
+#ifdef MNKT_THREADS
+                uint32_t band = atomic_fetch_add_explicit(&meshletPass->nextBand, 1, memory_order_relaxed);
+#else
+                uint32_t band = meshletPass->nextBand++;
+#endif
+
+                if(band >= meshletPass->bandsCount)
+                        return;
+
+                mnkt_runMeshletPassBand(meshletPass, band);
+        }
+}
+
+
+/**
+ * @function mnkt_runMeshletPassBand
+ * Draws the visible meshlets that overlap a band of the framebuffer, fragments outside of the band are discarded by the scissor test
+ * @param pass The meshlets pass
+ * @param band Index of the band to be drawn
+ * @note: For internal usage only!!!
+*/
+static void mnkt_runMeshletPassBand(MeshletPass_t* pass, uint32_t band)
+{
+        const int32_t firstRow = pass->area.y + (int32_t) (band * pass->bandHeight);
+        const int32_t endRow = (firstRow + (int32_t) pass->bandHeight < pass->area.y + pass->area.height) ? firstRow + (int32_t) pass->bandHeight : pass->area.y + pass->area.height;
+
+        // Each band is drawn on its own copy of the framebuffer, with its own occlusion query counter
+        Framebuffer_t bandFb = *pass->fb;
+        OcclusionQuery_t bandQuery;
+
+        mnkt_framebuffer_setScissor(&bandFb, pass->area.x, firstRow, pass->area.width, endRow - firstRow);
+
+        if(pass->fb->query != NULL)
+        {
+                bandQuery = *pass->fb->query;
+                bandQuery.samplesPassed = 0;
+                bandFb.query = &bandQuery;
+        }
+
+        ProcessedVertex_t processed[MNKT_MESHLET_MAX_VERTICES];
+
+        for(uint32_t i = 0; i < pass->visibleCount; ++i)
+        {
+                if(pass->rows[i * 2] >= endRow || pass->rows[(i * 2) + 1] < firstRow)
+                        continue;
+
+                const Meshlet_t* meshlet = &pass->meshlets->meshlets[pass->visible[i]];
+                const uint32_t* vertexIndices = &pass->meshlets->vertexIndices[meshlet->vertexOffset];
+                const uint8_t* triangles = &pass->meshlets->triangles[(size_t) meshlet->triangleOffset * 3];
+
+                for(uint32_t v = 0; v < meshlet->verticesCount; ++v)
+                        mnkt_processVertex(pass->vertices + ((size_t) vertexIndices[v] * pass->shader->vertexSize), pass->shader, &processed[v]);
+
+                for(uint32_t t = 0; t < meshlet->trianglesCount; ++t)
+                {
+                        const uint8_t* triangle = &triangles[t * 3];
+
+                        mnkt_drawTriangle(&processed[triangle[0]], &processed[triangle[1]], &processed[triangle[2]], pass->shader, &bandFb);
+                }
+        }
+
+        pass->samplesPassed[band] = (pass->fb->query != NULL) ? bandQuery.samplesPassed : 0;
+
+        // Multisampled framebuffers are drawn in a single band, the slots taken from the color pool by the copy must be kept
+        if(pass->fb->multisample.samplesCount > 1)
+        {
+                pass->fb->multisample.colorPoolUsed = bandFb.multisample.colorPoolUsed;
+                pass->fb->multisample.colorPoolFree = bandFb.multisample.colorPoolFree;
+        }
+}
+
+
+/**
+ * @function mnkt_runFullscreenPass
+ * Processes the tiles of a full screen pass until all of them have been taken (run by each thread of the pass)
+ * @param pass The full screen pass
+ * @note: For internal usage only!!!
+*/
+static void mnkt_runFullscreenPass(void* pass)
+{
+        FullscreenPass_t* fullscreenPass = pass;
+
+        for(;;)
+        {
+#ifdef MNKT_THREADS
+                uint32_t tile = atomic_fetch_add_explicit(&fullscreenPass->nextTile, 1, memory_order_relaxed);
+#else
+                uint32_t tile = fullscreenPass->nextTile++;
+#endif
+
+                if(tile >= fullscreenPass->tilesCount)
+                        return;
+
+                mnkt_runFullscreenPassTile(fullscreenPass, tile);
+        }
+}
+
+
+/**
+ * @function mnkt_runFullscreenPassTile
+ * Runs the pixel shader of a full screen pass over the pixels of a tile
+ * @param pass The full screen pass
+ * @param tile Index of the tile to be processed
+ * @note: For internal usage only!!!
+*/
+static void mnkt_runFullscreenPassTile(const FullscreenPass_t* pass, uint32_t tile)
+{
+        Framebuffer_t* fb = pass->fb;
+
+        const int32_t startX = pass->area.x + (int32_t) ((tile % pass->tilesX) * MNKT_PASS_TILE_SIZE);
+        const int32_t startY = pass->area.y + (int32_t) ((tile / pass->tilesX) * MNKT_PASS_TILE_SIZE);
+        const int32_t endX = startX + MNKT_PASS_TILE_SIZE < pass->area.x + pass->area.width ? startX + MNKT_PASS_TILE_SIZE : pass->area.x + pass->area.width;
+        const int32_t endY = startY + MNKT_PASS_TILE_SIZE < pass->area.y + pass->area.height ? startY + MNKT_PASS_TILE_SIZE : pass->area.y + pass->area.height;
+
+        Vec4_t attachments[MNKT_MAX_COLOR_ATTACHMENTS];
+
+        for(int32_t y = startY; y < endY; ++y)
+        {
+                size_t pixelIndex = ((size_t) y * fb->width) + startX;
+                Vec2_t fragCoords = { .x = startX, .y = y };
+
+                for(int32_t x = startX; x < endX; ++x, ++pixelIndex, ++fragCoords.x)
+                {
+                        for(uint32_t i = 0; i < fb->attachmentsCount; ++i)
+                                attachments[i] = mnkt_framebuffer_readAttachment(&fb->attachments[i], pixelIndex);
+
+                        float depth = fb->depthBuffer != NULL ? fb->depthBuffer[pixelIndex] : 1.0f;
+                        Vec4_t color = pass->pixelShader(attachments, depth, pass->uniforms, &fragCoords);
+
+                        fb->colorBuffer[ pixelIndex * 3 ] =             mnkt_colorAsUChar(color.r);
+                        fb->colorBuffer[ (pixelIndex * 3) + 1 ] =       mnkt_colorAsUChar(color.g);
+                        fb->colorBuffer[ (pixelIndex * 3) + 2 ] =       mnkt_colorAsUChar(color.b);
+                }
+        }
+}
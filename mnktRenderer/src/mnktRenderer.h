@@ -11,10 +11,72 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "math/mat.h"
+#include "mesh.h"
+#include "meshOptimizer.h"
+#include "meshSimplifier.h"
+#include "culling.h"
+#include "meshlet.h"
 #include "image.h"
 #include "shader.h"
 #include "framebuffer.h"
 #include "rasterizer.h"
+#include "pipeline.h"
+#include "utility/jobs.h"
+
+
+/**
+ * @struct DrawCommand_t
+ * Triangles to be drawn by mnkt_drawBatch, together with the bounds used to cull them
+*/
+typedef struct {
+        void*                   vertices;               ///< Array of data that defines the properties of each vertex
+        size_t                  verticesCount;          ///< Number of elements stored in the vertices array
+        const uint32_t*         indices;                ///< Indices of the vertices (NULL to group the vertices three by three)
+        size_t                  indicesCount;           ///< Number of elements stored in the indices array
+        const BoundingBox_t*    bounds;                 ///< Bounds of the triangles, in the space of the frustum (NULL if the command is never culled)
+        ShaderProgram_t*        shader;                 ///< Shader program to be used for drawing
+} DrawCommand_t;
+
+
+/**
+ * @struct MeshletCulling_t
+ * Parameters of the tests run on each meshlet by mnkt_drawMeshlets, expressed in the space of the vertices
+*/
+typedef struct {
+        Mat4_t                  viewProjection;         ///< Matrix that transforms the vertices into clip coordinates (the same applied by the vertex shader)
+        Vec3_t                  cameraPosition;         ///< Position of the camera, used by the back face test
+        int                     cullBackFaces;          ///< Non zero to skip the meshlets whose triangles all face away from the camera (front faces are counter clockwise)
+        const HiZBuffer_t*      hiz;                    ///< Hierarchical depth buffer of the occluders (NULL to disable the occlusion test)
+} MeshletCulling_t;
+
+
+/**
+ * @function mnkt_beginFrame
+ * Prepares the given framebuffer for a new frame, all the transient data allocated
+ * by the pipeline during the previous frame is released (nothing is done on the framebuffers
+ * returned by mnkt_pipeline_beginFrame, which already resets their frame arena)
+ * @param fb Framebuffer on which the new frame will be rendered
+*/
+void mnkt_beginFrame(Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_beginQuery
+ * Activates an occlusion query on the given framebuffer, from now on the samples that pass the depth test are counted
+ * into the query (its counter is reset). Only one query can be active on a framebuffer at a time.
+ * @param query The query to be activated
+ * @param fb Framebuffer on which the query is activated
+*/
+void mnkt_beginQuery(OcclusionQuery_t* query, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_endQuery
+ * Deactivates the occlusion query active on the given framebuffer, its samplesPassed field holds the result
+ * @param fb Framebuffer on which the query was activated
+*/
+void mnkt_endQuery(Framebuffer_t* fb);
 
 
 /**
@@ -44,7 +106,7 @@ void mnkt_drawLines(void* vertices, const size_t verticesCount, ShaderProgram_t*
 
 /**
  * @function mnkt_drawPolyLine
- * Draws a continuous segmented line
+ * Draws a continuous segmented line (line strip), each vertex is processed by the vertex shader only once
  * @param vertices Array of data that defines the properties of each vertex that composes the line to be drawn,
  *      Vertices in this array define the points that are to be connected by the line.
  * @param verticesCount Number of elements stored in the given vertices array
@@ -54,6 +116,19 @@ void mnkt_drawLines(void* vertices, const size_t verticesCount, ShaderProgram_t*
 void mnkt_drawPolyLine(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb);
 
 
+/**
+ * @function mnkt_drawLineLoop
+ * Draws a closed segmented line (the last vertex is connected to the first one),
+ * each vertex is processed by the vertex shader only once
+ * @param vertices Array of data that defines the properties of each vertex that composes the line to be drawn.
+ *      Vertices in this array define the points that are to be connected by the line.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered line should be outputted
+*/
+void mnkt_drawLineLoop(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb);
+
+
 /**
  * @function mnkt_draw
  * Draws a sequence of triangles
@@ -66,6 +141,108 @@ void mnkt_drawPolyLine(void* vertices, const size_t verticesCount, ShaderProgram
 void mnkt_draw(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb);
 
 
+/**
+ * @function mnkt_drawInstanced
+ * Draws multiple instances of the same sequence of triangles.
+ * For each instance the built-in parameters MNKT_BUILTIN_INSTANCE_ID and MNKT_BUILTIN_INSTANCE_DATA are set
+ * in the shader's uniforms, so that the shaders can customize each instance (e.g. by applying a different transform).
+ * The given shader program is not modified: the parameters are set on a copy of it, made once for all the instances.
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ *      Vertices in this array are grouped three by three to form triangles.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param instances Array of per-instance attributes (can be NULL if the shaders only use the instance ID)
+ * @param instanceSize Size in bytes of the attributes of a single instance
+ * @param instancesCount Number of instances to be drawn
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawInstanced(void* vertices, const size_t verticesCount, const void* instances, const size_t instanceSize, const size_t instancesCount,
+                        ShaderProgram_t* shader, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_drawTriangleStrip
+ * Draws a strip of triangles, each vertex (after the first two) forms a triangle with the two vertices that precede it.
+ * Each vertex is processed by the vertex shader only once and the winding order of the triangles is preserved.
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawTriangleStrip(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_drawTriangleFan
+ * Draws a fan of triangles, each vertex (after the first two) forms a triangle with the previous vertex and the first one.
+ * Each vertex is processed by the vertex shader only once.
+ * @param vertices Array of data that defines the properties of each vertex that must be drawn.
+ * @param verticesCount Number of elements stored in the given vertices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawTriangleFan(void* vertices, const size_t verticesCount, ShaderProgram_t* shader, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_drawIndexed
+ * Draws a sequence of indexed triangles, vertices shared by nearby triangles are processed by the vertex shader only once
+ * as long as they are still in the post transform cache (the last MNKT_VERTEX_CACHE_SIZE processed vertices)
+ * @param vertices Array of data that defines the properties of each vertex that can be drawn
+ * @param verticesCount Number of elements stored in the given vertices array (triangles that refer to other vertices are skipped)
+ * @param indices Indices of the vertices, grouped three by three to form triangles
+ * @param indicesCount Number of elements stored in the given indices array
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+*/
+void mnkt_drawIndexed(void* vertices, const size_t verticesCount, const uint32_t* indices, const size_t indicesCount, ShaderProgram_t* shader, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_drawBatch
+ * Draws a sequence of commands, the bounds of the commands are tested against the frustum
+ * in batches and the commands that are completely outside of it are skipped before running the vertex shader
+ * @param commands Commands to be drawn, in order
+ * @param commandsCount Number of elements stored in the given commands array
+ * @param frustum Frustum against which the bounds are tested, e.g. mnkt_frustum_fromMatrix(viewProjection) for world space bounds (NULL to draw all the commands)
+ * @param fb Framebuffer on which the rendered triangles should be outputted
+ * @return The number of commands that have been drawn
+*/
+size_t mnkt_drawBatch(const DrawCommand_t* commands, const size_t commandsCount, const Frustum_t* frustum, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_drawMeshlets
+ * Draws the meshlets of an indexed mesh, the meshlets that are outside of the frustum, that face away from the camera
+ * or that are occluded are skipped before their vertices are shaded. The vertices of each meshlet are processed by the vertex shader once.
+ * The framebuffer is split into horizontal bands that are drawn in parallel by the given number of threads, each thread
+ * draws (in order) the meshlets whose projected bounds overlap its band, so the result does not depend on the number of threads.
+ * @param meshlets Meshlets of the mesh
+ * @param vertices Array of data that defines the properties of each vertex of the mesh
+ * @param verticesCount Number of elements stored in the given vertices array (meshlets that refer to other vertices are skipped)
+ * @param culling Parameters of the culling tests (NULL to draw all the meshlets on the calling thread only)
+ * @param threadsCount Maximum number of threads that draw the meshlets, the calling thread included, taken from the job system (0 or 1 to draw them on the calling thread only)
+ * @param shader Shader program to be used for drawing
+ * @param fb Framebuffer on which the rendered triangles should be outputted (multisampled framebuffers are drawn on the calling thread only)
+ * @return The number of meshlets that have been drawn
+*/
+size_t mnkt_drawMeshlets(const Meshlets_t* meshlets, void* vertices, const size_t verticesCount, const MeshletCulling_t* culling, uint32_t threadsCount,
+                         ShaderProgram_t* shader, Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_drawFullscreenPass
+ * Runs a function over all the pixels of the framebuffer (those inside the clip rectangle), e.g. the lighting pass of deferred shading.
+ * For each pixel the function receives the content of the color attachments and of the depth buffer, its output is stored into the color buffer.
+ * The framebuffer is split into tiles that are processed in parallel by the given number of threads.
+ * @param pixelShader Function to be run for each pixel
+ * @param uniforms Uniforms to be passed to the function (can be NULL)
+ * @param threadsCount Maximum number of threads that process the tiles, the calling thread included, taken from the job system (0 or 1 to run the pass on the calling thread only)
+ * @param fb Framebuffer on which the pass is run (must have a color buffer)
+*/
+void mnkt_drawFullscreenPass(PixelShaderFunc_t pixelShader, const ShaderParameter_t* uniforms, uint32_t threadsCount, Framebuffer_t* fb);
+
+
 #endif // MNKT_RENDERER_H
 
 
@@ -0,0 +1,932 @@
+/**
+ * @file pipeline.c
+ *
+ * Contains implementation of the frame pipeline API
+*/
+
+#include "pipeline.h"
+
+#include "mnktRenderer.h"
+#include "utility/jobs.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @macro MNKT_BIN_CHUNK_SIZE
+ * Number of commands stored in each chunk of the list of a band
+*/
+#define MNKT_BIN_CHUNK_SIZE             128
+
+
+/**
+ * @enum BinCommandType_t
+ * Operations recorded into the binning buffers
+ * @note: For internal usage only!!!
+*/
+typedef enum {
+        MNKT_BIN_TRIANGLE = 0,                  ///< Triangle to be rasterized
+        MNKT_BIN_LINE,                          ///< Line to be rasterized
+        MNKT_BIN_POINT,                         ///< Point to be rasterized
+        MNKT_BIN_FULLSCREEN_PASS,               ///< Full screen pass to be run
+} BinCommandType_t;
+
+
+/**
+ * @struct DrawState_t
+ * States of the recording framebuffer and of the shader program at the time a command was recorded
+ * @note: For internal usage only!!!
+*/
+typedef struct DrawState_t {
+        ShaderProgram_t         shader;                 ///< Copy of the shader program (uniforms included)
+        Viewport_t              viewport;               ///< Viewport of the framebuffer
+        Rect_t                  scissor;                ///< Scissor rectangle of the framebuffer
+        int                     scissorEnabled;         ///< Non zero if the scissor rectangle was enabled
+} DrawState_t;
+
+
+/**
+ * @struct BinCommand_t
+ * Command recorded into the binning buffers, followed by the varyings of its vertices
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        BinCommandType_t        type;                   ///< Operation to be performed
+        const DrawState_t*      state;                  ///< States used to perform it
+        Vec3_t                  screenCoords[3];        ///< Screen coordinates of the vertices of the primitive
+        size_t                  pointSize;              ///< Size of the point, expressed in pixels
+        PixelShaderFunc_t       pixelShader;            ///< Function run by the full screen pass
+        const ShaderParameter_t* uniforms;              ///< Uniforms passed to the full screen pass
+        int                     hasVaryings;            ///< Non zero if the varyings are stored (they are never read by depth only programs)
+        uint32_t                varyingsCount;          ///< Number of varyings stored for each vertex after the first one (all of them are stored for the first one)
+        ShaderParameter_t       varyings[];             ///< Varyings of the vertices
+} BinCommand_t;
+
+
+/**
+ * @struct BinChunk_t
+ * Part of the list of the commands that overlap a band
+ * @note: For internal usage only!!!
+*/
+typedef struct BinChunk_t {
+        struct BinChunk_t*      next;                                   ///< Next chunk of the list
+        uint32_t                count;                                  ///< Number of commands stored in the chunk
+        const BinCommand_t*     commands[MNKT_BIN_CHUNK_SIZE];          ///< Commands, in the order they were recorded
+} BinChunk_t;
+
+
+/**
+ * @struct FramePass_t
+ * State of the rasterization of a frame shared by all the threads that run it, each thread repeatedly takes the next band
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        Framebuffer_t*          fb;                     ///< Framebuffer on which the frame is rendered
+        const FrameBins_t*      bins;                   ///< Binning buffers of the frame
+#ifdef MNKT_THREADS
+        atomic_uint             nextBand;               ///< Index of the next band to be rasterized
+#else
+        uint32_t                nextBand;               ///< Index of the next band to be rasterized
+#endif
+} FramePass_t;
+
+
+// Prototypes for internal functions
+
+static void     mnkt_pipeline_renderFrame(FramePipeline_t* pipeline, uint64_t fence);
+static void     mnkt_pipeline_runFramePass(void* pass);
+static void     mnkt_pipeline_runBand(const FramePass_t* pass, uint32_t band, Framebuffer_t* bandFb);
+static void     mnkt_pipeline_runCommand(const BinCommand_t* command, Framebuffer_t* bandFb);
+#ifdef MNKT_THREADS
+static int      mnkt_pipeline_runBackEnd(void* data);
+#endif
+
+static BinCommand_t* mnkt_frameBins_newCommand(FrameBins_t* bins, const Framebuffer_t* fb, BinCommandType_t type, const ShaderProgram_t* shader, uint32_t verticesCount);
+static const DrawState_t* mnkt_frameBins_getState(FrameBins_t* bins, const Framebuffer_t* fb, const ShaderProgram_t* shader);
+static void     mnkt_frameBins_storeVaryings(BinCommand_t* command, const ShaderParameter_t* varyings, uint32_t vertex);
+static void     mnkt_frameBins_loadVaryings(const BinCommand_t* command, ShaderParameter_t* varyings, uint32_t vertex);
+static int      mnkt_frameBins_getBands(const FrameBins_t* bins, const Framebuffer_t* fb, float minY, float maxY, uint32_t* firstBand, uint32_t* lastBand);
+static void     mnkt_frameBins_insert(FrameBins_t* bins, const BinCommand_t* command, uint32_t firstBand, uint32_t lastBand);
+
+
+/**
+ * @function mnkt_pipeline_create
+ * Initializes a frame pipeline and starts its back end thread
+ * @param pipeline The pipeline to be initialized (must be released with mnkt_pipeline_destroy)
+ * @param framebuffers The framebuffers on which the frames are rendered in turn (distinct, same size, the pipeline does not take ownership of them),
+ *      the commands of each frame are stored in the frame arena of its framebuffer (created by mnkt_framebuffer_init)
+ * @param workersCount Maximum number of threads that rasterize each frame, taken from the job system (0 to rasterize the frames on the calling thread, when they are submitted)
+ * @param onComplete Function invoked, on the back end thread, once a frame has been rasterized (can be NULL)
+ * @param userData Pointer passed to the completion function
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_pipeline_create(FramePipeline_t* pipeline, Framebuffer_t* framebuffers[MNKT_PIPELINE_FRAMES], uint32_t workersCount,
+                         FrameCompleteFunc_t onComplete, void* userData)
+{
+        if(pipeline == NULL)
+                return 1;
+
+        memset(pipeline, 0, sizeof(FramePipeline_t));
+
+        if(framebuffers == NULL || framebuffers[0] == NULL)
+                return 1;
+
+        const uint32_t bandsCount = (framebuffers[0]->height + MNKT_PIPELINE_BAND_HEIGHT - 1) / MNKT_PIPELINE_BAND_HEIGHT;
+
+        for(uint32_t i = 0; i < MNKT_PIPELINE_FRAMES; ++i)
+        {
+                // The commands of each frame are stored in the frame arena of its framebuffer
+                if(framebuffers[i] == NULL || framebuffers[i]->width != framebuffers[0]->width || framebuffers[i]->height != framebuffers[0]->height ||
+                   framebuffers[i]->frameArena == NULL || (i > 0 && framebuffers[i] == framebuffers[0]))
+                {
+                        mnkt_pipeline_destroy(pipeline);
+                        return 1;
+                }
+
+                FrameBins_t* bins = &pipeline->bins[i];
+
+                pipeline->framebuffers[i] = framebuffers[i];
+                bins->bandsCount = bandsCount;
+                bins->firstChunks = calloc( (bandsCount > 0 ? bandsCount : 1) * 2, sizeof(BinChunk_t*) );
+                bins->lastChunks = bins->firstChunks + bandsCount;
+
+                bins->arena = mnkt_frameArena_getThreadArena(framebuffers[i]->frameArena, 0);
+
+                if(bins->firstChunks == NULL)
+                {
+                        mnkt_pipeline_destroy(pipeline);
+                        return 1;
+                }
+        }
+
+        pipeline->workersCount = (workersCount < MNKT_MAX_THREADS) ? workersCount : MNKT_MAX_THREADS;
+        pipeline->onComplete = onComplete;
+        pipeline->userData = userData;
+
+#ifdef MNKT_THREADS
+        // Without a back end thread the frames are rasterized when they are submitted
+        if(pipeline->workersCount == 0)
+                return 0;
+
+        if(mtx_init(&pipeline->mutex, mtx_plain) != thrd_success)
+                return 0;
+
+        if(cnd_init(&pipeline->frameSubmitted) != thrd_success)
+        {
+                mtx_destroy(&pipeline->mutex);
+                return 0;
+        }
+
+        if(cnd_init(&pipeline->frameCompleted) != thrd_success)
+        {
+                cnd_destroy(&pipeline->frameSubmitted);
+                mtx_destroy(&pipeline->mutex);
+                return 0;
+        }
+
+        if(thrd_create(&pipeline->backEnd, mnkt_pipeline_runBackEnd, pipeline) != thrd_success)
+        {
+                cnd_destroy(&pipeline->frameCompleted);
+                cnd_destroy(&pipeline->frameSubmitted);
+                mtx_destroy(&pipeline->mutex);
+                return 0;
+        }
+
+        pipeline->asynchronous = 1;
+#endif
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_pipeline_destroy
+ * Waits for the completion of the submitted frames, stops the back end thread and releases the binning buffers
+ * @param pipeline The pipeline to be destroyed
+*/
+void mnkt_pipeline_destroy(FramePipeline_t* pipeline)
+{
+        if(pipeline == NULL)
+                return;
+
+        // The frame being recorded is discarded
+        pipeline->recordingFence = 0;
+        mnkt_pipeline_wait(pipeline, pipeline->submittedFence);
+
+#ifdef MNKT_THREADS
+        if(pipeline->asynchronous)
+        {
+                mtx_lock(&pipeline->mutex);
+                pipeline->stop = 1;
+                cnd_signal(&pipeline->frameSubmitted);
+                mtx_unlock(&pipeline->mutex);
+
+                thrd_join(pipeline->backEnd, NULL);
+
+                cnd_destroy(&pipeline->frameCompleted);
+                cnd_destroy(&pipeline->frameSubmitted);
+                mtx_destroy(&pipeline->mutex);
+        }
+#endif
+
+        for(uint32_t i = 0; i < MNKT_PIPELINE_FRAMES; ++i)
+        {
+                free(pipeline->bins[i].firstChunks);
+        }
+
+        memset(pipeline, 0, sizeof(FramePipeline_t));
+}
+
+
+/**
+ * @function mnkt_pipeline_beginFrame
+ * Starts recording a new frame, waiting until the framebuffer it uses is no longer in flight.
+ * The returned framebuffer is drawn with the usual API (viewport and scissor can be changed between draws): primitives and
+ * full screen passes are recorded, in order, and executed by the back end. Occlusion queries are not supported while recording.
+ * Vertex data can be modified as soon as a draw call returns, textures and uniforms pointers must stay valid until the frame is completed.
+ * @param pipeline The pipeline
+ * @param clearColor Color to which the framebuffer is cleared at the start of the frame (NULL to keep the content of the color buffer)
+ * @param clearDepth Value to which the depth buffer is cleared at the start of the frame
+ * @return The framebuffer on which the frame must be drawn (valid until the frame is submitted), NULL on failure
+*/
+Framebuffer_t* mnkt_pipeline_beginFrame(FramePipeline_t* pipeline, const unsigned char clearColor[3], float clearDepth)
+{
+        if(pipeline == NULL || pipeline->framebuffers[0] == NULL || pipeline->recordingFence != 0)
+                return NULL;
+
+        const uint64_t fence = pipeline->submittedFence + 1;
+        const uint32_t slot = (uint32_t) ((fence - 1) % MNKT_PIPELINE_FRAMES);
+
+        // Wait for the frame that used the same framebuffer and binning buffers
+        if(fence > MNKT_PIPELINE_FRAMES)
+                mnkt_pipeline_wait(pipeline, fence - MNKT_PIPELINE_FRAMES);
+
+        FrameBins_t* bins = &pipeline->bins[slot];
+
+        mnkt_frameArena_reset(pipeline->framebuffers[slot]->frameArena);
+        memset(bins->firstChunks, 0, (size_t) bins->bandsCount * 2 * sizeof(BinChunk_t*));
+
+        bins->lastState = NULL;
+        bins->clearColor = (clearColor != NULL);
+        bins->clearDepth = clearDepth;
+
+        if(clearColor != NULL)
+                memcpy(bins->clearRgb, clearColor, sizeof(bins->clearRgb));
+
+        pipeline->recording = *pipeline->framebuffers[slot];
+        pipeline->recording.query = NULL;
+        pipeline->recording.bins = bins;
+        pipeline->recordingFence = fence;
+
+        return &pipeline->recording;
+}
+
+
+/**
+ * @function mnkt_pipeline_submit
+ * Ends the recording of the current frame and hands it to the back end
+ * @param pipeline The pipeline
+ * @return The fence of the frame (zero if no frame was being recorded)
+*/
+uint64_t mnkt_pipeline_submit(FramePipeline_t* pipeline)
+{
+        if(pipeline == NULL || pipeline->recordingFence == 0)
+                return 0;
+
+        const uint64_t fence = pipeline->recordingFence;
+
+        pipeline->recording.bins = NULL;
+        pipeline->recordingFence = 0;
+
+#ifdef MNKT_THREADS
+        if(pipeline->asynchronous)
+        {
+                mtx_lock(&pipeline->mutex);
+                pipeline->submittedFence = fence;
+                cnd_signal(&pipeline->frameSubmitted);
+                mtx_unlock(&pipeline->mutex);
+
+                return fence;
+        }
+#endif
+
+        pipeline->submittedFence = fence;
+        mnkt_pipeline_renderFrame(pipeline, fence);
+        pipeline->completedFence = fence;
+
+        return fence;
+}
+
+
+/**
+ * @function mnkt_pipeline_isComplete
+ * Checks, without waiting, if a frame has been completed (its completion function has returned)
+ * @param pipeline The pipeline
+ * @param fence The fence of the frame
+ * @return One if the frame has been completed, zero otherwise
+*/
+int mnkt_pipeline_isComplete(FramePipeline_t* pipeline, uint64_t fence)
+{
+        if(pipeline == NULL)
+                return 1;
+
+#ifdef MNKT_THREADS
+        if(pipeline->asynchronous)
+        {
+                mtx_lock(&pipeline->mutex);
+                const int complete = (pipeline->completedFence >= fence);
+                mtx_unlock(&pipeline->mutex);
+
+                return complete;
+        }
+#endif
+
+        return pipeline->completedFence >= fence;
+}
+
+
+/**
+ * @function mnkt_pipeline_wait
+ * Waits until a frame has been completed (its completion function has returned)
+ * @param pipeline The pipeline
+ * @param fence The fence of the frame (frames are completed in order, so all the previous ones are completed as well)
+*/
+void mnkt_pipeline_wait(FramePipeline_t* pipeline, uint64_t fence)
+{
+        if(pipeline == NULL)
+                return;
+
+#ifdef MNKT_THREADS
+        if(pipeline->asynchronous)
+        {
+                mtx_lock(&pipeline->mutex);
+
+                // Frames that have not been submitted yet would never be completed
+                while(pipeline->completedFence < fence && pipeline->completedFence < pipeline->submittedFence)
+                        cnd_wait(&pipeline->frameCompleted, &pipeline->mutex);
+
+                mtx_unlock(&pipeline->mutex);
+        }
+#else
+        (void) fence;
+#endif
+}
+
+
+/**
+ * @function mnkt_frameBins_addTriangle
+ * Records a triangle, in screen coordinates, into the bins of the bands it overlaps
+ * @param fb The recording framebuffer (its viewport and scissor are recorded together with the shader)
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param shader Shader program to be used to rasterize the triangle
+ * @param varyings Varyings outputted by the vertex shader for the three vertices of the triangle
+ * @note: Used by the renderer to record the primitives drawn on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addTriangle(const Framebuffer_t* fb, const Vec3_t screenCoords[3], const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS])
+{
+        const float minY = fminf(screenCoords[0].y, fminf(screenCoords[1].y, screenCoords[2].y));
+        const float maxY = fmaxf(screenCoords[0].y, fmaxf(screenCoords[1].y, screenCoords[2].y));
+
+        uint32_t firstBand;
+        uint32_t lastBand;
+
+        if( !mnkt_frameBins_getBands(fb->bins, fb, minY, maxY, &firstBand, &lastBand) )
+                return;
+
+        BinCommand_t* command = mnkt_frameBins_newCommand(fb->bins, fb, MNKT_BIN_TRIANGLE, shader, 3);
+
+        if(command == NULL)
+                return;
+
+        for(uint32_t i = 0; i < 3; ++i)
+        {
+                command->screenCoords[i] = screenCoords[i];
+                mnkt_frameBins_storeVaryings(command, varyings[i], i);
+        }
+
+        mnkt_frameBins_insert(fb->bins, command, firstBand, lastBand);
+}
+
+
+/**
+ * @function mnkt_frameBins_addLine
+ * Records a line, in screen coordinates, into the bins of the bands it overlaps
+ * @param fb The recording framebuffer (its viewport and scissor are recorded together with the shader)
+ * @param screenCoords Screen coordinates of the extreme points of the line
+ * @param shader Shader program to be used to rasterize the line
+ * @param varyings Varyings outputted by the vertex shader for the two extreme points
+ * @note: Used by the renderer to record the primitives drawn on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addLine(const Framebuffer_t* fb, const Vec3_t screenCoords[2], const ShaderProgram_t* shader, const ShaderParameter_t varyings[2][MAX_VARYING_PARAMS])
+{
+        // Wide and anti-aliased lines cover pixels around the segment
+        const float padding = fmaxf(shader->lineWidth, 1.0f) + 2.0f;
+
+        uint32_t firstBand;
+        uint32_t lastBand;
+
+        if( !mnkt_frameBins_getBands(fb->bins, fb, fminf(screenCoords[0].y, screenCoords[1].y) - padding, fmaxf(screenCoords[0].y, screenCoords[1].y) + padding, &firstBand, &lastBand) )
+                return;
+
+        BinCommand_t* command = mnkt_frameBins_newCommand(fb->bins, fb, MNKT_BIN_LINE, shader, 2);
+
+        if(command == NULL)
+                return;
+
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+                command->screenCoords[i] = screenCoords[i];
+                mnkt_frameBins_storeVaryings(command, varyings[i], i);
+        }
+
+        mnkt_frameBins_insert(fb->bins, command, firstBand, lastBand);
+}
+
+
+/**
+ * @function mnkt_frameBins_addPoint
+ * Records a point, in screen coordinates, into the bins of the bands it overlaps
+ * @param fb The recording framebuffer (its viewport and scissor are recorded together with the shader)
+ * @param screenCoords Screen coordinates of the center of the point
+ * @param pointSize Size of the point, expressed in pixels
+ * @param shader Shader program to be used to rasterize the point
+ * @param varyings Varyings outputted by the vertex shader for the point
+ * @note: Used by the renderer to record the primitives drawn on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addPoint(const Framebuffer_t* fb, Vec3_t screenCoords, size_t pointSize, const ShaderProgram_t* shader, const ShaderParameter_t varyings[MAX_VARYING_PARAMS])
+{
+        const float padding = (float) pointSize + 1.0f;
+
+        uint32_t firstBand;
+        uint32_t lastBand;
+
+        if( !mnkt_frameBins_getBands(fb->bins, fb, screenCoords.y - padding, screenCoords.y + padding, &firstBand, &lastBand) )
+                return;
+
+        BinCommand_t* command = mnkt_frameBins_newCommand(fb->bins, fb, MNKT_BIN_POINT, shader, 1);
+
+        if(command == NULL)
+                return;
+
+        command->screenCoords[0] = screenCoords;
+        command->pointSize = pointSize;
+        mnkt_frameBins_storeVaryings(command, varyings, 0);
+
+        mnkt_frameBins_insert(fb->bins, command, firstBand, lastBand);
+}
+
+
+/**
+ * @function mnkt_frameBins_addFullscreenPass
+ * Records a full screen pass into the bins of all the bands
+ * @param fb The recording framebuffer (its viewport and scissor are recorded as well)
+ * @param pixelShader Function to be run for each pixel
+ * @param uniforms Uniforms to be passed to the function (can be NULL, must stay valid until the frame is completed)
+ * @note: Used by the renderer to record the passes run on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addFullscreenPass(const Framebuffer_t* fb, PixelShaderFunc_t pixelShader, const ShaderParameter_t* uniforms)
+{
+        uint32_t firstBand;
+        uint32_t lastBand;
+
+        if( !mnkt_frameBins_getBands(fb->bins, fb, 0.0f, (float) fb->height, &firstBand, &lastBand) )
+                return;
+
+        BinCommand_t* command = mnkt_frameBins_newCommand(fb->bins, fb, MNKT_BIN_FULLSCREEN_PASS, NULL, 0);
+
+        if(command == NULL)
+                return;
+
+        command->pixelShader = pixelShader;
+        command->uniforms = uniforms;
+
+        mnkt_frameBins_insert(fb->bins, command, firstBand, lastBand);
+}
+
+
+/**
+ * @function mnkt_pipeline_renderFrame
+ * Rasterizes the bands of a submitted frame and invokes the completion function
+ * @param pipeline The pipeline
+ * @param fence The fence of the frame
+ * @note: For internal usage only!!!
+*/
+static void mnkt_pipeline_renderFrame(FramePipeline_t* pipeline, uint64_t fence)
+{
+        const uint32_t slot = (uint32_t) ((fence - 1) % MNKT_PIPELINE_FRAMES);
+        Framebuffer_t* fb = pipeline->framebuffers[slot];
+        const FrameBins_t* bins = &pipeline->bins[slot];
+
+        FramePass_t pass = {
+                .fb = fb,
+                .bins = bins
+        };
+
+        // The whole color buffer is cleared, so the color pool is emptied at once (the clear of each band finds no slot to release)
+        if(bins->clearColor && fb->multisample.samplesCount > 1)
+        {
+                memset(fb->multisample.colorIndices, 0xFF, sizeof(uint32_t) * fb->width * fb->height);
+                fb->multisample.colorPoolUsed = 0;
+                fb->multisample.colorPoolFree = MNKT_PIXEL_COMPRESSED;
+        }
+
+        // Bands of multisampled framebuffers share the color pool, they are rasterized by a single thread
+        uint32_t workersCount = (pipeline->workersCount > 0) ? pipeline->workersCount : 1;
+
+        if(fb->multisample.samplesCount > 1)
+                workersCount = 1;
+
+        if(workersCount > bins->bandsCount)
+                workersCount = bins->bandsCount;
+
+#ifdef MNKT_THREADS
+        atomic_init(&pass.nextBand, 0);
+#else
+        pass.nextBand = 0;
+#endif
+
+        // The back end thread works together with the workers of the job system, the bands are taken by whoever is free
+        mnkt_jobs_runParallel(mnkt_pipeline_runFramePass, &pass, workersCount);
+
+        if(pipeline->onComplete != NULL)
+                pipeline->onComplete(fb, fence, pipeline->userData);
+}
+
+
+/**
+ * @function mnkt_pipeline_runFramePass
+ * Rasterizes the bands of a frame until all of them have been taken (run by each thread that rasterizes the frame)
+ * @param pass The rasterization of the frame
+ * @note: For internal usage only!!!
+*/
+static void mnkt_pipeline_runFramePass(void* pass)
+{
+        FramePass_t* framePass = pass;
+
+        // Each thread draws on its own copy of the framebuffer, whose viewport and scissor are set by each command
+        Framebuffer_t bandFb = *framePass->fb;
+
+        bandFb.query = NULL;
+        bandFb.frameArena = NULL;
+        bandFb.bins = NULL;
+
+        for(;;)
+        {
+#ifdef MNKT_THREADS
+                uint32_t band = atomic_fetch_add_explicit(&framePass->nextBand, 1, memory_order_relaxed);
+#else
+                uint32_t band = framePass->nextBand++;
+#endif
+
+                if(band >= framePass->bins->bandsCount)
+                        break;
+
+                mnkt_pipeline_runBand(framePass, band, &bandFb);
+        }
+
+        // Multisampled framebuffers are rasterized by a single thread, the slots taken from the color pool by the copy must be kept
+        if(framePass->fb->multisample.samplesCount > 1)
+        {
+                framePass->fb->multisample.colorPoolUsed = bandFb.multisample.colorPoolUsed;
+                framePass->fb->multisample.colorPoolFree = bandFb.multisample.colorPoolFree;
+        }
+}
+
+
+/**
+ * @function mnkt_pipeline_runBand
+ * Clears a band of the framebuffer and executes, in order, the commands that overlap it
+ * @param pass The rasterization of the frame
+ * @param band Index of the band
+ * @param bandFb Copy of the framebuffer used by the thread, fragments outside of the band are discarded by the scissor test
+ * @note: For internal usage only!!!
+*/
+static void mnkt_pipeline_runBand(const FramePass_t* pass, uint32_t band, Framebuffer_t* bandFb)
+{
+        const FrameBins_t* bins = pass->bins;
+
+        const int32_t firstRow = (int32_t) (band * MNKT_PIPELINE_BAND_HEIGHT);
+        const int32_t endRow = (firstRow + MNKT_PIPELINE_BAND_HEIGHT < (int32_t) bandFb->height) ? firstRow + MNKT_PIPELINE_BAND_HEIGHT : (int32_t) bandFb->height;
+
+        mnkt_framebuffer_setScissor(bandFb, 0, firstRow, (int32_t) bandFb->width, endRow - firstRow);
+
+        if(bins->clearColor)
+                mnkt_framebuffer_clearColor(bins->clearRgb[0], bins->clearRgb[1], bins->clearRgb[2], bandFb);
+
+        mnkt_framebuffer_clearDepth(bins->clearDepth, bandFb);
+
+        for(const BinChunk_t* chunk = bins->firstChunks[band]; chunk != NULL; chunk = chunk->next)
+        {
+                for(uint32_t i = 0; i < chunk->count; ++i)
+                {
+                        const BinCommand_t* command = chunk->commands[i];
+                        const DrawState_t* state = command->state;
+
+                        // Scissor rectangle of the command restricted to the band
+                        Rect_t scissor = { .x = 0, .y = firstRow, .width = (int32_t) bandFb->width, .height = endRow - firstRow };
+
+                        if(state->scissorEnabled)
+                        {
+                                const int32_t x0 = (state->scissor.x > scissor.x) ? state->scissor.x : scissor.x;
+                                const int32_t y0 = (state->scissor.y > scissor.y) ? state->scissor.y : scissor.y;
+                                const int32_t x1 = (state->scissor.x + state->scissor.width < scissor.x + scissor.width) ? state->scissor.x + state->scissor.width : scissor.x + scissor.width;
+                                const int32_t y1 = (state->scissor.y + state->scissor.height < scissor.y + scissor.height) ? state->scissor.y + state->scissor.height : scissor.y + scissor.height;
+
+                                if(x1 <= x0 || y1 <= y0)
+                                        continue;
+
+                                scissor = (Rect_t) { .x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0 };
+                        }
+
+                        bandFb->viewport = state->viewport;
+                        mnkt_framebuffer_setScissor(bandFb, scissor.x, scissor.y, scissor.width, scissor.height);
+
+                        mnkt_pipeline_runCommand(command, bandFb);
+                }
+        }
+}
+
+
+/**
+ * @function mnkt_pipeline_runCommand
+ * Executes a recorded command on the copy of the framebuffer of a thread
+ * @param command The command
+ * @param bandFb Copy of the framebuffer, with the viewport and the scissor rectangle of the command
+ * @note: For internal usage only!!!
+*/
+static void mnkt_pipeline_runCommand(const BinCommand_t* command, Framebuffer_t* bandFb)
+{
+        const ShaderProgram_t* shader = &command->state->shader;
+
+        Vec3_t screenCoords[3];
+        ShaderParameter_t varyings[3][MAX_VARYING_PARAMS];
+
+        switch(command->type)
+        {
+                case MNKT_BIN_TRIANGLE:
+                        for(uint32_t i = 0; i < 3; ++i)
+                        {
+                                screenCoords[i] = command->screenCoords[i];
+                                mnkt_frameBins_loadVaryings(command, varyings[i], i);
+                        }
+
+                        mnkt_rasterizeTriangle(screenCoords, shader, (const ShaderParameter_t (*)[MAX_VARYING_PARAMS]) varyings, bandFb);
+                        break;
+
+                case MNKT_BIN_LINE:
+                        for(uint32_t i = 0; i < 2; ++i)
+                        {
+                                screenCoords[i] = command->screenCoords[i];
+                                mnkt_frameBins_loadVaryings(command, varyings[i], i);
+                        }
+
+                        mnkt_rasterizeLine(screenCoords, shader, (const ShaderParameter_t (*)[MAX_VARYING_PARAMS]) varyings, bandFb);
+                        break;
+
+                case MNKT_BIN_POINT:
+                        mnkt_frameBins_loadVaryings(command, varyings[0], 0);
+                        mnkt_rasterizePoint(command->screenCoords[0], command->pointSize, shader, varyings[0], bandFb);
+                        break;
+
+                case MNKT_BIN_FULLSCREEN_PASS:
+                        mnkt_drawFullscreenPass(command->pixelShader, command->uniforms, 1, bandFb);
+                        break;
+        }
+}
+
+
+#ifdef MNKT_THREADS
+/**
+ * @function mnkt_pipeline_runBackEnd
+ * Rasterizes the submitted frames, in order, until the pipeline is destroyed (entry point of the back end thread)
+ * @param data The pipeline
+ * @return Always zero
+ * @note: For internal usage only!!!
+*/
+static int mnkt_pipeline_runBackEnd(void* data)
+{
+        FramePipeline_t* pipeline = data;
+
+        mtx_lock(&pipeline->mutex);
+
+        for(;;)
+        {
+                while(pipeline->completedFence == pipeline->submittedFence && !pipeline->stop)
+                        cnd_wait(&pipeline->frameSubmitted, &pipeline->mutex);
+
+                if(pipeline->completedFence == pipeline->submittedFence)
+                        break;
+
+                const uint64_t fence = pipeline->completedFence + 1;
+
+                mtx_unlock(&pipeline->mutex);
+                mnkt_pipeline_renderFrame(pipeline, fence);
+                mtx_lock(&pipeline->mutex);
+
+                pipeline->completedFence = fence;
+                cnd_broadcast(&pipeline->frameCompleted);
+        }
+
+        mtx_unlock(&pipeline->mutex);
+        return 0;
+}
+#endif
+
+
+/**
+ * @function mnkt_frameBins_newCommand
+ * Allocates a command, together with the space for the varyings of its vertices, and sets its state
+ * @param bins The binning buffers
+ * @param fb The recording framebuffer
+ * @param type Operation performed by the command
+ * @param shader Shader program used by the command (NULL for full screen passes)
+ * @param verticesCount Number of vertices of the primitive
+ * @return The command, NULL if the memory could not be allocated
+ * @note: For internal usage only!!!
+*/
+static BinCommand_t* mnkt_frameBins_newCommand(FrameBins_t* bins, const Framebuffer_t* fb, BinCommandType_t type, const ShaderProgram_t* shader, uint32_t verticesCount)
+{
+        const DrawState_t* state = mnkt_frameBins_getState(bins, fb, shader);
+
+        if(state == NULL)
+                return NULL;
+
+        // Varyings are read unless the rasterizer treats the command as depth only (no color buffer nor render targets),
+        // only the interpolated ones are read from the vertices after the first one
+        const int hasVaryings = (shader != NULL && !shader->depthOnly && (fb->colorBuffer != NULL || shader->targetsShader != NULL) && verticesCount > 0);
+        const uint32_t varyingsCount = hasVaryings ? (uint32_t) (shader->varyingsCount < MAX_VARYING_PARAMS ? shader->varyingsCount : MAX_VARYING_PARAMS) : 0;
+        const size_t storedVaryings = hasVaryings ? MAX_VARYING_PARAMS + ((size_t) (verticesCount - 1) * varyingsCount) : 0;
+
+        BinCommand_t* command = mnkt_arena_alloc(bins->arena, sizeof(BinCommand_t) + (storedVaryings * sizeof(ShaderParameter_t)), _Alignof(BinCommand_t));
+
+        if(command == NULL)
+                return NULL;
+
+        command->type = type;
+        command->state = state;
+        command->pointSize = 0;
+        command->pixelShader = NULL;
+        command->uniforms = NULL;
+        command->hasVaryings = hasVaryings;
+        command->varyingsCount = varyingsCount;
+
+        return command;
+}
+
+
+/**
+ * @function mnkt_frameBins_getState
+ * Gets the state of the commands drawn with the given framebuffer and shader, the state of the previous command is shared if they did not change
+ * @param bins The binning buffers
+ * @param fb The recording framebuffer
+ * @param shader Shader program used by the command (can be NULL)
+ * @return The state, NULL if the memory could not be allocated
+ * @note: For internal usage only!!!
+*/
+static const DrawState_t* mnkt_frameBins_getState(FrameBins_t* bins, const Framebuffer_t* fb, const ShaderProgram_t* shader)
+{
+        // Most commands are recorded by the same draw call, the last state is compared in place without building a new one
+        const DrawState_t* last = bins->lastState;
+
+        if(last != NULL && last->scissorEnabled == fb->scissorEnabled &&
+           memcmp(&last->viewport, &fb->viewport, sizeof(Viewport_t)) == 0 && memcmp(&last->scissor, &fb->scissor, sizeof(Rect_t)) == 0)
+        {
+                if(shader != NULL ? memcmp(&last->shader, shader, sizeof(ShaderProgram_t)) == 0 : last->shader.vertexShader == NULL)
+                        return last;
+        }
+
+        DrawState_t* state = mnkt_arena_alloc(bins->arena, sizeof(DrawState_t), _Alignof(DrawState_t));
+
+        if(state == NULL)
+                return NULL;
+
+        memset(state, 0, sizeof(DrawState_t));
+
+        if(shader != NULL)
+                memcpy(&state->shader, shader, sizeof(ShaderProgram_t));
+
+        state->viewport = fb->viewport;
+        state->scissor = fb->scissor;
+        state->scissorEnabled = fb->scissorEnabled;
+
+        bins->lastState = state;
+
+        return state;
+}
+
+
+/**
+ * @function mnkt_frameBins_storeVaryings
+ * Copies the varyings of a vertex into a command (all of them for the first vertex, only the interpolated ones for the others)
+ * @param command The command
+ * @param varyings Varyings of the vertex
+ * @param vertex Index of the vertex inside the primitive
+ * @note: For internal usage only!!!
+*/
+static void mnkt_frameBins_storeVaryings(BinCommand_t* command, const ShaderParameter_t* varyings, uint32_t vertex)
+{
+        if( !command->hasVaryings )
+                return;
+
+        if(vertex == 0)
+                memcpy(command->varyings, varyings, MAX_VARYING_PARAMS * sizeof(ShaderParameter_t));
+        else
+                memcpy(&command->varyings[MAX_VARYING_PARAMS + ((vertex - 1) * command->varyingsCount)], varyings, command->varyingsCount * sizeof(ShaderParameter_t));
+}
+
+
+/**
+ * @function mnkt_frameBins_loadVaryings
+ * Copies the varyings of a vertex stored into a command (those that are not stored are never read by the rasterizer)
+ * @param command The command
+ * @param varyings Where the varyings of the vertex are stored
+ * @param vertex Index of the vertex inside the primitive
+ * @note: For internal usage only!!!
+*/
+static void mnkt_frameBins_loadVaryings(const BinCommand_t* command, ShaderParameter_t* varyings, uint32_t vertex)
+{
+        if( !command->hasVaryings )
+                return;
+
+        if(vertex == 0)
+                memcpy(varyings, command->varyings, MAX_VARYING_PARAMS * sizeof(ShaderParameter_t));
+        else
+                memcpy(varyings, &command->varyings[MAX_VARYING_PARAMS + ((vertex - 1) * command->varyingsCount)], command->varyingsCount * sizeof(ShaderParameter_t));
+}
+
+
+/**
+ * @function mnkt_frameBins_getBands
+ * Computes the bands overlapped by the rows between two coordinates, inside the clip rectangle of the framebuffer
+ * @param bins The binning buffers
+ * @param fb The recording framebuffer
+ * @param minY Minimum y coordinate covered by the command
+ * @param maxY Maximum y coordinate covered by the command
+ * @param firstBand Where the index of the first band overlapped is stored
+ * @param lastBand Where the index of the last band overlapped is stored
+ * @return One if at least one band is overlapped, zero otherwise (or if the coordinates are not finite)
+ * @note: For internal usage only!!!
+*/
+static int mnkt_frameBins_getBands(const FrameBins_t* bins, const Framebuffer_t* fb, float minY, float maxY, uint32_t* firstBand, uint32_t* lastBand)
+{
+        // fmaxf and fminf drop NaN operands, so coordinates that are not finite must be rejected before clipping
+        if( !isfinite(minY) || !isfinite(maxY) )
+                return 0;
+
+        const Rect_t clipRect = mnkt_framebuffer_getClipRect(fb);
+
+        const float firstRow = fmaxf(floorf(minY), (float) clipRect.y);
+        const float endRow = fminf(ceilf(maxY) + 1.0f, (float) (clipRect.y + clipRect.height));
+
+        if( !(endRow > firstRow) || bins->bandsCount == 0 )
+                return 0;
+
+        *firstBand = (uint32_t) firstRow / MNKT_PIPELINE_BAND_HEIGHT;
+        *lastBand = ((uint32_t) endRow - 1) / MNKT_PIPELINE_BAND_HEIGHT;
+
+        if(*lastBand >= bins->bandsCount)
+                *lastBand = bins->bandsCount - 1;
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_frameBins_insert
+ * Appends a command to the lists of a range of bands
+ * @param bins The binning buffers
+ * @param command The command
+ * @param firstBand Index of the first band
+ * @param lastBand Index of the last band
+ * @note: For internal usage only!!!
+*/
+static void mnkt_frameBins_insert(FrameBins_t* bins, const BinCommand_t* command, uint32_t firstBand, uint32_t lastBand)
+{
+        for(uint32_t band = firstBand; band <= lastBand; ++band)
+        {
+                BinChunk_t* chunk = bins->lastChunks[band];
+
+                if(chunk == NULL || chunk->count == MNKT_BIN_CHUNK_SIZE)
+                {
+                        BinChunk_t* newChunk = mnkt_arena_alloc(bins->arena, sizeof(BinChunk_t), _Alignof(BinChunk_t));
+
+                        if(newChunk == NULL)
+                                return;
+
+                        newChunk->next = NULL;
+                        newChunk->count = 0;
+
+                        if(chunk != NULL)
+                                chunk->next = newChunk;
+                        else
+                                bins->firstChunks[band] = newChunk;
+
+                        bins->lastChunks[band] = newChunk;
+                        chunk = newChunk;
+                }
+
+                chunk->commands[chunk->count++] = command;
+        }
+}
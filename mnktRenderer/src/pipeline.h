@@ -0,0 +1,212 @@
+
+/**
+ * @file pipeline.h
+ *
+ * Defines the frame pipeline: a rendering mode in which the geometry of a frame is processed while
+ * the previous frame is still being rasterized.
+ *
+ * The pipeline owns two framebuffers and two sets of binning buffers. Primitives drawn on the framebuffer returned by
+ * mnkt_pipeline_beginFrame are processed by the vertex shader and clipped on the calling thread (the front end), then stored,
+ * in screen space, into the bins of the horizontal bands of the framebuffer that they overlap. Once the frame is submitted
+ * the back end thread rasterizes the bands (in parallel with the workers of the job system) and hands the framebuffer to the completion
+ * callback (e.g. to encode and write the image), while the front end goes on with the next frame.
+ *
+ * The primitives of each band are rasterized in the order they were drawn, so the result is the same of immediate drawing.
+*/
+
+#ifndef MNKT_PIPELINE_H
+#define MNKT_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "shader.h"
+#include "framebuffer.h"
+#include "utility/arena.h"
+#include "utility/thread.h"
+
+
+/**
+ * @macro MNKT_PIPELINE_FRAMES
+ * Number of frames in flight: the one being recorded by the front end and the one being rasterized by the back end
+*/
+#define MNKT_PIPELINE_FRAMES            2
+
+
+/**
+ * @macro MNKT_PIPELINE_BAND_HEIGHT
+ * Height, expressed in pixels, of the horizontal bands in which the primitives are binned
+*/
+#define MNKT_PIPELINE_BAND_HEIGHT       32
+
+
+/**
+ * @typedef FrameCompleteFunc_t
+ * Function invoked by the back end once a frame has been rasterized, before its fence is signaled
+ * (e.g. to resolve the framebuffer, encode the image and write it). The framebuffer is not reused until the function returns.
+ *
+ * Such function takes as input:
+ *      - fb: the framebuffer on which the frame has been rendered
+ *      - fence: the fence of the frame, as returned by mnkt_pipeline_submit
+ *      - userData: the pointer given to mnkt_pipeline_create
+*/
+typedef void (*FrameCompleteFunc_t)(Framebuffer_t* fb, uint64_t fence, void* userData);
+
+
+/**
+ * @struct FrameBins_t
+ * Binning buffers of a frame: the commands recorded by the front end and, for each band of the framebuffer, the list of the commands that overlap it
+*/
+typedef struct FrameBins_t {
+        Arena_t*                arena;                  ///< Memory of the commands, of their states and of the bins, taken from the frame arena of the framebuffer
+                                                        ///< (released when the frame is recorded again)
+        struct BinChunk_t**     firstChunks;            ///< For each band, the first chunk of its list of commands
+        struct BinChunk_t**     lastChunks;             ///< For each band, the chunk to which the next command is appended
+        uint32_t                bandsCount;             ///< Number of bands of the framebuffer
+        const struct DrawState_t* lastState;            ///< State of the last recorded command, shared by the following ones until it changes
+        int                     clearColor;             ///< Non zero if the color buffer is cleared at the start of the frame
+        unsigned char           clearRgb[3];            ///< Color to which the color buffer is cleared
+        float                   clearDepth;             ///< Value to which the depth buffer is cleared at the start of the frame
+} FrameBins_t;
+
+
+/**
+ * @struct FramePipeline_t
+ * Double buffered renderer: the front end records a frame while the back end rasterizes the previous one.
+ * Frames are identified by fences, increasing numbers returned by mnkt_pipeline_submit.
+*/
+typedef struct {
+        Framebuffer_t*          framebuffers[MNKT_PIPELINE_FRAMES];     ///< Framebuffers on which the frames are rendered, used in turn
+        FrameBins_t             bins[MNKT_PIPELINE_FRAMES];             ///< Binning buffers of each framebuffer
+        Framebuffer_t           recording;              ///< Framebuffer on which the front end draws the frame being recorded
+        uint32_t                workersCount;           ///< Maximum number of threads that rasterize the bands of a frame, the back end thread included
+        FrameCompleteFunc_t     onComplete;             ///< Function invoked when a frame has been rasterized (can be NULL)
+        void*                   userData;               ///< Pointer passed to the completion function
+        uint64_t                recordingFence;         ///< Fence of the frame being recorded (zero if no frame is being recorded)
+        uint64_t                submittedFence;         ///< Fence of the last submitted frame
+        uint64_t                completedFence;         ///< Fence of the last completed frame
+        int                     asynchronous;           ///< Non zero if the frames are rasterized by the back end thread, otherwise on submission
+#ifdef MNKT_THREADS
+        thrd_t                  backEnd;                ///< Thread that rasterizes the submitted frames
+        mtx_t                   mutex;                  ///< Protects the fences and the stop flag
+        cnd_t                   frameSubmitted;         ///< Signaled when a frame is submitted or the pipeline is destroyed
+        cnd_t                   frameCompleted;         ///< Signaled when a frame has been completed
+        int                     stop;                   ///< Non zero when the back end thread must terminate
+#endif
+} FramePipeline_t;
+
+
+/**
+ * @function mnkt_pipeline_create
+ * Initializes a frame pipeline and starts its back end thread
+ * @param pipeline The pipeline to be initialized (must be released with mnkt_pipeline_destroy)
+ * @param framebuffers The framebuffers on which the frames are rendered in turn (distinct, same size, the pipeline does not take ownership of them),
+ *      the commands of each frame are stored in the frame arena of its framebuffer (created by mnkt_framebuffer_init)
+ * @param workersCount Maximum number of threads that rasterize each frame, taken from the job system (0 to rasterize the frames on the calling thread, when they are submitted)
+ * @param onComplete Function invoked, on the back end thread, once a frame has been rasterized (can be NULL)
+ * @param userData Pointer passed to the completion function
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_pipeline_create(FramePipeline_t* pipeline, Framebuffer_t* framebuffers[MNKT_PIPELINE_FRAMES], uint32_t workersCount,
+                         FrameCompleteFunc_t onComplete, void* userData);
+
+
+/**
+ * @function mnkt_pipeline_destroy
+ * Waits for the completion of the submitted frames, stops the back end thread and releases the binning buffers
+ * @param pipeline The pipeline to be destroyed
+*/
+void mnkt_pipeline_destroy(FramePipeline_t* pipeline);
+
+
+/**
+ * @function mnkt_pipeline_beginFrame
+ * Starts recording a new frame, waiting until the framebuffer it uses is no longer in flight.
+ * The returned framebuffer is drawn with the usual API (viewport and scissor can be changed between draws): primitives and
+ * full screen passes are recorded, in order, and executed by the back end. Occlusion queries are not supported while recording.
+ * Vertex data can be modified as soon as a draw call returns, textures and uniforms pointers must stay valid until the frame is completed.
+ * @param pipeline The pipeline
+ * @param clearColor Color to which the framebuffer is cleared at the start of the frame (NULL to keep the content of the color buffer)
+ * @param clearDepth Value to which the depth buffer is cleared at the start of the frame
+ * @return The framebuffer on which the frame must be drawn (valid until the frame is submitted), NULL on failure
+*/
+Framebuffer_t* mnkt_pipeline_beginFrame(FramePipeline_t* pipeline, const unsigned char clearColor[3], float clearDepth);
+
+
+/**
+ * @function mnkt_pipeline_submit
+ * Ends the recording of the current frame and hands it to the back end
+ * @param pipeline The pipeline
+ * @return The fence of the frame (zero if no frame was being recorded)
+*/
+uint64_t mnkt_pipeline_submit(FramePipeline_t* pipeline);
+
+
+/**
+ * @function mnkt_pipeline_isComplete
+ * Checks, without waiting, if a frame has been completed (its completion function has returned)
+ * @param pipeline The pipeline
+ * @param fence The fence of the frame
+ * @return One if the frame has been completed, zero otherwise
+*/
+int mnkt_pipeline_isComplete(FramePipeline_t* pipeline, uint64_t fence);
+
+
+/**
+ * @function mnkt_pipeline_wait
+ * Waits until a frame has been completed (its completion function has returned)
+ * @param pipeline The pipeline
+ * @param fence The fence of the frame (frames are completed in order, so all the previous ones are completed as well)
+*/
+void mnkt_pipeline_wait(FramePipeline_t* pipeline, uint64_t fence);
+
+
+/**
+ * @function mnkt_frameBins_addTriangle
+ * Records a triangle, in screen coordinates, into the bins of the bands it overlaps
+ * @param fb The recording framebuffer (its viewport and scissor are recorded together with the shader)
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param shader Shader program to be used to rasterize the triangle
+ * @param varyings Varyings outputted by the vertex shader for the three vertices of the triangle
+ * @note: Used by the renderer to record the primitives drawn on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addTriangle(const Framebuffer_t* fb, const Vec3_t screenCoords[3], const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS]);
+
+
+/**
+ * @function mnkt_frameBins_addLine
+ * Records a line, in screen coordinates, into the bins of the bands it overlaps
+ * @param fb The recording framebuffer (its viewport and scissor are recorded together with the shader)
+ * @param screenCoords Screen coordinates of the extreme points of the line
+ * @param shader Shader program to be used to rasterize the line
+ * @param varyings Varyings outputted by the vertex shader for the two extreme points
+ * @note: Used by the renderer to record the primitives drawn on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addLine(const Framebuffer_t* fb, const Vec3_t screenCoords[2], const ShaderProgram_t* shader, const ShaderParameter_t varyings[2][MAX_VARYING_PARAMS]);
+
+
+/**
+ * @function mnkt_frameBins_addPoint
+ * Records a point, in screen coordinates, into the bins of the bands it overlaps
+ * @param fb The recording framebuffer (its viewport and scissor are recorded together with the shader)
+ * @param screenCoords Screen coordinates of the center of the point
+ * @param pointSize Size of the point, expressed in pixels
+ * @param shader Shader program to be used to rasterize the point
+ * @param varyings Varyings outputted by the vertex shader for the point
+ * @note: Used by the renderer to record the primitives drawn on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addPoint(const Framebuffer_t* fb, Vec3_t screenCoords, size_t pointSize, const ShaderProgram_t* shader, const ShaderParameter_t varyings[MAX_VARYING_PARAMS]);
+
+
+/**
+ * @function mnkt_frameBins_addFullscreenPass
+ * Records a full screen pass into the bins of all the bands
+ * @param fb The recording framebuffer (its viewport and scissor are recorded as well)
+ * @param pixelShader Function to be run for each pixel
+ * @param uniforms Uniforms to be passed to the function (can be NULL, must stay valid until the frame is completed)
+ * @note: Used by the renderer to record the passes run on the framebuffers of a pipeline
+*/
+void mnkt_frameBins_addFullscreenPass(const Framebuffer_t* fb, PixelShaderFunc_t pixelShader, const ShaderParameter_t* uniforms);
+
+
+#endif // MNKT_PIPELINE_H
@@ -7,7 +7,11 @@
 
 #include "rasterizer.h"
 
+#include "texture.h"
+#include "utility/simd.h"
+
 #include <stdio.h>
+#include <string.h>
 
 
 // Prototypes for internal functions and structs
@@ -24,418 +28,2145 @@ typedef struct {
 } BBox_t;
 
 
-static void     mnkt_rasterizeHorLine(Vec3_t* pointA, Vec3_t* pointB, const ShaderProgram_t* shader, const ShaderParameter_t* varyingsA, const ShaderParameter_t* varyingsB, Framebuffer_t* fb);
-static void     mnkt_rasterizeVertLine(Vec3_t* pointA, Vec3_t* pointB, const ShaderProgram_t* shader, const ShaderParameter_t* varyingsA, const ShaderParameter_t* varyingsB, Framebuffer_t* fb);
+/**
+ * @struct TriangleSetup_t
+ * Data computed once per triangle and used to compute the barycentric coordinates of its fragments
+*/
+typedef struct {
+        Vec2_t  a;                      ///< First vertex of the triangle
+        Vec2_t  ab;                     ///< Edge from the first to the second vertex
+        Vec2_t  ac;                     ///< Edge from the first to the third vertex
+        float   invDenom;               ///< Inverse of the triangle's doubled signed area
+        Vec3_t  baryDx;                 ///< Variation of the barycentric coordinates when moving by one pixel along the x axis
+        float   depthDx;                ///< Variation of the depth when moving by one pixel along the x axis
+} TriangleSetup_t;
 
-static BBox_t   mnkt_getScreenBBox(Vec3_t* points, size_t pointsNum);
-static Vec3_t   mnkt_getTriangleBarycentricCoords(const Vec3_t vertices[3], const Vec2_t* point);
 
-static void     mnkt_drawFragment(const Vec2_t* fragCoords, float fragDepth, size_t fragIndex, const ShaderProgram_t* shader, const ShaderParameter_t* varyings, Framebuffer_t* fb);
+/**
+ * @macro MNKT_MAX_SPAN_LENGTH
+ * Maximum number of fragments that are accumulated before being blended with the framebuffer content
+*/
+#define MNKT_MAX_SPAN_LENGTH            64
 
 
 /**
- * @function mnkt_rasterizePoint
- * Rasterizes a 2D point and invokes the fragment shader for each fragment produced.
- * @param screenCoords Vector which defines the screen coordinates of the center of the point to be rasterized
- * @param pointSize Number of pixels that each side of the point takes up.
- *      Use 0 to rasterize a single pixel.
- * @param shader Shader to be used to determine the color of each fragment produced
- * @param varyings Additional output parameters produced by the vertex shader (will be interpolated and passed as input to the fragment shader)
- * @param fb Framebuffer on which the point will be rasterized
+ * @macro MNKT_DEPTH_CHUNK_LENGTH
+ * Maximum number of contiguous fragments whose depth is tested at once (one bit of a 32 bits mask for each fragment)
 */
-void mnkt_rasterizePoint(Vec3_t screenCoords, const size_t pointSize, const ShaderProgram_t* shader, const ShaderParameter_t varyings[MAX_VARYING_PARAMS], Framebuffer_t* fb)
-{
-        if(shader == NULL || varyings == NULL || fb == NULL)
-                return;
+#define MNKT_DEPTH_CHUNK_LENGTH         32
 
-        // Ensure that the given coordinate for the point is in the valid range
-        if( !mnkt_math_pointIntersectRect(screenCoords.x, screenCoords.y, 0.0f, 0.0f, fb->width - 1, fb->height - 1) )
-                return;
 
-        // Determine area of the framebuffer on which point will be rasterized
-        Vec2_t startCoords;
-        startCoords.x = mnkt_math_clamp(screenCoords.x - pointSize, 0, fb->width - 1);
-        startCoords.y = mnkt_math_clamp(screenCoords.y - pointSize, 0, fb->height - 1);
+/**
+ * @macro MNKT_SMALL_TRIANGLE_SIZE
+ * Maximum size, in pixels, of the triangles whose pixel centers are tested one by one during the setup,
+ * so that those that cover no pixel center are rejected before running a kernel
+*/
+#define MNKT_SMALL_TRIANGLE_SIZE        4
 
-        Vec2_t endCoords;
-        endCoords.x = mnkt_math_clamp(screenCoords.x + pointSize, 0, fb->width - 1);
-        endCoords.y = mnkt_math_clamp(screenCoords.y + pointSize, 0, fb->height - 1);
 
-        Vec2_t fragCoords;
+/**
+ * @struct FragmentSpan_t
+ * Sequence of shaded fragments, contiguous in the framebuffer, waiting to be blended
+*/
+typedef struct {
+        size_t  startIndex;                             ///< Index, inside the framebuffer, of the first fragment of the span
+        size_t  count;                                  ///< Number of fragments in the span
+        Vec4_t  colors[MNKT_MAX_SPAN_LENGTH];           ///< Colors produced by the fragment shader
+} FragmentSpan_t;
 
-        for(size_t y = startCoords.y; y <= endCoords.y; ++y)
-        {
-                fragCoords.y = y;
-                size_t fragIndex = (y * fb->width) + (size_t) startCoords.x;
 
-                for(size_t x = startCoords.x; x <= endCoords.x; ++x, ++fragIndex)
-                {
-                        fragCoords.x = x;
+static int      mnkt_clipSegment(const Vec3_t points[2], const Rect_t* clipRect, float padding, float* tStart, float* tEnd);
+static void     mnkt_lerpVaryings(const ShaderParameter_t* varyingsA, const ShaderParameter_t* varyingsB, float t, size_t count, ShaderParameter_t* result);
 
-                        // TODO: Should we interpolate varyings??? (A point is made of a single vertex but multiple fragments may be produced...)
-                        mnkt_drawFragment(&fragCoords, screenCoords.z, fragIndex, shader, varyings, fb);
-                }
-        }
+static BBox_t   mnkt_getScreenBBox(Vec3_t* points, size_t pointsNum);
+static int      mnkt_clipBBox(const BBox_t* bBox, const Rect_t* clipRect, Rect_t* pixelRect);
+static int      mnkt_bboxContainsPixelCenter(const BBox_t* bBox);
+static int      mnkt_getSmallTriangleRows(const TriangleSetup_t* setup, Rect_t* triangleRect);
+static int      mnkt_setupTriangle(const Vec3_t vertices[3], TriangleSetup_t* setup);
+static Vec3_t   mnkt_getTriangleBarycentricCoords(const TriangleSetup_t* setup, const Vec2_t* point);
+static int      mnkt_getTriangleRowSpan(const TriangleSetup_t* setup, const Rect_t* triangleRect, int32_t y, Vec3_t* barycentricCoords, int32_t* xStart, int32_t* xEnd);
+
+static void     mnkt_rasterizeTriangleMultisample(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect, const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb);
+
+static int      mnkt_depthTest(DepthFunc_t depthFunc, float fragDepth, float storedDepth);
+static uint32_t mnkt_depthTestSpan(DepthFunc_t depthFunc, const float* depthBuffer, float baseDepth, float depthStep, size_t firstIndex, size_t count);
+static void     mnkt_writeDepthSpan(float* depthBuffer, float baseDepth, float depthStep, size_t firstIndex, uint32_t writeMask, size_t count);
+static uint64_t mnkt_rasterizeTriangleSpans(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect, DepthFunc_t depthFunc, int depthWrite, const unsigned char* fillColor, Framebuffer_t* fb);
+static void     mnkt_fillColorSpan(unsigned char* colorBuffer, const unsigned char color[3], size_t count);
+static uint32_t mnkt_countBits(uint32_t mask);
+
+static int      mnkt_isDepthOnly(const ShaderProgram_t* shader, const Framebuffer_t* fb);
+static Vec4_t   mnkt_shadeFragment(const ShaderProgram_t* shader, const ShaderParameter_t* varyings, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords, int* discard);
+static int      mnkt_shadeTargets(const ShaderProgram_t* shader, const ShaderParameter_t* varyings, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords, size_t fragIndex, Framebuffer_t* fb);
+static Vec4_t   mnkt_interpolateVec4(const Vec4_t* a, const Vec4_t* b, const Vec4_t* c, const Vec3_t* barycentricCoords);
+static Vec2_t   mnkt_interpolateVec2(const Vec2_t* a, const Vec2_t* b, const Vec2_t* c, const Vec3_t* barycentricCoords);
+
+static void     mnkt_drawFragment(const Vec2_t* fragCoords, float fragDepth, float coverage, size_t fragIndex, const ShaderProgram_t* shader, const ShaderParameter_t* varyings, FragmentSpan_t* span, Framebuffer_t* fb);
+static void     mnkt_drawSamples(const Vec2_t* fragCoords, uint32_t coverageMask, const float* samplesDepth, size_t fragIndex, const ShaderProgram_t* shader, const ShaderParameter_t* varyings, Framebuffer_t* fb);
+static void     mnkt_writeSamplesColor(uint32_t samplesMask, const Vec4_t* color, size_t fragIndex, const ShaderProgram_t* shader, Framebuffer_t* fb);
+static void     mnkt_writeFragmentColor(const Vec4_t* fragColor, size_t fragIndex, const ShaderProgram_t* shader, FragmentSpan_t* span, Framebuffer_t* fb);
+static void     mnkt_flushSpan(FragmentSpan_t* span, const ShaderProgram_t* shader, Framebuffer_t* fb);
+static void     mnkt_interpolateVaryings(const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], const Vec3_t* barycentricCoords, size_t count, ShaderParameter_t* result);
+
+
+// Specialized triangle kernels
 
-}
+/**
+ * @typedef TriangleKernel_t
+ * Function that rasterizes the pixels of a triangle's bounding box on a single sampled framebuffer,
+ * each kernel is specialized (at compile time) for a combination of pipeline states
+*/
+typedef void (*TriangleKernel_t)(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect, const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb);
 
 
 /**
- * @function mnkt_rasterizeLine
- * Rasterizes a 2D line and invokes the fragment shader for each fragment produced.
- * @param screenCoords Array of vectors which defines the screen coordinates of the two extreme points of the line to be rasterized
- * @param shader Shader to be used to determine the color of each fragment produced
- * @param varyings Additional output parameters produced by the vertex shader for the two extreme points of the line
- *      (those will be interpolated across the line and passed as input to the fragment shader)
- * @param fb Framebuffer on which the line will be rasterized
+ * @macro MNKT_DEPTH_TEST_PASSES
+ * Evaluates to non zero if a fragment passes the depth test, if the depth function is a compile time constant
+ * the compiler keeps only the comparison that applies
 */
-void mnkt_rasterizeLine(Vec3_t screenCoords[2], const ShaderProgram_t* shader, const ShaderParameter_t varyings[2][MAX_VARYING_PARAMS], Framebuffer_t* fb)
-{
-        if(shader == NULL || varyings == NULL || fb == NULL)
-                return;
-
-        // Ensure that all points are in the valid range
-        for(uint32_t i = 0; i < 2; ++i)
-        {
-                if( !mnkt_math_pointIntersectRect(screenCoords[i].x, screenCoords[i].y, 0.0f, 0.0f, fb->width - 1, fb->height - 1) )
-                        return;
-        }
+#define MNKT_DEPTH_TEST_PASSES(depthFunc, fragDepth, storedDepth)                                       \
+        ( ((depthFunc) == MNKT_DEPTH_ALWAYS) ||                                                         \
+          ((depthFunc) == MNKT_DEPTH_LESS && (fragDepth) < (storedDepth)) ||                            \
+          ((depthFunc) == MNKT_DEPTH_LESS_EQUAL && (fragDepth) <= (storedDepth)) ||                     \
+          ((depthFunc) == MNKT_DEPTH_EQUAL && (fragDepth) == (storedDepth)) )
 
-        Vec3_t* pointA = &screenCoords[0];
-        Vec3_t* pointB = &screenCoords[1];
 
-        // Invoke a specific internal line function according to the line type
-        if( abs((int) (pointA->x - pointB->x)) > abs((int) (pointA->y - pointB->y)) )
-        {
-                // If line is more "horizontal-ish"
-                
-                // Invoke function ensuring that the first point parameter is the leftmost point
-                if(pointA->x > pointB->x)
-                {
-                        mnkt_rasterizeHorLine(pointB, pointA, shader, varyings[1], varyings[0], fb);
-                } else {
-                        mnkt_rasterizeHorLine(pointA, pointB, shader, varyings[0], varyings[1], fb);
-                }
+/**
+ * @macro MNKT_STORE_COLOR_RGB8
+ * Stores a fragment color into a framebuffer whose color buffer holds 8 bits RGB pixels
+*/
+#define MNKT_STORE_COLOR_RGB8(fb, fragIndex, color)                                             \
+        do {                                                                                    \
+                (fb)->colorBuffer[ (fragIndex) * 3 ] =          mnkt_colorAsUChar((color).r);   \
+                (fb)->colorBuffer[ ((fragIndex) * 3) + 1 ] =    mnkt_colorAsUChar((color).g);   \
+                (fb)->colorBuffer[ ((fragIndex) * 3) + 2 ] =    mnkt_colorAsUChar((color).b);   \
+        } while(0)
 
-        } else {
-                // Otherwise if line is more "vertical-ish"
 
-                // Invoke function ensuring that the first point parameter is the bottom-most point
-                if(pointA->y > pointB->y)
-                {
-                        mnkt_rasterizeVertLine(pointB, pointA, shader, varyings[1], varyings[0], fb);
-                } else {
-                        mnkt_rasterizeVertLine(pointA, pointB, shader, varyings[0], varyings[1], fb);
-                }
-        }
+/**
+ * @macro MNKT_DEFINE_TRIANGLE_KERNEL
+ * Defines a triangle kernel specialized for the given states, the states are compile time constants
+ * so that the compiler removes all the branches that do not apply to the kernel
+ * @param NAME Name of the kernel function
+ * @param DEPTH_FUNC Comparison performed by the depth test (a DepthFunc_t value)
+ * @param DEPTH_WRITE Non zero if the depth of the fragments is written into the depth buffer
+ * @param BLEND Non zero if the fragments are blended with the framebuffer content
+ * @param INTERPOLATE Non zero if the varyings are interpolated, otherwise those of the first vertex are used
+ * @param STORE_COLOR Macro used to store an opaque fragment color (defines the color format)
+*/
+#define MNKT_DEFINE_TRIANGLE_KERNEL(NAME, DEPTH_FUNC, DEPTH_WRITE, BLEND, INTERPOLATE, STORE_COLOR)                             \
+static void NAME(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,                        \
+                 const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)     \
+{                                                                                                                               \
+        const size_t varyingsCount = shader->varyingsCount < MAX_VARYING_PARAMS ? shader->varyingsCount : MAX_VARYING_PARAMS;  \
+        const Vec3_t baryDx = setup->baryDx;                                                                                    \
+                                                                                                                                \
+        ShaderParameter_t fragVaryings[MAX_VARYING_PARAMS];                                                                     \
+        const ShaderParameter_t* inputVaryings = varyings[0];                                                                   \
+                                                                                                                                \
+        if(INTERPOLATE)                                                                                                         \
+        {                                                                                                                       \
+                memcpy(fragVaryings, varyings[0], sizeof(fragVaryings));                                                        \
+                inputVaryings = fragVaryings;                                                                                   \
+        }                                                                                                                       \
+                                                                                                                                \
+        FragmentSpan_t span;                                                                                                    \
+        span.count = 0;                                                                                                         \
+                                                                                                                                \
+        uint64_t samplesPassed = 0;                                                                                             \
+                                                                                                                                \
+        for(int32_t y = triangleRect->y; y < triangleRect->y + triangleRect->height; ++y)                                       \
+        {                                                                                                                       \
+                Vec3_t barycentricCoords;                                                                                       \
+                int32_t xStart;                                                                                                 \
+                int32_t xEnd;                                                                                                   \
+                                                                                                                                \
+                if( !mnkt_getTriangleRowSpan(setup, triangleRect, y, &barycentricCoords, &xStart, &xEnd) )                      \
+                        continue;                                                                                               \
+                                                                                                                                \
+                size_t fragIndex = ((size_t) y * fb->width) + xStart;                                                           \
+                Vec2_t fragCoords = { .x = xStart, .y = y };                                                                    \
+                const float rowDepth = (barycentricCoords.x * screenCoords[0].z) +                                              \
+                                       (barycentricCoords.y * screenCoords[1].z) +                                              \
+                                       (barycentricCoords.z * screenCoords[2].z);                                               \
+                                                                                                                                \
+                for(int32_t x = xStart; x < xEnd; ++x, ++fragIndex, ++fragCoords.x, barycentricCoords.x += baryDx.x,            \
+                        barycentricCoords.y += baryDx.y, barycentricCoords.z += baryDx.z)                                       \
+                {                                                                                                               \
+                        const float fragDepth = rowDepth + ((float) (x - xStart) * setup->depthDx);                             \
+                                                                                                                                \
+                        if( !MNKT_DEPTH_TEST_PASSES(DEPTH_FUNC, fragDepth, fb->depthBuffer[fragIndex]) )                        \
+                                continue;                                                                                       \
+                                                                                                                                \
+                        if(INTERPOLATE)                                                                                         \
+                                mnkt_interpolateVaryings(varyings, &barycentricCoords, varyingsCount, fragVaryings);            \
+                                                                                                                                \
+                        int discard = 0;                                                                                        \
+                        Vec4_t fragColor = shader->fragmentShader(inputVaryings, shader->uniforms, &fragCoords, &discard);      \
+                                                                                                                                \
+                        if(discard != 0)                                                                                        \
+                                continue;                                                                                       \
+                                                                                                                                \
+                        ++samplesPassed;                                                                                        \
+                                                                                                                                \
+                        if(DEPTH_WRITE)                                                                                         \
+                                fb->depthBuffer[fragIndex] = fragDepth;                                                         \
+                                                                                                                                \
+                        if(BLEND)                                                                                               \
+                        {                                                                                                       \
+                                if(span.count == MNKT_MAX_SPAN_LENGTH || (span.count > 0 && span.startIndex + span.count != fragIndex)) \
+                                        mnkt_flushSpan(&span, shader, fb);                                                      \
+                                                                                                                                \
+                                if(span.count == 0)                                                                             \
+                                        span.startIndex = fragIndex;                                                            \
+                                                                                                                                \
+                                span.colors[span.count++] = fragColor;                                                          \
+                        } else {                                                                                                \
+                                STORE_COLOR(fb, fragIndex, fragColor);                                                          \
+                        }                                                                                                       \
+                }                                                                                                               \
+        }                                                                                                                       \
+                                                                                                                                \
+        if(BLEND)                                                                                                               \
+                mnkt_flushSpan(&span, shader, fb);                                                                              \
+                                                                                                                                \
+        if(fb->query != NULL)                                                                                                   \
+                fb->query->samplesPassed += samplesPassed;                                                                      \
 }
 
 
 /**
- * @function mnkt_rasterizeHorLine
- * Rasterizes an horizontal-ish 2D line and invokes the fragment shader for each fragment produced.
- * @param pointA Screen coordinates of the leftmost point of the line
- * @param pointB Screen coordinates of the rightmost point of the line
- * @note: For internal usage only!!!
+ * @macro MNKT_DEFINE_TRIANGLE_KERNELS_FOR_DEPTH
+ * Defines the triangle kernels for all the combinations of depth write, blend and varyings interpolation
+ * (named mnkt_triangleKernel_<FORMAT>_<depth func><depth write><blend><interpolate>) for the given color format and depth function
 */
-static void mnkt_rasterizeHorLine(Vec3_t* pointA, Vec3_t* pointB, const ShaderProgram_t* shader, const ShaderParameter_t* varyingsA, const ShaderParameter_t* varyingsB, Framebuffer_t* fb)
-{
-        // Compute deltas
-        int32_t dx = pointB->x - pointA->x;
-        int32_t dy = pointB->y - pointA->y;
+#define MNKT_DEFINE_TRIANGLE_KERNELS_FOR_DEPTH(FORMAT, DEPTH_FUNC, D)                                                                   \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##000, DEPTH_FUNC, 0, 0, 0, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##001, DEPTH_FUNC, 0, 0, 1, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##010, DEPTH_FUNC, 0, 1, 0, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##011, DEPTH_FUNC, 0, 1, 1, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##100, DEPTH_FUNC, 1, 0, 0, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##101, DEPTH_FUNC, 1, 0, 1, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##110, DEPTH_FUNC, 1, 1, 0, MNKT_STORE_COLOR_##FORMAT)            \
+        MNKT_DEFINE_TRIANGLE_KERNEL(mnkt_triangleKernel_##FORMAT##_##D##111, DEPTH_FUNC, 1, 1, 1, MNKT_STORE_COLOR_##FORMAT)
 
-        size_t y = pointA->y;
-        int32_t yStep = 1;
 
-        // Determine step to take on y axis
-        if(dy < 0)
-        {
-                yStep = -1;
-                dy *= -1;
+/**
+ * @macro MNKT_DEFINE_TRIANGLE_KERNELS_FOR_FORMAT
+ * Defines the triangle kernels for all the combinations of depth function, depth write, blend and varyings interpolation
+ * for the given color format (the depth functions are numbered as in DepthFunc_t)
+*/
+#define MNKT_DEFINE_TRIANGLE_KERNELS_FOR_FORMAT(FORMAT)                                 \
+        MNKT_DEFINE_TRIANGLE_KERNELS_FOR_DEPTH(FORMAT, MNKT_DEPTH_LESS, 0)              \
+        MNKT_DEFINE_TRIANGLE_KERNELS_FOR_DEPTH(FORMAT, MNKT_DEPTH_ALWAYS, 1)            \
+        MNKT_DEFINE_TRIANGLE_KERNELS_FOR_DEPTH(FORMAT, MNKT_DEPTH_LESS_EQUAL, 2)        \
+        MNKT_DEFINE_TRIANGLE_KERNELS_FOR_DEPTH(FORMAT, MNKT_DEPTH_EQUAL, 3)
+
+
+/**
+ * @macro MNKT_TRIANGLE_KERNELS_TABLE_FOR_DEPTH
+ * Initializer of the dispatch table of the kernels of a color format and depth function, indexed by [depth write][blend][interpolate]
+*/
+#define MNKT_TRIANGLE_KERNELS_TABLE_FOR_DEPTH(FORMAT, D)                                                                                \
+        {                                                                                                                               \
+                { { mnkt_triangleKernel_##FORMAT##_##D##000, mnkt_triangleKernel_##FORMAT##_##D##001 },                                 \
+                  { mnkt_triangleKernel_##FORMAT##_##D##010, mnkt_triangleKernel_##FORMAT##_##D##011 } },                               \
+                { { mnkt_triangleKernel_##FORMAT##_##D##100, mnkt_triangleKernel_##FORMAT##_##D##101 },                                 \
+                  { mnkt_triangleKernel_##FORMAT##_##D##110, mnkt_triangleKernel_##FORMAT##_##D##111 } }                                \
         }
 
-        int32_t distance = (2 * dy) - dx;
 
-        Vec2_t fragCoords = { pointA->x, y };
-        size_t fragIndex = (y * fb->width) + (size_t) pointA->x;
+/**
+ * @macro MNKT_TRIANGLE_KERNELS_TABLE
+ * Initializer of the dispatch table of the kernels of a color format, indexed by [depth func][depth write][blend][interpolate]
+*/
+#define MNKT_TRIANGLE_KERNELS_TABLE(FORMAT)                                     \
+        {                                                               \
+                MNKT_TRIANGLE_KERNELS_TABLE_FOR_DEPTH(FORMAT, 0),       \
+                MNKT_TRIANGLE_KERNELS_TABLE_FOR_DEPTH(FORMAT, 1),       \
+                MNKT_TRIANGLE_KERNELS_TABLE_FOR_DEPTH(FORMAT, 2),       \
+                MNKT_TRIANGLE_KERNELS_TABLE_FOR_DEPTH(FORMAT, 3)        \
+        }
 
-        for(size_t x = pointA->x; x < pointB->x; ++x)
-        {
-                // TODO: Interpolate varyings and vertex depth values across the line...
-                
-                mnkt_drawFragment(&fragCoords, pointA->z, fragIndex, shader, varyingsA, fb);
 
-                if(distance > 0)
-                {
-                        y += yStep;
-                        distance += 2 * (dy - dx);
+MNKT_DEFINE_TRIANGLE_KERNELS_FOR_FORMAT(RGB8)
 
-                        fragCoords.y += yStep;
-                        fragIndex += (int32_t) (yStep * fb->width);
 
-                } else {
-                        distance += 2 * dy;
-                }
+/**
+ * @var mnkt_triangleKernels
+ * Dispatch table of the specialized triangle kernels, indexed by [color format][depth func][depth write][blend][interpolate]
+ * (the framebuffer currently supports only 8 bits RGB color buffers)
+*/
+static const TriangleKernel_t mnkt_triangleKernels[1][4][2][2][2] = {
+        MNKT_TRIANGLE_KERNELS_TABLE(RGB8)
+};
 
-                ++fragCoords.x;
-                ++fragIndex;
-        }
-}
 
+// Built-in shaders kernels
 
 /**
- * @function mnkt_rasterize2DHorLine
- * Rasterizes a vertical-ish 2D line and invokes the fragment shader for each fragment produced.
- * @param pointA Screen coordinates of the bottom-most point of the line
- * @param pointB Screen coordinates of the top-most point of the line
- * @note: For internal usage only!!!
+ * @macro MNKT_SHADE_FLAT_COLOR
+ * Computes the color of a fragment for the MNKT_SHADER_FLAT_COLOR built-in shader
 */
-static void mnkt_rasterizeVertLine(Vec3_t* pointA, Vec3_t* pointB, const ShaderProgram_t* shader, const ShaderParameter_t* varyingsA, const ShaderParameter_t* varyingsB, Framebuffer_t* fb)
-{
-        // Compute deltas
-        int32_t dx = pointB->x - pointA->x;
-        int32_t dy = pointB->y - pointA->y;
-
-        size_t x = pointA->x;
-        int32_t xStep = 1;
+#define MNKT_SHADE_FLAT_COLOR(color, barycentricCoords, varyings, texture)                                              \
+        do {                                                                                                            \
+                (color) = (varyings)[0][0].vec4;                                                                        \
+        } while(0)
 
-        // Determine step to take on x axis
-        if(dx < 0)
-        {
-                xStep = -1;
-                dx *= -1;
-        }
 
-        int32_t distance = (2 * dx) - dy;
+/**
+ * @macro MNKT_SHADE_VERTEX_COLOR
+ * Computes the color of a fragment for the MNKT_SHADER_VERTEX_COLOR built-in shader
+*/
+#define MNKT_SHADE_VERTEX_COLOR(color, barycentricCoords, varyings, texture)                                            \
+        do {                                                                                                            \
+                (color) = mnkt_interpolateVec4(&(varyings)[0][0].vec4, &(varyings)[1][0].vec4, &(varyings)[2][0].vec4,  \
+                                               &(barycentricCoords));                                                   \
+        } while(0)
 
-        Vec2_t fragCoords = { x, pointA->y };
-        size_t fragIndex = ( (size_t) pointA->y * fb->width ) + x;
 
-        for(size_t y = pointA->y; y < pointB->y; ++y)
-        {
-                // TODO: Interpolate varyings and vertex depth values across the line...
-                
-                mnkt_drawFragment(&fragCoords, pointA->z, fragIndex, shader, varyingsA, fb);
+/**
+ * @macro MNKT_SHADE_TEXTURED
+ * Computes the color of a fragment for the MNKT_SHADER_TEXTURED built-in shader
+*/
+#define MNKT_SHADE_TEXTURED(color, barycentricCoords, varyings, texture)                                                \
+        do {                                                                                                            \
+                Vec2_t uv = mnkt_interpolateVec2(&(varyings)[0][1].vec2, &(varyings)[1][1].vec2, &(varyings)[2][1].vec2,\
+                                                 &(barycentricCoords));                                                 \
+                (color) = mnkt_texture_sample((texture), &uv);                                                          \
+        } while(0)
 
-                if(distance > 0)
-                {
-                        x += xStep;
-                        distance += 2 * (dx - dy);
 
-                        fragCoords.x += xStep;
-                        fragIndex += xStep;
+/**
+ * @macro MNKT_SHADE_TEXTURED_MODULATED
+ * Computes the color of a fragment for the MNKT_SHADER_TEXTURED_MODULATED built-in shader
+*/
+#define MNKT_SHADE_TEXTURED_MODULATED(color, barycentricCoords, varyings, texture)                                      \
+        do {                                                                                                            \
+                Vec4_t vertexColor;                                                                                     \
+                MNKT_SHADE_VERTEX_COLOR(vertexColor, barycentricCoords, varyings, texture);                             \
+                MNKT_SHADE_TEXTURED(color, barycentricCoords, varyings, texture);                                       \
+                (color).r *= vertexColor.r;                                                                             \
+                (color).g *= vertexColor.g;                                                                             \
+                (color).b *= vertexColor.b;                                                                             \
+                (color).a *= vertexColor.a;                                                                             \
+        } while(0)
 
-                } else {
-                        distance += 2 * dx;
-                }
 
-                ++fragCoords.y;
-                fragIndex += fb->width;
-        }
+/**
+ * @macro MNKT_DEFINE_BUILTIN_KERNEL
+ * Defines a triangle kernel for a built-in shader: the exact extents of the triangle are computed for each row
+ * and the resulting span is filled with the fragment colors computed inline (no function pointer is invoked)
+ * @param NAME Name of the kernel function
+ * @param DEPTH_FUNC Comparison performed by the depth test (a DepthFunc_t value)
+ * @param DEPTH_WRITE Non zero if the depth of the fragments is written into the depth buffer
+ * @param SHADE Macro used to compute the color of a fragment
+*/
+#define MNKT_DEFINE_BUILTIN_KERNEL(NAME, DEPTH_FUNC, DEPTH_WRITE, SHADE)                                                        \
+static void NAME(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,                        \
+                 const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)     \
+{                                                                                                                               \
+        const Image_t* texture = shader->uniforms[0].texture;                                                                   \
+        const int blend = shader->blend.enabled;                                                                                \
+        const Vec3_t baryDx = setup->baryDx;                                                                                    \
+                                                                                                                                \
+        FragmentSpan_t span;                                                                                                    \
+        span.count = 0;                                                                                                         \
+                                                                                                                                \
+        uint64_t samplesPassed = 0;                                                                                             \
+                                                                                                                                \
+        (void) texture;                                                                                                         \
+                                                                                                                                \
+        for(int32_t y = triangleRect->y; y < triangleRect->y + triangleRect->height; ++y)                                       \
+        {                                                                                                                       \
+                Vec3_t barycentricCoords;                                                                                       \
+                int32_t xStart;                                                                                                 \
+                int32_t xEnd;                                                                                                   \
+                                                                                                                                \
+                if( !mnkt_getTriangleRowSpan(setup, triangleRect, y, &barycentricCoords, &xStart, &xEnd) )                      \
+                        continue;                                                                                               \
+                                                                                                                                \
+                size_t fragIndex = ((size_t) y * fb->width) + xStart;                                                           \
+                const float rowDepth = (barycentricCoords.x * screenCoords[0].z) +                                              \
+                                       (barycentricCoords.y * screenCoords[1].z) +                                              \
+                                       (barycentricCoords.z * screenCoords[2].z);                                               \
+                                                                                                                                \
+                for(int32_t x = xStart; x < xEnd; ++x, ++fragIndex, barycentricCoords.x += baryDx.x,                            \
+                        barycentricCoords.y += baryDx.y, barycentricCoords.z += baryDx.z)                                       \
+                {                                                                                                               \
+                        const float fragDepth = rowDepth + ((float) (x - xStart) * setup->depthDx);                             \
+                                                                                                                                \
+                        if( !MNKT_DEPTH_TEST_PASSES(DEPTH_FUNC, fragDepth, fb->depthBuffer[fragIndex]) )                        \
+                                continue;                                                                                       \
+                                                                                                                                \
+                        Vec4_t fragColor;                                                                                       \
+                        SHADE(fragColor, barycentricCoords, varyings, texture);                                                 \
+                                                                                                                                \
+                        ++samplesPassed;                                                                                        \
+                                                                                                                                \
+                        if(DEPTH_WRITE)                                                                                         \
+                                fb->depthBuffer[fragIndex] = fragDepth;                                                         \
+                                                                                                                                \
+                        if(blend)                                                                                               \
+                        {                                                                                                       \
+                                if(span.count == MNKT_MAX_SPAN_LENGTH || (span.count > 0 && span.startIndex + span.count != fragIndex)) \
+                                        mnkt_flushSpan(&span, shader, fb);                                                      \
+                                                                                                                                \
+                                if(span.count == 0)                                                                             \
+                                        span.startIndex = fragIndex;                                                            \
+                                                                                                                                \
+                                span.colors[span.count++] = fragColor;                                                          \
+                        } else {                                                                                                \
+                                MNKT_STORE_COLOR_RGB8(fb, fragIndex, fragColor);                                                \
+                        }                                                                                                       \
+                }                                                                                                               \
+        }                                                                                                                       \
+                                                                                                                                \
+        mnkt_flushSpan(&span, shader, fb);                                                                                      \
+                                                                                                                                \
+        if(fb->query != NULL)                                                                                                   \
+                fb->query->samplesPassed += samplesPassed;                                                                      \
 }
 
 
-/*
- * @function mnkt_rasterizeTriangle
- * Rasterizes a 2D triangle and invokes the fragment shader for each fragment produced.
- * @param screenCoords Array of vectors which defines the screen coordinates of the vertices of the triangle to be rasterized
- * @param shader Shader to be used to determine the color of each fragment produced
- * @param varyings Additional output parameters produced by the vertex shader for the vertices of the triangle
- *      (those will be interpolated across the triangle surface and passed as input to the fragment shader)
- * @param fb Framebuffer on which the line will be rasterized
+/**
+ * @macro MNKT_DEFINE_BUILTIN_KERNELS
+ * Defines the kernels of a built-in shader for all the combinations of depth function and depth write
+ * (named mnkt_builtinKernel_<SHADER>_<depth func><depth write>, the depth functions are numbered as in DepthFunc_t)
 */
-void mnkt_rasterizeTriangle(Vec3_t screenCoords[3], const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
-{
-        if(shader == NULL || varyings == NULL || fb == NULL)
-                return;
+#define MNKT_DEFINE_BUILTIN_KERNELS(SHADER)                                                                             \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_00, MNKT_DEPTH_LESS, 0, MNKT_SHADE_##SHADER)           \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_01, MNKT_DEPTH_LESS, 1, MNKT_SHADE_##SHADER)           \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_10, MNKT_DEPTH_ALWAYS, 0, MNKT_SHADE_##SHADER)         \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_11, MNKT_DEPTH_ALWAYS, 1, MNKT_SHADE_##SHADER)         \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_20, MNKT_DEPTH_LESS_EQUAL, 0, MNKT_SHADE_##SHADER)     \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_21, MNKT_DEPTH_LESS_EQUAL, 1, MNKT_SHADE_##SHADER)     \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_30, MNKT_DEPTH_EQUAL, 0, MNKT_SHADE_##SHADER)          \
+        MNKT_DEFINE_BUILTIN_KERNEL(mnkt_builtinKernel_##SHADER##_31, MNKT_DEPTH_EQUAL, 1, MNKT_SHADE_##SHADER)
 
-        // Ensure that all vertices are in the valid range
-        for(uint32_t i = 0; i < 3; ++i)
-        {
-                if( !mnkt_math_pointIntersectRect(screenCoords[i].x, screenCoords[i].y, 0.0f, 0.0f, fb->width - 1, fb->height - 1) )
-                        return;
+
+/**
+ * @macro MNKT_BUILTIN_KERNELS_TABLE
+ * Initializer of the dispatch table of the kernels of a built-in shader, indexed by [depth func][depth write]
+*/
+#define MNKT_BUILTIN_KERNELS_TABLE(SHADER)                                                              \
+        {                                                                                               \
+                { mnkt_builtinKernel_##SHADER##_00, mnkt_builtinKernel_##SHADER##_01 },                 \
+                { mnkt_builtinKernel_##SHADER##_10, mnkt_builtinKernel_##SHADER##_11 },                 \
+                { mnkt_builtinKernel_##SHADER##_20, mnkt_builtinKernel_##SHADER##_21 },                 \
+                { mnkt_builtinKernel_##SHADER##_30, mnkt_builtinKernel_##SHADER##_31 }                  \
         }
 
-        // Compute triangle's bounding box
-        BBox_t bBox = mnkt_getScreenBBox(screenCoords, 3);
 
-        // Clamp the bounding box onto the framebuffer
-        bBox.x = mnkt_math_clamp(bBox.x, 0, fb->width - 1);
-        bBox.y = mnkt_math_clamp(bBox.y, 0, fb->height - 1);
-        bBox.width = mnkt_math_clamp(bBox.width, 0, fb->width - 1);
-        bBox.height = mnkt_math_clamp(bBox.height, 0, fb->height - 1);
+MNKT_DEFINE_BUILTIN_KERNELS(FLAT_COLOR)
+MNKT_DEFINE_BUILTIN_KERNELS(VERTEX_COLOR)
+MNKT_DEFINE_BUILTIN_KERNELS(TEXTURED)
+MNKT_DEFINE_BUILTIN_KERNELS(TEXTURED_MODULATED)
 
-        // Threshold value used to determine if barycentric coordinates are valid
-        const float EPSILON = 0.00001f;
 
-        Vec2_t fragCoords = { .x = bBox.x, .y = bBox.y };
-        Vec2_t fragCenterCoords = { .x = bBox.x + 0.5f, .y = bBox.y + 0.5f };
+/**
+ * @function mnkt_rasterizeTriangleSpans
+ * Computes the exact extents of the triangle on each row, the depth of the resulting span is tested (and written) in chunks
+ * with vector instructions and, if a color is given, the visible runs of pixels are filled with a memset-like color write.
+ * No varying is read and no fragment shader is invoked.
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param depthFunc Comparison performed by the depth test
+ * @param depthWrite Non zero if the depth of the visible fragments is written into the depth buffer
+ * @param fillColor RGB color written into the visible pixels (NULL to leave the color buffer untouched)
+ * @param fb Framebuffer on which the triangle will be rasterized
+ * @return The number of fragments that passed the depth test
+*/
+static uint64_t mnkt_rasterizeTriangleSpans(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,
+                                            DepthFunc_t depthFunc, int depthWrite, const unsigned char* fillColor, Framebuffer_t* fb)
+{
+        const float depthStep = setup->depthDx;
 
-        size_t fragIndex = ((size_t) bBox.y * fb->width) + (size_t) bBox.x;
+        uint64_t samplesPassed = 0;
 
-        // For each fragment in the bounding box
-        for(size_t y = 0; y < (size_t) bBox.height; ++y)
+        for(int32_t y = triangleRect->y; y < triangleRect->y + triangleRect->height; ++y)
         {
-                for(size_t x = 0; x < (size_t) bBox.width; ++x)
+                Vec3_t barycentricCoords;
+                int32_t xStart;
+                int32_t xEnd;
+
+                if( !mnkt_getTriangleRowSpan(setup, triangleRect, y, &barycentricCoords, &xStart, &xEnd) )
+                        continue;
+
+                const size_t rowIndex = (size_t) y * fb->width;
+                const float rowDepth = (barycentricCoords.x * screenCoords[0].z) + (barycentricCoords.y * screenCoords[1].z) + (barycentricCoords.z * screenCoords[2].z);
+
+                for(int32_t chunkX = xStart; chunkX < xEnd; chunkX += MNKT_DEPTH_CHUNK_LENGTH)
                 {
-                        // Compute barycentric coordinates for the current fragment
-                        Vec3_t barycentricCoords = mnkt_getTriangleBarycentricCoords(screenCoords, &fragCenterCoords);
+                        size_t chunkLength = (size_t) (xEnd - chunkX);
+                        if(chunkLength > MNKT_DEPTH_CHUNK_LENGTH)
+                                chunkLength = MNKT_DEPTH_CHUNK_LENGTH;
 
-                        // If the fragment is inside the triangle
-                        if(barycentricCoords.x > -EPSILON && barycentricCoords.y > -EPSILON && barycentricCoords.z > -EPSILON)
+                        float* depthChunk = &fb->depthBuffer[rowIndex + chunkX];
+                        size_t chunkOffset = (size_t) (chunkX - xStart);
+
+                        uint32_t passMask = mnkt_depthTestSpan(depthFunc, depthChunk, rowDepth, depthStep, chunkOffset, chunkLength);
+
+                        if(passMask == 0)
+                                continue;
+
+                        samplesPassed += mnkt_countBits(passMask);
+
+                        if(depthWrite)
+                                mnkt_writeDepthSpan(depthChunk, rowDepth, depthStep, chunkOffset, passMask, chunkLength);
+
+                        if(fillColor == NULL)
+                                continue;
+
+                        // Fill each run of contiguous visible pixels
+                        unsigned char* colorChunk = &fb->colorBuffer[(rowIndex + chunkX) * 3];
+                        size_t i = 0;
+
+                        while(i < chunkLength)
                         {
-                                // TODO: interpolate varyings and depth value (use early depth test to avoid varyings interpolation if not needed)
-                                
-                                mnkt_drawFragment(&fragCoords, screenCoords[0].z, fragIndex, shader, *varyings, fb);
+                                if( !(passMask & (1u << i)) )
+                                {
+                                        ++i;
+                                        continue;
+                                }
+
+                                size_t runStart = i;
+
+                                while(i < chunkLength && (passMask & (1u << i)))
+                                        ++i;
+
+                                mnkt_fillColorSpan(&colorChunk[runStart * 3], fillColor, i - runStart);
                         }
-                
-                        // Move to the next fragment
-                        ++fragIndex;
-        
-                        ++fragCoords.x;
-                        ++fragCenterCoords.x;
                 }
+        }
 
-                // Update fragment index (go to line below, at the start of the BBox)
-                fragIndex += fb->width;
-                fragIndex -= (size_t) bBox.width;
+        return samplesPassed;
+}
 
-                // Update fragment coordinates
-                ++fragCoords.y;
-                fragCoords.x = bBox.x;
 
-                ++fragCenterCoords.y;
-                fragCenterCoords.x = bBox.x + 0.5f;
-        }
+/**
+ * @function mnkt_flatColorSpanKernel
+ * Triangle kernel for opaque triangles drawn with the MNKT_SHADER_FLAT_COLOR built-in shader:
+ * the spans of the triangle are filled with the color of its first vertex
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param shader Shader program (defines the depth states)
+ * @param varyings Varyings of the vertices of the triangle (the color of the first vertex is used)
+ * @param fb Framebuffer on which the triangle will be rasterized
+*/
+static void mnkt_flatColorSpanKernel(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,
+                                     const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
+{
+        const Vec4_t* flatColor = &varyings[0][0].vec4;
+        const unsigned char color[3] = { mnkt_colorAsUChar(flatColor->r), mnkt_colorAsUChar(flatColor->g), mnkt_colorAsUChar(flatColor->b) };
+
+        uint64_t samplesPassed = mnkt_rasterizeTriangleSpans(screenCoords, setup, triangleRect, shader->depthFunc, !shader->depthWriteDisabled, color, fb);
+
+        if(fb->query != NULL)
+                fb->query->samplesPassed += samplesPassed;
 }
 
 
 /**
- * @function mnkt_getScreenBBox
- * @param points Array of points, expressed in screen coordinates, for which the bounding box must be computed
- * @param pointsNum The number of points given in the array
- * @return The bounding box that contains all the points given as parameters
+ * @function mnkt_depthOnlyKernel
+ * Triangle kernel for depth only programs (depth prepass): the interpolated depth of the spans of the triangle
+ * is tested and written with vector instructions, varyings and color buffer are never touched
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param shader Shader program (defines the depth states)
+ * @param varyings Varyings of the vertices of the triangle (unused)
+ * @param fb Framebuffer on which the triangle will be rasterized
 */
-static BBox_t mnkt_getScreenBBox(Vec3_t* points, size_t pointsNum)
+static void mnkt_depthOnlyKernel(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,
+                                 const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
 {
-        if(points == NULL || pointsNum == 0)
-        {
-                return (BBox_t) {
-                        .x = 0,
-                        .y = 0,
-                        .width = 0,
-                        .height = 0,
-                };
-        }
-        
-        BBox_t box = {
-                .x      = points[0].x,
-                .y      = points[0].y,
-                .width  = points[0].x,
-                .height = points[0].y,
-        };
-        
-        // Search min and max values of x and y
-        for(size_t i = 1; i < pointsNum; ++i)
+        (void) varyings;
+
+        uint64_t samplesPassed = mnkt_rasterizeTriangleSpans(screenCoords, setup, triangleRect, shader->depthFunc, !shader->depthWriteDisabled, NULL, fb);
+
+        if(fb->query != NULL)
+                fb->query->samplesPassed += samplesPassed;
+}
+
+
+/**
+ * @function mnkt_targetsKernel
+ * Triangle kernel for multiple targets programs: the exact extents of the triangle are computed for each row,
+ * the fragments that pass the depth test are shaded once and the outputs are stored into the framebuffer's color attachments
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param shader Shader program (defines the targets shader and the depth states)
+ * @param varyings Varyings of the vertices of the triangle
+ * @param fb Framebuffer on which the triangle will be rasterized
+*/
+static void mnkt_targetsKernel(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,
+                               const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
+{
+        const size_t varyingsCount = mnkt_getInterpolatedVaryingsCount(shader);
+        const Vec3_t baryDx = setup->baryDx;
+
+        ShaderParameter_t fragVaryings[MAX_VARYING_PARAMS];
+        memcpy(fragVaryings, varyings[0], sizeof(fragVaryings));
+
+        uint64_t samplesPassed = 0;
+
+        for(int32_t y = triangleRect->y; y < triangleRect->y + triangleRect->height; ++y)
         {
-                if(points[i].x < box.x)
-                {
-                        box.x = points[i].x;
+                Vec3_t barycentricCoords;
+                int32_t xStart;
+                int32_t xEnd;
 
-                } else if(points[i].x > box.width)
-                {
-                        box.width = points[i].x;
-                }
+                if( !mnkt_getTriangleRowSpan(setup, triangleRect, y, &barycentricCoords, &xStart, &xEnd) )
+                        continue;
 
-                if(points[i].y < box.y)
-                {
-                        box.y = points[i].y;
+                size_t fragIndex = ((size_t) y * fb->width) + xStart;
+                Vec2_t fragCoords = { .x = xStart, .y = y };
+                const float rowDepth = (barycentricCoords.x * screenCoords[0].z) + (barycentricCoords.y * screenCoords[1].z) + (barycentricCoords.z * screenCoords[2].z);
 
-                } else if(points[i].y > box.height)
+                for(int32_t x = xStart; x < xEnd; ++x, ++fragIndex, ++fragCoords.x, barycentricCoords.x += baryDx.x,
+                        barycentricCoords.y += baryDx.y, barycentricCoords.z += baryDx.z)
                 {
-                        box.height = points[i].y;
+                        const float fragDepth = rowDepth + ((float) (x - xStart) * setup->depthDx);
+
+                        if( !mnkt_depthTest(shader->depthFunc, fragDepth, fb->depthBuffer[fragIndex]) )
+                                continue;
+
+                        mnkt_interpolateVaryings(varyings, &barycentricCoords, varyingsCount, fragVaryings);
+
+                        if( !mnkt_shadeTargets(shader, fragVaryings, shader->uniforms, &fragCoords, fragIndex, fb) )
+                                continue;
+
+                        ++samplesPassed;
+
+                        if( !shader->depthWriteDisabled )
+                                fb->depthBuffer[fragIndex] = fragDepth;
                 }
         }
 
-        box.width -= box.x;     // Compute box width (currently in such variable is stored the max x value found)
-        box.height -= box.y;    // Compute box height (currently in such variable is stored the max y value found)
-        
-        return box;
+        if(fb->query != NULL)
+                fb->query->samplesPassed += samplesPassed;
 }
 
 
 /**
- * @function mnkt_getTriangleBarycentricCoords
- * Computes the barycentric coordinates of a point relative to a triangle
- * @param vertices Vertices of the triangle expressed in counter-clockwise order
- * @param point Point of which barycentric coordinates must be computed
- * @return The barycentric coordinates of the given point relative to the specified triangle
- * @note: This function assumes that the given point lies on the same plane of the triangle, 
- *      all the z coordinates of the given vertices are ignored
+ * @function mnkt_testOnlyKernel
+ * Triangle kernel used while a test only occlusion query is active: the depth of each row span is tested in chunks
+ * with vector instructions and the fragments that pass the test are counted, nothing is shaded or written
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param shader Shader program (defines the depth function)
+ * @param varyings Varyings of the vertices of the triangle (unused)
+ * @param fb Framebuffer on which the query is active
 */
-static Vec3_t mnkt_getTriangleBarycentricCoords(const Vec3_t vertices[3], const Vec2_t* point)
+static void mnkt_testOnlyKernel(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect,
+                                const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
 {
-        Vec2_t a = { vertices[0].x, vertices[0].y };
-        Vec2_t b = { vertices[1].x, vertices[1].y };
-        Vec2_t c = { vertices[2].x, vertices[2].y };
-
-        // Compute two of the triangle's edges
-        Vec2_t ab = mnkt_vec2_sub( &b, &a );
-        Vec2_t ac = mnkt_vec2_sub( &c, &a );
-
-        // Compute vector from vertex A to the point P
-        Vec2_t ap = mnkt_vec2_sub( point, &a );
+        (void) varyings;
 
-        float precomputedDenom = 1 / ( (ab.x * ac.y) - (ab.y * ac.x) );
+        fb->query->samplesPassed += mnkt_rasterizeTriangleSpans(screenCoords, setup, triangleRect, shader->depthFunc, 0, NULL, fb);
+}
 
-        // Compute v and w barycentric coords
-        float v = (ac.y * ap.x - ac.x * ap.y) * precomputedDenom;
-        float w = (ab.x * ap.y - ab.y * ap.x) * precomputedDenom;
 
-        return (Vec3_t) {
-                .x = 1.0f - v - w,
-                .y = v,
-                .z = w
-        };
-}
+/**
+ * @var mnkt_builtinKernels
+ * Dispatch table of the built-in shaders kernels, indexed by [built-in shader - 1][depth func][depth write]
+*/
+static const TriangleKernel_t mnkt_builtinKernels[4][4][2] = {
+        MNKT_BUILTIN_KERNELS_TABLE(FLAT_COLOR),
+        MNKT_BUILTIN_KERNELS_TABLE(VERTEX_COLOR),
+        MNKT_BUILTIN_KERNELS_TABLE(TEXTURED),
+        MNKT_BUILTIN_KERNELS_TABLE(TEXTURED_MODULATED)
+};
 
 
 /**
- * @function mnkt_drawFragment
- * Computes color and depth values of a fragment and stores them into the given framebuffer.
- * @param fragCoords Coordinates of the fragment inside the frame buffer, those will be passed to the fragment shader (must be non null)
- * @param fragDepth Depth value, computed by the vertex shader, for the fragment; this will be used for depth test against fb's depth buffer
- * @param fragIndex Index of the fragment to be drawn inside the frame buffer, this will be used to access fb's color and depth buffers
- * @param shader Shader program to be used to compute the fragment color
- * @param varyings Additional parameters, outputted by the vertex shader, to be passed as input to the fragment shader
- * @param fb Frame buffer into which the fragment should be drawn
+ * @function mnkt_rasterizePoint
+ * Rasterizes a 2D point as a square sprite (clipped to the framebuffer's clip rectangle) and invokes the fragment shader for each fragment produced.
+ * The coordinates of each fragment inside the sprite are passed to the fragment shader through the MNKT_BUILTIN_POINT_COORD uniform.
+ * @param screenCoords Vector which defines the screen coordinates of the center of the point to be rasterized
+ * @param pointSize Number of pixels that the sprite extends from its center on each side.
+ *      Use 0 to rasterize a single pixel.
+ * @param shader Shader to be used to determine the color of each fragment produced
+ * @param varyings Additional output parameters produced by the vertex shader (passed as input to the fragment shader)
+ * @param fb Framebuffer on which the point will be rasterized
 */
-static void mnkt_drawFragment(const Vec2_t* fragCoords, float fragDepth, size_t fragIndex, const ShaderProgram_t* shader, const ShaderParameter_t* varyings, Framebuffer_t* fb)
+void mnkt_rasterizePoint(Vec3_t screenCoords, const size_t pointSize, const ShaderProgram_t* shader, const ShaderParameter_t varyings[MAX_VARYING_PARAMS], Framebuffer_t* fb)
 {
-        int discard = 0;
-
-        // Perform depth test
-        if(fb->depthBuffer[fragIndex] <= fragDepth)
-        {
-                // If current fragment's depth is greater than what is already stored in the depth buffer, then skip the fragment
+        if(shader == NULL || varyings == NULL || fb == NULL)
                 return;
-        }
 
-        // Invoke fragment shader
-        Vec4_t fragColor = shader->fragmentShader(varyings, shader->uniforms, fragCoords, &discard);
-        
-        // Discard fragment, if necessary
-        if(discard != 0)
+        // Determine area of the framebuffer on which point will be rasterized (clamped onto the clip rectangle)
+        Rect_t clipRect = mnkt_framebuffer_getClipRect(fb);
+        Rect_t pointRect;
+
+        BBox_t bBox = {
+                .x = floorf(screenCoords.x - pointSize),
+                .y = floorf(screenCoords.y - pointSize),
+                .width = (2 * pointSize) + 1,
+                .height = (2 * pointSize) + 1
+        };
+
+        if( !mnkt_clipBBox(&bBox, &clipRect, &pointRect) )
                 return;
 
-        // TODO: Perform color blending (if requested by the shader)
+        const float invSpriteSize = 1.0f / bBox.width;
+        const float fragDepth = screenCoords.z;
 
-        // Update framebuffer content
-        fb->colorBuffer[ fragIndex * 3 ] =              mnkt_colorAsUChar(fragColor.r);
-        fb->colorBuffer[ (fragIndex * 3) + 1 ] =        mnkt_colorAsUChar(fragColor.g);
-        fb->colorBuffer[ (fragIndex * 3) + 2 ] =        mnkt_colorAsUChar(fragColor.b);
+        Vec2_t fragCoords;
 
-        fb->depthBuffer[fragIndex] = fragDepth;
-}
+        // On multisampled framebuffers each fragment goes through the per-sample path (the uniforms are updated on a copy of the shader)
+        if(fb->multisample.samplesCount > 1)
+        {
+                ShaderProgram_t spriteShader = *shader;
+                Vec2_t* pointCoord = &spriteShader.uniforms[MNKT_BUILTIN_POINT_COORD].vec2;
+
+                for(int32_t y = pointRect.y; y < pointRect.y + pointRect.height; ++y)
+                {
+                        fragCoords.y = y;
+                        pointCoord->y = (y + 0.5f - bBox.y) * invSpriteSize;
+
+                        size_t fragIndex = ((size_t) y * fb->width) + (size_t) pointRect.x;
+
+                        for(int32_t x = pointRect.x; x < pointRect.x + pointRect.width; ++x, ++fragIndex)
+                        {
+                                fragCoords.x = x;
+                                pointCoord->x = (x + 0.5f - bBox.x) * invSpriteSize;
 
+                                mnkt_drawFragment(&fragCoords, fragDepth, 1.0f, fragIndex, &spriteShader, varyings, NULL, fb);
+                        }
+                }
+
+                return;
+        }
+
+        ShaderParameter_t uniforms[MAX_UNIFORM_PARAMS + MNKT_BUILTIN_PARAMS_COUNT];
+        memcpy(uniforms, shader->uniforms, sizeof(uniforms));
+
+        Vec2_t* pointCoord = &uniforms[MNKT_BUILTIN_POINT_COORD].vec2;
+        FragmentSpan_t span = { .count = 0 };
+
+        const int testOnly = fb->query != NULL && fb->query->testOnly;
+        const int depthOnly = mnkt_isDepthOnly(shader, fb);
+
+        // The sprite is processed by rows, the depth of a whole chunk of fragments is tested and written at once
+        for(int32_t y = pointRect.y; y < pointRect.y + pointRect.height; ++y)
+        {
+                fragCoords.y = y;
+                pointCoord->y = (y + 0.5f - bBox.y) * invSpriteSize;
+
+                const size_t rowIndex = (size_t) y * fb->width;
+
+                for(int32_t chunkX = pointRect.x; chunkX < pointRect.x + pointRect.width; chunkX += MNKT_DEPTH_CHUNK_LENGTH)
+                {
+                        size_t chunkLength = (size_t) (pointRect.x + pointRect.width - chunkX);
+                        if(chunkLength > MNKT_DEPTH_CHUNK_LENGTH)
+                                chunkLength = MNKT_DEPTH_CHUNK_LENGTH;
+
+                        float* depthChunk = &fb->depthBuffer[rowIndex + chunkX];
+
+                        uint32_t passMask = mnkt_depthTestSpan(shader->depthFunc, depthChunk, fragDepth, 0.0f, 0, chunkLength);
+                        uint32_t writeMask = 0;
+
+                        if(passMask == 0)
+                                continue;
+
+                        if(testOnly)
+                        {
+                                fb->query->samplesPassed += mnkt_countBits(passMask);
+                                continue;
+                        }
+
+                        // Depth only programs write the depth of all the fragments that passed the test
+                        if(depthOnly)
+                        {
+                                if(fb->query != NULL)
+                                        fb->query->samplesPassed += mnkt_countBits(passMask);
+
+                                if( !shader->depthWriteDisabled )
+                                        mnkt_writeDepthSpan(depthChunk, fragDepth, 0.0f, 0, passMask, chunkLength);
+
+                                continue;
+                        }
+
+                        for(size_t i = 0; i < chunkLength; ++i)
+                        {
+                                if( !(passMask & (1u << i)) )
+                                        continue;
+
+                                int32_t x = chunkX + (int32_t) i;
+                                int discard = 0;
+
+                                fragCoords.x = x;
+                                pointCoord->x = (x + 0.5f - bBox.x) * invSpriteSize;
+
+                                if(shader->targetsShader != NULL)
+                                {
+                                        if( mnkt_shadeTargets(shader, varyings, uniforms, &fragCoords, rowIndex + x, fb) )
+                                                writeMask |= 1u << i;
+
+                                        continue;
+                                }
+
+                                Vec4_t fragColor = mnkt_shadeFragment(shader, varyings, uniforms, &fragCoords, &discard);
+
+                                if(discard != 0)
+                                        continue;
+
+                                writeMask |= 1u << i;
+                                mnkt_writeFragmentColor(&fragColor, rowIndex + x, shader, &span, fb);
+                        }
+
+                        if(fb->query != NULL)
+                                fb->query->samplesPassed += mnkt_countBits(writeMask);
+
+                        if( !shader->depthWriteDisabled )
+                                mnkt_writeDepthSpan(depthChunk, fragDepth, 0.0f, 0, writeMask, chunkLength);
+                }
+        }
+
+        mnkt_flushSpan(&span, shader, fb);
+}
+
+
+/**
+ * @function mnkt_rasterizeLine
+ * Rasterizes a 2D line and invokes the fragment shader for each fragment produced.
+ * The line is stepped along its major axis using fixed point arithmetic, depth and varyings are interpolated
+ * between the two extreme points; its width and anti-aliasing are defined by the shader program.
+ * Anti-aliased lines compute the coverage of each pixel across the line and, at its extremes, along the major axis
+ * (the ends of the line are cut perpendicularly to the major axis rather than to the line).
+ * @param screenCoords Array of vectors which defines the screen coordinates of the two extreme points of the line to be rasterized
+ * @param shader Shader to be used to determine the color of each fragment produced
+ * @param varyings Additional output parameters produced by the vertex shader for the two extreme points of the line
+ *      (those will be interpolated across the line and passed as input to the fragment shader)
+ * @param fb Framebuffer on which the line will be rasterized
+*/
+void mnkt_rasterizeLine(Vec3_t screenCoords[2], const ShaderProgram_t* shader, const ShaderParameter_t varyings[2][MAX_VARYING_PARAMS], Framebuffer_t* fb)
+{
+        if(shader == NULL || varyings == NULL || fb == NULL)
+                return;
+
+        Rect_t clipRect = mnkt_framebuffer_getClipRect(fb);
+        if(clipRect.width == 0 || clipRect.height == 0)
+                return;
+
+        const float lineWidth = shader->lineWidth > 1.0f ? shader->lineWidth : 1.0f;
+
+        // Clip the line against the clip rectangle (enlarged so that the pixels covered by the line's width are kept)
+        float tStart = 0.0f;
+        float tEnd = 1.0f;
+
+        if( !mnkt_clipSegment(screenCoords, &clipRect, (lineWidth / 2.0f) + 1.0f, &tStart, &tEnd) )
+                return;
+
+        // Anti-aliased lines blend their coverage with the framebuffer content (standard alpha blending is used if the shader does not define one)
+        ShaderProgram_t smoothShader;
+
+        if(shader->lineSmooth && !shader->blend.enabled)
+        {
+                smoothShader = *shader;
+                smoothShader.blend = mnkt_blend_alphaState();
+                shader = &smoothShader;
+        }
+
+        // Express the line in terms of its major (the one with the greatest extent) and minor axes
+        const int xMajor = fabsf(screenCoords[1].x - screenCoords[0].x) >= fabsf(screenCoords[1].y - screenCoords[0].y);
+
+        float startMajor = xMajor ? screenCoords[0].x : screenCoords[0].y;
+        float startMinor = xMajor ? screenCoords[0].y : screenCoords[0].x;
+        float endMajor = xMajor ? screenCoords[1].x : screenCoords[1].y;
+        float endMinor = xMajor ? screenCoords[1].y : screenCoords[1].x;
+
+        const float majorDelta = endMajor - startMajor;
+        if(majorDelta == 0.0f)
+                return;
+
+        const float slope = (endMinor - startMinor) / majorDelta;
+
+        // Clipped extremes, ordered along the major axis
+        float clippedStart = startMajor + (tStart * majorDelta);
+        float clippedEnd = startMajor + (tEnd * majorDelta);
+
+        if(clippedStart > clippedEnd)
+        {
+                float tmp = clippedStart;
+                clippedStart = clippedEnd;
+                clippedEnd = tmp;
+        }
+
+        // Determine the first and last pixels along the major axis: the ones whose center lies on the line (both extremes are included),
+        // anti-aliased lines also keep the pixels partially covered by their extremes
+        const int32_t clipMajorMin = xMajor ? clipRect.x : clipRect.y;
+        const int32_t clipMajorMax = xMajor ? clipRect.x + clipRect.width : clipRect.y + clipRect.height;
+        const int32_t clipMinorMin = xMajor ? clipRect.y : clipRect.x;
+        const int32_t clipMinorMax = xMajor ? clipRect.y + clipRect.height : clipRect.x + clipRect.width;
+
+        int32_t firstPixel = shader->lineSmooth ? floorf(clippedStart) : ceilf(clippedStart - 0.5f);
+        int32_t lastPixel = shader->lineSmooth ? ceilf(clippedEnd) - 1.0f : floorf(clippedEnd - 0.5f);
+
+        if(firstPixel < clipMajorMin)
+                firstPixel = clipMajorMin;
+
+        if(lastPixel >= clipMajorMax)
+                lastPixel = clipMajorMax - 1;
+
+        if(firstPixel > lastPixel)
+                return;
+
+        // Setup the stepping along the minor axis (16.16 fixed point), the line's width is measured perpendicularly to the line.
+        // The stepping starts from the first pixel of the line clipped against the whole framebuffer, so that the pixels produced
+        // do not depend on the viewport and the scissor (e.g. a line drawn across the bands of a frame pipeline is rasterized
+        // as if it was drawn at once) and the origin stays close to the framebuffer even if the extreme points are far away
+        const int64_t FIXED_ONE = 1 << 16;
+        const int64_t FIXED_HALF = FIXED_ONE / 2;
+
+        const Rect_t fbRect = { .x = 0, .y = 0, .width = (int32_t) fb->width, .height = (int32_t) fb->height };
+        float tOriginStart = 0.0f;
+        float tOriginEnd = 1.0f;
+
+        if( !mnkt_clipSegment(screenCoords, &fbRect, (lineWidth / 2.0f) + 1.0f, &tOriginStart, &tOriginEnd) )
+                return;
+
+        const int32_t originPixel = ceilf(fminf(startMajor + (tOriginStart * majorDelta), startMajor + (tOriginEnd * majorDelta)) - 0.5f);
+        const float originCenter = originPixel + 0.5f;
+        const int64_t minorStepFixed = (int64_t) (slope * FIXED_ONE);
+        int64_t minorFixed = (int64_t) ( (startMinor + (slope * (originCenter - startMajor))) * FIXED_ONE ) +
+                             ((int64_t) (firstPixel - originPixel) * minorStepFixed);
+        const int64_t halfWidthFixed = (int64_t) ( (lineWidth / 2.0f) * sqrtf(1.0f + (slope * slope)) * FIXED_ONE );
+
+        // Setup the interpolation parameter (0 on the first extreme point, 1 on the second one)
+        const float tOrigin = (originCenter - startMajor) / majorDelta;
+        const float tStep = 1.0f / majorDelta;
+
+        // Extent of the (unclipped) line along the major axis, used for the coverage of the pixels at its extremes
+        const float lineMin = fminf(startMajor, endMajor);
+        const float lineMax = fmaxf(startMajor, endMajor);
+
+        const size_t varyingsCount = mnkt_getInterpolatedVaryingsCount(shader);
+
+        ShaderParameter_t fragVaryings[MAX_VARYING_PARAMS];
+        memcpy(fragVaryings, varyings[0], sizeof(fragVaryings));
+
+        FragmentSpan_t span = { .count = 0 };
+
+        for(int32_t major = firstPixel; major <= lastPixel; ++major, minorFixed += minorStepFixed)
+        {
+                // Compute the pixels covered, along the minor axis, by the line's width
+                int64_t low = minorFixed - halfWidthFixed;
+                int64_t high = minorFixed + halfWidthFixed;
+
+                int32_t firstMinor;
+                int32_t lastMinor;
+
+                if(shader->lineSmooth)
+                {
+                        // All the pixels that overlap the line
+                        firstMinor = (int32_t) (low >> 16);
+                        lastMinor = (int32_t) ((high + FIXED_ONE - 1) >> 16) - 1;
+                } else {
+                        // Only the pixels whose center is covered
+                        firstMinor = (int32_t) ((low - FIXED_HALF + FIXED_ONE - 1) >> 16);
+                        lastMinor = (int32_t) ((high - FIXED_HALF + FIXED_ONE - 1) >> 16) - 1;
+                }
+
+                if(firstMinor < clipMinorMin)
+                        firstMinor = clipMinorMin;
+
+                if(lastMinor >= clipMinorMax)
+                        lastMinor = clipMinorMax - 1;
+
+                if(firstMinor > lastMinor)
+                        continue;
+
+                // Interpolate depth and varyings (the same values are used for all the pixels along the minor axis)
+                float t = tOrigin + ((float) (major - originPixel) * tStep);
+                float clampedT = mnkt_math_clamp(t, 0.0f, 1.0f);
+                float fragDepth = mnkt_math_lerp(screenCoords[0].z, screenCoords[1].z, clampedT);
+
+                mnkt_lerpVaryings(varyings[0], varyings[1], clampedT, varyingsCount, fragVaryings);
+
+                // Fraction of the pixels' column (or row) covered along the major axis, less than one only at the extremes
+                // (the ends of the line are cut perpendicularly to the major axis)
+                const float majorCoverage = fminf((float) major + 1.0f, lineMax) - fmaxf((float) major, lineMin);
+
+                if(shader->lineSmooth && majorCoverage <= 0.0f)
+                        continue;
+
+                for(int32_t minor = firstMinor; minor <= lastMinor; ++minor)
+                {
+                        float coverage = 1.0f;
+
+                        if(shader->lineSmooth)
+                        {
+                                // Fraction of the pixel covered by the line (analytic coverage along the minor axis, scaled by the one along the major axis)
+                                int64_t pixelLow = (int64_t) minor << 16;
+                                int64_t overlapLow = low > pixelLow ? low : pixelLow;
+                                int64_t overlapHigh = high < pixelLow + FIXED_ONE ? high : pixelLow + FIXED_ONE;
+
+                                coverage = ((float) (overlapHigh - overlapLow) / FIXED_ONE) * fminf(majorCoverage, 1.0f);
+                        }
+
+                        int32_t x = xMajor ? major : minor;
+                        int32_t y = xMajor ? minor : major;
+                        Vec2_t fragCoords = { x, y };
+
+                        mnkt_drawFragment(&fragCoords, fragDepth, coverage, ((size_t) y * fb->width) + x, shader, fragVaryings, &span, fb);
+                }
+        }
+
+        mnkt_flushSpan(&span, shader, fb);
+}
+
+
+/*
+ * @function mnkt_rasterizeTriangle
+ * Rasterizes a 2D triangle and invokes the fragment shader for each fragment produced.
+ * @param screenCoords Array of vectors which defines the screen coordinates of the vertices of the triangle to be rasterized
+ * @param shader Shader to be used to determine the color of each fragment produced
+ * @param varyings Additional output parameters produced by the vertex shader for the vertices of the triangle
+ *      (those will be interpolated across the triangle surface and passed as input to the fragment shader)
+ * @param fb Framebuffer on which the line will be rasterized
+*/
+void mnkt_rasterizeTriangle(Vec3_t screenCoords[3], const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
+{
+        if(shader == NULL || varyings == NULL || fb == NULL)
+                return;
+
+        // Compute triangle's bounding box and clamp it onto the clip rectangle (framebuffer, viewport and scissor),
+        // so that no work is done for the regions of the triangle that cannot produce fragments
+        Rect_t clipRect = mnkt_framebuffer_getClipRect(fb);
+        Rect_t triangleRect;
+
+        BBox_t bBox = mnkt_getScreenBBox(screenCoords, 3);
+
+        // Fragments of single sampled framebuffers are produced at the pixel centers: most of the triangles of dense meshes
+        // are smaller than a pixel and fall between the centers, so they are rejected before any other work
+        const int smallTriangle = fb->multisample.samplesCount <= 1 &&
+                                  bBox.width <= MNKT_SMALL_TRIANGLE_SIZE && bBox.height <= MNKT_SMALL_TRIANGLE_SIZE;
+
+        if( smallTriangle && !mnkt_bboxContainsPixelCenter(&bBox) )
+                return;
+
+        if( !mnkt_clipBBox(&bBox, &clipRect, &triangleRect) )
+                return;
+
+        // Precompute the data needed to compute barycentric coordinates (degenerate triangles produce no fragment)
+        TriangleSetup_t setup;
+
+        if( !mnkt_setupTriangle(screenCoords, &setup) )
+                return;
+
+        // The few pixel centers of small triangles are tested directly: triangles that cover none of them are rejected
+        // and the kernel visits only the rows that are actually covered
+        if( smallTriangle && !mnkt_getSmallTriangleRows(&setup, &triangleRect) )
+                return;
+
+        // Multisampled framebuffers need coverage and depth for each sample
+        if(fb->multisample.samplesCount > 1)
+        {
+                mnkt_rasterizeTriangleMultisample(screenCoords, &setup, &triangleRect, shader, varyings, fb);
+                return;
+        }
+
+        // Pick the kernel specialized for the current states (unknown depth functions behave as MNKT_DEPTH_LESS)
+        const int depthFunc = shader->depthFunc <= MNKT_DEPTH_EQUAL ? (int) shader->depthFunc : MNKT_DEPTH_LESS;
+        const int depthWrite = !shader->depthWriteDisabled;
+        const int blend = shader->blend.enabled != 0;
+        const int interpolate = shader->varyingsCount > 0;
+
+        TriangleKernel_t kernel;
+
+        if(fb->query != NULL && fb->query->testOnly)
+                kernel = mnkt_testOnlyKernel;
+        else if( mnkt_isDepthOnly(shader, fb) )
+                kernel = mnkt_depthOnlyKernel;
+        else if(shader->targetsShader != NULL)
+                kernel = mnkt_targetsKernel;
+        else if(shader->builtinShader == MNKT_SHADER_FLAT_COLOR && !blend)
+                kernel = mnkt_flatColorSpanKernel;
+        else if(shader->builtinShader > MNKT_SHADER_CUSTOM && shader->builtinShader <= MNKT_SHADER_TEXTURED_MODULATED)
+                kernel = mnkt_builtinKernels[shader->builtinShader - 1][depthFunc][depthWrite];
+        else
+                kernel = mnkt_triangleKernels[0][depthFunc][depthWrite][blend][interpolate];
+
+        kernel(screenCoords, &setup, &triangleRect, shader, varyings, fb);
+}
+
+
+/**
+ * @function mnkt_rasterizeTriangleMultisample
+ * Rasterizes a 2D triangle on a multisampled framebuffer, coverage and depth are computed for each sample
+ * but the fragment shader is invoked only once for each pixel.
+ * @param screenCoords Screen coordinates of the vertices of the triangle
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param shader Shader to be used to determine the color of each fragment produced
+ * @param varyings Varyings outputted by the vertex shader for the three vertices of the triangle
+ * @param fb Multisampled framebuffer on which the triangle will be rasterized
+ * @note: For internal usage only!!!
+*/
+static void mnkt_rasterizeTriangleMultisample(const Vec3_t screenCoords[3], const TriangleSetup_t* setup, const Rect_t* triangleRect, const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb)
+{
+        const float EPSILON = 0.00001f;
+        const size_t varyingsCount = mnkt_getInterpolatedVaryingsCount(shader);
+
+        ShaderParameter_t fragVaryings[MAX_VARYING_PARAMS];
+        memcpy(fragVaryings, varyings[0], sizeof(fragVaryings));
+
+        const uint32_t samplesCount = fb->multisample.samplesCount;
+        const Vec2_t* samplePositions = mnkt_framebuffer_getSamplePositions(samplesCount);
+
+        float samplesDepth[MNKT_MAX_SAMPLES];
+
+        for(int32_t y = triangleRect->y; y < triangleRect->y + triangleRect->height; ++y)
+        {
+                size_t fragIndex = ((size_t) y * fb->width) + triangleRect->x;
+
+                for(int32_t x = triangleRect->x; x < triangleRect->x + triangleRect->width; ++x, ++fragIndex)
+                {
+                        uint32_t coverageMask = 0;
+
+                        // Compute coverage and depth of each sample
+                        for(uint32_t s = 0; s < samplesCount; ++s)
+                        {
+                                Vec2_t sampleCoords = { x + 0.5f + samplePositions[s].x, y + 0.5f + samplePositions[s].y };
+                                Vec3_t barycentricCoords = mnkt_getTriangleBarycentricCoords(setup, &sampleCoords);
+
+                                if(barycentricCoords.x > -EPSILON && barycentricCoords.y > -EPSILON && barycentricCoords.z > -EPSILON)
+                                {
+                                        coverageMask |= 1u << s;
+                                        samplesDepth[s] = (barycentricCoords.x * screenCoords[0].z) + (barycentricCoords.y * screenCoords[1].z) + (barycentricCoords.z * screenCoords[2].z);
+                                }
+                        }
+
+                        if(coverageMask == 0)
+                                continue;
+
+                        Vec2_t fragCoords = { x, y };
+
+                        // Varyings are interpolated at the pixel center
+                        if(varyingsCount > 0)
+                        {
+                                Vec2_t fragCenterCoords = { x + 0.5f, y + 0.5f };
+                                Vec3_t barycentricCoords = mnkt_getTriangleBarycentricCoords(setup, &fragCenterCoords);
+
+                                mnkt_interpolateVaryings(varyings, &barycentricCoords, varyingsCount, fragVaryings);
+                        }
+
+                        mnkt_drawSamples(&fragCoords, coverageMask, samplesDepth, fragIndex, shader, fragVaryings, fb);
+                }
+        }
+}
+
+
+/**
+ * @function mnkt_interpolateVaryings
+ * Computes the varyings of a point inside a triangle from those of its vertices, each varying is interpolated as a Vec4_t
+ * @param varyings Varyings of the three vertices of the triangle
+ * @param barycentricCoords Barycentric coordinates of the point relative to the triangle
+ * @param count Number of varyings to be interpolated (starting from the first one)
+ * @param result Array in which the interpolated varyings are stored
+*/
+static void mnkt_interpolateVaryings(const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], const Vec3_t* barycentricCoords, size_t count, ShaderParameter_t* result)
+{
+        for(size_t i = 0; i < count; ++i)
+        {
+                const Vec4_t* a = &varyings[0][i].vec4;
+                const Vec4_t* b = &varyings[1][i].vec4;
+                const Vec4_t* c = &varyings[2][i].vec4;
+
+                result[i].vec4.x = (barycentricCoords->x * a->x) + (barycentricCoords->y * b->x) + (barycentricCoords->z * c->x);
+                result[i].vec4.y = (barycentricCoords->x * a->y) + (barycentricCoords->y * b->y) + (barycentricCoords->z * c->y);
+                result[i].vec4.z = (barycentricCoords->x * a->z) + (barycentricCoords->y * b->z) + (barycentricCoords->z * c->z);
+                result[i].vec4.w = (barycentricCoords->x * a->w) + (barycentricCoords->y * b->w) + (barycentricCoords->z * c->w);
+        }
+}
+
+
+/**
+ * @function mnkt_getScreenBBox
+ * @param points Array of points, expressed in screen coordinates, for which the bounding box must be computed
+ * @param pointsNum The number of points given in the array
+ * @return The bounding box that contains all the points given as parameters
+*/
+static BBox_t mnkt_getScreenBBox(Vec3_t* points, size_t pointsNum)
+{
+        if(points == NULL || pointsNum == 0)
+        {
+                return (BBox_t) {
+                        .x = 0,
+                        .y = 0,
+                        .width = 0,
+                        .height = 0,
+                };
+        }
+        
+        BBox_t box = {
+                .x      = points[0].x,
+                .y      = points[0].y,
+                .width  = points[0].x,
+                .height = points[0].y,
+        };
+        
+        // Search min and max values of x and y
+        for(size_t i = 1; i < pointsNum; ++i)
+        {
+                if(points[i].x < box.x)
+                {
+                        box.x = points[i].x;
+
+                } else if(points[i].x > box.width)
+                {
+                        box.width = points[i].x;
+                }
+
+                if(points[i].y < box.y)
+                {
+                        box.y = points[i].y;
+
+                } else if(points[i].y > box.height)
+                {
+                        box.height = points[i].y;
+                }
+        }
+
+        box.width -= box.x;     // Compute box width (currently in such variable is stored the max x value found)
+        box.height -= box.y;    // Compute box height (currently in such variable is stored the max y value found)
+        
+        return box;
+}
+
+
+/**
+ * @function mnkt_clipBBox
+ * Computes the pixels covered by a bounding box that are inside the given clip rectangle
+ * @param bBox Bounding box, expressed in screen coordinates, to be clipped
+ * @param clipRect Area of the framebuffer in which fragments can be produced
+ * @param pixelRect Rectangle in which the pixels covered by the clipped bounding box are stored
+ * @return One if at least one pixel is covered, zero if the bounding box is completely outside the clip rectangle
+ *      or if its coordinates are not finite
+*/
+static int mnkt_clipBBox(const BBox_t* bBox, const Rect_t* clipRect, Rect_t* pixelRect)
+{
+        // fmaxf and fminf drop NaN operands, so coordinates that are not finite must be rejected before clipping
+        if( !isfinite(bBox->x) || !isfinite(bBox->y) || !isfinite(bBox->width) || !isfinite(bBox->height) )
+                return 0;
+
+        float minX = fmaxf(floorf(bBox->x), clipRect->x);
+        float minY = fmaxf(floorf(bBox->y), clipRect->y);
+        float maxX = fminf(ceilf(bBox->x + bBox->width), clipRect->x + clipRect->width);
+        float maxY = fminf(ceilf(bBox->y + bBox->height), clipRect->y + clipRect->height);
+
+        if( !(maxX > minX && maxY > minY) )
+                return 0;
+
+        pixelRect->x = minX;
+        pixelRect->y = minY;
+        pixelRect->width = maxX - minX;
+        pixelRect->height = maxY - minY;
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_bboxContainsPixelCenter
+ * Checks if a bounding box can contain the center of a pixel (the box is slightly enlarged, since the coverage test
+ * accepts points that are at most EPSILON, in barycentric coordinates, outside the triangle)
+ * @param bBox Bounding box, expressed in screen coordinates, of a small triangle
+ * @return One if a pixel center can be inside the box, zero otherwise
+*/
+static int mnkt_bboxContainsPixelCenter(const BBox_t* bBox)
+{
+        const float MARGIN = 0.001f;
+
+        // The pixel centers are at integer coordinates plus one half
+        const float firstX = ceilf(bBox->x - MARGIN - 0.5f);
+        const float lastX = floorf(bBox->x + bBox->width + MARGIN - 0.5f);
+        const float firstY = ceilf(bBox->y - MARGIN - 0.5f);
+        const float lastY = floorf(bBox->y + bBox->height + MARGIN - 0.5f);
+
+        // NaN coordinates are left to the clipping of the bounding box
+        return !(firstX > lastX || firstY > lastY);
+}
+
+
+/**
+ * @function mnkt_getSmallTriangleRows
+ * Tests the pixel centers of a small triangle one by one and narrows its rectangle to the rows that contain covered pixels
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box (at most MNKT_SMALL_TRIANGLE_SIZE + 1 pixels wide and high)
+ * @return One if at least one pixel center can be covered, zero if the triangle produces no fragment
+ * @note: The test is conservative, pixels close to the edges are left to the exact test performed by the kernels
+*/
+static int mnkt_getSmallTriangleRows(const TriangleSetup_t* setup, Rect_t* triangleRect)
+{
+        // Larger than the threshold of the coverage test, to absorb the rounding errors of the incremental evaluation of the kernels
+        const float EPSILON = 0.0001f;
+
+        int32_t firstRow = INT32_MAX;
+        int32_t lastRow = INT32_MIN;
+
+        for(int32_t y = triangleRect->y; y < triangleRect->y + triangleRect->height; ++y)
+        {
+                for(int32_t x = triangleRect->x; x < triangleRect->x + triangleRect->width; ++x)
+                {
+                        Vec2_t center = { x + 0.5f, y + 0.5f };
+                        Vec3_t barycentricCoords = mnkt_getTriangleBarycentricCoords(setup, &center);
+
+                        if(barycentricCoords.x > -EPSILON && barycentricCoords.y > -EPSILON && barycentricCoords.z > -EPSILON)
+                        {
+                                if(firstRow == INT32_MAX)
+                                        firstRow = y;
+
+                                lastRow = y;
+                                break;
+                        }
+                }
+        }
+
+        if(firstRow > lastRow)
+                return 0;
+
+        triangleRect->y = firstRow;
+        triangleRect->height = lastRow - firstRow + 1;
+        return 1;
+}
+
+
+/**
+ * @function mnkt_clipSegment
+ * Clips a segment against a rectangle (Liang-Barsky algorithm)
+ * @param points Screen coordinates of the extreme points of the segment
+ * @param clipRect Rectangle against which the segment is clipped
+ * @param padding Distance by which the rectangle is enlarged on each side
+ * @param tStart Where the interpolation parameter of the first point of the clipped segment is stored
+ * @param tEnd Where the interpolation parameter of the last point of the clipped segment is stored
+ * @return One if part of the segment is inside the rectangle, zero otherwise (or if its coordinates are not finite)
+*/
+static int mnkt_clipSegment(const Vec3_t points[2], const Rect_t* clipRect, float padding, float* tStart, float* tEnd)
+{
+        // Comparisons with NaN are false, so coordinates that are not finite would be accepted by the tests below
+        if( !isfinite(points[0].x) || !isfinite(points[0].y) || !isfinite(points[1].x) || !isfinite(points[1].y) )
+                return 0;
+
+        const float dx = points[1].x - points[0].x;
+        const float dy = points[1].y - points[0].y;
+
+        // For each side of the rectangle: the projection of the segment on the side's normal and the distance from the side
+        const float p[4] = { -dx, dx, -dy, dy };
+        const float q[4] = {
+                points[0].x - (clipRect->x - padding),
+                (clipRect->x + clipRect->width + padding) - points[0].x,
+                points[0].y - (clipRect->y - padding),
+                (clipRect->y + clipRect->height + padding) - points[0].y
+        };
+
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+
+        for(int i = 0; i < 4; ++i)
+        {
+                if(p[i] == 0.0f)
+                {
+                        // The segment is parallel to the side, reject it if it is outside
+                        if(q[i] < 0.0f)
+                                return 0;
+
+                        continue;
+                }
+
+                float t = q[i] / p[i];
+
+                if(p[i] < 0.0f)
+                {
+                        if(t > t0)
+                                t0 = t;
+                } else {
+                        if(t < t1)
+                                t1 = t;
+                }
+        }
+
+        if( !(t0 <= t1) )
+                return 0;
+
+        *tStart = t0;
+        *tEnd = t1;
+        return 1;
+}
+
+
+/**
+ * @function mnkt_lerpVaryings
+ * Computes the linear interpolation between two sets of varyings, each varying is interpolated as a Vec4_t
+ * @param varyingsA Varyings of the first vertex
+ * @param varyingsB Varyings of the second vertex
+ * @param t Interpolation parameter
+ * @param count Number of varyings to be interpolated (starting from the first one)
+ * @param result Array in which the interpolated varyings are stored
+*/
+static void mnkt_lerpVaryings(const ShaderParameter_t* varyingsA, const ShaderParameter_t* varyingsB, float t, size_t count, ShaderParameter_t* result)
+{
+        for(size_t i = 0; i < count; ++i)
+        {
+                result[i].vec4.x = varyingsA[i].vec4.x + t * (varyingsB[i].vec4.x - varyingsA[i].vec4.x);
+                result[i].vec4.y = varyingsA[i].vec4.y + t * (varyingsB[i].vec4.y - varyingsA[i].vec4.y);
+                result[i].vec4.z = varyingsA[i].vec4.z + t * (varyingsB[i].vec4.z - varyingsA[i].vec4.z);
+                result[i].vec4.w = varyingsA[i].vec4.w + t * (varyingsB[i].vec4.w - varyingsA[i].vec4.w);
+        }
+}
+
+
+/**
+ * @function mnkt_setupTriangle
+ * Precomputes the data needed to compute barycentric coordinates of points relative to a triangle
+ * @param vertices Vertices of the triangle
+ * @param setup Struct in which the precomputed data is stored
+ * @return One on success, zero if the triangle is degenerate (has no area)
+*/
+static int mnkt_setupTriangle(const Vec3_t vertices[3], TriangleSetup_t* setup)
+{
+        Vec2_t b = { vertices[1].x, vertices[1].y };
+        Vec2_t c = { vertices[2].x, vertices[2].y };
+
+        setup->a = (Vec2_t) { vertices[0].x, vertices[0].y };
+
+        // Compute two of the triangle's edges
+        setup->ab = mnkt_vec2_sub( &b, &setup->a );
+        setup->ac = mnkt_vec2_sub( &c, &setup->a );
+
+        float denom = (setup->ab.x * setup->ac.y) - (setup->ab.y * setup->ac.x);
+        if(denom == 0.0f || !isfinite(denom))
+                return 0;
+
+        setup->invDenom = 1 / denom;
+
+        // Barycentric coordinates are linear along each row
+        setup->baryDx.y = setup->ac.y * setup->invDenom;
+        setup->baryDx.z = -setup->ab.y * setup->invDenom;
+        setup->baryDx.x = -setup->baryDx.y - setup->baryDx.z;
+
+        // All the kernels compute the depth of a fragment from the one of the first pixel of its row span and this
+        // variation, so that different programs produce exactly the same depth values (needed by MNKT_DEPTH_EQUAL)
+        setup->depthDx = (setup->baryDx.x * vertices[0].z) + (setup->baryDx.y * vertices[1].z) + (setup->baryDx.z * vertices[2].z);
+        return 1;
+}
+
+
+/**
+ * @function mnkt_getTriangleBarycentricCoords
+ * Computes the barycentric coordinates of a point relative to a triangle
+ * @param setup Data precomputed for the triangle
+ * @param point Point of which barycentric coordinates must be computed
+ * @return The barycentric coordinates of the given point relative to the specified triangle
+ * @note: This function assumes that the given point lies on the same plane of the triangle, 
+ *      all the z coordinates of the given vertices are ignored
+*/
+static Vec3_t mnkt_getTriangleBarycentricCoords(const TriangleSetup_t* setup, const Vec2_t* point)
+{
+        // Compute vector from vertex A to the point P
+        Vec2_t ap = mnkt_vec2_sub( point, &setup->a );
+
+        // Compute v and w barycentric coords
+        float v = (setup->ac.y * ap.x - setup->ac.x * ap.y) * setup->invDenom;
+        float w = (setup->ab.x * ap.y - setup->ab.y * ap.x) * setup->invDenom;
+
+        return (Vec3_t) {
+                .x = 1.0f - v - w,
+                .y = v,
+                .z = w
+        };
+}
+
+
+/**
+ * @function mnkt_getTriangleRowSpan
+ * Computes the exact extents of the pixels covered by a triangle on a row of its bounding box
+ * @param setup Data precomputed for the triangle
+ * @param triangleRect Area of the framebuffer covered by the triangle's bounding box
+ * @param y Row to be processed
+ * @param barycentricCoords Where the barycentric coordinates of the center of the first covered pixel are stored
+ * @param xStart Where the x coordinate of the first covered pixel is stored
+ * @param xEnd Where the x coordinate following the last covered pixel is stored
+ * @return One if at least one pixel of the row is covered, zero otherwise
+*/
+static int mnkt_getTriangleRowSpan(const TriangleSetup_t* setup, const Rect_t* triangleRect, int32_t y, Vec3_t* barycentricCoords, int32_t* xStart, int32_t* xEnd)
+{
+        // Same threshold used by the per pixel test
+        const float EPSILON = 0.00001f;
+
+        Vec2_t rowStart = { triangleRect->x + 0.5f, y + 0.5f };
+        Vec3_t start = mnkt_getTriangleBarycentricCoords(setup, &rowStart);
+
+        const float startCoords[3] = { start.x, start.y, start.z };
+        const float gradients[3] = { setup->baryDx.x, setup->baryDx.y, setup->baryDx.z };
+
+        // Offsets (from the first pixel of the row) of the first and last covered pixels
+        float first = 0.0f;
+        float last = triangleRect->width - 1;
+
+        // Each barycentric coordinate must be greater than -EPSILON: start + gradient * offset > -EPSILON
+        for(int i = 0; i < 3; ++i)
+        {
+                if(gradients[i] == 0.0f)
+                {
+                        if(startCoords[i] <= -EPSILON)
+                                return 0;
+
+                        continue;
+                }
+
+                float bound = (-EPSILON - startCoords[i]) / gradients[i];
+
+                // Keep the bound in a range that can be safely converted to an integer
+                bound = mnkt_math_clamp(bound, -2.0f, triangleRect->width + 1.0f);
+
+                if(gradients[i] > 0.0f)
+                {
+                        float candidate = floorf(bound) + 1.0f;
+                        if(candidate > first)
+                                first = candidate;
+                } else {
+                        float candidate = ceilf(bound) - 1.0f;
+                        if(candidate < last)
+                                last = candidate;
+                }
+        }
+
+        if(first > last)
+                return 0;
+
+        *xStart = triangleRect->x + (int32_t) first;
+        *xEnd = triangleRect->x + (int32_t) last + 1;
+
+        barycentricCoords->x = start.x + (first * setup->baryDx.x);
+        barycentricCoords->y = start.y + (first * setup->baryDx.y);
+        barycentricCoords->z = start.z + (first * setup->baryDx.z);
+        return 1;
+}
+
+
+/**
+ * @function mnkt_isDepthOnly
+ * Checks if only the depth of the fragments must be written
+ * @param shader The shader program
+ * @param fb The framebuffer on which the fragments are drawn
+ * @return Non zero if the program is a depth only one or if there is no color buffer for it to write
+*/
+static int mnkt_isDepthOnly(const ShaderProgram_t* shader, const Framebuffer_t* fb)
+{
+        return shader->depthOnly || (fb->colorBuffer == NULL && shader->targetsShader == NULL);
+}
+
+
+/**
+ * @function mnkt_getInterpolatedVaryingsCount
+ * Determines how many varyings must be interpolated across a primitive for the given shader program
+ * @param shader The shader program
+ * @return The number of varyings (starting from the first one) to be interpolated
+*/
+size_t mnkt_getInterpolatedVaryingsCount(const ShaderProgram_t* shader)
+{
+        if(shader->depthOnly)
+                return 0;
+
+        if(shader->targetsShader != NULL)
+                return shader->varyingsCount < MAX_VARYING_PARAMS ? shader->varyingsCount : MAX_VARYING_PARAMS;
+
+        switch(shader->builtinShader)
+        {
+                case MNKT_SHADER_FLAT_COLOR:
+                        return 0;
+
+                case MNKT_SHADER_VERTEX_COLOR:
+                case MNKT_SHADER_TEXTURED:
+                case MNKT_SHADER_TEXTURED_MODULATED:
+                        return 2;
+
+                case MNKT_SHADER_CUSTOM:
+                default:
+                        return shader->varyingsCount < MAX_VARYING_PARAMS ? shader->varyingsCount : MAX_VARYING_PARAMS;
+        }
+}
+
+
+/**
+ * @function mnkt_shadeFragment
+ * Computes the color of a fragment using either the built-in shader or the fragment shader function of the program
+ * @param shader Shader program to be used
+ * @param varyings Varyings to be passed as input to the fragment shader
+ * @param uniforms Uniforms to be passed as input to the fragment shader
+ * @param fragCoords Coordinates of the fragment inside the frame buffer
+ * @param discard Flag set to non zero if the fragment must be discarded
+ * @return The color of the fragment
+*/
+static Vec4_t mnkt_shadeFragment(const ShaderProgram_t* shader, const ShaderParameter_t* varyings, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords, int* discard)
+{
+        Vec4_t color;
+
+        switch(shader->builtinShader)
+        {
+                case MNKT_SHADER_FLAT_COLOR:
+                case MNKT_SHADER_VERTEX_COLOR:
+                        return varyings[0].vec4;
+
+                case MNKT_SHADER_TEXTURED:
+                        return mnkt_texture_sample(uniforms[0].texture, &varyings[1].vec2);
+
+                case MNKT_SHADER_TEXTURED_MODULATED:
+                        color = mnkt_texture_sample(uniforms[0].texture, &varyings[1].vec2);
+                        color.r *= varyings[0].vec4.r;
+                        color.g *= varyings[0].vec4.g;
+                        color.b *= varyings[0].vec4.b;
+                        color.a *= varyings[0].vec4.a;
+                        return color;
+
+                case MNKT_SHADER_CUSTOM:
+                default:
+                        return shader->fragmentShader(varyings, uniforms, fragCoords, discard);
+        }
+}
+
+
+/**
+ * @function mnkt_shadeTargets
+ * Invokes the multiple targets fragment shader of the program and stores its outputs into the framebuffer's color attachments
+ * @param shader Shader program to be used
+ * @param varyings Varyings to be passed as input to the fragment shader
+ * @param uniforms Uniforms to be passed as input to the fragment shader
+ * @param fragCoords Coordinates of the fragment inside the frame buffer
+ * @param fragIndex Index of the fragment inside the frame buffer
+ * @param fb Frame buffer whose attachments are written
+ * @return Non zero if the outputs were stored, zero if the fragment was discarded
+*/
+static int mnkt_shadeTargets(const ShaderProgram_t* shader, const ShaderParameter_t* varyings, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords, size_t fragIndex, Framebuffer_t* fb)
+{
+        Vec4_t outputs[MNKT_MAX_COLOR_ATTACHMENTS];
+        int discard = 0;
+
+        shader->targetsShader(varyings, uniforms, fragCoords, outputs, &discard);
+
+        if(discard != 0)
+                return 0;
+
+        for(uint32_t i = 0; i < fb->attachmentsCount; ++i)
+                mnkt_framebuffer_writeAttachment(&fb->attachments[i], fragIndex, &outputs[i]);
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_interpolateVec4
+ * Interpolates a Vec4_t attribute across a triangle
+ * @param a Value of the attribute on the first vertex
+ * @param b Value of the attribute on the second vertex
+ * @param c Value of the attribute on the third vertex
+ * @param barycentricCoords Barycentric coordinates of the point in which the attribute is interpolated
+ * @return The interpolated value
+*/
+static Vec4_t mnkt_interpolateVec4(const Vec4_t* a, const Vec4_t* b, const Vec4_t* c, const Vec3_t* barycentricCoords)
+{
+        return (Vec4_t) {
+                .x = (barycentricCoords->x * a->x) + (barycentricCoords->y * b->x) + (barycentricCoords->z * c->x),
+                .y = (barycentricCoords->x * a->y) + (barycentricCoords->y * b->y) + (barycentricCoords->z * c->y),
+                .z = (barycentricCoords->x * a->z) + (barycentricCoords->y * b->z) + (barycentricCoords->z * c->z),
+                .w = (barycentricCoords->x * a->w) + (barycentricCoords->y * b->w) + (barycentricCoords->z * c->w)
+        };
+}
+
+
+/**
+ * @function mnkt_interpolateVec2
+ * Interpolates a Vec2_t attribute across a triangle
+ * @param a Value of the attribute on the first vertex
+ * @param b Value of the attribute on the second vertex
+ * @param c Value of the attribute on the third vertex
+ * @param barycentricCoords Barycentric coordinates of the point in which the attribute is interpolated
+ * @return The interpolated value
+*/
+static Vec2_t mnkt_interpolateVec2(const Vec2_t* a, const Vec2_t* b, const Vec2_t* c, const Vec3_t* barycentricCoords)
+{
+        return (Vec2_t) {
+                .x = (barycentricCoords->x * a->x) + (barycentricCoords->y * b->x) + (barycentricCoords->z * c->x),
+                .y = (barycentricCoords->x * a->y) + (barycentricCoords->y * b->y) + (barycentricCoords->z * c->y)
+        };
+}
+
+
+/**
+ * @function mnkt_drawFragment
+ * Computes color and depth values of a fragment and stores them into the given framebuffer.
+ * @param fragCoords Coordinates of the fragment inside the frame buffer, those will be passed to the fragment shader (must be non null)
+ * @param fragDepth Depth value, computed by the vertex shader, for the fragment; this will be used for depth test against fb's depth buffer
+ * @param coverage Fraction of the pixel covered by the primitive, the alpha of the fragment color is multiplied by it
+ * @param fragIndex Index of the fragment to be drawn inside the frame buffer, this will be used to access fb's color and depth buffers
+ * @param shader Shader program to be used to compute the fragment color
+ * @param varyings Additional parameters, outputted by the vertex shader, to be passed as input to the fragment shader
+ * @param span Span in which the fragment is accumulated if it must be blended with the framebuffer content (unused on multisampled framebuffers)
+ * @param fb Frame buffer into which the fragment should be drawn
+*/
+static void mnkt_drawFragment(const Vec2_t* fragCoords, float fragDepth, float coverage, size_t fragIndex, const ShaderProgram_t* shader, const ShaderParameter_t* varyings, FragmentSpan_t* span, Framebuffer_t* fb)
+{
+        int discard = 0;
+
+        // On multisampled framebuffers the fragment covers all the samples of the pixel
+        if(fb->multisample.samplesCount > 1)
+        {
+                float samplesDepth[MNKT_MAX_SAMPLES];
+
+                for(uint32_t s = 0; s < fb->multisample.samplesCount; ++s)
+                        samplesDepth[s] = fragDepth;
+
+                mnkt_drawSamples(fragCoords, (1u << fb->multisample.samplesCount) - 1, samplesDepth, fragIndex, shader, varyings, fb);
+                return;
+        }
+
+        // Perform depth test
+        if( !mnkt_depthTest(shader->depthFunc, fragDepth, fb->depthBuffer[fragIndex]) )
+        {
+                // If current fragment is hidden by what is already stored in the depth buffer, then skip the fragment
+                return;
+        }
+
+        // Test only occlusion queries just count the fragment
+        if(fb->query != NULL && fb->query->testOnly)
+        {
+                ++fb->query->samplesPassed;
+                return;
+        }
+
+        // Depth only programs do not shade the fragment
+        if( mnkt_isDepthOnly(shader, fb) )
+        {
+                if(fb->query != NULL)
+                        ++fb->query->samplesPassed;
+
+                if( !shader->depthWriteDisabled )
+                        fb->depthBuffer[fragIndex] = fragDepth;
+
+                return;
+        }
+
+        // Multiple targets programs write the color attachments
+        if(shader->targetsShader != NULL)
+        {
+                if( !mnkt_shadeTargets(shader, varyings, shader->uniforms, fragCoords, fragIndex, fb) )
+                        return;
+
+                if(fb->query != NULL)
+                        ++fb->query->samplesPassed;
+
+                if( !shader->depthWriteDisabled )
+                        fb->depthBuffer[fragIndex] = fragDepth;
+
+                return;
+        }
+
+        // Invoke fragment shader
+        Vec4_t fragColor = mnkt_shadeFragment(shader, varyings, shader->uniforms, fragCoords, &discard);
+        
+        // Discard fragment, if necessary
+        if(discard != 0)
+                return;
+
+        if(fb->query != NULL)
+                ++fb->query->samplesPassed;
+
+        fragColor.a *= coverage;
+
+        if( !shader->depthWriteDisabled )
+                fb->depthBuffer[fragIndex] = fragDepth;
+
+        mnkt_writeFragmentColor(&fragColor, fragIndex, shader, span, fb);
+}
+
+
+/**
+ * @function mnkt_writeFragmentColor
+ * Writes the color of a shaded fragment into the framebuffer, if blending is enabled the fragment is accumulated
+ * into the given span and blended, together with its neighbours, later
+ * @param fragColor Color produced by the fragment shader
+ * @param fragIndex Index of the fragment inside the frame buffer
+ * @param shader Shader program that defines the blend state
+ * @param span Span of fragments waiting to be blended
+ * @param fb Frame buffer into which the fragment should be written
+*/
+static void mnkt_writeFragmentColor(const Vec4_t* fragColor, size_t fragIndex, const ShaderProgram_t* shader, FragmentSpan_t* span, Framebuffer_t* fb)
+{
+        if( !shader->blend.enabled )
+        {
+                fb->colorBuffer[ fragIndex * 3 ] =              mnkt_colorAsUChar(fragColor->r);
+                fb->colorBuffer[ (fragIndex * 3) + 1 ] =        mnkt_colorAsUChar(fragColor->g);
+                fb->colorBuffer[ (fragIndex * 3) + 2 ] =        mnkt_colorAsUChar(fragColor->b);
+                return;
+        }
+
+        // Start a new span if the fragment is not contiguous to the pending ones
+        if(span->count == MNKT_MAX_SPAN_LENGTH || (span->count > 0 && span->startIndex + span->count != fragIndex))
+                mnkt_flushSpan(span, shader, fb);
+
+        if(span->count == 0)
+                span->startIndex = fragIndex;
+
+        span->colors[span->count++] = *fragColor;
+}
+
+
+/**
+ * @function mnkt_depthTest
+ * Performs the depth test on a single fragment
+ * @param depthFunc Comparison to be performed
+ * @param fragDepth Depth of the fragment
+ * @param storedDepth Depth stored in the depth buffer
+ * @return Non zero if the fragment passed the test
+*/
+static int mnkt_depthTest(DepthFunc_t depthFunc, float fragDepth, float storedDepth)
+{
+        switch(depthFunc)
+        {
+                case MNKT_DEPTH_ALWAYS:
+                        return 1;
+
+                case MNKT_DEPTH_LESS_EQUAL:
+                        return fragDepth <= storedDepth;
+
+                case MNKT_DEPTH_EQUAL:
+                        return fragDepth == storedDepth;
+
+                case MNKT_DEPTH_LESS:
+                default:
+                        return fragDepth < storedDepth;
+        }
+}
+
+
+/**
+ * @function mnkt_depthTestSpan
+ * Performs the depth test on a sequence of contiguous fragments whose depth varies linearly along a row
+ * (the depth of the i-th fragment of the row is baseDepth + i * depthStep)
+ * @param depthFunc Comparison to be performed
+ * @param depthBuffer Pointer to the depth of the first fragment to be tested inside the depth buffer
+ * @param baseDepth Depth of the first fragment of the row
+ * @param depthStep Depth variation between two consecutive fragments (zero for a constant depth)
+ * @param firstIndex Index, along the row, of the first fragment to be tested
+ * @param count Number of fragments to be tested (at most MNKT_DEPTH_CHUNK_LENGTH)
+ * @return Mask of the fragments that passed the test (bit i is set if fragment firstIndex + i passed it)
+*/
+static uint32_t mnkt_depthTestSpan(DepthFunc_t depthFunc, const float* depthBuffer, float baseDepth, float depthStep, size_t firstIndex, size_t count)
+{
+        if(depthFunc == MNKT_DEPTH_ALWAYS)
+                return count >= 32 ? UINT32_MAX : (1u << count) - 1;
+
+        uint32_t passMask = 0;
+        size_t i = 0;
+
+#ifdef MNKT_SIMD_SSE2
+        const __m128 base = _mm_set1_ps(baseDepth);
+        const __m128 step = _mm_set1_ps(depthStep);
+        const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+        for(; i + 4 <= count; i += 4)
+        {
+                __m128 offsets = _mm_add_ps( _mm_set1_ps((float) (firstIndex + i)), lanes );
+                __m128 depth = _mm_add_ps( base, _mm_mul_ps(offsets, step) );
+                __m128 stored = _mm_loadu_ps(&depthBuffer[i]);
+                __m128 pass;
+
+                switch(depthFunc)
+                {
+                        case MNKT_DEPTH_LESS_EQUAL:
+                                pass = _mm_cmple_ps(depth, stored);
+                                break;
+
+                        case MNKT_DEPTH_EQUAL:
+                                pass = _mm_cmpeq_ps(depth, stored);
+                                break;
+
+                        case MNKT_DEPTH_LESS:
+                        default:
+                                pass = _mm_cmplt_ps(depth, stored);
+                                break;
+                }
+
+                passMask |= (uint32_t) _mm_movemask_ps(pass) << i;
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                if( mnkt_depthTest(depthFunc, baseDepth + ((float) (firstIndex + i) * depthStep), depthBuffer[i]) )
+                        passMask |= 1u << i;
+        }
+
+        return passMask;
+}
+
+
+/**
+ * @function mnkt_writeDepthSpan
+ * Writes the depth of a sequence of contiguous fragments, whose depth varies linearly along a row, into the depth buffer
+ * (the depth of the i-th fragment of the row is baseDepth + i * depthStep)
+ * @param depthBuffer Pointer to the depth of the first fragment to be written inside the depth buffer
+ * @param baseDepth Depth of the first fragment of the row
+ * @param depthStep Depth variation between two consecutive fragments (zero for a constant depth)
+ * @param firstIndex Index, along the row, of the first fragment of the sequence
+ * @param writeMask Mask of the fragments whose depth must be written (bit i is set if fragment firstIndex + i must be written)
+ * @param count Number of fragments in the sequence (at most MNKT_DEPTH_CHUNK_LENGTH)
+*/
+static void mnkt_writeDepthSpan(float* depthBuffer, float baseDepth, float depthStep, size_t firstIndex, uint32_t writeMask, size_t count)
+{
+        size_t i = 0;
+
+#ifdef MNKT_SIMD_SSE2
+        const __m128 base = _mm_set1_ps(baseDepth);
+        const __m128 step = _mm_set1_ps(depthStep);
+        const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+        for(; i + 4 <= count; i += 4)
+        {
+                uint32_t lanesMask = (writeMask >> i) & 0xF;
+
+                if(lanesMask == 0)
+                        continue;
+
+                __m128 offsets = _mm_add_ps( _mm_set1_ps((float) (firstIndex + i)), lanes );
+                __m128 depth = _mm_add_ps( base, _mm_mul_ps(offsets, step) );
+
+                // Partially written groups keep the stored depth on the lanes that must not be written
+                if(lanesMask != 0xF)
+                {
+                        __m128 select = _mm_castsi128_ps( _mm_setr_epi32( -(int32_t) (lanesMask & 1), -(int32_t) ((lanesMask >> 1) & 1),
+                                                                         -(int32_t) ((lanesMask >> 2) & 1), -(int32_t) ((lanesMask >> 3) & 1) ) );
+                        __m128 stored = _mm_loadu_ps(&depthBuffer[i]);
+
+                        depth = _mm_or_ps( _mm_and_ps(select, depth), _mm_andnot_ps(select, stored) );
+                }
+
+                _mm_storeu_ps(&depthBuffer[i], depth);
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                if( writeMask & (1u << i) )
+                        depthBuffer[i] = baseDepth + ((float) (firstIndex + i) * depthStep);
+        }
+}
+
+
+/**
+ * @function mnkt_fillColorSpan
+ * Fills a sequence of contiguous pixels of an RGB color buffer with the same color
+ * @param colorBuffer Pointer to the first pixel of the sequence inside the color buffer
+ * @param color The RGB color to be written
+ * @param count Number of pixels to be filled
+*/
+static void mnkt_fillColorSpan(unsigned char* colorBuffer, const unsigned char color[3], size_t count)
+{
+        // Pattern of 16 pixels (48 bytes, a multiple of the 16 bytes vector size), copied as a whole with wide stores
+        enum { PATTERN_PIXELS = 16 };
+        unsigned char pattern[PATTERN_PIXELS * 3];
+
+        size_t patternPixels = count < PATTERN_PIXELS ? count : PATTERN_PIXELS;
+
+        for(size_t i = 0; i < patternPixels; ++i)
+        {
+                pattern[i * 3] = color[0];
+                pattern[(i * 3) + 1] = color[1];
+                pattern[(i * 3) + 2] = color[2];
+        }
+
+        size_t i = 0;
+
+        for(; i + PATTERN_PIXELS <= count; i += PATTERN_PIXELS)
+                memcpy(&colorBuffer[i * 3], pattern, sizeof(pattern));
+
+        memcpy(&colorBuffer[i * 3], pattern, (count - i) * 3);
+}
+
+
+/**
+ * @function mnkt_countBits
+ * Counts the bits set in a mask
+ * @param mask The mask
+ * @return The number of bits set
+*/
+static uint32_t mnkt_countBits(uint32_t mask)
+{
+        uint32_t count = 0;
+
+        // Clear the lowest set bit at each iteration
+        for(; mask != 0; mask &= mask - 1)
+                ++count;
+
+        return count;
+}
+
+
+/**
+ * @function mnkt_drawSamples
+ * Performs the depth test on the covered samples of a pixel of a multisampled framebuffer and, if at least one sample passes it,
+ * invokes the fragment shader (once for the whole pixel) and stores the result into the samples that passed the test.
+ * @param fragCoords Coordinates of the pixel inside the frame buffer, those will be passed to the fragment shader
+ * @param coverageMask Mask of the samples covered by the primitive (bit i is set if sample i is covered)
+ * @param samplesDepth Depth value of each covered sample
+ * @param fragIndex Index of the pixel inside the frame buffer
+ * @param shader Shader program to be used to compute the fragment color
+ * @param varyings Additional parameters, outputted by the vertex shader, to be passed as input to the fragment shader
+ * @param fb Multisampled frame buffer into which the samples should be drawn
+*/
+static void mnkt_drawSamples(const Vec2_t* fragCoords, uint32_t coverageMask, const float* samplesDepth, size_t fragIndex, const ShaderProgram_t* shader, const ShaderParameter_t* varyings, Framebuffer_t* fb)
+{
+        const uint32_t samplesCount = fb->multisample.samplesCount;
+        float* depthBuffer = &fb->multisample.depthBuffer[fragIndex * samplesCount];
+
+        // Perform depth test on each covered sample
+        uint32_t passMask = 0;
+
+        for(uint32_t s = 0; s < samplesCount; ++s)
+        {
+                if( (coverageMask & (1u << s)) && mnkt_depthTest(shader->depthFunc, samplesDepth[s], depthBuffer[s]) )
+                        passMask |= 1u << s;
+        }
+
+        if(passMask == 0)
+                return;
+
+        // Test only occlusion queries just count the samples
+        if(fb->query != NULL && fb->query->testOnly)
+        {
+                fb->query->samplesPassed += mnkt_countBits(passMask);
+                return;
+        }
+
+        // Invoke fragment shader (only once for all the samples), depth only programs skip it
+        int discard = 0;
+        Vec4_t fragColor = { 0 };
+        const int depthOnly = mnkt_isDepthOnly(shader, fb);
+
+        if(shader->targetsShader != NULL && !depthOnly)
+                discard = !mnkt_shadeTargets(shader, varyings, shader->uniforms, fragCoords, fragIndex, fb);
+        else if( !depthOnly )
+                fragColor = mnkt_shadeFragment(shader, varyings, shader->uniforms, fragCoords, &discard);
+
+        if(discard != 0)
+                return;
+
+        if(fb->query != NULL)
+                fb->query->samplesPassed += mnkt_countBits(passMask);
+
+        for(uint32_t s = 0; s < samplesCount && !shader->depthWriteDisabled; ++s)
+        {
+                if(passMask & (1u << s))
+                        depthBuffer[s] = samplesDepth[s];
+        }
+
+        if( !depthOnly && shader->targetsShader == NULL )
+                mnkt_writeSamplesColor(passMask, &fragColor, fragIndex, shader, fb);
+}
+
+
+/**
+ * @function mnkt_writeSamplesColor
+ * Stores a color into some of the samples of a pixel of a multisampled framebuffer.
+ * If all the samples are written the pixel is kept (or becomes) compressed, releasing its slot, otherwise a slot of
+ * the color pool is assigned to it to store the color of each sample.
+ * @param samplesMask Mask of the samples to be written
+ * @param color Color to be stored (blended with the samples content if blending is enabled)
+ * @param fragIndex Index of the pixel inside the frame buffer
+ * @param shader Shader program that defines the blend state
+ * @param fb Multisampled frame buffer that contains the pixel
+*/
+static void mnkt_writeSamplesColor(uint32_t samplesMask, const Vec4_t* color, size_t fragIndex, const ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        MultisampleBuffer_t* ms = &fb->multisample;
+
+        const uint32_t fullMask = (1u << ms->samplesCount) - 1;
+        uint32_t slot = ms->colorIndices[fragIndex];
+
+        if(slot == MNKT_PIXEL_COMPRESSED)
+        {
+                // All samples still share the same color
+                if(samplesMask == fullMask)
+                {
+                        mnkt_blend_span(&shader->blend, color, &fb->colorBuffer[fragIndex * 3], 1);
+                        return;
+                }
+
+                // No more slots available, the pixel stays compressed and is written only if most of its samples are covered
+                if(ms->colorPoolFree == MNKT_PIXEL_COMPRESSED && ms->colorPoolUsed == ms->colorPoolCapacity)
+                {
+                        uint32_t coveredCount = 0;
+
+                        for(uint32_t s = 0; s < ms->samplesCount; ++s)
+                                coveredCount += (samplesMask >> s) & 1u;
+
+                        if(coveredCount * 2 >= ms->samplesCount)
+                                mnkt_blend_span(&shader->blend, color, &fb->colorBuffer[fragIndex * 3], 1);
+
+                        return;
+                }
+
+                // Decompress the pixel into a released slot, if any, each sample starts with the color shared until now
+                unsigned char* samplesColor;
+
+                if(ms->colorPoolFree != MNKT_PIXEL_COMPRESSED)
+                {
+                        slot = ms->colorPoolFree;
+                        samplesColor = &ms->colorPool[ (size_t) slot * ms->samplesCount * 3 ];
+                        memcpy(&ms->colorPoolFree, samplesColor, sizeof(uint32_t));
+
+                } else
+                {
+                        slot = ms->colorPoolUsed++;
+                        samplesColor = &ms->colorPool[ (size_t) slot * ms->samplesCount * 3 ];
+                }
+
+                ms->colorIndices[fragIndex] = slot;
+
+                for(uint32_t s = 0; s < ms->samplesCount; ++s)
+                        memcpy(&samplesColor[s * 3], &fb->colorBuffer[fragIndex * 3], 3);
+
+        } else if(samplesMask == fullMask && !shader->blend.enabled)
+        {
+                // All samples are overwritten with the same color, compress the pixel again and release its slot
+                memcpy(&ms->colorPool[ (size_t) slot * ms->samplesCount * 3 ], &ms->colorPoolFree, sizeof(uint32_t));
+                ms->colorPoolFree = slot;
+                ms->colorIndices[fragIndex] = MNKT_PIXEL_COMPRESSED;
+                mnkt_blend_span(&shader->blend, color, &fb->colorBuffer[fragIndex * 3], 1);
+                return;
+        }
+
+        unsigned char* samplesColor = &ms->colorPool[ (size_t) slot * ms->samplesCount * 3 ];
+
+        for(uint32_t s = 0; s < ms->samplesCount; ++s)
+        {
+                if(samplesMask & (1u << s))
+                        mnkt_blend_span(&shader->blend, color, &samplesColor[s * 3], 1);
+        }
+}
+
+
+/**
+ * @function mnkt_flushSpan
+ * Blends all the fragments accumulated in the given span with the framebuffer content and empties the span
+ * @param span The span to be flushed
+ * @param shader Shader program that defines the blend state
+ * @param fb Frame buffer into which the fragments should be blended
+*/
+static void mnkt_flushSpan(FragmentSpan_t* span, const ShaderProgram_t* shader, Framebuffer_t* fb)
+{
+        if(span->count == 0)
+                return;
+
+        mnkt_blend_span(&shader->blend, span->colors, &fb->colorBuffer[span->startIndex * 3], span->count);
+        span->count = 0;
+}
 
@@ -22,12 +22,13 @@
 
 /**
  * @function mnkt_rasterizePoint
- * Rasterizes a 2D point and invokes the fragment shader for each fragment produced.
+ * Rasterizes a 2D point as a square sprite (clipped to the framebuffer's clip rectangle) and invokes the fragment shader for each fragment produced.
+ * The coordinates of each fragment inside the sprite are passed to the fragment shader through the MNKT_BUILTIN_POINT_COORD uniform.
  * @param screenCoords Vector which defines the screen coordinates of the center of the point to be rasterized
- * @param pointSize Number of pixels that each side of the point takes up.
+ * @param pointSize Number of pixels that the sprite extends from its center on each side.
  *      Use 0 to rasterize a single pixel.
  * @param shader Shader to be used to determine the color of each fragment produced
- * @param varyings Additional output parameters produced by the vertex shader (will be interpolated and passed as input to the fragment shader)
+ * @param varyings Additional output parameters produced by the vertex shader (passed as input to the fragment shader)
  * @param fb Framebuffer on which the point will be rasterized
 */
 void mnkt_rasterizePoint(Vec3_t screenCoords, const size_t pointSize, const ShaderProgram_t* shader, const ShaderParameter_t varyings[MAX_VARYING_PARAMS], Framebuffer_t* fb);
@@ -36,10 +37,14 @@ void mnkt_rasterizePoint(Vec3_t screenCoords, const size_t pointSize, const Shad
 /**
  * @function mnkt_rasterizeLine
  * Rasterizes a 2D line and invokes the fragment shader for each fragment produced.
+ * The line is stepped along its major axis using fixed point arithmetic, depth and varyings are interpolated
+ * between the two extreme points; its width and anti-aliasing are defined by the shader program.
+ * Anti-aliased lines compute the coverage of each pixel across the line and, at its extremes, along the major axis
+ * (the ends of the line are cut perpendicularly to the major axis rather than to the line).
  * @param screenCoords Array of vectors which defines the screen coordinates of the two extreme points of the line to be rasterized
  * @param shader Shader to be used to determine the color of each fragment produced
  * @param varyings Additional output parameters produced by the vertex shader for the two extreme points of the line
- *      (those will be interpolated and passed as input to the fragment shader)
+ *      (those will be interpolated across the line and passed as input to the fragment shader)
  * @param fb Framebuffer on which the line will be rasterized
 */
 void mnkt_rasterizeLine(Vec3_t screenCoords[2], const ShaderProgram_t* shader, const ShaderParameter_t varyings[2][MAX_VARYING_PARAMS], Framebuffer_t* fb);
@@ -57,4 +62,14 @@ void mnkt_rasterizeLine(Vec3_t screenCoords[2], const ShaderProgram_t* shader, c
 void mnkt_rasterizeTriangle(Vec3_t screenCoords[3], const ShaderProgram_t* shader, const ShaderParameter_t varyings[3][MAX_VARYING_PARAMS], Framebuffer_t* fb);
 
 
+/**
+ * @function mnkt_getInterpolatedVaryingsCount
+ * Determines how many varyings must be interpolated across a primitive for the given shader program
+ * (the others keep the value outputted for the first vertex of the primitive)
+ * @param shader The shader program
+ * @return The number of varyings (starting from the first one) to be interpolated
+*/
+size_t mnkt_getInterpolatedVaryingsCount(const ShaderProgram_t* shader);
+
+
 #endif // MNKT_RASTERIZER_H
@@ -13,6 +13,9 @@
 
 #include "math/vec.h"
 #include "image.h"
+#include "texture.h"
+#include "framebuffer.h"
+#include "blend.h"
 
 
 
@@ -31,6 +34,38 @@
 #define MAX_UNIFORM_PARAMS              8
 
 
+/**
+ * @macro MNKT_BUILTIN_INSTANCE_ID
+ * Index, inside the uniforms array, of the built-in parameter that stores (as uintData) the index of the instance being drawn
+ * by mnkt_drawInstanced
+*/
+#define MNKT_BUILTIN_INSTANCE_ID        (MAX_UNIFORM_PARAMS + 0)
+
+
+/**
+ * @macro MNKT_BUILTIN_INSTANCE_DATA
+ * Index, inside the uniforms array, of the built-in parameter that stores (as userData) a pointer to the per-instance
+ * attributes of the instance being drawn by mnkt_drawInstanced
+*/
+#define MNKT_BUILTIN_INSTANCE_DATA      (MAX_UNIFORM_PARAMS + 1)
+
+
+/**
+ * @macro MNKT_BUILTIN_POINT_COORD
+ * Index, inside the uniforms array, of the built-in parameter that stores (as vec2) the coordinates of the fragment
+ * inside the point sprite being rasterized, both in the range [0, 1] with the origin on the top left corner of the sprite
+ * (only meaningful in the fragment shader while drawing points)
+*/
+#define MNKT_BUILTIN_POINT_COORD        (MAX_UNIFORM_PARAMS + 2)
+
+
+/**
+ * @macro MNKT_BUILTIN_PARAMS_COUNT
+ * Number of built-in parameters, those are stored after the user defined uniforms and are set by the renderer
+*/
+#define MNKT_BUILTIN_PARAMS_COUNT       3
+
+
 /**
  * @union ShaderParameter_t
  * Union of all data types that can be passed as parameters to a vertex/fragment shader.
@@ -49,6 +84,7 @@ typedef union {
         Vec4_t          vec4;
 
         Image_t*        texture;
+        DepthTexture_t* depthTexture;
 
         void*           userData;
 
@@ -83,17 +119,92 @@ typedef Vec4_t (*VertexShaderFunc_t)(const void* vertex, ShaderParameter_t* vary
 typedef Vec4_t (*FragmentShaderFunc_t)(const ShaderParameter_t* varyings, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords, int* discard);
 
 
+/**
+ * @typedef TargetsShaderFunc_t
+ * Typedef for the function pointer data type that can be used as a multiple targets fragment shader
+ * (writes one color for each color attachment of the framebuffer, e.g. to fill a G-buffer).
+ *
+ * Such function takes as input:
+ *      - varyings: an array of additional parameters, those can be outputted by the vertex shader
+ *      - uniforms: an array of uniform parameters, those are set before the draw operation is invoked
+ *      - fragCoords: the coordinates of the fragment to be processed, expressed in pixels
+ *      - outputs: an array of MNKT_MAX_COLOR_ATTACHMENTS colors, output i is stored into the framebuffer's attachment i
+ *      - discard: a flag that can be set (to non zero) whithin the fragment shader to indicate that the fragment must be discarded
+*/
+typedef void (*TargetsShaderFunc_t)(const ShaderParameter_t* varyings, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords, Vec4_t* outputs, int* discard);
+
+
+/**
+ * @typedef PixelShaderFunc_t
+ * Typedef for the function pointer data type that is run by full screen passes (e.g. deferred lighting) once for each pixel.
+ *
+ * Such function takes as input:
+ *      - attachments: the colors stored in the framebuffer's color attachments for the pixel (attachmentsCount elements)
+ *      - depth: the depth stored in the framebuffer's depth buffer for the pixel
+ *      - uniforms: an array of uniform parameters, passed to the full screen pass
+ *      - fragCoords: the coordinates of the pixel, expressed in pixels
+ *
+ * Such function must output the color to be stored into the framebuffer's color buffer
+*/
+typedef Vec4_t (*PixelShaderFunc_t)(const Vec4_t* attachments, float depth, const ShaderParameter_t* uniforms, const Vec2_t* fragCoords);
+
+
+/**
+ * @enum BuiltinShader_t
+ * Fragment shading programs implemented by the renderer itself, the rasterizer runs dedicated loops for them
+ * (no function pointer is invoked for each fragment). All of them read the same inputs:
+ *      - varyings[0] (vec4): the color of the vertex
+ *      - varyings[1] (vec2): the texture coordinates of the vertex
+ *      - uniforms[0] (texture): the texture to be sampled
+*/
+typedef enum {
+        MNKT_SHADER_CUSTOM = 0,                 ///< The fragmentShader function of the program is used
+        MNKT_SHADER_FLAT_COLOR,                 ///< The color of the first vertex of the primitive is used for all the fragments
+        MNKT_SHADER_VERTEX_COLOR,               ///< The colors of the vertices are interpolated across the primitive
+        MNKT_SHADER_TEXTURED,                   ///< The texture is sampled at the interpolated texture coordinates
+        MNKT_SHADER_TEXTURED_MODULATED,         ///< The sampled texture color is multiplied by the interpolated vertex color
+} BuiltinShader_t;
+
+
+/**
+ * @enum DepthFunc_t
+ * Comparison performed, during the depth test, between the depth of a fragment and the one stored in the depth buffer
+*/
+typedef enum {
+        MNKT_DEPTH_LESS = 0,                    ///< The fragment passes if its depth is less than the stored one
+        MNKT_DEPTH_ALWAYS,                      ///< The depth test is disabled, all the fragments pass
+        MNKT_DEPTH_LESS_EQUAL,                  ///< The fragment passes if its depth is less than or equal to the stored one
+        MNKT_DEPTH_EQUAL,                       ///< The fragment passes if its depth is equal to the stored one (e.g. shading after a depth prepass)
+} DepthFunc_t;
+
+
 /**
  * @struct ShaderProgram_t
  * Models a shader program that can be used during a draw operation
 */
 typedef struct {
         VertexShaderFunc_t      vertexShader;                   ///< Function to be used as vertex shader
-        FragmentShaderFunc_t    fragmentShader;                 ///< Function to be used as fragment shader
+        FragmentShaderFunc_t    fragmentShader;                 ///< Function to be used as fragment shader (ignored if builtinShader is not MNKT_SHADER_CUSTOM)
+        BuiltinShader_t         builtinShader;                  ///< Built-in fragment shading to be used instead of fragmentShader
+        TargetsShaderFunc_t     targetsShader;                  ///< Fragment shader that writes the framebuffer's color attachments, if set it is used instead
+                                                                ///< of fragmentShader and builtinShader (the color buffer is left untouched and blending is ignored)
 
         size_t                  vertexSize;                     ///< Size in bytes of a single vertex (containing all the attributes necessary for one invocation of the vertex shader)
+        size_t                  varyingsCount;                  ///< Number of varyings (starting from the first one) that are interpolated across primitives as Vec4_t values,
+                                                                ///< the others keep the value outputted for the first vertex of the primitive
+
+        ShaderParameter_t       uniforms[MAX_UNIFORM_PARAMS + MNKT_BUILTIN_PARAMS_COUNT];       ///< Uniform parameters to be passed to shader (followed by the built-in ones)
+
+        DepthFunc_t             depthFunc;                      ///< Comparison used for the depth test
+        int                     depthWriteDisabled;             ///< Non zero if the depth of the fragments must not be written into the depth buffer
+        int                     depthOnly;                      ///< Non zero if only the depth buffer is written (depth prepass, shadow map): the fragment shader is not invoked
+                                                                ///< (fragmentShader can be NULL), varyings are ignored and the color buffer is left untouched
+                                                                ///< (framebuffers without color buffer are always drawn as if this was set)
+
+        BlendState_t            blend;                          ///< Defines how the fragments colors are combined with the framebuffer content (zero initialize to disable blending)
 
-        ShaderParameter_t       uniforms[MAX_UNIFORM_PARAMS];   ///< Uniform parameters to be passed to shader
+        float                   lineWidth;                      ///< Width of the lines expressed in pixels (values smaller than one produce one pixel wide lines)
+        int                     lineSmooth;                     ///< Non zero if lines must be anti-aliased
 
 } ShaderProgram_t;
 
@@ -0,0 +1,211 @@
+/**
+ * @file texture.c
+ *
+ * Contains implementation of the functions used to sample images as textures
+*/
+
+#include "texture.h"
+
+#include "utility/simd.h"
+
+#include <math.h>
+
+
+// Prototypes for internal functions
+
+static uint32_t mnkt_texture_countLitTexels(const float* row, uint32_t width, int64_t x, uint32_t count, float refDepth);
+
+
+/**
+ * @function mnkt_texture_sample
+ * Samples an image at the given texture coordinates (nearest filtering, coordinates outside the range [0, 1] are wrapped).
+ * The pixels of the image are expected to be packed as 0xRRGGBBAA.
+ * @param texture The image to be sampled
+ * @param uv Texture coordinates, (0, 0) is the top left corner of the image and (1, 1) the bottom right one
+ * @return The color of the sampled texel with components in the range [0.0f, 1.0f] (opaque white if texture is NULL or empty)
+*/
+Vec4_t mnkt_texture_sample(const Image_t* texture, const Vec2_t* uv)
+{
+        if(texture == NULL || texture->pixels == NULL || texture->width == 0 || texture->height == 0)
+                return (Vec4_t) { .r = 1.0f, .g = 1.0f, .b = 1.0f, .a = 1.0f };
+
+        // Wrap the coordinates into the range [0, 1)
+        float u = uv->x - floorf(uv->x);
+        float v = uv->y - floorf(uv->y);
+
+        uint32_t x = (uint32_t) (u * texture->width);
+        uint32_t y = (uint32_t) (v * texture->height);
+
+        // Guard against rounding up to the size of the image
+        if(x >= texture->width)
+                x = texture->width - 1;
+
+        if(y >= texture->height)
+                y = texture->height - 1;
+
+        uint32_t texel = (uint32_t) texture->pixels[ ((size_t) y * texture->width) + x ];
+
+        return (Vec4_t) {
+                .r = ( (texel >> 24) & 0xFF ) / 255.0f,
+                .g = ( (texel >> 16) & 0xFF ) / 255.0f,
+                .b = ( (texel >> 8) & 0xFF ) / 255.0f,
+                .a = ( texel & 0xFF ) / 255.0f
+        };
+}
+
+
+/**
+ * @function mnkt_texture_fromDepthBuffer
+ * Binds the depth buffer of a framebuffer as a depth texture, the texture refers to the framebuffer's memory (no copy is made).
+ * The framebuffer should be a depth only one rendered with depth only programs, multisampled framebuffers are not supported.
+ * @param fb Framebuffer whose depth buffer is bound
+ * @return The depth texture (an empty one if fb is NULL)
+*/
+DepthTexture_t mnkt_texture_fromDepthBuffer(const Framebuffer_t* fb)
+{
+        if(fb == NULL)
+                return (DepthTexture_t) { .width = 0, .height = 0, .depth = NULL };
+
+        return (DepthTexture_t) {
+                .width = fb->width,
+                .height = fb->height,
+                .depth = fb->depthBuffer
+        };
+}
+
+
+/**
+ * @function mnkt_texture_sampleCompare
+ * Compares a reference depth with the texel of a depth texture at the given texture coordinates (nearest filtering)
+ * @param texture The depth texture to be sampled
+ * @param uv Texture coordinates, (0, 0) is the top left corner of the texture and (1, 1) the bottom right one
+ * @param refDepth Depth to be compared with the stored one (e.g. the depth of the fragment as seen from the light, bias included)
+ * @return 1.0f if refDepth is less than or equal to the stored depth (lit), 0.0f otherwise.
+ *      Coordinates outside the texture, as well as an empty texture, are always lit.
+*/
+float mnkt_texture_sampleCompare(const DepthTexture_t* texture, const Vec2_t* uv, float refDepth)
+{
+        if(texture == NULL || texture->depth == NULL)
+                return 1.0f;
+
+        float u = floorf(uv->x * texture->width);
+        float v = floorf(uv->y * texture->height);
+
+        // Also rejects NaN coordinates
+        if( !(u >= 0.0f && u < texture->width && v >= 0.0f && v < texture->height) )
+                return 1.0f;
+
+        size_t texelIndex = ((size_t) v * texture->width) + (size_t) u;
+
+        return refDepth <= texture->depth[texelIndex] ? 1.0f : 0.0f;
+}
+
+
+/**
+ * @function mnkt_texture_samplePCF
+ * Percentage-closer filtering: compares a reference depth with a square of kernelSize x kernelSize texels centered on the given
+ * texture coordinates and averages the results (the rows of the kernel are compared with vector instructions)
+ * @param texture The depth texture to be sampled
+ * @param uv Texture coordinates, (0, 0) is the top left corner of the texture and (1, 1) the bottom right one
+ * @param refDepth Depth to be compared with the stored ones (e.g. the depth of the fragment as seen from the light, bias included)
+ * @param kernelSize Number of texels on each side of the kernel (2 for a 2x2 kernel, values smaller than one are treated as one)
+ * @return Fraction, in the range [0.0f, 1.0f], of the texels for which refDepth is less than or equal to the stored depth.
+ *      Texels outside the texture, as well as an empty texture, are always lit.
+*/
+float mnkt_texture_samplePCF(const DepthTexture_t* texture, const Vec2_t* uv, float refDepth, uint32_t kernelSize)
+{
+        if(texture == NULL || texture->depth == NULL)
+                return 1.0f;
+
+        if(kernelSize < 1)
+                kernelSize = 1;
+
+        // Top left texel of the kernel: the texels whose centers are the closest ones to the sampled point
+        float firstX = floorf( (uv->x * texture->width) - (kernelSize * 0.5f) + 0.5f );
+        float firstY = floorf( (uv->y * texture->height) - (kernelSize * 0.5f) + 0.5f );
+
+        // Also rejects NaN coordinates and kernels that lie completely outside the texture
+        if( !(firstX > -(float) kernelSize && firstX < texture->width && firstY > -(float) kernelSize && firstY < texture->height) )
+                return 1.0f;
+
+        const int64_t x = (int64_t) firstX;
+        const int64_t y = (int64_t) firstY;
+
+#ifdef MNKT_SIMD_SSE2
+        // 2x2 kernels inside the texture are compared at once, the two rows are loaded into the same register
+        if(kernelSize == 2 && x >= 0 && y >= 0 && x + 2 <= texture->width && y + 2 <= texture->height)
+        {
+                const float* top = &texture->depth[((size_t) y * texture->width) + (size_t) x];
+                const __m128 block = _mm_loadh_pi( _mm_loadl_pi(_mm_setzero_ps(), (const __m64*) top), (const __m64*) (top + texture->width) );
+                const int mask = _mm_movemask_ps( _mm_cmple_ps(_mm_set1_ps(refDepth), block) );
+
+                return (float) ( (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1) ) / 4.0f;
+        }
+#endif
+
+        uint32_t lit = 0;
+
+        for(int64_t row = y; row < y + kernelSize; ++row)
+        {
+                if(row < 0 || row >= texture->height)
+                {
+                        lit += kernelSize;
+                        continue;
+                }
+
+                lit += mnkt_texture_countLitTexels(&texture->depth[(size_t) row * texture->width], texture->width, x, kernelSize, refDepth);
+        }
+
+        return (float) lit / (float) (kernelSize * kernelSize);
+}
+
+
+/**
+ * @function mnkt_texture_countLitTexels
+ * Counts the texels of a sequence, on a row of a depth texture, whose depth is greater than or equal to the reference one
+ * @param row Pointer to the first texel of the row
+ * @param width Number of texels in the row
+ * @param x Index of the first texel of the sequence (may be outside the row)
+ * @param count Number of texels in the sequence
+ * @param refDepth Depth to be compared with the stored ones
+ * @return The number of lit texels (those outside the row are always lit)
+ * @note: For internal usage only!!!
+*/
+static uint32_t mnkt_texture_countLitTexels(const float* row, uint32_t width, int64_t x, uint32_t count, float refDepth)
+{
+        uint32_t lit = 0;
+        uint32_t i = 0;
+
+        // Texels outside the row
+        for(; i < count && x + i < 0; ++i)
+                ++lit;
+
+#ifdef MNKT_SIMD_SSE2
+        const __m128 ref = _mm_set1_ps(refDepth);
+
+        for(; i + 4 <= count && x + i + 4 <= width; i += 4)
+        {
+                int mask = _mm_movemask_ps( _mm_cmple_ps(ref, _mm_loadu_ps(&row[x + i])) );
+
+                // Count the bits of the 4 lanes mask
+                lit += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+        }
+
+        // The last texels (less than 4, e.g. the rows of a 3x3 kernel) are compared together if 4 texels can be read from the row
+        if(i < count && x + i + 4 <= width)
+        {
+                int mask = _mm_movemask_ps( _mm_cmple_ps(ref, _mm_loadu_ps(&row[x + i])) ) & ((1 << (count - i)) - 1);
+
+                lit += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1);
+                i = count;
+        }
+#endif
+
+        for(; i < count; ++i)
+        {
+                if(x + i >= width || refDepth <= row[x + i])
+                        ++lit;
+        }
+
+        return lit;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file texture.h
+ *
+ * Defines the functions used to sample images as textures.
+*/
+
+#ifndef MNKT_TEXTURE_H
+#define MNKT_TEXTURE_H
+
+#include "math/vec.h"
+#include "image.h"
+#include "framebuffer.h"
+
+
+/**
+ * @struct DepthTexture_t
+ * Depth buffer bound as a texture that can be sampled with depth comparisons (e.g. a shadow map).
+ * Depth values are kept in the same float format used by the depth buffer, so no conversion is performed while sampling.
+*/
+typedef struct {
+        uint32_t        width;                  ///< Width of the texture expressed in texels
+        uint32_t        height;                 ///< Height of the texture expressed in texels
+        const float*    depth;                  ///< Depth value of each texel, width * height elements
+} DepthTexture_t;
+
+
+/**
+ * @function mnkt_texture_sample
+ * Samples an image at the given texture coordinates (nearest filtering, coordinates outside the range [0, 1] are wrapped).
+ * The pixels of the image are expected to be packed as 0xRRGGBBAA.
+ * @param texture The image to be sampled
+ * @param uv Texture coordinates, (0, 0) is the top left corner of the image and (1, 1) the bottom right one
+ * @return The color of the sampled texel with components in the range [0.0f, 1.0f] (opaque white if texture is NULL or empty)
+*/
+Vec4_t  mnkt_texture_sample(const Image_t* texture, const Vec2_t* uv);
+
+
+/**
+ * @function mnkt_texture_fromDepthBuffer
+ * Binds the depth buffer of a framebuffer as a depth texture, the texture refers to the framebuffer's memory (no copy is made).
+ * The framebuffer should be a depth only one rendered with depth only programs, multisampled framebuffers are not supported.
+ * @param fb Framebuffer whose depth buffer is bound
+ * @return The depth texture (an empty one if fb is NULL)
+*/
+DepthTexture_t mnkt_texture_fromDepthBuffer(const Framebuffer_t* fb);
+
+
+/**
+ * @function mnkt_texture_sampleCompare
+ * Compares a reference depth with the texel of a depth texture at the given texture coordinates (nearest filtering)
+ * @param texture The depth texture to be sampled
+ * @param uv Texture coordinates, (0, 0) is the top left corner of the texture and (1, 1) the bottom right one
+ * @param refDepth Depth to be compared with the stored one (e.g. the depth of the fragment as seen from the light, bias included)
+ * @return 1.0f if refDepth is less than or equal to the stored depth (lit), 0.0f otherwise.
+ *      Coordinates outside the texture, as well as an empty texture, are always lit.
+*/
+float   mnkt_texture_sampleCompare(const DepthTexture_t* texture, const Vec2_t* uv, float refDepth);
+
+
+/**
+ * @function mnkt_texture_samplePCF
+ * Percentage-closer filtering: compares a reference depth with a square of kernelSize x kernelSize texels centered on the given
+ * texture coordinates and averages the results (the rows of the kernel are compared with vector instructions)
+ * @param texture The depth texture to be sampled
+ * @param uv Texture coordinates, (0, 0) is the top left corner of the texture and (1, 1) the bottom right one
+ * @param refDepth Depth to be compared with the stored ones (e.g. the depth of the fragment as seen from the light, bias included)
+ * @param kernelSize Number of texels on each side of the kernel (2 for a 2x2 kernel, values smaller than one are treated as one)
+ * @return Fraction, in the range [0.0f, 1.0f], of the texels for which refDepth is less than or equal to the stored depth.
+ *      Texels outside the texture, as well as an empty texture, are always lit.
+*/
+float   mnkt_texture_samplePCF(const DepthTexture_t* texture, const Vec2_t* uv, float refDepth, uint32_t kernelSize);
+
+
+#endif // MNKT_TEXTURE_H
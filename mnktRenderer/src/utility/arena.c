@@ -0,0 +1,304 @@
+/**
+ * @file arena.c
+ *
+ * Contains implementation of the linear allocators API
+*/
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * @struct ArenaOverflowBlock_t
+ * Header of a memory block allocated when an arena's buffer is exhausted
+*/
+typedef struct ArenaOverflowBlock_t {
+        struct ArenaOverflowBlock_t*    next;           ///< Next block in the list
+        max_align_t                     data[];         ///< Memory given to the user
+} ArenaOverflowBlock_t;
+
+
+static uintptr_t mnkt_arena_alignAddress(uintptr_t address, size_t alignment);
+static void      mnkt_arena_freeOverflowBlocks(Arena_t* arena);
+
+
+/**
+ * @function mnkt_arena_create
+ * Initializes an arena and allocates its buffer
+ * @param arena Arena to be initialized
+ * @param capacity Initial size in bytes of the arena's buffer
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_arena_create(Arena_t* arena, size_t capacity)
+{
+        if(arena == NULL)
+                return 1;
+
+        memset(arena, 0, sizeof(Arena_t));
+
+        if(capacity == 0)
+                return 0;
+
+        arena->buffer = malloc(capacity);
+        if(arena->buffer == NULL)
+                return 1;
+
+        arena->capacity = capacity;
+        arena->systemAllocations = 1;
+        return 0;
+}
+
+
+/**
+ * @function mnkt_arena_destroy
+ * Deallocates all the memory owned by the given arena
+ * @param arena Arena to be destroyed
+*/
+void mnkt_arena_destroy(Arena_t* arena)
+{
+        if(arena == NULL)
+                return;
+
+        mnkt_arena_freeOverflowBlocks(arena);
+
+        free(arena->buffer);
+        memset(arena, 0, sizeof(Arena_t));
+}
+
+
+/**
+ * @function mnkt_arena_alloc
+ * Allocates a memory block from the given arena
+ * @param arena Arena from which memory must be taken
+ * @param size Size in bytes of the memory block
+ * @param alignment Alignment of the memory block, must be a power of two (use 0 for the default alignment)
+ * @return Pointer to the allocated memory, NULL on failure.
+ *      The memory stays valid until the arena is reset or destroyed.
+*/
+void* mnkt_arena_alloc(Arena_t* arena, size_t size, size_t alignment)
+{
+        if(arena == NULL || size == 0)
+                return NULL;
+
+        if(alignment < _Alignof(max_align_t))
+                alignment = _Alignof(max_align_t);
+
+        // Try to serve the allocation from the buffer
+        if(arena->buffer != NULL)
+        {
+                uintptr_t start = (uintptr_t) arena->buffer;
+                uintptr_t address = mnkt_arena_alignAddress(start + arena->offset, alignment);
+
+                if(address + size <= start + arena->capacity)
+                {
+                        arena->offset = (address - start) + size;
+                        return (void*) address;
+                }
+        }
+
+        // The buffer is exhausted, allocate a dedicated block (the buffer will be grown on the next reset)
+        ArenaOverflowBlock_t* block = malloc(sizeof(ArenaOverflowBlock_t) + size + alignment);
+        if(block == NULL)
+                return NULL;
+
+        block->next = arena->overflowBlocks;
+        arena->overflowBlocks = block;
+
+        arena->overflowSize += size + alignment;
+        ++arena->systemAllocations;
+
+        return (void*) mnkt_arena_alignAddress((uintptr_t) block->data, alignment);
+}
+
+
+/**
+ * @function mnkt_arena_reset
+ * Releases all the allocations made from the given arena, the buffer is grown if during
+ * the last frame the allocations did not fit in it
+ * @param arena Arena to be reset
+*/
+void mnkt_arena_reset(Arena_t* arena)
+{
+        if(arena == NULL)
+                return;
+
+        size_t used = arena->offset + arena->overflowSize;
+        if(used > arena->highWaterMark)
+                arena->highWaterMark = used;
+
+        // Grow the buffer so that it can hold everything that was allocated during the last frame
+        // (its content is dead, so a new buffer is allocated instead of copying the old one with realloc)
+        if(arena->overflowSize > 0)
+        {
+                size_t newCapacity = arena->highWaterMark + (arena->highWaterMark / 2);
+
+                free(arena->buffer);
+                arena->buffer = malloc(newCapacity);
+                arena->capacity = (arena->buffer != NULL) ? newCapacity : 0;
+                ++arena->systemAllocations;
+        }
+
+        mnkt_arena_freeOverflowBlocks(arena);
+        arena->offset = 0;
+}
+
+
+/**
+ * @function mnkt_arena_getStats
+ * Reports the memory usage of the given arena
+ * @param arena Arena of which the memory usage must be reported
+ * @param stats Struct in which the report is stored
+*/
+void mnkt_arena_getStats(const Arena_t* arena, ArenaStats_t* stats)
+{
+        if(arena == NULL || stats == NULL)
+                return;
+
+        stats->capacity = arena->capacity;
+        stats->used = arena->offset + arena->overflowSize;
+        stats->highWaterMark = stats->used > arena->highWaterMark ? stats->used : arena->highWaterMark;
+        stats->systemAllocations = arena->systemAllocations;
+}
+
+
+/**
+ * @function mnkt_frameArena_create
+ * Initializes a frame arena and all its sub arenas
+ * @param frameArena Frame arena to be initialized
+ * @param threadsCount Number of threads that will allocate from the frame arena (at most MNKT_MAX_THREADS)
+ * @param capacityPerThread Initial size in bytes of each sub arena
+ * @return Zero on success, non zero on failure
+*/
+int mnkt_frameArena_create(FrameArena_t* frameArena, uint32_t threadsCount, size_t capacityPerThread)
+{
+        if(frameArena == NULL || threadsCount == 0 || threadsCount > MNKT_MAX_THREADS)
+                return 1;
+
+        memset(frameArena, 0, sizeof(FrameArena_t));
+
+        for(uint32_t i = 0; i < threadsCount; ++i)
+        {
+                if(mnkt_arena_create(&frameArena->threadArenas[i].arena, capacityPerThread) != 0)
+                {
+                        mnkt_frameArena_destroy(frameArena);
+                        return 1;
+                }
+
+                frameArena->threadsCount = i + 1;
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_frameArena_destroy
+ * Deallocates all the memory owned by the given frame arena
+ * @param frameArena Frame arena to be destroyed
+*/
+void mnkt_frameArena_destroy(FrameArena_t* frameArena)
+{
+        if(frameArena == NULL)
+                return;
+
+        for(uint32_t i = 0; i < frameArena->threadsCount; ++i)
+                mnkt_arena_destroy(&frameArena->threadArenas[i].arena);
+
+        frameArena->threadsCount = 0;
+}
+
+
+/**
+ * @function mnkt_frameArena_getThreadArena
+ * Gets the sub arena reserved to a thread
+ * @param frameArena Frame arena from which the sub arena must be taken
+ * @param threadIndex Index of the thread that will use the sub arena
+ * @return The sub arena of the given thread, NULL if the thread index is not valid
+*/
+Arena_t* mnkt_frameArena_getThreadArena(FrameArena_t* frameArena, uint32_t threadIndex)
+{
+        if(frameArena == NULL || threadIndex >= frameArena->threadsCount)
+                return NULL;
+
+        return &frameArena->threadArenas[threadIndex].arena;
+}
+
+
+/**
+ * @function mnkt_frameArena_reset
+ * Releases all the allocations made from all the sub arenas, must be called when no thread is using the frame arena
+ * @param frameArena Frame arena to be reset
+*/
+void mnkt_frameArena_reset(FrameArena_t* frameArena)
+{
+        if(frameArena == NULL)
+                return;
+
+        for(uint32_t i = 0; i < frameArena->threadsCount; ++i)
+                mnkt_arena_reset(&frameArena->threadArenas[i].arena);
+}
+
+
+/**
+ * @function mnkt_frameArena_getStats
+ * Reports the memory usage of the given frame arena, values are summed over all the sub arenas
+ * @param frameArena Frame arena of which the memory usage must be reported
+ * @param stats Struct in which the report is stored
+*/
+void mnkt_frameArena_getStats(const FrameArena_t* frameArena, ArenaStats_t* stats)
+{
+        if(frameArena == NULL || stats == NULL)
+                return;
+
+        memset(stats, 0, sizeof(ArenaStats_t));
+
+        for(uint32_t i = 0; i < frameArena->threadsCount; ++i)
+        {
+                ArenaStats_t threadStats;
+                mnkt_arena_getStats(&frameArena->threadArenas[i].arena, &threadStats);
+
+                stats->capacity += threadStats.capacity;
+                stats->used += threadStats.used;
+                stats->highWaterMark += threadStats.highWaterMark;
+                stats->systemAllocations += threadStats.systemAllocations;
+        }
+}
+
+
+/**
+ * @function mnkt_arena_alignAddress
+ * Rounds up the given address to the next multiple of alignment
+ * @param address The address to be aligned
+ * @param alignment The alignment required, must be a power of two
+ * @return The aligned address
+ * @note: For internal usage only!!!
+*/
+static uintptr_t mnkt_arena_alignAddress(uintptr_t address, size_t alignment)
+{
+        return (address + (alignment - 1)) & ~((uintptr_t) alignment - 1);
+}
+
+
+/**
+ * @function mnkt_arena_freeOverflowBlocks
+ * Releases all the overflow blocks allocated by the given arena
+ * @param arena Arena of which the overflow blocks must be released
+ * @note: For internal usage only!!!
+*/
+static void mnkt_arena_freeOverflowBlocks(Arena_t* arena)
+{
+        ArenaOverflowBlock_t* block = arena->overflowBlocks;
+
+        while(block != NULL)
+        {
+                ArenaOverflowBlock_t* next = block->next;
+                free(block);
+                block = next;
+        }
+
+        arena->overflowBlocks = NULL;
+        arena->overflowSize = 0;
+}
+
@@ -0,0 +1,176 @@
+/**
+ * @file arena.h
+ *
+ * Defines the linear (bump) allocators used to store the transient data produced
+ * by the pipeline during a frame.
+*/
+
+#ifndef MNKT_ARENA_H
+#define MNKT_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/**
+ * @macro MNKT_MAX_THREADS
+ * Maximum number of threads that can allocate concurrently from the same frame arena
+*/
+#define MNKT_MAX_THREADS                64
+
+
+/**
+ * @macro MNKT_CACHE_LINE_SIZE
+ * Size in bytes of a cache line, used to keep per-thread data on separate lines
+*/
+#define MNKT_CACHE_LINE_SIZE            64
+
+
+/**
+ * @struct Arena_t
+ * Linear allocator, memory is taken from a single buffer by bumping an offset and
+ * is released all at once by resetting the arena.
+ *
+ * If an allocation does not fit in the buffer it is served by a dedicated overflow block,
+ * on the next reset the buffer is grown to the high water mark so that, once the
+ * workload stabilizes, no more calls to malloc/free are made.
+*/
+typedef struct {
+        unsigned char*  buffer;                 ///< Memory area from which allocations are served
+        size_t          capacity;               ///< Size in bytes of the buffer
+        size_t          offset;                 ///< Offset of the first free byte inside the buffer
+        size_t          overflowSize;           ///< Number of bytes, allocated since the last reset, that did not fit in the buffer
+        size_t          highWaterMark;          ///< Maximum number of bytes used between two resets since the arena was created
+        size_t          systemAllocations;      ///< Number of calls made to the system allocator since the arena was created
+        void*           overflowBlocks;         ///< List of the blocks allocated when the buffer was exhausted
+} Arena_t;
+
+
+/**
+ * @struct ArenaStats_t
+ * Report about the memory usage of one or more arenas
+*/
+typedef struct {
+        size_t          capacity;               ///< Size in bytes of the buffers owned by the arenas
+        size_t          used;                   ///< Number of bytes currently allocated
+        size_t          highWaterMark;          ///< Maximum number of bytes used between two resets
+        size_t          systemAllocations;      ///< Number of calls made to the system allocator
+} ArenaStats_t;
+
+
+/**
+ * @struct ThreadArena_t
+ * Arena reserved to a single thread, aligned so that different threads never share a cache line
+*/
+typedef struct {
+        _Alignas(MNKT_CACHE_LINE_SIZE) Arena_t arena;
+} ThreadArena_t;
+
+
+/**
+ * @struct FrameArena_t
+ * Set of arenas used to store the transient data of a frame, each thread
+ * has its own sub arena so no synchronization is needed to allocate.
+*/
+typedef struct {
+        ThreadArena_t   threadArenas[MNKT_MAX_THREADS];         ///< Sub arenas, one for each thread
+        uint32_t        threadsCount;                           ///< Number of sub arenas in use
+} FrameArena_t;
+
+
+/**
+ * @function mnkt_arena_create
+ * Initializes an arena and allocates its buffer
+ * @param arena Arena to be initialized
+ * @param capacity Initial size in bytes of the arena's buffer
+ * @return Zero on success, non zero on failure
+*/
+int     mnkt_arena_create(Arena_t* arena, size_t capacity);
+
+
+/**
+ * @function mnkt_arena_destroy
+ * Deallocates all the memory owned by the given arena
+ * @param arena Arena to be destroyed
+*/
+void    mnkt_arena_destroy(Arena_t* arena);
+
+
+/**
+ * @function mnkt_arena_alloc
+ * Allocates a memory block from the given arena
+ * @param arena Arena from which memory must be taken
+ * @param size Size in bytes of the memory block
+ * @param alignment Alignment of the memory block, must be a power of two (use 0 for the default alignment)
+ * @return Pointer to the allocated memory, NULL on failure.
+ *      The memory stays valid until the arena is reset or destroyed.
+*/
+void*   mnkt_arena_alloc(Arena_t* arena, size_t size, size_t alignment);
+
+
+/**
+ * @function mnkt_arena_reset
+ * Releases all the allocations made from the given arena, the buffer is grown if during
+ * the last frame the allocations did not fit in it
+ * @param arena Arena to be reset
+*/
+void    mnkt_arena_reset(Arena_t* arena);
+
+
+/**
+ * @function mnkt_arena_getStats
+ * Reports the memory usage of the given arena
+ * @param arena Arena of which the memory usage must be reported
+ * @param stats Struct in which the report is stored
+*/
+void    mnkt_arena_getStats(const Arena_t* arena, ArenaStats_t* stats);
+
+
+/**
+ * @function mnkt_frameArena_create
+ * Initializes a frame arena and all its sub arenas
+ * @param frameArena Frame arena to be initialized
+ * @param threadsCount Number of threads that will allocate from the frame arena (at most MNKT_MAX_THREADS)
+ * @param capacityPerThread Initial size in bytes of each sub arena
+ * @return Zero on success, non zero on failure
+*/
+int     mnkt_frameArena_create(FrameArena_t* frameArena, uint32_t threadsCount, size_t capacityPerThread);
+
+
+/**
+ * @function mnkt_frameArena_destroy
+ * Deallocates all the memory owned by the given frame arena
+ * @param frameArena Frame arena to be destroyed
+*/
+void    mnkt_frameArena_destroy(FrameArena_t* frameArena);
+
+
+/**
+ * @function mnkt_frameArena_getThreadArena
+ * Gets the sub arena reserved to a thread
+ * @param frameArena Frame arena from which the sub arena must be taken
+ * @param threadIndex Index of the thread that will use the sub arena
+ * @return The sub arena of the given thread, NULL if the thread index is not valid
+*/
+Arena_t* mnkt_frameArena_getThreadArena(FrameArena_t* frameArena, uint32_t threadIndex);
+
+
+/**
+ * @function mnkt_frameArena_reset
+ * Releases all the allocations made from all the sub arenas, must be called when no thread is using the frame arena
+ * @param frameArena Frame arena to be reset
+*/
+void    mnkt_frameArena_reset(FrameArena_t* frameArena);
+
+
+/**
+ * @function mnkt_frameArena_getStats
+ * Reports the memory usage of the given frame arena, values are summed over all the sub arenas
+ * @param frameArena Frame arena of which the memory usage must be reported
+ * @param stats Struct in which the report is stored
+*/
+void    mnkt_frameArena_getStats(const FrameArena_t* frameArena, ArenaStats_t* stats);
+
+
+#endif // MNKT_ARENA_H
+
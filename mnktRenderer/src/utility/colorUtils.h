@@ -3,11 +3,15 @@
  * @file colorUtils.h
  *
  * Contains definition of utility functions to work with colors
+ * (defined in this header to be inlined in every translation unit)
 */
 
 #ifndef MNKT_COLOR_UTILS_H
 #define MNKT_COLOR_UTILS_H
 
+#include "inline.h"
+#include "../math/mathUtils.h"
+
 
 /**
  * @function mnkt_colorAsUChar
@@ -16,7 +20,12 @@
  *      Should be in range [0.0f, 1.0f], a greater value will be clamped
  * @return A value in the range [0, 255] that represents the given color value
 */
-unsigned char   mnkt_colorAsUChar(float color);
+static MNKT_FORCEINLINE unsigned char mnkt_colorAsUChar(float color)
+{
+        color = mnkt_math_clamp(color, 0.0f, 1.0f);
+
+        return color * 255;
+}
 
 
 /**
@@ -25,7 +34,10 @@ unsigned char   mnkt_colorAsUChar(float color);
  * @param color The value to be converted.
  * @return A float value in the range [0.0f, 1.0f] that represents the given color value
 */
-float           mnkt_colorAsFloat(unsigned char color);
+static MNKT_FORCEINLINE float mnkt_colorAsFloat(unsigned char color)
+{
+        return (float) color / 255.0f;
+}
 
 
 #endif // MNKT_COLOR_UTILS_H
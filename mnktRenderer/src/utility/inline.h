@@ -0,0 +1,26 @@
+
+/**
+ * @file inline.h
+ *
+ * Defines the macro used to force the inlining of small functions defined in headers
+ * (e.g. the math functions used in the per pixel loops), so that they are inlined in every translation unit.
+*/
+
+#ifndef MNKT_INLINE_H
+#define MNKT_INLINE_H
+
+
+/**
+ * @macro MNKT_FORCEINLINE
+ * Asks the compiler to always inline the function (must be used along with static)
+*/
+#if defined(_MSC_VER)
+        #define MNKT_FORCEINLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+        #define MNKT_FORCEINLINE inline __attribute__((always_inline))
+#else
+        #define MNKT_FORCEINLINE inline
+#endif
+
+
+#endif // MNKT_INLINE_H
@@ -0,0 +1,633 @@
+/**
+ * @file jobs.c
+ *
+ * Contains implementation of the job system API
+*/
+
+// Needed by pthread_setaffinity_np, used to bind the workers to the requested processors
+#ifdef __linux__
+        #define _GNU_SOURCE
+#endif
+
+#include "jobs.h"
+
+#include "arena.h"
+
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+        #include <unistd.h>
+#endif
+
+#if defined(MNKT_THREADS) && defined(__GLIBC__)
+        #include <pthread.h>
+        #include <sched.h>
+#endif
+
+
+/**
+ * @macro MNKT_JOBS_DEFAULT_WORKERS
+ * Number of workers started by default when the number of processors can not be queried
+*/
+#define MNKT_JOBS_DEFAULT_WORKERS       3
+
+
+#ifdef MNKT_THREADS
+/**
+ * @enum JobSystemState_t
+ * States of the pool of workers
+ * @note: For internal usage only!!!
+*/
+typedef enum {
+        MNKT_JOBS_NOT_STARTED = 0,              ///< The pool is started with the default configuration when the first job is submitted
+        MNKT_JOBS_RUNNING,                      ///< The workers are running
+        MNKT_JOBS_STOPPED,                      ///< The workers have been stopped, jobs are run by the submitting thread
+} JobSystemState_t;
+
+
+/**
+ * @struct Job_t
+ * Job waiting in a deque
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        JobFunc_t               func;                   ///< Function run by the job
+        void*                   data;                   ///< Pointer passed to the function
+        JobCounter_t*           counter;                ///< Counter decremented once the job has been completed (can be NULL)
+} Job_t;
+
+
+/**
+ * @struct JobQueue_t
+ * Deque of the jobs of a worker: the worker pushes and takes jobs at the bottom, the other threads steal them from the top.
+ * Each deque is on its own cache lines, so workers that use their own deque do not interfere with each other.
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        _Alignas(MNKT_CACHE_LINE_SIZE) mtx_t mutex;     ///< Protects the deque
+        uint32_t                top;                    ///< Position of the oldest job
+        uint32_t                bottom;                 ///< Position following the newest job
+        Job_t                   jobs[MNKT_JOBS_QUEUE_SIZE];     ///< Circular buffer of the jobs
+} JobQueue_t;
+
+
+/**
+ * @struct JobSystem_t
+ * Pool of workers shared by the whole library
+ * @note: For internal usage only!!!
+*/
+typedef struct {
+        JobQueue_t              queues[MNKT_MAX_THREADS];       ///< Deque of each worker
+        thrd_t                  threads[MNKT_MAX_THREADS];      ///< Threads of the workers that have been started
+        uint32_t                cpus[MNKT_MAX_THREADS];         ///< Processor to which each worker is bound
+        int                     pinned;                 ///< Non zero if the workers are bound to the processors
+        uint32_t                workersCount;           ///< Number of deques in use (one for each worker)
+        uint32_t                threadsCount;           ///< Number of workers that have been started
+        atomic_uint             queuedJobs;             ///< Number of jobs waiting in the deques
+        atomic_uint             nextQueue;              ///< Deque used by the next job submitted from outside of the pool
+        mtx_t                   sleepMutex;             ///< Protects the stop flag, used by idle workers to wait for jobs
+        cnd_t                   jobQueued;              ///< Signaled when a job is queued or the pool is stopped
+        int                     stop;                   ///< Non zero when the workers must terminate
+        mtx_t                   stateMutex;             ///< Serializes the start and the stop of the pool
+        atomic_int              state;                  ///< State of the pool
+} JobSystem_t;
+
+
+// Pool of workers of the library, started by the first job
+static JobSystem_t mnkt_jobSystem;
+static once_flag mnkt_jobs_onceFlag = ONCE_FLAG_INIT;
+
+// Index of the worker run by the current thread (-1 for the threads outside of the pool)
+static _Thread_local int32_t mnkt_jobs_workerIndex = -1;
+
+
+// Prototypes for internal functions
+
+static void     mnkt_jobs_initOnce(void);
+static uint32_t mnkt_jobs_ensureStarted(void);
+static int      mnkt_jobs_start(uint32_t workersCount, const uint32_t* cpus);
+static void     mnkt_jobs_stop(void);
+static int      mnkt_jobs_runWorker(void* data);
+static int      mnkt_jobs_push(const Job_t* job);
+static int      mnkt_jobs_take(int32_t workerIndex, Job_t* job);
+static void     mnkt_jobs_execute(const Job_t* job);
+static uint32_t mnkt_jobs_getDefaultWorkersCount(void);
+#endif
+
+
+/**
+ * @function mnkt_jobs_init
+ * Starts the pool of workers, replacing the one already running (no job must be in flight)
+ * @param workersCount Number of worker threads, the threads that submit jobs not included (0 to run the jobs on the submitting thread, in order)
+ * @param cpus Processor to which each worker is bound (NULL to let the system schedule them, ignored where not supported)
+ * @return Zero on success, non zero if some workers could not be started (the pool keeps those that were started)
+*/
+int mnkt_jobs_init(uint32_t workersCount, const uint32_t* cpus)
+{
+#ifdef MNKT_THREADS
+        call_once(&mnkt_jobs_onceFlag, mnkt_jobs_initOnce);
+
+        mtx_lock(&mnkt_jobSystem.stateMutex);
+
+        if(atomic_load(&mnkt_jobSystem.state) == MNKT_JOBS_RUNNING)
+                mnkt_jobs_stop();
+
+        const int result = mnkt_jobs_start(workersCount, cpus);
+
+        mtx_unlock(&mnkt_jobSystem.stateMutex);
+
+        return result;
+#else
+        (void) cpus;
+
+        return workersCount > 0;
+#endif
+}
+
+
+/**
+ * @function mnkt_jobs_shutdown
+ * Runs the jobs still queued, stops the workers and waits for them. Jobs submitted later are run by the submitting thread.
+*/
+void mnkt_jobs_shutdown(void)
+{
+#ifdef MNKT_THREADS
+        call_once(&mnkt_jobs_onceFlag, mnkt_jobs_initOnce);
+
+        mtx_lock(&mnkt_jobSystem.stateMutex);
+
+        if(atomic_load(&mnkt_jobSystem.state) == MNKT_JOBS_RUNNING)
+                mnkt_jobs_stop();
+
+        atomic_store(&mnkt_jobSystem.state, MNKT_JOBS_STOPPED);
+
+        mtx_unlock(&mnkt_jobSystem.stateMutex);
+#endif
+}
+
+
+/**
+ * @function mnkt_jobs_getWorkersCount
+ * Gets the number of worker threads of the pool (the pool is started if needed)
+ * @return The number of workers (0 if the jobs are run by the submitting thread)
+*/
+uint32_t mnkt_jobs_getWorkersCount(void)
+{
+#ifdef MNKT_THREADS
+        return mnkt_jobs_ensureStarted();
+#else
+        return 0;
+#endif
+}
+
+
+/**
+ * @function mnkt_jobs_initCounter
+ * Initializes a counter with no pending jobs
+ * @param counter The counter
+*/
+void mnkt_jobs_initCounter(JobCounter_t* counter)
+{
+        if(counter == NULL)
+                return;
+
+#ifdef MNKT_THREADS
+        atomic_init(&counter->pending, 0);
+#else
+        counter->pending = 0;
+#endif
+}
+
+
+/**
+ * @function mnkt_jobs_submit
+ * Queues a job, it is run by one of the workers (or by a thread that waits for a counter)
+ * @param func Function run by the job
+ * @param data Pointer passed to the function (must stay valid until the job has been completed)
+ * @param counter Counter incremented now and decremented once the job has been completed (can be NULL)
+*/
+void mnkt_jobs_submit(JobFunc_t func, void* data, JobCounter_t* counter)
+{
+        if(func == NULL)
+                return;
+
+#ifdef MNKT_THREADS
+        const Job_t job = {
+                .func = func,
+                .data = data,
+                .counter = counter
+        };
+
+        if(counter != NULL)
+                atomic_fetch_add_explicit(&counter->pending, 1, memory_order_relaxed);
+
+        // Without workers, or if the deque is full, the job is run right away
+        if(mnkt_jobs_ensureStarted() == 0 || !mnkt_jobs_push(&job))
+                mnkt_jobs_execute(&job);
+#else
+        (void) counter;
+
+        func(data);
+#endif
+}
+
+
+/**
+ * @function mnkt_jobs_wait
+ * Runs the queued jobs until all the jobs of a counter have been completed
+ * @param counter The counter
+*/
+void mnkt_jobs_wait(JobCounter_t* counter)
+{
+#ifdef MNKT_THREADS
+        if(counter == NULL)
+                return;
+
+        Job_t job;
+
+        // The waiting thread helps the workers instead of sleeping, so waiting inside a job never blocks the pool
+        while(atomic_load_explicit(&counter->pending, memory_order_acquire) != 0)
+        {
+                if( mnkt_jobs_take(mnkt_jobs_workerIndex, &job) )
+                        mnkt_jobs_execute(&job);
+                else
+                        thrd_yield();
+        }
+#else
+        (void) counter;
+#endif
+}
+
+
+/**
+ * @function mnkt_jobs_runParallel
+ * Runs a function on several threads at once: the calling thread and up to threadsCount - 1 workers,
+ * then waits for all of them. The function is expected to split the work by itself (e.g. by taking the next tile from an atomic index).
+ * @param func Function to be run
+ * @param data Pointer passed to the function
+ * @param threadsCount Maximum number of threads that run the function, the calling thread included
+*/
+void mnkt_jobs_runParallel(JobFunc_t func, void* data, uint32_t threadsCount)
+{
+        if(func == NULL)
+                return;
+
+        // Jobs that start after the work has been taken by the other threads return immediately
+        uint32_t helpersCount = (threadsCount > 1) ? threadsCount - 1 : 0;
+
+        if(helpersCount > 0 && helpersCount > mnkt_jobs_getWorkersCount())
+                helpersCount = mnkt_jobs_getWorkersCount();
+
+        JobCounter_t counter;
+        mnkt_jobs_initCounter(&counter);
+
+        for(uint32_t i = 0; i < helpersCount; ++i)
+                mnkt_jobs_submit(func, data, &counter);
+
+        func(data);
+
+        mnkt_jobs_wait(&counter);
+}
+
+
+#ifdef MNKT_THREADS
+/**
+ * @function mnkt_jobs_initOnce
+ * Initializes the mutex that serializes the start and the stop of the pool
+ * @note: For internal usage only!!!
+*/
+static void mnkt_jobs_initOnce(void)
+{
+        mtx_init(&mnkt_jobSystem.stateMutex, mtx_plain);
+}
+
+
+/**
+ * @function mnkt_jobs_ensureStarted
+ * Starts the pool with the default configuration if it has been neither configured nor stopped
+ * @return The number of workers of the pool
+ * @note: For internal usage only!!!
+*/
+static uint32_t mnkt_jobs_ensureStarted(void)
+{
+        int state = atomic_load_explicit(&mnkt_jobSystem.state, memory_order_acquire);
+
+        if(state == MNKT_JOBS_NOT_STARTED)
+        {
+                call_once(&mnkt_jobs_onceFlag, mnkt_jobs_initOnce);
+
+                mtx_lock(&mnkt_jobSystem.stateMutex);
+
+                if(atomic_load(&mnkt_jobSystem.state) == MNKT_JOBS_NOT_STARTED)
+                        mnkt_jobs_start(mnkt_jobs_getDefaultWorkersCount(), NULL);
+
+                mtx_unlock(&mnkt_jobSystem.stateMutex);
+
+                state = atomic_load_explicit(&mnkt_jobSystem.state, memory_order_acquire);
+        }
+
+        return (state == MNKT_JOBS_RUNNING) ? mnkt_jobSystem.workersCount : 0;
+}
+
+
+/**
+ * @function mnkt_jobs_start
+ * Creates the deques and starts the workers (the state mutex must be locked)
+ * @param workersCount Number of workers
+ * @param cpus Processor to which each worker is bound (can be NULL)
+ * @return Zero on success, non zero if some workers could not be started
+ * @note: For internal usage only!!!
+*/
+static int mnkt_jobs_start(uint32_t workersCount, const uint32_t* cpus)
+{
+        JobSystem_t* system = &mnkt_jobSystem;
+
+        if(workersCount > MNKT_MAX_THREADS)
+                workersCount = MNKT_MAX_THREADS;
+
+        system->workersCount = 0;
+        system->threadsCount = 0;
+        system->stop = 0;
+        system->pinned = (cpus != NULL);
+
+        atomic_init(&system->queuedJobs, 0);
+        atomic_init(&system->nextQueue, 0);
+
+        // Without workers the jobs are run, in order, by the submitting thread
+        if(workersCount == 0)
+        {
+                atomic_store(&system->state, MNKT_JOBS_STOPPED);
+                return 0;
+        }
+
+        if(mtx_init(&system->sleepMutex, mtx_plain) != thrd_success)
+        {
+                atomic_store(&system->state, MNKT_JOBS_STOPPED);
+                return 1;
+        }
+
+        if(cnd_init(&system->jobQueued) != thrd_success)
+        {
+                mtx_destroy(&system->sleepMutex);
+                atomic_store(&system->state, MNKT_JOBS_STOPPED);
+                return 1;
+        }
+
+        for(uint32_t i = 0; i < workersCount; ++i)
+        {
+                JobQueue_t* queue = &system->queues[i];
+
+                mtx_init(&queue->mutex, mtx_plain);
+                queue->top = 0;
+                queue->bottom = 0;
+
+                system->cpus[i] = (cpus != NULL) ? cpus[i] : 0;
+        }
+
+        // The deques of the workers that could not be started are emptied by the others
+        system->workersCount = workersCount;
+
+        for(uint32_t i = 0; i < workersCount; ++i)
+        {
+                if(thrd_create(&system->threads[system->threadsCount], mnkt_jobs_runWorker, (void*) (uintptr_t) i) == thrd_success)
+                        ++system->threadsCount;
+        }
+
+        if(system->threadsCount == 0)
+        {
+                mnkt_jobs_stop();
+                return 1;
+        }
+
+        atomic_store_explicit(&system->state, MNKT_JOBS_RUNNING, memory_order_release);
+
+        return system->threadsCount < workersCount;
+}
+
+
+/**
+ * @function mnkt_jobs_stop
+ * Stops the workers once the queued jobs have been run and releases the deques (the state mutex must be locked)
+ * @note: For internal usage only!!!
+*/
+static void mnkt_jobs_stop(void)
+{
+        JobSystem_t* system = &mnkt_jobSystem;
+
+        mtx_lock(&system->sleepMutex);
+        system->stop = 1;
+        cnd_broadcast(&system->jobQueued);
+        mtx_unlock(&system->sleepMutex);
+
+        for(uint32_t i = 0; i < system->threadsCount; ++i)
+                thrd_join(system->threads[i], NULL);
+
+        for(uint32_t i = 0; i < system->workersCount; ++i)
+                mtx_destroy(&system->queues[i].mutex);
+
+        cnd_destroy(&system->jobQueued);
+        mtx_destroy(&system->sleepMutex);
+
+        system->workersCount = 0;
+        system->threadsCount = 0;
+
+        atomic_store(&system->state, MNKT_JOBS_STOPPED);
+}
+
+
+/**
+ * @function mnkt_jobs_runWorker
+ * Runs the jobs of its own deque and steals the others, sleeps when there are no jobs (entry point of the workers)
+ * @param data Index of the worker
+ * @return Always zero
+ * @note: For internal usage only!!!
+*/
+static int mnkt_jobs_runWorker(void* data)
+{
+        JobSystem_t* system = &mnkt_jobSystem;
+        const int32_t workerIndex = (int32_t) (uintptr_t) data;
+
+        mnkt_jobs_workerIndex = workerIndex;
+
+#ifdef __GLIBC__
+        if(system->pinned && system->cpus[workerIndex] < CPU_SETSIZE)
+        {
+                cpu_set_t cpuSet;
+
+                CPU_ZERO(&cpuSet);
+                CPU_SET(system->cpus[workerIndex], &cpuSet);
+                pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+        }
+#endif
+
+        Job_t job;
+
+        for(;;)
+        {
+                if( mnkt_jobs_take(workerIndex, &job) )
+                {
+                        mnkt_jobs_execute(&job);
+                        continue;
+                }
+
+                // Jobs are counted before the condition is signaled, so a job queued while checking is never missed
+                mtx_lock(&system->sleepMutex);
+
+                while(atomic_load(&system->queuedJobs) == 0 && !system->stop)
+                        cnd_wait(&system->jobQueued, &system->sleepMutex);
+
+                const int terminate = system->stop && atomic_load(&system->queuedJobs) == 0;
+
+                mtx_unlock(&system->sleepMutex);
+
+                if(terminate)
+                        break;
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_jobs_push
+ * Pushes a job at the bottom of the deque of the current worker (of one of the workers, in turn, for the threads outside of the pool)
+ * and wakes up an idle worker
+ * @param job The job
+ * @return One if the job has been queued, zero if the deque is full
+ * @note: For internal usage only!!!
+*/
+static int mnkt_jobs_push(const Job_t* job)
+{
+        JobSystem_t* system = &mnkt_jobSystem;
+
+        const uint32_t queueIndex = (mnkt_jobs_workerIndex >= 0) ? (uint32_t) mnkt_jobs_workerIndex :
+                                    atomic_fetch_add_explicit(&system->nextQueue, 1, memory_order_relaxed) % system->workersCount;
+
+        JobQueue_t* queue = &system->queues[queueIndex];
+
+        mtx_lock(&queue->mutex);
+
+        if(queue->bottom - queue->top == MNKT_JOBS_QUEUE_SIZE)
+        {
+                mtx_unlock(&queue->mutex);
+                return 0;
+        }
+
+        queue->jobs[queue->bottom % MNKT_JOBS_QUEUE_SIZE] = *job;
+        ++queue->bottom;
+
+        mtx_unlock(&queue->mutex);
+
+        atomic_fetch_add(&system->queuedJobs, 1);
+
+        mtx_lock(&system->sleepMutex);
+        cnd_signal(&system->jobQueued);
+        mtx_unlock(&system->sleepMutex);
+
+        return 1;
+}
+
+
+/**
+ * @function mnkt_jobs_take
+ * Takes the newest job of the deque of a worker or, if it is empty, steals the oldest job of another deque
+ * @param workerIndex Index of the worker (-1 for the threads outside of the pool, they only steal)
+ * @param job Where the job is stored
+ * @return One if a job has been taken, zero if all the deques are empty
+ * @note: For internal usage only!!!
+*/
+static int mnkt_jobs_take(int32_t workerIndex, Job_t* job)
+{
+        JobSystem_t* system = &mnkt_jobSystem;
+
+        if(atomic_load_explicit(&system->queuedJobs, memory_order_relaxed) == 0)
+                return 0;
+
+        const uint32_t workersCount = system->workersCount;
+
+        if(workerIndex >= 0)
+        {
+                JobQueue_t* queue = &system->queues[workerIndex];
+
+                mtx_lock(&queue->mutex);
+
+                if(queue->bottom != queue->top)
+                {
+                        --queue->bottom;
+                        *job = queue->jobs[queue->bottom % MNKT_JOBS_QUEUE_SIZE];
+
+                        mtx_unlock(&queue->mutex);
+                        atomic_fetch_sub(&system->queuedJobs, 1);
+
+                        return 1;
+                }
+
+                mtx_unlock(&queue->mutex);
+        }
+
+        // Victims are visited starting from a different deque for each thief
+        const uint32_t first = (workerIndex >= 0) ? (uint32_t) workerIndex + 1 :
+                               atomic_load_explicit(&system->nextQueue, memory_order_relaxed);
+
+        for(uint32_t i = 0; i < workersCount; ++i)
+        {
+                const uint32_t victim = (first + i) % workersCount;
+
+                if((int32_t) victim == workerIndex)
+                        continue;
+
+                JobQueue_t* queue = &system->queues[victim];
+
+                mtx_lock(&queue->mutex);
+
+                if(queue->bottom != queue->top)
+                {
+                        *job = queue->jobs[queue->top % MNKT_JOBS_QUEUE_SIZE];
+                        ++queue->top;
+
+                        mtx_unlock(&queue->mutex);
+                        atomic_fetch_sub(&system->queuedJobs, 1);
+
+                        return 1;
+                }
+
+                mtx_unlock(&queue->mutex);
+        }
+
+        return 0;
+}
+
+
+/**
+ * @function mnkt_jobs_execute
+ * Runs a job and decrements its counter
+ * @param job The job
+ * @note: For internal usage only!!!
+*/
+static void mnkt_jobs_execute(const Job_t* job)
+{
+        job->func(job->data);
+
+        if(job->counter != NULL)
+                atomic_fetch_sub_explicit(&job->counter->pending, 1, memory_order_release);
+}
+
+
+/**
+ * @function mnkt_jobs_getDefaultWorkersCount
+ * Computes the number of workers started by default: one less than the number of processors, as the submitting thread works as well
+ * @return The number of workers
+ * @note: For internal usage only!!!
+*/
+static uint32_t mnkt_jobs_getDefaultWorkersCount(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+        const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+        if(processors >= 1)
+                return (processors - 1 < MNKT_MAX_THREADS) ? (uint32_t) (processors - 1) : MNKT_MAX_THREADS;
+#endif
+
+        return MNKT_JOBS_DEFAULT_WORKERS;
+}
+#endif
@@ -0,0 +1,120 @@
+
+/**
+ * @file jobs.h
+ *
+ * Defines the job system: a fixed pool of worker threads shared by all the parallel parts of the renderer
+ * (full screen passes, meshlets bands, bands of the frame pipeline) and available to the application
+ * (e.g. to encode the images produced by the pipeline).
+ *
+ * Each worker owns a deque of jobs: it runs the most recently pushed job of its own deque and, when it is empty,
+ * steals the oldest job of the other deques. Threads that wait for a counter run the queued jobs as well,
+ * so jobs can submit other jobs and wait for them without blocking a worker.
+ *
+ * The pool is started, with one worker less than the number of processors, the first time a job is submitted,
+ * unless it has been configured with mnkt_jobs_init. With zero workers (or without threads support) the jobs
+ * are run, in order, by the thread that submits them.
+*/
+
+#ifndef MNKT_JOBS_H
+#define MNKT_JOBS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "thread.h"
+
+
+/**
+ * @macro MNKT_JOBS_QUEUE_SIZE
+ * Maximum number of jobs waiting in the deque of each worker (jobs that do not fit are run by the submitting thread)
+*/
+#define MNKT_JOBS_QUEUE_SIZE            256
+
+
+/**
+ * @typedef JobFunc_t
+ * Function run by a job
+ *
+ * Such function takes as input:
+ *      - data: the pointer given when the job was submitted
+*/
+typedef void (*JobFunc_t)(void* data);
+
+
+/**
+ * @struct JobCounter_t
+ * Number of the submitted jobs that have not been completed yet, used to wait for a group of jobs
+ * (e.g. the jobs that a later one depends on)
+*/
+typedef struct {
+#ifdef MNKT_THREADS
+        atomic_uint             pending;                ///< Jobs not completed yet
+#else
+        uint32_t                pending;                ///< Jobs not completed yet
+#endif
+} JobCounter_t;
+
+
+/**
+ * @function mnkt_jobs_init
+ * Starts the pool of workers, replacing the one already running (no job must be in flight)
+ * @param workersCount Number of worker threads, the threads that submit jobs not included (0 to run the jobs on the submitting thread, in order)
+ * @param cpus Processor to which each worker is bound (NULL to let the system schedule them, ignored where not supported)
+ * @return Zero on success, non zero if some workers could not be started (the pool keeps those that were started)
+*/
+int     mnkt_jobs_init(uint32_t workersCount, const uint32_t* cpus);
+
+
+/**
+ * @function mnkt_jobs_shutdown
+ * Runs the jobs still queued, stops the workers and waits for them. Jobs submitted later are run by the submitting thread.
+*/
+void    mnkt_jobs_shutdown(void);
+
+
+/**
+ * @function mnkt_jobs_getWorkersCount
+ * Gets the number of worker threads of the pool (the pool is started if needed)
+ * @return The number of workers (0 if the jobs are run by the submitting thread)
+*/
+uint32_t mnkt_jobs_getWorkersCount(void);
+
+
+/**
+ * @function mnkt_jobs_initCounter
+ * Initializes a counter with no pending jobs
+ * @param counter The counter
+*/
+void    mnkt_jobs_initCounter(JobCounter_t* counter);
+
+
+/**
+ * @function mnkt_jobs_submit
+ * Queues a job, it is run by one of the workers (or by a thread that waits for a counter)
+ * @param func Function run by the job
+ * @param data Pointer passed to the function (must stay valid until the job has been completed)
+ * @param counter Counter incremented now and decremented once the job has been completed (can be NULL)
+*/
+void    mnkt_jobs_submit(JobFunc_t func, void* data, JobCounter_t* counter);
+
+
+/**
+ * @function mnkt_jobs_wait
+ * Runs the queued jobs until all the jobs of a counter have been completed
+ * @param counter The counter
+*/
+void    mnkt_jobs_wait(JobCounter_t* counter);
+
+
+/**
+ * @function mnkt_jobs_runParallel
+ * Runs a function on several threads at once: the calling thread and up to threadsCount - 1 workers,
+ * then waits for all of them. The function is expected to split the work by itself (e.g. by taking the next tile from an atomic index).
+ * @param func Function to be run
+ * @param data Pointer passed to the function
+ * @param threadsCount Maximum number of threads that run the function, the calling thread included
+*/
+void    mnkt_jobs_runParallel(JobFunc_t func, void* data, uint32_t threadsCount);
+
+
+#endif // MNKT_JOBS_H
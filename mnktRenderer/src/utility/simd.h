@@ -0,0 +1,43 @@
+/**
+ * @file simd.h
+ *
+ * Detects the SIMD instruction sets available on the target and includes the related intrinsics.
+ * Code that uses SIMD instructions must always provide a scalar fallback.
+*/
+
+#ifndef MNKT_SIMD_H
+#define MNKT_SIMD_H
+
+
+/**
+ * @macro MNKT_SIMD_SSE2
+ * Defined if SSE2 instructions can be used
+*/
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define MNKT_SIMD_SSE2
+        #include <emmintrin.h>
+#endif
+
+
+/**
+ * @macro MNKT_SIMD_SSE41
+ * Defined if SSE4.1 instructions can be used
+*/
+#if defined(__SSE4_1__) || defined(__AVX__)
+        #define MNKT_SIMD_SSE41
+        #include <smmintrin.h>
+#endif
+
+
+/**
+ * @macro MNKT_SIMD_AVX
+ * Defined if AVX instructions can be used
+*/
+#if defined(__AVX__)
+        #define MNKT_SIMD_AVX
+        #include <immintrin.h>
+#endif
+
+
+#endif // MNKT_SIMD_H
+
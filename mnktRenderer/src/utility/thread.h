@@ -0,0 +1,24 @@
+
+/**
+ * @file thread.h
+ *
+ * Detects whether the C11 threads and atomics libraries are available and includes them.
+ * Code that uses threads must always provide a single threaded fallback.
+*/
+
+#ifndef MNKT_THREAD_H
+#define MNKT_THREAD_H
+
+
+/**
+ * @macro MNKT_THREADS
+ * Defined if C11 threads and atomic operations can be used
+*/
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__) && !defined(__STDC_NO_ATOMICS__)
+        #define MNKT_THREADS
+        #include <threads.h>
+        #include <stdatomic.h>
+#endif
+
+
+#endif // MNKT_THREAD_H